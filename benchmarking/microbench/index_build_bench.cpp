@@ -0,0 +1,191 @@
+// CREATE INDEX cost: bulk loading against one insert per row.
+//
+// Builds the same index over millions of (key, RID) entries, which arrive in
+// random key order as they would from a heap scan, two ways: through
+// BTreeCursor::insertIntoIndex, one root-to-leaf descent and possibly a
+// split per row, and through IndexBuilder, which sorts the entries (spilling
+// runs past DBFS_INDEX_BUILD_SORT_MEMORY_MB) and writes packed pages bottom
+// up. Both times include writing every page back and fsyncing the file. Two
+// key shapes: a single integer, and TPC-C order-line primary keys
+// (w_id, d_id, o_id, ol_number). Reports the time, the rate, the page count
+// and the tree height.
+//
+// Usage: index_build_bench [max_rows] [dir]
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "logging.h"
+#include "storage/buffer/bufferpool.h"
+#include "storage/disk/file.h"
+#include "storage/index/btreecursor.h"
+#include "storage/index/index_builder.h"
+#include "storage/index/index_key.h"
+#include "storage/index/index_page.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<int, 3> kRowCounts = {1000000, 2000000, 4000000};
+
+using KeyOf = std::string (*)(int);
+
+std::string encodeIntKey(int value) {
+  return index_key::encodeFieldValue(
+      FieldValue{static_cast<Column::IntegerType>(value)},
+      Column::Type::Integer);
+}
+
+// The value-th order line, ten per order, 3000 orders per district.
+std::string encodeOrderLineKey(int value) {
+  std::string key;
+  for (const int field : {value / 300000 + 1, value / 30000 % 10 + 1,
+                          value / 10 % 3000 + 1, value % 10 + 1}) {
+    key.push_back('I');
+    key += index_key::encodeInteger(field);
+  }
+  return key;
+}
+
+// The RID a heap with 100 rows per page would give the value-th row.
+RID ridOf(int value) {
+  return RID{static_cast<uint16_t>(value / 100),
+             static_cast<uint16_t>(value % 100)};
+}
+
+void initializeIndexFile(const std::string& path) {
+  std::filesystem::remove(path);
+  File file(path);
+  std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+  Page::initializeNew(buffer.data(), PageKind::LeafIndex,
+                      LeafIndexPage::NO_RIGHT_SIBLING, 0);
+  file.writePageFromBuffer(0, buffer.data());
+}
+
+int treeHeight(BufferPool& pool, File& file) {
+  int height = 1;
+  PageId page_id = file.getRootPageID();
+  while (true) {
+    ReadPageGuard page = pool.readPage(page_id, file);
+    if (page->isLeaf()) {
+      return height;
+    }
+    page_id = InternalIndexPage(*page).leftMostChildPageId();
+    ++height;
+  }
+}
+
+struct BuildResult {
+  double seconds;
+  int pages;
+  int height;
+};
+
+BuildResult insertPerRow(const std::vector<int>& order, KeyOf key_of,
+                         const std::string& path, const std::string& wal_dir) {
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  initializeIndexFile(path);
+  File file(path);
+
+  const auto start = Clock::now();
+  for (const int value : order) {
+    const RID rid = ridOf(value);
+    BTreeCursor::insertIntoIndex(pool, file, key_of(value), rid.heap_page_id,
+                                 rid.slot_id);
+  }
+  while (pool.writeBackDirtyPages(1024) > 0) {
+  }
+  file.sync();
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return {seconds, static_cast<int>(file.getMaxPageID()) + 1,
+          treeHeight(pool, file)};
+}
+
+BuildResult bulkLoad(const std::vector<int>& order, KeyOf key_of,
+                     const std::string& path, const std::string& wal_dir) {
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  initializeIndexFile(path);
+  File file(path);
+
+  const auto start = Clock::now();
+  IndexBuilder builder(file);
+  for (const int value : order) {
+    builder.add(key_of(value), ridOf(value));
+  }
+  builder.finish();
+  file.sync();
+  const double seconds =
+      std::chrono::duration<double>(Clock::now() - start).count();
+  return {seconds, static_cast<int>(file.getMaxPageID()) + 1,
+          treeHeight(pool, file)};
+}
+
+void report(int rows, const char* shape, const char* method,
+            const BuildResult& result) {
+  std::printf("%10d %10s %9s %9.2f %12.0f %7d %7d\n", rows, shape, method,
+              result.seconds, rows / result.seconds, result.pages,
+              result.height);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int max_rows = argc > 1 ? std::atoi(argv[1]) : kRowCounts.back();
+  const std::filesystem::path dir =
+      argc > 2 ? std::filesystem::path(argv[2])
+               : std::filesystem::temp_directory_path() /
+                     "dbfs_index_build_bench";
+  std::filesystem::create_directories(dir);
+  const std::string path = (dir / "bench.index").string();
+  const std::string wal_dir = (dir / "bench.wal").string();
+
+  // Room for the whole per-row index, so it is only written back once.
+  setenv("DBFS_BUFFER_POOL_SIZE_MB", "512", 1);
+  setenv("DBFS_BUFFER_POOL_BGWRITER_DELAY_MS", "0", 1);
+  // Splits log at info level; keep the table readable.
+  dbfs_log::index().set_level(spdlog::level::warn);
+  dbfs_log::storage().set_level(spdlog::level::warn);
+
+  const IndexBuilder::Options options = IndexBuilder::optionsFromEnv();
+  std::printf("fill factor %d%%, sort memory %zu MiB\n",
+              options.fill_factor_percent, options.sort_memory_bytes >> 20);
+  std::printf("%10s %10s %9s %9s %12s %7s %7s\n", "rows", "shape", "method",
+              "seconds", "rows/s", "pages", "height");
+  for (const int rows : kRowCounts) {
+    if (rows > max_rows) {
+      break;
+    }
+    std::vector<int> order(static_cast<size_t>(rows));
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(17));
+    for (const auto& [shape, key_of] :
+         {std::pair<const char*, KeyOf>{"integer", encodeIntKey},
+          std::pair<const char*, KeyOf>{"order_line", encodeOrderLineKey}}) {
+      report(rows, shape, "per-row", insertPerRow(order, key_of, path,
+                                                  wal_dir));
+      report(rows, shape, "bulk", bulkLoad(order, key_of, path, wal_dir));
+    }
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,180 @@
+// B+tree point lookup cost per tree level.
+//
+// Builds indexes of growing size with BTreeCursor (keys inserted in random
+// order, so leaves are partly full like in a live index), keeps every page
+// resident, then times exact-match findEntries on random keys. Two key
+// shapes: a single integer, and TPC-C order-line primary keys
+// (w_id, d_id, o_id, ol_number), whose long shared prefixes the pages store
+// once. Reports the tree height and page count, the time per lookup and the
+// time per level, which is what the in-page search costs once the buffer pool
+// hits. Also times InternalIndexPage::findChildPage alone on the root.
+//
+// Usage: index_lookup_bench [lookups] [dir]
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "logging.h"
+#include "storage/buffer/bufferpool.h"
+#include "storage/disk/file.h"
+#include "storage/index/btreecursor.h"
+#include "storage/index/index_key.h"
+#include "storage/index/index_page.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<int, 4> kIndexSizes = {200, 10000, 100000, 400000};
+
+using KeyOf = std::string (*)(int);
+
+std::string encodeIntKey(int value) {
+  return index_key::encodeFieldValue(
+      FieldValue{static_cast<Column::IntegerType>(value)},
+      Column::Type::Integer);
+}
+
+// The value-th order line, ten per order, 3000 orders per district.
+std::string encodeOrderLineKey(int value) {
+  std::string key;
+  for (const int field : {value / 300000 + 1, value / 30000 % 10 + 1,
+                          value / 10 % 3000 + 1, value % 10 + 1}) {
+    key.push_back('I');
+    key += index_key::encodeInteger(field);
+  }
+  return key;
+}
+
+void initializeIndexFile(const std::string& path) {
+  std::filesystem::remove(path);
+  File file(path);
+  std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+  Page::initializeNew(buffer.data(), PageKind::LeafIndex,
+                      LeafIndexPage::NO_RIGHT_SIBLING, 0);
+  file.writePageFromBuffer(0, buffer.data());
+}
+
+int treeHeight(BufferPool& pool, File& file) {
+  int height = 1;
+  PageId page_id = file.getRootPageID();
+  while (true) {
+    ReadPageGuard page = pool.readPage(page_id, file);
+    if (page->isLeaf()) {
+      return height;
+    }
+    page_id = InternalIndexPage(*page).leftMostChildPageId();
+    ++height;
+  }
+}
+
+double nanosPer(Clock::duration elapsed, size_t count) {
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         static_cast<double>(count);
+}
+
+// Builds one index and times lookups on it; false if a key went missing.
+bool benchIndex(const char* shape, KeyOf key_of, int keys, size_t lookups,
+                const std::string& path, const std::string& wal_dir) {
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  initializeIndexFile(path);
+  File file(path);
+
+  std::mt19937 rng(17);
+  std::vector<int> order(static_cast<size_t>(keys));
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), rng);
+  for (const int key : order) {
+    BTreeCursor::insertIntoIndex(pool, file, key_of(key), 1,
+                                 static_cast<uint16_t>(key));
+  }
+
+  std::uniform_int_distribution<int> key_dist(0, keys - 1);
+  std::vector<std::string> probes(lookups);
+  std::generate(probes.begin(), probes.end(),
+                [&] { return key_of(key_dist(rng)); });
+
+  size_t found = 0;
+  const auto start = Clock::now();
+  for (const std::string& probe : probes) {
+    const BTreeCursor::Boundary exact{probe, true};
+    found += BTreeCursor::findEntries(pool, file, {exact, exact}, false).size();
+  }
+  const auto elapsed = Clock::now() - start;
+  if (found != lookups) {
+    std::fprintf(stderr, "found %zu of %zu keys\n", found, lookups);
+    return false;
+  }
+
+  const int height = treeHeight(pool, file);
+  double root_search = 0.0;
+  {
+    ReadPageGuard root = pool.readPage(file.getRootPageID(), file);
+    if (!root->isLeaf()) {
+      InternalIndexPage internal(*root);
+      uint64_t checksum = 0;
+      const auto root_start = Clock::now();
+      for (const std::string& probe : probes) {
+        checksum += internal.findChildPage(probe);
+      }
+      root_search = nanosPer(Clock::now() - root_start, lookups);
+      if (checksum == 1) {
+        std::printf("\n");
+      }
+    }
+  }
+
+  const double per_lookup = nanosPer(elapsed, lookups);
+  std::printf("%10d %10s %7d %7d %14.1f %13.1f %16.1f\n", keys, shape,
+              height, static_cast<int>(file.getMaxPageID()) + 1, per_lookup,
+              per_lookup / height, root_search);
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t lookups =
+      argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  const std::filesystem::path dir =
+      argc > 2 ? std::filesystem::path(argv[2])
+               : std::filesystem::temp_directory_path() /
+                     "dbfs_index_lookup_bench";
+  std::filesystem::create_directories(dir);
+  const std::string path = (dir / "bench.index").string();
+  const std::string wal_dir = (dir / "bench.wal").string();
+
+  setenv("DBFS_BUFFER_POOL_SIZE_MB", "256", 1);
+  setenv("DBFS_BUFFER_POOL_BGWRITER_DELAY_MS", "0", 1);
+  // Splits log at info level; keep the table readable.
+  dbfs_log::index().set_level(spdlog::level::warn);
+  dbfs_log::storage().set_level(spdlog::level::warn);
+
+  std::printf("%zu lookups per index\n", lookups);
+  std::printf("%10s %10s %7s %7s %14s %13s %16s\n", "keys", "shape",
+              "height", "pages", "ns/lookup", "ns/level", "ns/root search");
+  for (const int keys : kIndexSizes) {
+    if (!benchIndex("integer", encodeIntKey, keys, lookups, path, wal_dir) ||
+        !benchIndex("order_line", encodeOrderLineKey, keys, lookups, path,
+                    wal_dir)) {
+      return 1;
+    }
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
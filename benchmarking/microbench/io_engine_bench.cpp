@@ -0,0 +1,171 @@
+// Buffer pool I/O: blocking misses against batched reads and write-back.
+//
+// Builds a heap file larger than the buffer pool, drops it from the page
+// cache, and scans it: pinPage on every page with read-ahead off (one
+// blocking read per miss), pinPage with the default sequential read-ahead,
+// and prefetchPages in batches followed by pins, once per I/O engine. The
+// scan is run in file order and in a random order. Then it times
+// writeBackDirtyPages on a pool full of dirty pages per engine; the thread
+// pool with a single thread stands in for one write at a time.
+//
+// Usage: io_engine_bench [pages] [dir]
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/buffer/bufferpool.h"
+#include "storage/disk/file.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kPrefetchBatch = 64;
+
+struct EngineConfig {
+  const char* label;
+  const char* engine;
+  const char* threads;
+};
+
+constexpr std::array<EngineConfig, 3> kEngines = {{
+    {"io_uring", "io_uring", "4"},
+    {"threads(4)", "threads", "4"},
+    {"threads(1)", "threads", "1"},
+}};
+
+void dropFromPageCache(const std::string& path) {
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd == -1) {
+    return;
+  }
+  ::fdatasync(fd);
+  ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  ::close(fd);
+}
+
+void buildFile(const std::string& path, int pages) {
+  std::filesystem::remove(path);
+  File file(path);
+  std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+  for (int i = 0; i < pages; ++i) {
+    const PageId page_id = file.allocateNextPageId();
+    Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    file.writePageFromBuffer(page_id, buffer.data());
+  }
+}
+
+void useEngine(const EngineConfig& config) {
+  setenv("DBFS_IO_ENGINE", config.engine, 1);
+  setenv("DBFS_IO_THREADS", config.threads, 1);
+}
+
+double scan(const std::string& path, const std::string& wal_dir,
+            const std::vector<PageId>& order, bool prefetch) {
+  dropFromPageCache(path);
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  File file(path);
+  const auto start = Clock::now();
+  for (size_t first = 0; first < order.size(); first += kPrefetchBatch) {
+    const size_t last = std::min(order.size(), first + kPrefetchBatch);
+    if (prefetch) {
+      pool.prefetchPages(file, std::vector<PageId>(order.begin() + first,
+                                                   order.begin() + last));
+    }
+    for (size_t i = first; i < last; ++i) {
+      Page* page = pool.pinPage(order[i], file);
+      pool.unpinPage(page, file);
+    }
+  }
+  return std::chrono::duration<double, std::milli>(Clock::now() - start)
+      .count();
+}
+
+double writeBack(const std::string& path, const std::string& wal_dir,
+                 int pages) {
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  File file(path);
+  const int resident =
+      std::min<int>(pages, static_cast<int>(pool.frameCount()));
+  for (int page_id = 1; page_id <= resident; ++page_id) {
+    Page* page = pool.pinPage(page_id, file);
+    page->markDirty();
+    pool.unpinPage(page, file);
+  }
+  const auto start = Clock::now();
+  const size_t written = pool.writeBackDirtyPages(pool.frameCount());
+  file.sync();
+  const double elapsed =
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  if (written != static_cast<size_t>(resident)) {
+    std::fprintf(stderr, "wrote %zu of %d pages\n", written, resident);
+  }
+  return elapsed;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int pages = argc > 1 ? std::atoi(argv[1]) : 40000;
+  const std::filesystem::path dir =
+      argc > 2
+          ? std::filesystem::path(argv[2])
+          : std::filesystem::temp_directory_path() / "dbfs_io_engine_bench";
+  std::filesystem::create_directories(dir);
+  const std::string path = (dir / "bench.db").string();
+  const std::string wal_dir = (dir / "bench.wal").string();
+  setenv("DBFS_BUFFER_POOL_BGWRITER_DELAY_MS", "0", 1);
+
+  buildFile(path, pages);
+  std::printf("file: %d pages (%.0f MiB)\n", pages,
+              pages * static_cast<double>(Page::PAGE_SIZE_BYTE) / (1 << 20));
+
+  std::vector<PageId> sequential(static_cast<size_t>(pages));
+  std::iota(sequential.begin(), sequential.end(), 1);
+  std::vector<PageId> random = sequential;
+  std::shuffle(random.begin(), random.end(), std::mt19937(17));
+
+  for (const auto& [label, order] :
+       {std::make_pair("sequential", &sequential),
+        std::make_pair("random", &random)}) {
+    useEngine(kEngines[0]);
+    setenv("DBFS_BUFFER_POOL_READ_AHEAD_PAGES", "0", 1);
+    std::printf("%-10s blocking pinPage          %9.1f ms\n", label,
+                scan(path, wal_dir, *order, false));
+    unsetenv("DBFS_BUFFER_POOL_READ_AHEAD_PAGES");
+    std::printf("%-10s pinPage with read-ahead   %9.1f ms\n", label,
+                scan(path, wal_dir, *order, false));
+    for (const auto& engine : kEngines) {
+      useEngine(engine);
+      std::printf("%-10s prefetch %-16s %9.1f ms\n", label, engine.label,
+                  scan(path, wal_dir, *order, true));
+    }
+  }
+  // Read-ahead past the last dirtied page would evict some of them.
+  setenv("DBFS_BUFFER_POOL_READ_AHEAD_PAGES", "0", 1);
+  for (const auto& engine : kEngines) {
+    useEngine(engine);
+    std::printf("write-back %-25s %9.1f ms\n", engine.label,
+                writeBack(path, wal_dir, pages));
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Hit-path microbenchmark for the buffer pool page table.
+//
+// Compares the former std::map<std::pair<int, std::string>, int> lookup with
+// the (file_id, page_id) open-addressing PageTable, then measures the full
+// BufferPool::pinPage/unpinPage hit path on resident pages.
+//
+// Usage: page_table_bench [lookups]
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "storage/buffer/bufferpool.h"
+#include "storage/buffer/page_table.h"
+#include "storage/disk/file.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::array<std::string, 9> kTpccPaths = {
+    "data/warehouse.db", "data/district.db",   "data/customer.db",
+    "data/history.db",   "data/new_order.db",  "data/oorder.db",
+    "data/order_line.db", "data/item.db",      "data/stock.db"};
+
+struct Probe {
+  std::uint32_t file_index;
+  int page_id;
+};
+
+double nanosPerOp(Clock::duration elapsed, size_t ops) {
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         static_cast<double>(ops);
+}
+
+void benchLookups(size_t lookups) {
+  constexpr int kPagesPerFile = 1800;
+  std::map<std::pair<int, std::string>, int> map_table;
+  PageTable hash_table;
+  int frame_id = 0;
+  for (std::uint32_t file = 0; file < kTpccPaths.size(); ++file) {
+    for (int page_id = 0; page_id < kPagesPerFile; ++page_id) {
+      map_table[{page_id, kTpccPaths[file]}] = frame_id;
+      hash_table.insert(file + 1, page_id, frame_id);
+      ++frame_id;
+    }
+  }
+
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<std::uint32_t> file_dist(
+      0, kTpccPaths.size() - 1);
+  std::uniform_int_distribution<int> page_dist(0, kPagesPerFile - 1);
+  std::vector<Probe> probes(lookups);
+  for (auto& probe : probes) {
+    probe = Probe{file_dist(rng), page_dist(rng)};
+  }
+
+  // The old pinPage built the key from File::getFilePath(), which returned
+  // the path by value; keep that copy in the baseline.
+  std::uint64_t checksum = 0;
+  auto start = Clock::now();
+  for (const auto& probe : probes) {
+    std::string path = kTpccPaths[probe.file_index];
+    auto it = map_table.find(std::make_pair(probe.page_id, path));
+    checksum += static_cast<std::uint64_t>(it->second);
+  }
+  const double map_ns = nanosPerOp(Clock::now() - start, lookups);
+
+  start = Clock::now();
+  for (const auto& probe : probes) {
+    checksum += static_cast<std::uint64_t>(
+        hash_table.find(probe.file_index + 1, probe.page_id).value());
+  }
+  const double hash_ns = nanosPerOp(Clock::now() - start, lookups);
+
+  std::printf("lookup std::map<pair<int,string>>   %8.1f ns/op\n", map_ns);
+  std::printf("lookup PageTable(file_id, page_id)  %8.1f ns/op (%.1fx)\n",
+              hash_ns, map_ns / hash_ns);
+  std::printf("checksum %llu\n", static_cast<unsigned long long>(checksum));
+}
+
+void benchPinHits(size_t lookups) {
+  const std::filesystem::path dir =
+      std::filesystem::temp_directory_path() / "dbfs_page_table_bench";
+  std::filesystem::remove_all(dir);
+  std::filesystem::create_directories(dir);
+
+  auto wal = WAL::initializeNew((dir / "bench.wal").string());
+  BufferPool pool(*wal);
+  constexpr int kPagesPerFile = 1000;
+  std::vector<std::unique_ptr<File>> files;
+  for (const auto& path : kTpccPaths) {
+    files.push_back(std::make_unique<File>(
+        (dir / std::filesystem::path(path).filename()).string()));
+    for (int i = 0; i < kPagesPerFile; ++i) {
+      pool.createPage(PageKind::Heap, *files.back());
+    }
+  }
+
+  std::mt19937 rng(11);
+  std::uniform_int_distribution<std::uint32_t> file_dist(0, files.size() - 1);
+  std::uniform_int_distribution<int> page_dist(1, kPagesPerFile);
+  std::vector<Probe> probes(lookups);
+  for (auto& probe : probes) {
+    probe = Probe{file_dist(rng), page_dist(rng)};
+  }
+
+  const auto start = Clock::now();
+  for (const auto& probe : probes) {
+    File& file = *files[probe.file_index];
+    Page* page = pool.pinPage(probe.page_id, file);
+    pool.unpinPage(page, file);
+  }
+  std::printf("BufferPool pinPage+unpinPage hit   %8.1f ns/op\n",
+              nanosPerOp(Clock::now() - start, lookups));
+
+  files.clear();
+  std::filesystem::remove_all(dir);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const size_t lookups =
+      argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10))
+               : 2000000;
+  benchLookups(lookups);
+  benchPinHits(lookups);
+  return 0;
+}
@@ -0,0 +1,114 @@
+// Buffer pool hit latency with and without huge pages.
+//
+// Builds a heap file that fits in the buffer pool, loads all of it, then
+// times pinPage + unpinPage on resident pages in a random order, reading a
+// word from each page so the frame memory itself is touched. Runs once per
+// DBFS_BUFFER_POOL_HUGE_PAGES mode; the mode in effect is printed, since
+// hugetlb falls back when no huge pages are preallocated
+// (/proc/sys/vm/nr_hugepages).
+//
+// Usage: pin_hit_bench [pages] [pins] [dir]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/buffer/bufferpool.h"
+#include "storage/disk/file.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::array<const char*, 3> kHugePageModes = {"off", "transparent",
+                                                       "hugetlb"};
+
+void buildFile(const std::string& path, int pages) {
+  std::filesystem::remove(path);
+  File file(path);
+  std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+  for (int i = 0; i < pages; ++i) {
+    const PageId page_id = file.allocateNextPageId();
+    Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    file.writePageFromBuffer(page_id, buffer.data());
+  }
+}
+
+// Nanoseconds per pin + unpin over the probes, with every page resident.
+double pinHits(const std::string& path, const std::string& wal_dir,
+               int pages, const std::vector<int>& probes,
+               std::string& mode_in_effect) {
+  std::filesystem::remove_all(wal_dir);
+  auto wal = WAL::initializeNew(wal_dir);
+  BufferPool pool(*wal);
+  mode_in_effect = pool.hugePageModeName();
+  File file(path);
+  for (int page_id = 1; page_id <= pages; ++page_id) {
+    pool.unpinPage(pool.pinPage(page_id, file), file);
+  }
+
+  std::uint64_t checksum = 0;
+  const auto start = Clock::now();
+  for (const int page_id : probes) {
+    Page* page = pool.pinPage(page_id, file);
+    std::uint64_t word = 0;
+    std::memcpy(&word, page->data() + Page::PAGE_SIZE_BYTE / 2, sizeof(word));
+    checksum += word;
+    pool.unpinPage(page, file);
+  }
+  const auto elapsed = Clock::now() - start;
+  if (checksum == 1) {
+    std::printf("\n");
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         static_cast<double>(probes.size());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int pages = argc > 1 ? std::atoi(argv[1]) : 30000;
+  const size_t pins = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 5000000;
+  const std::filesystem::path dir =
+      argc > 3 ? std::filesystem::path(argv[3])
+               : std::filesystem::temp_directory_path() / "dbfs_pin_hit_bench";
+  std::filesystem::create_directories(dir);
+  const std::string path = (dir / "bench.db").string();
+  const std::string wal_dir = (dir / "bench.wal").string();
+
+  // Room for every page, so the timed loop only hits.
+  const size_t pool_mb =
+      (static_cast<size_t>(pages) * BufferPool::FRAME_SIZE_BYTE >> 20) + 16;
+  setenv("DBFS_BUFFER_POOL_SIZE_MB", std::to_string(pool_mb).c_str(), 1);
+  setenv("DBFS_BUFFER_POOL_READ_AHEAD_PAGES", "0", 1);
+  setenv("DBFS_BUFFER_POOL_BGWRITER_DELAY_MS", "0", 1);
+
+  buildFile(path, pages);
+  std::printf("file: %d pages, pool: %zu MiB, %zu pins\n", pages, pool_mb,
+              pins);
+
+  std::vector<int> probes(pins);
+  std::mt19937 rng(17);
+  std::uniform_int_distribution<int> page_id(1, pages);
+  std::generate(probes.begin(), probes.end(), [&] { return page_id(rng); });
+
+  for (const char* mode : kHugePageModes) {
+    setenv("DBFS_BUFFER_POOL_HUGE_PAGES", mode, 1);
+    std::string in_effect;
+    const double nanos = pinHits(path, wal_dir, pages, probes, in_effect);
+    std::printf("huge pages %-12s (in effect: %-11s) %7.1f ns/pin\n", mode,
+                in_effect.c_str(), nanos);
+  }
+
+  std::filesystem::remove_all(dir);
+  return 0;
+}
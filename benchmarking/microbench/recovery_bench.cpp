@@ -0,0 +1,84 @@
+// Restart recovery time as the amount of log to redo grows.
+//
+// Each round inserts rows into a fresh indexed table, makes the log durable,
+// drops the buffer pool without writing back its pages (a crash), and times
+// Recovery::run on a new pool. Without checkpoints, recovery time should grow
+// linearly with the log size. Every log size is recovered with 1, 2, 4, ...
+// redo threads up to the core count (DBFS_RECOVERY_REDO_THREADS).
+//
+// Usage: recovery_bench [max_rows]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catalog/recovery.h"
+#include "catalog/table.h"
+#include "storage/buffer/bufferpool.h"
+#include "storage/index/btreecursor.h"
+#include "storage/record/record_serializer.h"
+#include "storage/wal/wal.h"
+
+namespace {
+
+constexpr const char* kTableName = "recovery_bench_table";
+constexpr const char* kWalPath = "recovery_bench.wal";
+
+void benchRecovery(int rows, unsigned redo_threads) {
+  Table::removeBackingFilesFor(kTableName);
+  std::filesystem::remove_all(kWalPath);
+
+  {
+    auto wal = WAL::initializeNew(kWalPath);
+    auto pool = std::make_unique<BufferPool>(*wal);
+    Table table = Table::initialize(
+        kTableName,
+        Schema(std::vector<Column>{Column("id", Column::Type::Integer),
+                                   Column("value", Column::Type::Varchar)}));
+    table.createIndex({"id"});
+    for (int id = 0; id < rows; ++id) {
+      const TypedRow row{{id, "value-" + std::to_string(id)}};
+      const RID rid = table.heapFile().insertRecord(
+          *pool, *wal,
+          RecordSerializer(table.schema(), row).serializedBytes());
+      BTreeCursor::insertIntoIndex(*pool, table.requireIndexFile(),
+                                   table.extractIndexKey(row),
+                                   rid.heap_page_id, rid.slot_id);
+    }
+    wal->flush();
+    pool.reset();
+  }
+
+  setenv("DBFS_RECOVERY_REDO_THREADS", std::to_string(redo_threads).c_str(),
+         1);
+  auto wal = WAL::openExisting(kWalPath);
+  BufferPool pool(*wal);
+  const RecoveryStats stats = Recovery::run(kWalPath, pool);
+  std::printf(
+      "rows=%8d wal_bytes=%10llu dirty_pages=%6zu redone=%8llu "
+      "redo_threads=%3zu elapsed_ms=%9.1f\n",
+      rows, static_cast<unsigned long long>(stats.end_lsn), stats.dirty_pages,
+      static_cast<unsigned long long>(stats.records_redone),
+      stats.redo_threads, stats.elapsed_ms);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  const int max_rows = argc > 1 ? std::atoi(argv[1]) : 100000;
+  std::filesystem::create_directories("data");
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  for (int rows = max_rows / 16; rows <= max_rows; rows *= 2) {
+    for (unsigned threads = 1; threads <= cores; threads *= 2) {
+      benchRecovery(rows, threads);
+    }
+  }
+  Table::removeBackingFilesFor(kTableName);
+  std::filesystem::remove_all(kWalPath);
+  return 0;
+}
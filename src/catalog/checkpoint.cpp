@@ -0,0 +1,91 @@
+#include "catalog/checkpoint.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+#include "catalog/table.h"
+#include "catalog/table_metadata.h"
+#include "storage/buffer/bufferpool.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+#include "storage/wal/wal_body.h"
+#include "util.h"
+
+namespace {
+
+struct RelationFile {
+  std::uint32_t relation_id;
+  bool is_index;
+};
+
+}  // namespace
+
+Checkpoint Checkpoint::begin(BufferPool& pool, WAL& wal) {
+  const auto started = std::chrono::steady_clock::now();
+  // Read the log end first: a page dirtied after it has a recLSN past it.
+  const std::uint64_t log_end_lsn = wal.getEndLSN();
+  return Checkpoint(started, log_end_lsn, pool.dirtyPages());
+}
+
+CheckpointStats Checkpoint::complete(WAL& wal) {
+  CheckpointStats stats;
+
+  // Make every page written back so far durable, save the free-space maps,
+  // and map backing files to relations for the dirty page table.
+  std::unordered_map<std::string, RelationFile> relation_files;
+  for (const std::string& table_name : TableMetadataStore::listTableNames()) {
+    if (!Table::isPersisted(table_name)) {
+      continue;
+    }
+    Table table = Table::getTable(table_name);
+    if (table.relationId() == 0) {
+      continue;
+    }
+    File& heap_file = table.heapFile().rawFile();
+    heap_file.sync();
+    stats.files_synced++;
+    table.heapFile().freeSpaceMap().save();
+    relation_files[heap_file.getFilePath()] =
+        RelationFile{table.relationId(), false};
+    if (const auto index_file = table.indexFile()) {
+      index_file->get().sync();
+      stats.files_synced++;
+      relation_files[index_file->get().getFilePath()] =
+          RelationFile{table.relationId(), true};
+    }
+  }
+
+  CheckpointBody body;
+  body.redo_lsn = log_end_lsn_;
+  std::set<std::uint32_t> stale_indexes;
+  for (const DirtyPageInfo& page : dirty_pages_) {
+    const auto relation_file = relation_files.find(page.file_path);
+    if (relation_file == relation_files.end()) {
+      // Dropped since begin(), or not a table file.
+      continue;
+    }
+    if (relation_file->second.is_index) {
+      // Index pages are not logged; recovery has to rebuild the index.
+      stale_indexes.insert(relation_file->second.relation_id);
+      continue;
+    }
+    if (page.rec_lsn == Page::NO_REC_LSN) {
+      // A heap page that was created but not logged to yet.
+      continue;
+    }
+    body.dirty_pages.push_back(CheckpointBody::DirtyPage{
+        relation_file->second.relation_id, page.page_id, page.rec_lsn});
+    body.redo_lsn = std::min(body.redo_lsn, page.rec_lsn);
+  }
+  body.stale_indexes.assign(stale_indexes.begin(), stale_indexes.end());
+
+  stats.checkpoint_lsn = wal.writeCheckpoint(body.encode());
+  stats.redo_lsn = body.redo_lsn;
+  stats.dirty_pages = body.dirty_pages.size();
+  stats.stale_indexes = body.stale_indexes.size();
+  stats.segments_removed = wal.removeSegmentsBefore(body.redo_lsn);
+  stats.elapsed_ms = dbfs_util::millisecondsSince(started_);
+  return stats;
+}
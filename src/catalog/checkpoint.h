@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "storage/buffer/frame_directory.h"
+
+class BufferPool;
+class WAL;
+
+struct CheckpointStats {
+  std::uint64_t checkpoint_lsn = 0;
+  // Where restart recovery will start redo.
+  std::uint64_t redo_lsn = 0;
+  // Logged dirty heap pages recorded in the checkpoint.
+  std::size_t dirty_pages = 0;
+  std::size_t stale_indexes = 0;
+  std::size_t files_synced = 0;
+  std::size_t segments_removed = 0;
+  double elapsed_ms = 0;
+};
+
+/**
+ * Fuzzy checkpoint. Statements keep running while it is taken; only the
+ * snapshot in begin() has to exclude page modifications.
+ *
+ * - begin() notes the end of the log and the buffer pool's dirty pages with
+ *   their recLSNs.
+ * - complete() fsyncs every table's files, so pages written back before
+ *   begin() are durable. It then logs a CHECKPOINT record with the dirty page
+ *   table and the redo point (the smallest recLSN, or the log end noted by
+ *   begin() when no logged page was dirty), points the WAL's checkpoint file
+ *   at it, and removes WAL segments that lie entirely below the redo point.
+ *
+ * Restart recovery and WAL startup then read only from the latest
+ * checkpoint on, so their cost is bounded by the checkpoint interval rather
+ * than the whole history.
+ */
+class Checkpoint {
+ public:
+  /**
+   * A change whose record is written but not yet noted in its page's recLSN
+   * would be missed, so callers must keep pages from being modified while
+   * this runs. The server holds its statement latch exclusively.
+   */
+  static Checkpoint begin(BufferPool& pool, WAL& wal);
+  CheckpointStats complete(WAL& wal);
+
+ private:
+  Checkpoint(std::chrono::steady_clock::time_point started,
+             std::uint64_t log_end_lsn, std::vector<DirtyPageInfo> dirty_pages)
+      : started_(started),
+        log_end_lsn_(log_end_lsn),
+        dirty_pages_(std::move(dirty_pages)) {}
+
+  std::chrono::steady_clock::time_point started_;
+  std::uint64_t log_end_lsn_;
+  std::vector<DirtyPageInfo> dirty_pages_;
+};
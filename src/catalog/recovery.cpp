@@ -0,0 +1,298 @@
+#include "catalog/recovery.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+#include <map>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/table.h"
+#include "catalog/table_metadata.h"
+#include "execution/operator.h"
+#include "execution/operators/exchange/exchange_coordinator.h"
+#include "logging.h"
+#include "storage/wal/wal_body.h"
+#include "storage/wal/wal_directory.h"
+#include "storage/wal/wal_reader.h"
+#include "storage/wal/wal_record.h"
+#include "util.h"
+
+namespace {
+
+using RelationPage = std::pair<std::uint32_t, PageId>;
+
+struct AnalysisResult {
+  // (relation, page) -> LSN of the first record that touches the page.
+  std::map<RelationPage, std::uint64_t> dirty_page_table;
+  // Relations whose unlogged index pages were dirty at the checkpoint.
+  std::set<std::uint32_t> stale_indexes;
+  std::uint64_t end_lsn = 0;
+};
+
+AnalysisResult analyze(const std::string& wal_dir, RecoveryStats& stats) {
+  AnalysisResult result;
+  std::uint64_t scan_start_lsn = 0;
+  if (const auto checkpoint_lsn = WALDirectory::readCheckpointLSN(wal_dir)) {
+    WALReader checkpoint_reader(wal_dir, *checkpoint_lsn);
+    const auto record = checkpoint_reader.next();
+    if (!record.has_value() ||
+        record->get_type() != WALRecord::RecordType::CHECKPOINT) {
+      throw std::runtime_error(fmt::format(
+          "WAL checkpoint file names LSN {}, which is not a checkpoint record",
+          *checkpoint_lsn));
+    }
+    const CheckpointBody checkpoint =
+        std::get<CheckpointBody>(decode_body(*record));
+    for (const CheckpointBody::DirtyPage& page : checkpoint.dirty_pages) {
+      result.dirty_page_table.emplace(
+          RelationPage{page.relation_id, page.page_id}, page.rec_lsn);
+    }
+    result.stale_indexes.insert(checkpoint.stale_indexes.begin(),
+                                checkpoint.stale_indexes.end());
+    stats.checkpoint_lsn = *checkpoint_lsn;
+    // Pages modified while the checkpoint was taken are not in its dirty page
+    // table, so scan from the redo point rather than from the checkpoint.
+    scan_start_lsn = checkpoint.redo_lsn;
+  } else if (const auto segments = WALDirectory::listSegments(wal_dir);
+             !segments.empty()) {
+    scan_start_lsn = segments.front().start_lsn;
+  }
+
+  WALReader reader(wal_dir, scan_start_lsn);
+  while (const auto record = reader.next()) {
+    stats.records_scanned++;
+    if (record->get_type() == WALRecord::RecordType::CHECKPOINT) {
+      continue;
+    }
+    result.dirty_page_table.emplace(
+        RelationPage{record->get_relation_id(), record->get_page_id()},
+        record->get_lsn());
+  }
+  result.end_lsn = reader.validEndLSN();
+  return result;
+}
+
+std::unordered_map<std::uint32_t, Table> loadTablesByRelationId() {
+  std::unordered_map<std::uint32_t, Table> tables;
+  for (const std::string& table_name : TableMetadataStore::listTableNames()) {
+    if (!Table::isPersisted(table_name)) {
+      dbfs_log::catalog().warn(
+          "Recovery skips table {} because its backing files are missing.",
+          table_name);
+      continue;
+    }
+    Table table = Table::getTable(table_name);
+    if (table.relationId() == 0) {
+      dbfs_log::catalog().warn(
+          "Table {} has no relation id; its changes cannot be recovered.",
+          table_name);
+      continue;
+    }
+    tables.emplace(table.relationId(), std::move(table));
+  }
+  return tables;
+}
+
+// DBFS_RECOVERY_REDO_THREADS, one per core by default.
+size_t redoThreadsFromEnv() {
+  const std::uint64_t cores =
+      std::max(1u, std::thread::hardware_concurrency());
+  return static_cast<size_t>(std::clamp<std::uint64_t>(
+      dbfs_util::unsignedFromEnv("DBFS_RECOVERY_REDO_THREADS", cores), 1, 64));
+}
+
+// Records the reader hands to the redo workers per batch.
+constexpr size_t kRedoBatchRecords = 256;
+
+/**
+ * Feeds the exchange with the log's page records from the redo point on, in
+ * log order. It runs on the exchange's producer thread, where an exception
+ * would terminate the process: the reader is therefore opened on
+ * construction, and a read error ends the stream and is kept for error().
+ */
+class RedoRecordSource : public Operator<WALRecord> {
+ public:
+  RedoRecordSource(const std::string& wal_dir, std::uint64_t start_lsn)
+      : reader_(wal_dir, start_lsn) {}
+
+  void open() override {}
+
+  std::optional<WALRecord> next() override {
+    try {
+      while (auto record = reader_.next()) {
+        if (record->get_type() != WALRecord::RecordType::CHECKPOINT) {
+          return record;
+        }
+      }
+    } catch (...) {
+      error_ = std::current_exception();
+    }
+    return std::nullopt;
+  }
+
+  void close() override {}
+
+  std::exception_ptr error() const { return error_; }
+
+ private:
+  WALReader reader_;
+  std::exception_ptr error_;
+};
+
+size_t relationPageHash(const WALRecord& record) {
+  // Mix the bits so that consecutive pages spread over the workers.
+  std::uint64_t hash =
+      (record.get_page_id() ^
+       (static_cast<std::uint64_t>(record.get_relation_id()) << 40)) *
+      0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t>(hash >> 32);
+}
+
+struct RedoCounters {
+  std::uint64_t redone = 0;
+  std::uint64_t already_applied = 0;
+  std::uint64_t without_table = 0;
+};
+
+void redoRecord(BufferPool& pool, const AnalysisResult& analysis,
+                std::unordered_map<std::uint32_t, Table>& tables,
+                const WALRecord& record, RedoCounters& counters) {
+  const auto rec_lsn = analysis.dirty_page_table.find(
+      RelationPage{record.get_relation_id(), record.get_page_id()});
+  if (rec_lsn == analysis.dirty_page_table.end() ||
+      record.get_lsn() < rec_lsn->second) {
+    return;
+  }
+  const auto table = tables.find(record.get_relation_id());
+  if (table == tables.end()) {
+    counters.without_table++;
+    return;
+  }
+  if (table->second.heapFile().redo(pool, record)) {
+    counters.redone++;
+  } else {
+    counters.already_applied++;
+  }
+}
+
+void redo(const std::string& wal_dir, BufferPool& pool,
+          const AnalysisResult& analysis,
+          const std::map<std::uint32_t, PageId>& max_logged_page_ids,
+          std::unordered_map<std::uint32_t, Table>& tables,
+          RecoveryStats& stats) {
+  std::uint64_t redo_start_lsn = std::numeric_limits<std::uint64_t>::max();
+  for (const auto& [page, rec_lsn] : analysis.dirty_page_table) {
+    redo_start_lsn = std::min(redo_start_lsn, rec_lsn);
+  }
+  stats.redo_start_lsn = redo_start_lsn;
+
+  for (const auto& [relation_id, max_page_id] : max_logged_page_ids) {
+    const auto table = tables.find(relation_id);
+    if (table != tables.end()) {
+      table->second.heapFile().prepareForRedo(max_page_id);
+    }
+  }
+
+  // One producer reads the log; records are partitioned by (relation, page)
+  // so that each page is redone by one worker, in log order.
+  const size_t worker_count = redoThreadsFromEnv();
+  RedoRecordSource* source = nullptr;
+  ExchangeCoordinator<WALRecord> exchange(
+      kRedoBatchRecords, 1, worker_count,
+      ExchangeCoordinator<WALRecord>::DispatchRule::HashPartition,
+      [&](size_t) -> std::unique_ptr<Operator<WALRecord>> {
+        auto reader =
+            std::make_unique<RedoRecordSource>(wal_dir, redo_start_lsn);
+        source = reader.get();
+        return reader;
+      },
+      relationPageHash);
+
+  std::vector<RedoCounters> counters(worker_count);
+  std::vector<std::exception_ptr> errors(worker_count);
+  std::vector<std::thread> workers;
+  workers.reserve(worker_count);
+  for (size_t worker = 0; worker < worker_count; ++worker) {
+    workers.emplace_back([&, worker] {
+      auto& consumer = exchange.consumerAt(worker);
+      consumer.open();
+      try {
+        while (const auto record = consumer.next()) {
+          redoRecord(pool, analysis, tables, *record, counters[worker]);
+        }
+      } catch (...) {
+        errors[worker] = std::current_exception();
+        // Keep draining so the producer is never left holding records.
+        while (consumer.next()) {
+        }
+      }
+      consumer.close();
+    });
+  }
+  exchange.startOnce();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  exchange.join();
+
+  if (source->error()) {
+    std::rethrow_exception(source->error());
+  }
+  stats.redo_threads = worker_count;
+  for (size_t worker = 0; worker < worker_count; ++worker) {
+    if (errors[worker]) {
+      std::rethrow_exception(errors[worker]);
+    }
+    stats.records_redone += counters[worker].redone;
+    stats.records_already_applied += counters[worker].already_applied;
+    stats.records_without_table += counters[worker].without_table;
+  }
+}
+
+}  // namespace
+
+RecoveryStats Recovery::run(const std::string& wal_dir, BufferPool& pool) {
+  const auto started = std::chrono::steady_clock::now();
+  RecoveryStats stats;
+
+  AnalysisResult analysis = analyze(wal_dir, stats);
+  stats.end_lsn = analysis.end_lsn;
+  stats.dirty_pages = analysis.dirty_page_table.size();
+  if (analysis.dirty_page_table.empty() && analysis.stale_indexes.empty()) {
+    stats.elapsed_ms = dbfs_util::millisecondsSince(started);
+    return stats;
+  }
+
+  std::unordered_map<std::uint32_t, Table> tables = loadTablesByRelationId();
+  std::map<std::uint32_t, PageId> max_logged_page_ids;
+  for (const auto& [page, rec_lsn] : analysis.dirty_page_table) {
+    // Keys are ordered, so the last page seen per relation is the largest.
+    max_logged_page_ids[page.first] = page.second;
+  }
+  if (!analysis.dirty_page_table.empty()) {
+    redo(wal_dir, pool, analysis, max_logged_page_ids, tables, stats);
+  }
+
+  std::set<std::uint32_t> stale_indexes = analysis.stale_indexes;
+  for (const auto& [relation_id, max_page_id] : max_logged_page_ids) {
+    stale_indexes.insert(relation_id);
+  }
+  for (const std::uint32_t relation_id : stale_indexes) {
+    const auto table = tables.find(relation_id);
+    if (table == tables.end() || !table->second.indexFile().has_value()) {
+      continue;
+    }
+    table->second.rebuildIndex(pool);
+    stats.indexes_rebuilt++;
+  }
+
+  stats.elapsed_ms = dbfs_util::millisecondsSince(started);
+  return stats;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class BufferPool;
+
+struct RecoveryStats {
+  // Checkpoint analysis started from (0 without one), the LSN redo started
+  // from, and the end of the valid log.
+  std::uint64_t checkpoint_lsn = 0;
+  std::uint64_t redo_start_lsn = 0;
+  std::uint64_t end_lsn = 0;
+  // Records read by analysis, from the checkpoint's redo point on.
+  std::uint64_t records_scanned = 0;
+  std::uint64_t records_redone = 0;
+  // Records whose page already reflected them (pageLSN past the record).
+  std::uint64_t records_already_applied = 0;
+  // Records of relations that no longer exist, e.g. dropped tables.
+  std::uint64_t records_without_table = 0;
+  // Size of the dirty page table built by analysis.
+  std::size_t dirty_pages = 0;
+  // Workers redo ran on (DBFS_RECOVERY_REDO_THREADS); 0 if nothing to redo.
+  std::size_t redo_threads = 0;
+  std::size_t indexes_rebuilt = 0;
+  double elapsed_ms = 0;
+};
+
+/**
+ * ARIES-style restart recovery for heap pages.
+ *
+ * Every statement runs in autocommit and its records are durable before it
+ * is acknowledged, so there are no loser transactions to undo. Redo alone
+ * brings the heap files to the state of the durable log.
+ *
+ * - Analysis starts from the latest checkpoint (see Checkpoint): its dirty
+ *   page table seeds ours, and the log is scanned from its redo point. Every
+ *   (relation, page) with records is added with the LSN of its first record
+ *   (recLSN). Without a checkpoint, the scan starts at the oldest segment.
+ * - Redo scans again from the smallest recLSN. The log is read by one
+ *   thread and its records are hash partitioned by (relation, page) over
+ *   DBFS_RECOVERY_REDO_THREADS workers (one per core by default) through an
+ *   ExchangeCoordinator, so every page is redone by one worker in log order.
+ *   Each record goes to its table's HeapFile::redo, which skips it when the
+ *   page's pageLSN shows it is already applied. Replaying the log twice
+ *   therefore changes nothing.
+ * - Index pages are not logged, so the index of every table that has records
+ *   in the scanned log, or whose index pages were dirty at the checkpoint, is
+ *   rebuilt from the redone heap.
+ *
+ * Runs at server startup, before any statement touches the pool. Redone pages
+ * stay dirty in the pool; they are flushable immediately because their
+ * records are already durable.
+ */
+class Recovery {
+ public:
+  static RecoveryStats run(const std::string& wal_dir, BufferPool& pool);
+};
@@ -9,6 +9,7 @@
 #include "logging.h"
 #include "storage/buffer/bufferpool.h"
 #include "storage/index/btreecursor.h"
+#include "storage/index/index_builder.h"
 #include "storage/index/index_key.h"
 #include "storage/index/index_page.h"
 #include "storage/page/page.h"
@@ -39,7 +40,7 @@ std::string indexFileName(
 
 }  // namespace
 
-Table::Table(std::string name, Schema schema,
+Table::Table(std::string name, std::uint32_t relation_id, Schema schema,
              std::optional<std::string> index_path,
              std::vector<std::string> indexed_column_names)
     : name_(std::move(name)),
@@ -48,7 +49,7 @@ Table::Table(std::string name, Schema schema,
       index_file_(index_path.has_value()
                       ? std::optional<File>(std::in_place, index_path.value())
                       : std::nullopt),
-      heap_file_(defaultHeapPath(name_)) {}
+      heap_file_(defaultHeapPath(name_), relation_id) {}
 
 Table Table::initialize(const std::string& table_name, const Schema& schema) {
   if (anyBackingFileExists(table_name)) {
@@ -56,9 +57,10 @@ Table Table::initialize(const std::string& table_name, const Schema& schema) {
   }
 
   try {
-    Table table(table_name, schema, std::nullopt, {});
+    const std::uint32_t relation_id = TableMetadataStore::allocateRelationId();
+    Table table(table_name, relation_id, schema, std::nullopt, {});
     table.heap_file_.initialize();
-    TableMetadataStore::write(table_name, schema, {});
+    TableMetadataStore::write(table_name, relation_id, schema, {});
     return table;
   } catch (...) {
     removeBackingFilesFor(table_name);
@@ -92,24 +94,71 @@ void Table::createIndex(const std::vector<std::string>& column_names) {
   indexed_column_names_ = column_names;
 
   try {
-    std::array<char, Page::PAGE_SIZE_BYTE> index_root_buffer{};
-    Page::initializeNew(index_root_buffer.data(), PageKind::LeafIndex,
-                        LeafIndexPage::NO_RIGHT_SIBLING, 0);
-    index_file_->writePageFromBuffer(0, index_root_buffer.data());
+    writeEmptyIndexRoot(index_file_.value());
 
     TableMetadataStore::write(
-        name_, schema_,
+        name_, relationId(), schema_,
         {PersistedIndexMetadata{index_file_->getFilePath(),
                                 indexed_column_names_}});
   } catch (...) {
     index_file_.reset();
     indexed_column_names_.clear();
     removeFileIfExists(index_path);
-    TableMetadataStore::write(name_, schema_, {});
+    TableMetadataStore::write(name_, relationId(), schema_, {});
     throw;
   }
 }
 
+void Table::createIndex(BufferPool& pool,
+                        const std::vector<std::string>& column_names) {
+  const bool had_index = index_file_.has_value();
+  createIndex(column_names);
+  if (had_index || !index_file_.has_value()) {
+    return;
+  }
+  try {
+    loadIndexFromHeap(pool);
+  } catch (...) {
+    const std::string index_path = index_file_->getFilePath();
+    index_file_.reset();
+    indexed_column_names_.clear();
+    removeFileIfExists(index_path);
+    TableMetadataStore::write(name_, relationId(), schema_, {});
+    throw;
+  }
+}
+
+void Table::rebuildIndex(BufferPool& pool) {
+  if (!index_file_.has_value()) {
+    return;
+  }
+
+  const std::string index_path = index_file_->getFilePath();
+  index_file_.reset();
+  removeFileIfExists(index_path);
+  index_file_.emplace(index_path);
+  writeEmptyIndexRoot(index_file_.value());
+  loadIndexFromHeap(pool);
+}
+
+void Table::loadIndexFromHeap(BufferPool& pool) {
+  IndexBuilder builder(index_file_.value());
+  heap_file_.forEachRecord(pool, [&](const RID& rid, RecordCellView cell) {
+    builder.add(extractIndexKey(cell.getTypedRow(schema_)), rid);
+  });
+  const size_t entry_count = builder.finish();
+  index_file_->sync();
+  dbfs_log::catalog().info("Built index {} of table {} with {} entries.",
+                           index_file_->getFilePath(), name_, entry_count);
+}
+
+void Table::writeEmptyIndexRoot(File& index_file) {
+  std::array<char, Page::PAGE_SIZE_BYTE> index_root_buffer{};
+  Page::initializeNew(index_root_buffer.data(), PageKind::LeafIndex,
+                      LeafIndexPage::NO_RIGHT_SIBLING, 0);
+  index_file.writePageFromBuffer(0, index_root_buffer.data());
+}
+
 Table Table::getTable(const std::string& table_name) {
   PersistedTableMetadata metadata = TableMetadataStore::read(table_name);
   std::optional<std::string> index_path;
@@ -119,8 +168,8 @@ Table Table::getTable(const std::string& table_name) {
     index_path = std::move(index.index_path);
     indexed_column_names = std::move(index.indexed_column_names);
   }
-  return Table(table_name, std::move(metadata.schema), std::move(index_path),
-               std::move(indexed_column_names));
+  return Table(table_name, metadata.relation_id, std::move(metadata.schema),
+               std::move(index_path), std::move(indexed_column_names));
 }
 
 bool Table::isPersisted(const std::string& table_name) {
@@ -145,9 +194,30 @@ void Table::removeBackingFilesFor(const std::string& table_name) {
     }
   }
   removeFileIfExists(defaultHeapPath(table_name));
+  FreeSpaceMap::remove(defaultHeapPath(table_name));
   removeFileIfExists(meta_path);
 }
 
+void Table::removeBackingFilesFor(const std::string& table_name,
+                                  BufferPool& pool) {
+  std::vector<std::string> paged_paths{defaultHeapPath(table_name)};
+  const std::string meta_path = TableMetadataStore::pathFor(table_name);
+  if (std::filesystem::exists(meta_path)) {
+    for (const auto& index :
+         TableMetadataStore::readFromPath(meta_path).indexes) {
+      paged_paths.push_back(index.index_path);
+    }
+  }
+  for (const std::string& path : paged_paths) {
+    pool.discardFile(path);
+  }
+  removeBackingFilesFor(table_name);
+  // Nothing refers to their ids any more, so new files can take them.
+  for (const std::string& path : paged_paths) {
+    File::releaseFileId(path);
+  }
+}
+
 std::string Table::defaultIndexPath(
     const std::string& table_name,
     const std::vector<std::string>& indexed_column_names) {
@@ -161,13 +231,7 @@ std::string Table::defaultHeapPath(const std::string& table_name) {
 }
 
 void Table::removeFileIfExists(const std::string& path) {
-  File::invalidateCache(path);
-  std::error_code error;
-  std::filesystem::remove(path, error);
-  if (error) {
-    throw std::runtime_error("failed to remove file: " + path + ": " +
-                             error.message());
-  }
+  File::remove(path);
 }
 
 bool Table::hasIndexForColumn(const std::string& column_name) const {
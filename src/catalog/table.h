@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <filesystem>
 #include <functional>
 #include <optional>
@@ -32,10 +33,31 @@ class Table {
   static bool isPersisted(const std::string& table_name);
 
   static void removeBackingFilesFor(const std::string& table_name);
+  // Also drops the table's pages from pool first, so that its writer cannot
+  // recreate the files, and frees the files' ids afterwards. DROP TABLE uses
+  // this one.
+  static void removeBackingFilesFor(const std::string& table_name,
+                                    BufferPool& pool);
 
+  // Adds an empty index; for tables that have no rows yet.
   void createIndex(const std::vector<std::string>& column_names);
 
+  /**
+   * Adds an index and bulk loads it with the rows already in the heap, as
+   * CREATE INDEX does. Does nothing if the table already has an index.
+   */
+  void createIndex(BufferPool& pool,
+                   const std::vector<std::string>& column_names);
+
+  /**
+   * Recreates the index from the heap. Index pages are not WAL-logged, so
+   * restart recovery calls this after redoing the heap. It must run before
+   * anything else has pinned pages of the index.
+   */
+  void rebuildIndex(BufferPool& pool);
+
   const std::string& name() const { return name_; }
+  std::uint32_t relationId() const { return heap_file_.relationId(); }
   const Schema& schema() const { return schema_; }
   bool hasIndexForColumn(const std::string& column_name) const;
   std::string extractIndexKey(const TypedRow& row) const;
@@ -50,9 +72,16 @@ class Table {
   HeapFile& heapFile() { return heap_file_; }
 
  private:
-  Table(std::string name, Schema schema, std::optional<std::string> index_path,
+  Table(std::string name, std::uint32_t relation_id, Schema schema,
+        std::optional<std::string> index_path,
         std::vector<std::string> indexed_column_names);
 
+  static void writeEmptyIndexRoot(File& index_file);
+
+  // Fills the new, empty index with an entry for every row of the heap,
+  // writing the index pages directly rather than through the pool.
+  void loadIndexFromHeap(BufferPool& pool);
+
   static std::string defaultIndexPath(
       const std::string& table_name,
       const std::vector<std::string>& indexed_column_names);
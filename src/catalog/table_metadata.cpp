@@ -1,7 +1,9 @@
 #include "catalog/table_metadata.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <mutex>
 #include <nlohmann/json.hpp>
 #include <stdexcept>
 #include <unordered_map>
@@ -26,6 +28,12 @@ namespace {
  * explicit catalog cache and invalidation path.
  */
 std::unordered_map<std::string, PersistedTableMetadata> metadata_cache;
+// Server threads resolve tables concurrently, so cache accesses are serialized.
+std::mutex metadata_cache_mutex;
+// Serializes relation id allocation within the process.
+std::mutex relation_id_mutex;
+
+constexpr const char* kMetadataSuffix = ".meta.json";
 
 std::string prepareMetadataPath(const std::string& path) {
   std::filesystem::path filesystem_path(path);
@@ -38,7 +46,8 @@ std::string prepareMetadataPath(const std::string& path) {
 }  // namespace
 
 std::string TableMetadataStore::pathFor(const std::string& table_name) {
-  return (std::filesystem::path("data") / (table_name + ".meta.json")).string();
+  return (std::filesystem::path("data") / (table_name + kMetadataSuffix))
+      .string();
 }
 
 bool TableMetadataStore::exists(const std::string& table_name) {
@@ -46,9 +55,10 @@ bool TableMetadataStore::exists(const std::string& table_name) {
 }
 
 void TableMetadataStore::write(
-    const std::string& table_name, const Schema& schema,
-    const std::vector<PersistedIndexMetadata>& indexes) {
+    const std::string& table_name, std::uint32_t relation_id,
+    const Schema& schema, const std::vector<PersistedIndexMetadata>& indexes) {
   nlohmann::json metadata;
+  metadata["relationId"] = relation_id;
   metadata["indexes"] = nlohmann::json::array();
   for (const auto& index : indexes) {
     metadata["indexes"].push_back(
@@ -73,17 +83,22 @@ void TableMetadataStore::write(
     throw std::runtime_error("failed to write metadata file: " + meta_path);
   }
 
-  metadata_cache.insert_or_assign(table_name,
-                                  PersistedTableMetadata{schema, indexes});
+  std::lock_guard<std::mutex> lock(metadata_cache_mutex);
+  metadata_cache.insert_or_assign(
+      table_name, PersistedTableMetadata{schema, indexes, relation_id});
 }
 
 PersistedTableMetadata TableMetadataStore::read(const std::string& table_name) {
-  const auto cached = metadata_cache.find(table_name);
-  if (cached != metadata_cache.end()) {
-    return cached->second;
+  {
+    std::lock_guard<std::mutex> lock(metadata_cache_mutex);
+    const auto cached = metadata_cache.find(table_name);
+    if (cached != metadata_cache.end()) {
+      return cached->second;
+    }
   }
 
   PersistedTableMetadata metadata = readFromPath(pathFor(table_name));
+  std::lock_guard<std::mutex> lock(metadata_cache_mutex);
   metadata_cache.insert_or_assign(table_name, metadata);
   return metadata;
 }
@@ -146,5 +161,81 @@ PersistedTableMetadata TableMetadataStore::readFromPath(
         Column::typeFromString(column_json["type"].get<std::string>()));
   }
 
-  return PersistedTableMetadata{Schema(std::move(columns)), std::move(indexes)};
+  std::uint32_t relation_id = 0;
+  if (metadata.contains("relationId")) {
+    if (!metadata["relationId"].is_number_unsigned()) {
+      throw std::runtime_error(
+          "invalid table metadata: relationId must be an unsigned integer");
+    }
+    relation_id = metadata["relationId"].get<std::uint32_t>();
+  }
+
+  return PersistedTableMetadata{Schema(std::move(columns)), std::move(indexes),
+                                relation_id};
+}
+
+std::uint32_t TableMetadataStore::allocateRelationId() {
+  std::lock_guard<std::mutex> lock(relation_id_mutex);
+  const std::string counter_path =
+      (std::filesystem::path("data") / "next_relation_id").string();
+
+  std::uint32_t next_id = 1;
+  std::ifstream input(counter_path);
+  if (input.is_open()) {
+    if (!(input >> next_id) || next_id == 0) {
+      throw std::runtime_error("invalid relation id counter: " + counter_path);
+    }
+  } else {
+    // First allocation in this data directory: start above any id that is
+    // already in use.
+    for (const std::string& table_name : listTableNames()) {
+      next_id = std::max(next_id,
+                         readFromPath(pathFor(table_name)).relation_id + 1);
+    }
+  }
+
+  std::ofstream output(prepareMetadataPath(counter_path), std::ios::trunc);
+  output << (next_id + 1);
+  if (!output.good()) {
+    throw std::runtime_error("failed to write relation id counter: " +
+                             counter_path);
+  }
+  return next_id;
+}
+
+std::vector<std::string> TableMetadataStore::listTableNames() {
+  std::vector<std::string> table_names;
+  const std::filesystem::path data_dir("data");
+  if (!std::filesystem::is_directory(data_dir)) {
+    return table_names;
+  }
+  const std::string suffix = kMetadataSuffix;
+  for (const auto& entry : std::filesystem::directory_iterator(data_dir)) {
+    const std::string file_name = entry.path().filename().string();
+    if (entry.is_regular_file() && file_name.size() > suffix.size() &&
+        file_name.compare(file_name.size() - suffix.size(), suffix.size(),
+                          suffix) == 0) {
+      table_names.push_back(
+          file_name.substr(0, file_name.size() - suffix.size()));
+    }
+  }
+  std::sort(table_names.begin(), table_names.end());
+  return table_names;
+}
+
+std::map<std::uint32_t, std::string> TableMetadataStore::relationRegistry() {
+  std::map<std::uint32_t, std::string> registry;
+  for (const std::string& table_name : listTableNames()) {
+    const std::uint32_t relation_id = read(table_name).relation_id;
+    if (relation_id == 0) {
+      continue;
+    }
+    const auto [entry, inserted] = registry.emplace(relation_id, table_name);
+    if (!inserted) {
+      throw std::runtime_error("relation id " + std::to_string(relation_id) +
+                               " is used by both " + entry->second + " and " +
+                               table_name);
+    }
+  }
+  return registry;
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+#include <map>
 #include <optional>
 #include <string>
 #include <vector>
@@ -14,6 +16,9 @@ struct PersistedIndexMetadata {
 struct PersistedTableMetadata {
   Schema schema;
   std::vector<PersistedIndexMetadata> indexes;
+  // Identifies the table's heap in WAL records. 0 for tables created before
+  // relation ids existed; their changes cannot be recovered.
+  std::uint32_t relation_id = 0;
 };
 
 class TableMetadataStore {
@@ -22,10 +27,29 @@ class TableMetadataStore {
 
   static bool exists(const std::string& table_name);
 
-  static void write(const std::string& table_name, const Schema& schema,
+  static void write(const std::string& table_name, std::uint32_t relation_id,
+                    const Schema& schema,
                     const std::vector<PersistedIndexMetadata>& indexes);
 
   static PersistedTableMetadata read(const std::string& table_name);
 
   static PersistedTableMetadata readFromPath(const std::string& meta_path);
+
+  /**
+   * Returns a relation id that no table has used before. Ids are never
+   * reused, even after DROP TABLE, so WAL records of a dropped table cannot
+   * be replayed into a new table. The next id is kept in
+   * data/next_relation_id.
+   */
+  static std::uint32_t allocateRelationId();
+
+  // Names of all tables with a metadata file under data/.
+  static std::vector<std::string> listTableNames();
+
+  /**
+   * Relation id -> table name for every table under data/ that has a
+   * relation id, to resolve the relation ids of WAL records. Dropped tables
+   * are not listed. Throws std::runtime_error if two tables share an id.
+   */
+  static std::map<std::uint32_t, std::string> relationRegistry();
 };
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "catalog/vacuum.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "catalog/table.h"
+#include "catalog/table_metadata.h"
+#include "storage/disk/free_space_map.h"
+#include "util.h"
+
+VacuumStats Vacuum::runRound(BufferPool& pool, WAL& wal,
+                             std::size_t max_pages, bool release_dead_slots) {
+  VacuumStats stats;
+  if (max_pages == 0 || !FreeSpaceMap::anyVacuumCandidates()) {
+    return stats;
+  }
+  const auto started = std::chrono::steady_clock::now();
+
+  std::vector<std::string> table_names;
+  for (const std::string& table_name : TableMetadataStore::listTableNames()) {
+    if (Table::isPersisted(table_name)) {
+      table_names.push_back(table_name);
+    }
+  }
+  const std::size_t pages_per_table =
+      std::max<std::size_t>(1, max_pages / std::max<std::size_t>(
+                                               1, table_names.size()));
+  for (const std::string& table_name : table_names) {
+    if (stats.pages_visited >= max_pages) {
+      break;
+    }
+    Table table = Table::getTable(table_name);
+    HeapFile& heap_file = table.heapFile();
+    if (table.relationId() == 0) {
+      // Not logged, so a compaction could not be redone; inserts still
+      // compact its pages when they need the space.
+      heap_file.freeSpaceMap().takeVacuumCandidates(SIZE_MAX);
+      continue;
+    }
+    const std::vector<PageId> pages =
+        heap_file.freeSpaceMap().takeVacuumCandidates(
+            std::min(pages_per_table, max_pages - stats.pages_visited));
+    if (pages.empty()) {
+      continue;
+    }
+    stats.tables_visited++;
+    for (const PageId page_id : pages) {
+      stats.pages_visited++;
+      const std::size_t reclaimed =
+          heap_file.vacuumPage(pool, wal, page_id, release_dead_slots);
+      if (reclaimed > 0) {
+        stats.pages_compacted++;
+        stats.bytes_reclaimed += reclaimed;
+      }
+    }
+  }
+
+  stats.elapsed_ms = dbfs_util::millisecondsSince(started);
+  return stats;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+
+class BufferPool;
+class WAL;
+
+struct VacuumStats {
+  std::size_t tables_visited = 0;
+  // Queued pages the round took, compacted or not.
+  std::size_t pages_visited = 0;
+  std::size_t pages_compacted = 0;
+  std::size_t bytes_reclaimed = 0;
+  double elapsed_ms = 0;
+};
+
+/**
+ * Online heap vacuum. Deletes queue their page in the heap's free-space map
+ * (an UPDATE is a delete plus an insert, so updates do too); a round takes
+ * queued pages and compacts each in place with HeapFile::vacuumPage, which
+ * keeps slot ids and logs a COMPACT record. The freed space shows up in the
+ * free-space map, where inserts find it.
+ *
+ * Rounds are small so the caller can throttle them: a round visits at most
+ * max_pages pages, split evenly over the tables, and returns at once when
+ * no page is queued. Each page is compacted under its write latch and slot
+ * ids do not change, so readers and writers run alongside a round. Callers
+ * must keep tables from being dropped while it runs.
+ *
+ * With release_dead_slots the round also frees the slots of deleted rows so
+ * inserts reuse them, which keeps a page's slot array from growing with
+ * every update. A freed slot id can go to another row, so the caller must
+ * make sure no RID is held meanwhile, the way PostgreSQL's vacuum waits for
+ * a cleanup lock; RIDs only live within a statement, so the server runs
+ * rounds holding its statement latch exclusively.
+ */
+class Vacuum {
+ public:
+  static VacuumStats runRound(BufferPool& pool, WAL& wal,
+                              std::size_t max_pages,
+                              bool release_dead_slots = false);
+};
@@ -38,8 +38,6 @@
 #include "storage/record/record_cell.h"
 #include "storage/record/record_serializer.h"
 #include "storage/wal/wal.h"
-#include "storage/wal/wal_body.h"
-#include "storage/wal/wal_record.h"
 
 namespace {
 
@@ -352,11 +350,7 @@ std::size_t removeMatchingRows(
       BTreeCursor::findEntries(pool, index_file->get(), boundaries, true);
     }
 
-    wal.write(WALRecord::RecordType::DELETE, rid.heap_page_id,
-              DeleteRedoBody(rid.slot_id).encode());
-    Page* page = pool.pinPage(rid.heap_page_id, table.heapFile().rawFile());
-    page->invalidateSlot(rid.slot_id);
-    pool.unpinPage(page, table.heapFile().rawFile());
+    table.heapFile().removeRecord(pool, wal, rid);
     ++removed_count;
   }
 
@@ -389,31 +383,8 @@ void insertRow(BufferPool& pool, Table& table, const TypedRow& row, WAL& wal) {
   }
 
   RecordSerializer cell(table.schema(), row);
-  const std::vector<std::byte>& serialized_cell = cell.serializedBytes();
-
-  File& heap_file = table.heapFile().rawFile();
-  uint16_t target_page_id = heap_file.getMaxPageID();
-  Page* heap_page = pool.pinPage(target_page_id, heap_file);
-  auto inserted_slot_id = heap_page->insertCell(serialized_cell);
-  if (!inserted_slot_id.has_value()) {
-    pool.unpinPage(heap_page, heap_file);
-    target_page_id = pool.createPage(PageKind::Heap, heap_file);
-    heap_page = pool.pinPage(target_page_id, heap_file);
-    inserted_slot_id = heap_page->insertCell(serialized_cell);
-    if (!inserted_slot_id.has_value()) {
-      pool.unpinPage(heap_page, heap_file);
-      throw std::runtime_error(
-          "Failed to insert record cell into a new heap page due to "
-          "insufficient space.");
-    }
-  }
-  pool.unpinPage(heap_page, heap_file);
-
-  const RID inserted_rid{target_page_id,
-                         static_cast<uint16_t>(inserted_slot_id.value())};
-
-  wal.write(WALRecord::RecordType::INSERT, inserted_rid.heap_page_id,
-            InsertRedoBody(inserted_rid.slot_id, serialized_cell).encode());
+  const RID inserted_rid =
+      table.heapFile().insertRecord(pool, wal, cell.serializedBytes());
 
   if (index_file.has_value()) {
     BTreeCursor::insertIntoIndex(pool, index_file->get(), key.value(),
@@ -789,7 +760,8 @@ void executor::create_table(const CreateTableParser& parser) {
   }
 }
 
-void executor::create_index(const CreateIndexParser& parser) {
+void executor::create_index(BufferPool& pool,
+                            const CreateIndexParser& parser) {
   const std::vector<std::string> column_names = parser.extractColumnNames();
   if (column_names.empty()) {
     throw std::runtime_error(
@@ -797,11 +769,11 @@ void executor::create_index(const CreateIndexParser& parser) {
   }
 
   Table table = Table::getTable(parser.extractTableName());
-  table.createIndex(column_names);
+  table.createIndex(pool, column_names);
 }
 
-void executor::drop_table(const DropTableParser& parser) {
-  Table::removeBackingFilesFor(parser.extractTableName());
+void executor::drop_table(BufferPool& pool, const DropTableParser& parser) {
+  Table::removeBackingFilesFor(parser.extractTableName(), pool);
 }
 
 void executor::insert(BufferPool& pool, Table& table,
@@ -28,10 +28,10 @@ void remove(BufferPool& pool, Table& table, const DeleteParser& parser,
 void update(BufferPool& pool, Table& table, const UpdateParser& parser,
             WAL& wal);
 
-void create_index(const CreateIndexParser& parser);
+void create_index(BufferPool& pool, const CreateIndexParser& parser);
 
 void create_table(const CreateTableParser& parser);
 
-void drop_table(const DropTableParser& parser);
+void drop_table(BufferPool& pool, const DropTableParser& parser);
 
 }  // namespace executor
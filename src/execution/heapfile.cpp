@@ -0,0 +1,164 @@
+#include "heapfile.h"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <stdexcept>
+#include <variant>
+
+#include "storage/wal/wal.h"
+#include "storage/wal/wal_body.h"
+
+RID HeapFile::insertRecord(BufferPool& pool, WAL& wal,
+                           const std::vector<std::byte>& record) {
+  const size_t needed_bytes = record.size() + Page::CELL_POINTER_SIZE;
+  while (const auto candidate = free_space_->findPage(needed_bytes)) {
+    if (!file_.isPageIDUsed(*candidate)) {
+      // Left over from a heap that was larger.
+      free_space_->update(*candidate, 0);
+      continue;
+    }
+    WritePageGuard page = pool.writePage(*candidate, file_);
+    if (const auto slot_id = page->insertCell(record)) {
+      return logInsert(wal, *page, *slot_id, record);
+    }
+    // Another insert took the space; the map cannot offer the page again.
+    free_space_->update(*candidate, page->heapFreeBytes());
+  }
+
+  PageId page_id = file_.getMaxPageID();
+  WritePageGuard page = pool.writePage(page_id, file_);
+  auto slot_id = page->insertCell(record);
+  if (!slot_id.has_value()) {
+    free_space_->update(page_id, page->heapFreeBytes());
+    page.release();
+    page_id = pool.createPage(PageKind::Heap, file_);
+    page = pool.writePage(page_id, file_);
+    slot_id = page->insertCell(record);
+    if (!slot_id.has_value()) {
+      throw std::runtime_error(
+          "Failed to insert record cell into a new heap page due to "
+          "insufficient space.");
+    }
+  }
+  return logInsert(wal, *page, *slot_id, record);
+}
+
+RID HeapFile::logInsert(WAL& wal, Page& page, int slot_id,
+                        const std::vector<std::byte>& record) {
+  const RID rid{page.getPageID(), static_cast<uint16_t>(slot_id)};
+  logChange(wal, page, WALRecord::RecordType::INSERT,
+            InsertRedoBody(rid.slot_id, record).encode());
+  free_space_->update(rid.heap_page_id, page.heapFreeBytes());
+  return rid;
+}
+
+void HeapFile::removeRecord(BufferPool& pool, WAL& wal, const RID& rid) {
+  WritePageGuard page = pool.writePage(rid.heap_page_id, file_);
+  page->invalidateSlot(rid.slot_id);
+  logChange(wal, *page, WALRecord::RecordType::DELETE,
+            DeleteRedoBody(rid.slot_id).encode());
+  free_space_->update(rid.heap_page_id, page->heapFreeBytes());
+  free_space_->addVacuumCandidate(rid.heap_page_id);
+}
+
+size_t HeapFile::vacuumPage(BufferPool& pool, WAL& wal, PageId page_id,
+                            bool release_dead_slots) {
+  if (!file_.isPageIDUsed(page_id)) {
+    return 0;
+  }
+  WritePageGuard page = pool.writePage(page_id, file_);
+  const uint16_t reclaimable_bytes = page->reclaimableBytes();
+  if (!page->isInitialized() ||
+      (reclaimable_bytes == 0 &&
+       !(release_dead_slots && page->hasDeadSlots()))) {
+    return 0;
+  }
+  CompactRedoBody body;
+  body.slot_count = page->slotCount();
+  body.reclaimed_bytes = reclaimable_bytes;
+  body.released_slots = page->compactHeapCells(release_dead_slots);
+  logChange(wal, *page, WALRecord::RecordType::COMPACT, body.encode());
+  free_space_->update(page_id, page->heapFreeBytes());
+  return reclaimable_bytes;
+}
+
+void HeapFile::prepareForRedo(PageId max_logged_page_id) {
+  while (!file_.isPageIDUsed(max_logged_page_id)) {
+    file_.allocateNextPageId();
+  }
+
+  std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+  for (PageId page_id = file_.pageCountOnDisk();
+       page_id <= file_.getMaxPageID(); ++page_id) {
+    Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    file_.writePageFromBuffer(page_id, buffer.data());
+  }
+}
+
+bool HeapFile::redo(BufferPool& pool, const WALRecord& record) {
+  const PageId page_id = record.get_page_id();
+  WritePageGuard page = pool.writePage(page_id, file_);
+  if (!page->isInitialized()) {
+    Page::initializeNew(page->data(), PageKind::Heap, 0, page_id);
+    page->markDirty();
+  }
+  if (record.get_lsn() < page->getPageLSN()) {
+    return false;
+  }
+
+  const WALBody body = decode_body(record);
+  if (const auto* insert = std::get_if<InsertRedoBody>(&body)) {
+    const auto slot_id = page->insertCell(insert->tuple);
+    if (slot_id != std::optional<int>(insert->offset)) {
+      throw std::runtime_error(fmt::format(
+          "Redo of the insert at LSN {} into page {} of {} did not land in "
+          "slot {}",
+          record.get_lsn(), page_id, file_.getFilePath(), insert->offset));
+    }
+  } else if (const auto* remove = std::get_if<DeleteRedoBody>(&body)) {
+    if (remove->offset >= page->slotCount()) {
+      throw std::runtime_error(fmt::format(
+          "Redo of the delete at LSN {} names slot {}, but page {} of {} "
+          "has {} slots",
+          record.get_lsn(), remove->offset, page_id, file_.getFilePath(),
+          page->slotCount()));
+    }
+    page->invalidateSlot(remove->offset);
+    free_space_->addVacuumCandidate(page_id);
+  } else if (const auto* compact = std::get_if<CompactRedoBody>(&body)) {
+    if (compact->slot_count != page->slotCount()) {
+      throw std::runtime_error(fmt::format(
+          "Redo of the compaction at LSN {} expects {} slots, but page {} of "
+          "{} has {}",
+          record.get_lsn(), compact->slot_count, page_id, file_.getFilePath(),
+          page->slotCount()));
+    }
+    const uint16_t released =
+        page->compactHeapCells(compact->released_slots > 0);
+    if (released != compact->released_slots) {
+      throw std::runtime_error(fmt::format(
+          "Redo of the compaction at LSN {} released {} slots of page {} of "
+          "{}, but {} were logged",
+          record.get_lsn(), released, page_id, file_.getFilePath(),
+          compact->released_slots));
+    }
+  } else {
+    throw std::runtime_error(
+        fmt::format("Heap pages do not log UPDATE records (LSN {})",
+                    record.get_lsn()));
+  }
+
+  page->noteRecLSN(record.get_lsn());
+  page->setPageLSN(record.get_lsn() + WALRecord::size_bytes(record.get_body()));
+  free_space_->update(page_id, page->heapFreeBytes());
+  return true;
+}
+
+void HeapFile::logChange(WAL& wal, Page& page, WALRecord::RecordType type,
+                         const std::vector<std::byte>& body) {
+  const std::uint64_t lsn =
+      wal.write(type, relation_id_, page.getPageID(), body);
+  page.noteRecLSN(lsn);
+  page.setPageLSN(lsn + WALRecord::size_bytes(body));
+}
@@ -2,6 +2,8 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -11,62 +13,131 @@
 
 #include "storage/buffer/bufferpool.h"
 #include "storage/disk/file.h"
+#include "storage/disk/free_space_map.h"
 #include "storage/index/rid.h"
 #include "storage/page/cell.h"
 #include "storage/page/page.h"
 #include "storage/record/record_cell.h"
+#include "storage/wal/wal_record.h"
+
+class WAL;
 
 class HeapFile {
  public:
-  explicit HeapFile(std::string path) : file_(std::move(path)) {}
+  HeapFile(std::string path, std::uint32_t relation_id)
+      : file_(std::move(path)),
+        relation_id_(relation_id),
+        free_space_(FreeSpaceMap::forHeap(file_.getFilePath())) {}
 
   void initialize() {
     std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
-    Page::initializeNew(buffer.data(), PageKind::Heap, 0, 0);
+    Page page = Page::initializeNew(buffer.data(), PageKind::Heap, 0, 0);
     file_.writePageFromBuffer(0, buffer.data());
+    free_space_->clear();
+    free_space_->update(0, page.heapFreeBytes());
   }
 
   File& rawFile() { return file_; }
   const File& rawFile() const { return file_; }
+  std::uint32_t relationId() const { return relation_id_; }
+  FreeSpaceMap& freeSpaceMap() { return *free_space_; }
+
+  /**
+   * Inserts record into a page the free-space map has room on, else into the
+   * last page, else into a new page, and logs the insert. Every change is
+   * logged and stamped into the page's pageLSN while the page is still
+   * pinned, so the page cannot be written back before its log record is
+   * durable.
+   */
+  RID insertRecord(BufferPool& pool, WAL& wal,
+                   const std::vector<std::byte>& record);
+  // Invalidates the record's cell and queues its page for the vacuum.
+  void removeRecord(BufferPool& pool, WAL& wal, const RID& rid);
+
+  /**
+   * Vacuums one page: compacts its invalidated cells away in place and logs
+   * a COMPACT record. Slot ids are kept, so RIDs stay valid; the slots of
+   * invalidated cells stay allocated unless release_dead_slots is set, which
+   * frees them and any dead slots for later inserts (see
+   * Page::compactHeapCells) and is only safe while no RID read from the page
+   * is still held. Returns the bytes reclaimed, 0 for a page without
+   * invalidated cells or one past the end of the file.
+   */
+  size_t vacuumPage(BufferPool& pool, WAL& wal, PageId page_id,
+                    bool release_dead_slots = false);
+
+  /**
+   * Makes pages 0..max_logged_page_id pinnable before redo. The file header
+   * is written independently of the pages, so after a crash it can be behind
+   * pages that were logged, or name pages that never reached the disk. This
+   * raises the high-water mark and writes empty heap pages past the end of
+   * the file.
+   */
+  void prepareForRedo(PageId max_logged_page_id);
 
-  bool isPageIDUsed(uint16_t page_id) const {
+  /**
+   * Restart-recovery redo of one of this file's WAL records. Applies it
+   * unless the page's pageLSN shows it is already reflected, and returns
+   * whether it did. A page that reads back as zeros (a hole in the file) is
+   * initialized first.
+   */
+  bool redo(BufferPool& pool, const WALRecord& record);
+
+  bool isPageIDUsed(PageId page_id) const {
     return file_.isPageIDUsed(page_id);
   }
 
   std::vector<RID> collectRids(BufferPool& pool) {
     std::vector<RID> rids;
-    for (uint16_t page_id = 0; page_id <= file_.getMaxPageID(); ++page_id) {
-      Page* page = pool.pinPage(page_id, file_);
+    forEachRecord(pool, [&rids](const RID& rid, RecordCellView) {
+      rids.push_back(rid);
+    });
+    return rids;
+  }
+
+  /**
+   * Calls fn(rid, cell) for every live record in page order, reading ahead
+   * like a sequential scan. Each page is read latched while its records are
+   * visited, so fn must not pin pages of this file.
+   */
+  template <typename Fn>
+  void forEachRecord(BufferPool& pool, Fn&& fn) {
+    const auto strategy = pool.bulkReadStrategy(file_);
+    PageId read_ahead_until = 0;
+    for (PageId page_id = 0; page_id <= file_.getMaxPageID(); ++page_id) {
+      if (page_id == read_ahead_until) {
+        pool.readAhead(file_, page_id, strategy.get());
+        read_ahead_until += pool.readAheadPages(strategy.get());
+      }
+      ReadPageGuard page = pool.readPage(page_id, file_, strategy.get());
       for (uint16_t slot_id = 0; slot_id < page->slotCount(); ++slot_id) {
         char* cell_start = page->slotCellStartUnchecked(slot_id);
         if (!Cell::isValid(cell_start)) {
           continue;
         }
-        rids.push_back(RID{page_id, slot_id});
+        fn(RID{page_id, slot_id}, RecordCellView(cell_start));
       }
-      pool.unpinPage(page, file_);
     }
-
-    return rids;
   }
 
   template <typename Fn>
   auto withCell(BufferPool& pool, const RID& rid, Fn&& fn) const
       -> std::optional<std::invoke_result_t<Fn, RecordCellView>> {
-    using Result = std::invoke_result_t<Fn, RecordCellView>;
-
-    Page* page = pool.pinPage(rid.heap_page_id, file_);
+    ReadPageGuard page = pool.readPage(rid.heap_page_id, file_);
     char* cell_start = page->slotCellStartUnchecked(rid.slot_id);
     if (!Cell::isValid(cell_start)) {
-      pool.unpinPage(page, file_);
       return std::nullopt;
     }
-
-    Result result = std::forward<Fn>(fn)(RecordCellView(cell_start));
-    pool.unpinPage(page, file_);
-    return result;
+    return std::forward<Fn>(fn)(RecordCellView(cell_start));
   }
 
  private:
+  void logChange(WAL& wal, Page& page, WALRecord::RecordType type,
+                 const std::vector<std::byte>& body);
+  RID logInsert(WAL& wal, Page& page, int slot_id,
+                const std::vector<std::byte>& record);
+
   mutable File file_;
+  std::uint32_t relation_id_;
+  std::shared_ptr<FreeSpaceMap> free_space_;
 };
@@ -3,6 +3,8 @@
 #include <mutex>
 #include <optional>
 #include <queue>
+#include <utility>
+#include <vector>
 
 template <typename T>
 class ClosableQueue {
@@ -19,7 +21,7 @@ class ClosableQueue {
     if (queue_.empty()) {
       return std::nullopt;
     }
-    std::vector<T> batch = queue_.front();
+    std::vector<T> batch = std::move(queue_.front());
     queue_.pop();
     return batch;
   }
@@ -17,6 +17,8 @@ SeqScanOperator::SeqScanOperator(
 void SeqScanOperator::open() {
   current_page_id_ = 0;
   current_slot_id_ = 0;
+  read_ahead_until_ = 0;
+  strategy_ = pool_.bulkReadStrategy(heap_file_);
   is_open_ = true;
   logger_.open();
 }
@@ -27,7 +29,12 @@ std::optional<TypedRow> SeqScanOperator::next() {
   }
 
   while (current_page_id_ <= heap_file_.getMaxPageID()) {
-    Page* page = pool_.pinPage(current_page_id_, heap_file_);
+    if (current_page_id_ == read_ahead_until_) {
+      pool_.readAhead(heap_file_, current_page_id_, strategy_.get());
+      read_ahead_until_ += pool_.readAheadPages(strategy_.get());
+    }
+    ReadPageGuard page =
+        pool_.readPage(current_page_id_, heap_file_, strategy_.get());
     while (current_slot_id_ < page->slotCount()) {
       const uint16_t slot_id = current_slot_id_++;
       char* cell_start = page->slotCellStartUnchecked(slot_id);
@@ -37,7 +44,6 @@ std::optional<TypedRow> SeqScanOperator::next() {
 
       logger_.recordInput();
       TypedRow row = RecordCellView(cell_start).getTypedRow(schema_);
-      pool_.unpinPage(page, heap_file_);
       // Apply filtering: skip row if predicates don't match
       if (!passesPredicates(row, predicates_)) {
         continue;
@@ -46,7 +52,6 @@ std::optional<TypedRow> SeqScanOperator::next() {
       return row;
     }
 
-    pool_.unpinPage(page, heap_file_);
     ++current_page_id_;
     current_slot_id_ = 0;
   }
@@ -56,5 +61,6 @@ std::optional<TypedRow> SeqScanOperator::next() {
 
 void SeqScanOperator::close() {
   is_open_ = false;
+  strategy_.reset();
   logger_.close();
 }
\ No newline at end of file
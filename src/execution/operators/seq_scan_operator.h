@@ -1,11 +1,14 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <vector>
 
 #include "execution/comparison_predicate.h"
 #include "execution/operator.h"
+#include "storage/buffer/buffer_access_strategy.h"
+#include "storage/page/page_id.h"
 
 class BufferPool;
 class File;
@@ -26,7 +29,11 @@ class SeqScanOperator : public TypedRowOperator {
   const Schema& schema_;
   std::vector<BoundComparisonPredicate> predicates_;
   OperatorExecutionLogger logger_{"SeqScanOperator"};
-  uint16_t current_page_id_ = 0;
+  PageId current_page_id_ = 0;
   uint16_t current_slot_id_ = 0;
+  // First page past the last read-ahead window requested from the pool.
+  PageId read_ahead_until_ = 0;
+  // Ring for scans of large files; null when the file fits in the pool.
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   bool is_open_ = false;
 };
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <sys/socket.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cerrno>
 #include <cstdint>
 #include <cstdlib>
@@ -13,13 +14,18 @@
 #include <filesystem>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <nlohmann/json.hpp>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
+#include "catalog/checkpoint.h"
+#include "catalog/recovery.h"
 #include "catalog/table.h"
+#include "catalog/vacuum.h"
 #include "execution/executor.h"
 #include "execution/parsers/create_index_parser.h"
 #include "execution/parsers/create_table_parser.h"
@@ -31,7 +37,9 @@
 #include "execution/select_item.h"
 #include "logging.h"
 #include "storage/buffer/bufferpool.h"
+#include "storage/disk/free_space_map.h"
 #include "storage/wal/wal.h"
+#include "util.h"
 
 namespace {
 
@@ -222,9 +230,149 @@ Server::Server(int port) : port_(port) {
   wal_ = std::filesystem::exists(wal_path) ? WAL::openExisting(wal_path)
                                            : WAL::initializeNew(wal_path);
   pool_ = std::make_unique<BufferPool>(*wal_);
+
+  const RecoveryStats recovery = Recovery::run(wal_path, *pool_);
+  dbfs_log::server().info(
+      "Recovery scanned {} WAL records up to LSN {}: redone={} "
+      "already_applied={} without_table={} dirty_pages={} redo_threads={} "
+      "indexes_rebuilt={} elapsed_ms={:.1f}",
+      recovery.records_scanned, recovery.end_lsn, recovery.records_redone,
+      recovery.records_already_applied, recovery.records_without_table,
+      recovery.dirty_pages, recovery.redo_threads, recovery.indexes_rebuilt,
+      recovery.elapsed_ms);
+
+  checkpoint_interval_ = std::chrono::milliseconds(
+      dbfs_util::unsignedFromEnv("DBFS_CHECKPOINT_INTERVAL_MS", 60000));
+  checkpoint_wal_bytes_ =
+      dbfs_util::unsignedFromEnv("DBFS_CHECKPOINT_WAL_BYTES", 64ULL << 20);
+  if (checkpoint_interval_.count() > 0) {
+    checkpointer_ = std::thread([this] { runCheckpointer(); });
+  }
+
+  vacuum_delay_ = std::chrono::milliseconds(
+      dbfs_util::unsignedFromEnv("DBFS_VACUUM_DELAY_MS", 100));
+  vacuum_pages_per_round_ = static_cast<std::size_t>(
+      dbfs_util::unsignedFromEnv("DBFS_VACUUM_PAGES_PER_ROUND", 32));
+  if (vacuum_delay_.count() > 0 && vacuum_pages_per_round_ > 0) {
+    vacuum_ = std::thread([this] { runVacuum(); });
+  }
 }
 
-Server::~Server() = default;
+Server::~Server() {
+  {
+    std::lock_guard<std::mutex> lock(background_mutex_);
+    stop_background_ = true;
+  }
+  background_cv_.notify_all();
+  if (checkpointer_.joinable()) {
+    checkpointer_.join();
+  }
+  if (vacuum_.joinable()) {
+    vacuum_.join();
+  }
+}
+
+void Server::runCheckpointer() {
+  // Poll often enough to notice the WAL volume trigger between intervals.
+  const auto poll_interval =
+      std::min(checkpoint_interval_, std::chrono::milliseconds(1000));
+  auto last_checkpoint_at = std::chrono::steady_clock::now();
+  std::uint64_t last_checkpoint_end_lsn = wal_->getEndLSN();
+  std::unique_lock<std::mutex> lock(background_mutex_);
+  while (!stop_background_) {
+    background_cv_.wait_for(lock, poll_interval,
+                              [this] { return stop_background_; });
+    if (stop_background_) {
+      break;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const std::uint64_t end_lsn = wal_->getEndLSN();
+    if (now - last_checkpoint_at < checkpoint_interval_ &&
+        end_lsn - last_checkpoint_end_lsn < checkpoint_wal_bytes_) {
+      continue;
+    }
+    if (end_lsn == last_checkpoint_end_lsn) {
+      // Nothing was logged since the last checkpoint.
+      last_checkpoint_at = now;
+      continue;
+    }
+
+    lock.unlock();
+    try {
+      takeCheckpoint();
+    } catch (const std::exception& e) {
+      dbfs_log::server().error("Checkpoint failed: {}", e.what());
+    }
+    lock.lock();
+    last_checkpoint_at = std::chrono::steady_clock::now();
+    last_checkpoint_end_lsn = wal_->getEndLSN();
+  }
+}
+
+void Server::runVacuum() {
+  std::unique_lock<std::mutex> lock(background_mutex_);
+  while (!stop_background_) {
+    background_cv_.wait_for(lock, vacuum_delay_,
+                            [this] { return stop_background_; });
+    if (stop_background_) {
+      break;
+    }
+    if (!FreeSpaceMap::anyVacuumCandidates()) {
+      continue;
+    }
+
+    lock.unlock();
+    try {
+      // Rounds free the slots of deleted rows for reuse, so no statement may
+      // hold a RID meanwhile; RIDs do not outlive a statement, so holding the
+      // latch exclusively is enough. It also keeps DDL from dropping the
+      // tables and checkpoints from starting mid-change.
+      std::unique_lock<std::shared_mutex> statement_lock(statement_latch_);
+      const VacuumStats stats = Vacuum::runRound(
+          *pool_, *wal_, vacuum_pages_per_round_, /*release_dead_slots=*/true);
+      if (stats.pages_visited > 0) {
+        dbfs_log::server().debug(
+            "Vacuum round: tables={} pages_visited={} pages_compacted={} "
+            "bytes_reclaimed={} elapsed_ms={:.1f}",
+            stats.tables_visited, stats.pages_visited, stats.pages_compacted,
+            stats.bytes_reclaimed, stats.elapsed_ms);
+      }
+    } catch (const std::exception& e) {
+      dbfs_log::server().error("Vacuum round failed: {}", e.what());
+    }
+    lock.lock();
+  }
+}
+
+void Server::takeCheckpoint() {
+  // Cleaning the pool first moves the redo point up to the pages that are
+  // still being modified.
+  pool_->writeBackDirtyPages(pool_->frameCount());
+  std::optional<Checkpoint> checkpoint;
+  {
+    // A change that is logged but not yet noted in its page's recLSN would be
+    // missed, so begin() waits out the statements in flight and holds off new
+    // ones while it snapshots the dirty pages.
+    std::unique_lock<std::shared_mutex> lock(statement_latch_);
+    checkpoint.emplace(Checkpoint::begin(*pool_, *wal_));
+  }
+  const CheckpointStats stats = checkpoint->complete(*wal_);
+  dbfs_log::server().info(
+      "Checkpoint at LSN {}: redo_lsn={} dirty_pages={} stale_indexes={} "
+      "files_synced={} segments_removed={} elapsed_ms={:.1f}",
+      stats.checkpoint_lsn, stats.redo_lsn, stats.dirty_pages,
+      stats.stale_indexes, stats.files_synced, stats.segments_removed,
+      stats.elapsed_ms);
+}
+
+std::mutex& Server::tableLatch(const std::string& table_name) {
+  std::lock_guard<std::mutex> lock(table_latches_mutex_);
+  std::unique_ptr<std::mutex>& latch = table_latches_[table_name];
+  if (latch == nullptr) {
+    latch = std::make_unique<std::mutex>();
+  }
+  return *latch;
+}
 
 void Server::start() {
   int server_fd = ::socket(AF_INET, SOCK_STREAM, 0);
@@ -269,11 +417,7 @@ void Server::start() {
         std::string request;
         try {
           request = readFrame(client_fd);
-          std::string response;
-          {
-            std::lock_guard<std::mutex> lock(request_mutex_);
-            response = handleRequest(request);
-          }
+          const std::string response = handleRequest(request);
           writeFrame(client_fd, response);
         } catch (const std::exception& e) {
           const std::string what = e.what();
@@ -369,6 +513,22 @@ std::string Server::handleRequest(const std::string& request) {
           : renderSqlWithParameters(sql_template, parameters);
 
   dbfs_log::server().debug("parsed SQL: {}", sql);
+  const bool read_only =
+      operation != "batchUpdate" &&
+      (operation == "query" || leadingKeyword(sql) == "SELECT");
+  const bool changes_catalog =
+      !read_only && operation != "batchUpdate" &&
+      (leadingKeyword(sql) == "CREATE" || leadingKeyword(sql) == "DROP");
+  std::shared_lock<std::shared_mutex> shared_lock(statement_latch_,
+                                                  std::defer_lock);
+  std::unique_lock<std::shared_mutex> exclusive_lock(statement_latch_,
+                                                     std::defer_lock);
+  if (changes_catalog) {
+    exclusive_lock.lock();
+  } else {
+    shared_lock.lock();
+  }
+
   nlohmann::json res;
   res["ok"] = true;
 
@@ -393,6 +553,7 @@ std::string Server::handleRequest(const std::string& request) {
       } else {
         InsertParser first_parser(first_sql);
         Table table = Table::getTable(first_parser.extractTableName());
+        std::lock_guard<std::mutex> table_lock(tableLatch(table.name()));
         nlohmann::json update_counts = nlohmann::json::array();
 
         // Minimal TPC-C-oriented batch path. This reduces JDBC/server round
@@ -428,27 +589,30 @@ std::string Server::handleRequest(const std::string& request) {
     }
   } else if (leadingKeyword(sql) == "CREATE") {
     if (sql.find("CREATE INDEX") == 0 || sql.find("create index") == 0) {
-      executor::create_index(CreateIndexParser(sql));
+      executor::create_index(*pool_, CreateIndexParser(sql));
     } else {
       executor::create_table(CreateTableParser(sql));
     }
     res["updateCount"] = 0;
   } else if (leadingKeyword(sql) == "DROP") {
-    executor::drop_table(DropTableParser(sql));
+    executor::drop_table(*pool_, DropTableParser(sql));
     res["updateCount"] = 0;
   } else if (leadingKeyword(sql) == "INSERT") {
     InsertParser parser(sql);
     Table table = Table::getTable(parser.extractTableName());
+    std::lock_guard<std::mutex> table_lock(tableLatch(table.name()));
     executor::insert(*pool_, table, parser, *wal_);
     res["updateCount"] = 1;
   } else if (leadingKeyword(sql) == "UPDATE") {
     UpdateParser parser(sql);
     Table table = Table::getTable(parser.extractTableName());
+    std::lock_guard<std::mutex> table_lock(tableLatch(table.name()));
     executor::update(*pool_, table, parser, *wal_);
     res["updateCount"] = 1;
   } else if (leadingKeyword(sql) == "DELETE") {
     DeleteParser parser(sql);
     Table table = Table::getTable(parser.extractTableName());
+    std::lock_guard<std::mutex> table_lock(tableLatch(table.name()));
     executor::remove(*pool_, table, parser, *wal_);
     res["updateCount"] = 1;
   } else {
@@ -457,6 +621,19 @@ std::string Server::handleRequest(const std::string& request) {
     res["errorMessage"] = "unsupported SQL: " + sql;
   }
 
+  if (!read_only) {
+    // Autocommit: the statement's WAL records must be durable before we
+    // answer. Waiting outside the latches lets the next statements append
+    // their records meanwhile and share the same flush.
+    const WAL::CommitHandle commit = wal_->requestCommit();
+    if (changes_catalog) {
+      exclusive_lock.unlock();
+    } else {
+      shared_lock.unlock();
+    }
+    commit.wait();
+  }
+
   std::string response = res.dump();
   const std::size_t max_log_len = 2000;
   if (response.size() > max_log_len) {
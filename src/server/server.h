@@ -1,8 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 
 class BufferPool;
 class WAL;
@@ -17,7 +24,42 @@ class Server {
   int port_;
   std::unique_ptr<WAL> wal_;
   std::unique_ptr<BufferPool> pool_;
-  std::mutex request_mutex_;
+  // Statements share this latch and rely on page latches for the pages they
+  // touch; CREATE and DROP take it exclusively because they change the
+  // catalog every other statement reads. A SELECT may see the changes of a
+  // concurrent statement partly applied.
+  std::shared_mutex statement_latch_;
+
+  // INSERT, UPDATE and DELETE on the same table run one at a time: the
+  // duplicate-key check has to see the previous insert's index entry, and
+  // there are no row locks to keep two statements off the same row.
+  // Statements on different tables run concurrently.
+  std::mutex table_latches_mutex_;
+  std::unordered_map<std::string, std::unique_ptr<std::mutex>> table_latches_;
+  std::mutex& tableLatch(const std::string& table_name);
+
+  // Tells the checkpointer and the vacuum to stop.
+  bool stop_background_ = false;
+  std::mutex background_mutex_;
+  std::condition_variable background_cv_;
+
+  // Takes a fuzzy checkpoint every DBFS_CHECKPOINT_INTERVAL_MS (default
+  // 60000; 0 disables the thread) or once DBFS_CHECKPOINT_WAL_BYTES (default
+  // 64 MiB) of log were written since the last one.
+  std::chrono::milliseconds checkpoint_interval_;
+  std::uint64_t checkpoint_wal_bytes_;
+  std::thread checkpointer_;
+  void runCheckpointer();
+  void takeCheckpoint();
+
+  // Runs a vacuum round of at most DBFS_VACUUM_PAGES_PER_ROUND (default 32)
+  // pages every DBFS_VACUUM_DELAY_MS (default 100; 0 disables the thread).
+  // A round holds the statement latch exclusively, so the two bound how much
+  // of the time the vacuum takes and how often statements wait for it.
+  std::chrono::milliseconds vacuum_delay_;
+  std::size_t vacuum_pages_per_round_;
+  std::thread vacuum_;
+  void runVacuum();
 
   std::string readFrame(int client_fd);
   void writeFrame(int client_fd, const std::string& response);
@@ -0,0 +1,136 @@
+#include "arc_eviction_policy.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "logging.h"
+
+ARCEvictionPolicy::ARCEvictionPolicy(size_t frame_count)
+    : capacity_(frame_count),
+      keys_(frame_count, 0),
+      t1_(frame_count),
+      t2_(frame_count) {}
+
+void ARCEvictionPolicy::recordAdmission(int frame_id, PageKey key) {
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  t1_.remove(frame_id);
+  t2_.remove(frame_id);
+  keys_[frame_id] = key;
+
+  if (b1_.contains(key)) {
+    ghost_hits_.fetch_add(1, std::memory_order_relaxed);
+    const size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+    p_ = std::min(capacity_, p_ + delta);
+    b1_.erase(key);
+    t2_.pushFront(frame_id);
+    return;
+  }
+  if (b2_.contains(key)) {
+    ghost_hits_.fetch_add(1, std::memory_order_relaxed);
+    const size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+    p_ = p_ > delta ? p_ - delta : 0;
+    b2_.erase(key);
+    t2_.pushFront(frame_id);
+    return;
+  }
+
+  // Complete miss: keep |T1| + |B1| <= c and the directory within 2c.
+  if (t1_.size() + b1_.size() >= capacity_) {
+    b1_.popBack();
+  } else if (t1_.size() + t2_.size() + b1_.size() + b2_.size() >=
+             2 * capacity_) {
+    b2_.popBack();
+  }
+  t1_.pushFront(frame_id);
+}
+
+void ARCEvictionPolicy::recordHit(int frame_id) {
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
+  if (t1_.contains(frame_id)) {
+    t1_.remove(frame_id);
+    t2_.pushFront(frame_id);
+  } else if (t2_.contains(frame_id)) {
+    t2_.moveToFront(frame_id);
+  }
+}
+
+void ARCEvictionPolicy::recordEviction(int frame_id) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (t1_.contains(frame_id)) {
+    t1_.remove(frame_id);
+    b1_.pushFront(keys_[frame_id]);
+  } else if (t2_.contains(frame_id)) {
+    t2_.remove(frame_id);
+    b2_.pushFront(keys_[frame_id]);
+  }
+  // Evictions that were not followed by an admission (e.g. a failed load)
+  // could otherwise let the ghost lists outgrow the cache size.
+  while (b1_.size() + b2_.size() > capacity_) {
+    if (b1_.size() > b2_.size()) {
+      b1_.popBack();
+    } else {
+      b2_.popBack();
+    }
+  }
+}
+
+void ARCEvictionPolicy::recordRemoval(int frame_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  t1_.remove(frame_id);
+  t2_.remove(frame_id);
+}
+
+void ARCEvictionPolicy::setFrameCount(size_t frame_count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  capacity_ = frame_count;
+  p_ = std::min(p_, capacity_);
+  while (b1_.size() + b2_.size() > capacity_) {
+    if (b1_.size() > b2_.size()) {
+      b1_.popBack();
+    } else {
+      b2_.popBack();
+    }
+  }
+}
+
+std::optional<int> ARCEvictionPolicy::firstEvictable(
+    const FrameList& list, const CanEvict& can_evict) const {
+  for (int frame_id = list.back(); frame_id != FrameList::NONE;
+       frame_id = list.towardFront(frame_id)) {
+    if (can_evict(frame_id)) {
+      return frame_id;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<int> ARCEvictionPolicy::pickVictim(
+    const CanEvict& can_evict, std::optional<PageKey> incoming) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool incoming_in_b2 =
+      incoming.has_value() && b2_.contains(incoming.value());
+  const bool replace_from_t1 =
+      t1_.size() > 0 &&
+      (t1_.size() > p_ || (incoming_in_b2 && t1_.size() == p_));
+  const FrameList& first = replace_from_t1 ? t1_ : t2_;
+  const FrameList& second = replace_from_t1 ? t2_ : t1_;
+  auto victim = firstEvictable(first, can_evict);
+  if (!victim.has_value()) {
+    victim = firstEvictable(second, can_evict);
+  }
+  return victim;
+}
+
+std::string ARCEvictionPolicy::describeState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fmt::format("p={} t1={} t2={} b1={} b2={}", p_, t1_.size(),
+                     t2_.size(), b1_.size(), b2_.size());
+}
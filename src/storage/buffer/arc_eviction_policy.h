@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "eviction_policy.h"
+
+/**
+ * ARC (Megiddo and Modha). T1 holds pages seen once recently and T2 pages
+ * seen at least twice; B1 and B2 remember the pages evicted from each. A
+ * ghost hit in B1 grows the target size p of T1, one in B2 shrinks it, so the
+ * split between recency and frequency adapts to the workload.
+ *
+ * The paper adapts p before REPLACE. Here the directory asks for a victim
+ * before it knows whether the load will go ahead, so pickVictim() applies
+ * REPLACE with the current p (still honouring "incoming is in B2") and p is
+ * adapted when the page is actually admitted.
+ */
+class ARCEvictionPolicy : public EvictionPolicy {
+ public:
+  explicit ARCEvictionPolicy(size_t frame_count);
+
+  const char* name() const override { return "arc"; }
+  void recordAdmission(int frame_id, PageKey key) override;
+  void recordHit(int frame_id) override;
+  void recordEviction(int frame_id) override;
+  void recordRemoval(int frame_id) override;
+  void setFrameCount(size_t frame_count) override;
+  std::optional<int> pickVictim(const CanEvict& can_evict,
+                                std::optional<PageKey> incoming) override;
+  std::string describeState() const override;
+
+ private:
+  std::optional<int> firstEvictable(const FrameList& list,
+                                    const CanEvict& can_evict) const;
+
+  size_t capacity_;
+  mutable std::mutex mutex_;
+  // Target size of T1.
+  size_t p_ = 0;
+  std::vector<PageKey> keys_;
+  FrameList t1_;
+  FrameList t2_;
+  GhostList b1_;
+  GhostList b2_;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+
+#include "eviction_policy.h"
+
+/**
+ * A private ring of frames for a bulk sequential scan, like PostgreSQL's
+ * bulk-read ring buffer. Pages the scan misses on are loaded into the ring's
+ * frames, each miss reusing the frame of the page loaded ringSize() misses
+ * earlier, so a scan larger than the pool does not push the hot set out.
+ * Pages that are already resident are pinned from the shared frames as
+ * usual and never join the ring.
+ *
+ * The ring only remembers frames. BufferPool reuses one only if it still
+ * holds the page the ring put there and is unpinned; otherwise it takes a
+ * frame from the shared pool and puts that in the ring instead. A strategy
+ * belongs to one scan and is not thread-safe.
+ */
+class BufferAccessStrategy {
+ public:
+  explicit BufferAccessStrategy(size_t ring_size)
+      : ring_(ring_size == 0 ? 1 : ring_size) {}
+
+  size_t ringSize() const { return ring_.size(); }
+
+ private:
+  friend class BufferPool;
+  struct Slot {
+    int frame_id = -1;
+    PageKey key = 0;
+  };
+
+  // Returns the slot for the next miss and moves past it.
+  Slot& nextSlot() {
+    Slot& slot = ring_[next_];
+    next_ = (next_ + 1) % ring_.size();
+    return slot;
+  }
+
+  std::vector<Slot> ring_;
+  size_t next_ = 0;
+};
@@ -2,6 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
 #include <cstring>
@@ -14,6 +15,7 @@
 #include "storage/disk/file.h"
 #include "storage/page/page.h"
 #include "storage/wal/wal.h"
+#include "util.h"
 
 namespace {
 
@@ -29,16 +31,114 @@ const char* pageKindLabel(PageKind kind) {
   return "unknown";
 }
 
+EvictionPolicyKind evictionPolicyKindFromEnv() {
+  const char* policy_env = std::getenv("DBFS_BUFFER_POOL_EVICTION_POLICY");
+  if (policy_env == nullptr || *policy_env == '\0') {
+    return EvictionPolicyKind::Clock;
+  }
+  return evictionPolicyKindFromString(policy_env);
+}
+
+size_t lruKFromEnv() {
+  const char* lru_k_env = std::getenv("DBFS_BUFFER_POOL_LRU_K");
+  if (lru_k_env == nullptr || *lru_k_env == '\0') {
+    return 2;
+  }
+  size_t k = 0;
+  try {
+    k = std::stoull(lru_k_env);
+  } catch (...) {
+    k = 0;
+  }
+  if (k == 0) {
+    throw std::invalid_argument(fmt::format(
+        "DBFS_BUFFER_POOL_LRU_K must be a positive integer: {}", lru_k_env));
+  }
+  return k;
+}
+
+IOEngineKind ioEngineKindFromEnv() {
+  const char* engine_env = std::getenv("DBFS_IO_ENGINE");
+  if (engine_env == nullptr || *engine_env == '\0') {
+    return IOEngineKind::Auto;
+  }
+  return ioEngineKindFromString(engine_env);
+}
+
+size_t frameCountFromEnv(const char* name, size_t default_frame_count) {
+  const std::uint64_t default_mb =
+      default_frame_count * BufferPool::FRAME_SIZE_BYTE >> 20;
+  const std::uint64_t mb = dbfs_util::unsignedFromEnv(name, default_mb);
+  return static_cast<size_t>((mb << 20) / BufferPool::FRAME_SIZE_BYTE);
+}
+
+HugePageMode hugePageModeFromEnv() {
+  const char* mode_env = std::getenv("DBFS_BUFFER_POOL_HUGE_PAGES");
+  if (mode_env == nullptr || *mode_env == '\0') {
+    return HugePageMode::Transparent;
+  }
+  return hugePageModeFromString(mode_env);
+}
+
+NumaMode numaModeFromEnv() {
+  const char* mode_env = std::getenv("DBFS_BUFFER_POOL_NUMA");
+  if (mode_env == nullptr || *mode_env == '\0') {
+    return NumaMode::Off;
+  }
+  return numaModeFromString(mode_env);
+}
+
+size_t checkedMaxFrameCount(size_t frame_count, size_t max_frame_count) {
+  if (frame_count == 0) {
+    throw std::invalid_argument("BufferPool needs at least one frame");
+  }
+  max_frame_count = std::max(frame_count, max_frame_count);
+  if (max_frame_count >
+      BufferPool::MAX_POOL_SIZE_BYTE / BufferPool::FRAME_SIZE_BYTE) {
+    throw std::invalid_argument(fmt::format(
+        "Buffer pool maximum of {} frames exceeds the {} GiB cap",
+        max_frame_count, BufferPool::MAX_POOL_SIZE_BYTE >> 30));
+  }
+  return max_frame_count;
+}
+
 }  // namespace
 
 BufferPool::BufferPool(WAL& wal)
-    : buffer_(operator new(BUFFER_SIZE_BYTE)),
+    : BufferPool(wal, evictionPolicyKindFromEnv()) {}
+
+BufferPool::BufferPool(WAL& wal, EvictionPolicyKind eviction_policy)
+    : BufferPool(wal, eviction_policy,
+                 frameCountFromEnv("DBFS_BUFFER_POOL_SIZE_MB",
+                                   DEFAULT_FRAME_COUNT),
+                 frameCountFromEnv("DBFS_BUFFER_POOL_MAX_SIZE_MB", 0)) {}
+
+BufferPool::BufferPool(WAL& wal, EvictionPolicyKind eviction_policy,
+                       size_t frame_count, size_t max_frame_count)
+    : arena_(checkedMaxFrameCount(frame_count, max_frame_count) *
+                 FRAME_SIZE_BYTE,
+             hugePageModeFromEnv(), numaModeFromEnv()),
       wal_(wal),
       buffer_pool_stats_log_interval_ms_(0),
       buffer_pool_event_log_enabled_(false),
       buffer_pool_event_file_log_enabled_(false),
       buffer_pool_event_id_(0),
-      last_buffer_pool_stats_log_at_() {
+      last_buffer_pool_stats_log_at_(),
+      io_engine_(makeIOEngine(
+          ioEngineKindFromEnv(),
+          dbfs_util::unsignedFromEnv("DBFS_IO_THREADS", 4))),
+      read_ahead_pages_(dbfs_util::unsignedFromEnv(
+          "DBFS_BUFFER_POOL_READ_AHEAD_PAGES", 32)),
+      scan_ring_pages_(dbfs_util::unsignedFromEnv(
+          "DBFS_BUFFER_POOL_SCAN_RING_PAGES", 128)),
+      background_writer_delay_ms_(dbfs_util::unsignedFromEnv(
+          "DBFS_BUFFER_POOL_BGWRITER_DELAY_MS", 200)),
+      background_writer_max_pages_(dbfs_util::unsignedFromEnv(
+          "DBFS_BUFFER_POOL_BGWRITER_MAX_PAGES", 100)),
+      frame_directory_(
+          makeEvictionPolicy(eviction_policy, arena_.size() / FRAME_SIZE_BYTE,
+                             lruKFromEnv()),
+          frame_count, arena_.size() / FRAME_SIZE_BYTE) {
   const char* event_log_env = std::getenv("DBFS_BUFFER_POOL_EVENT_LOG");
   buffer_pool_event_log_enabled_ =
       event_log_env != nullptr && *event_log_env != '\0' &&
@@ -72,17 +172,25 @@ BufferPool::BufferPool(WAL& wal)
       buffer_pool_stats_log_interval_ms_ = 0;
     }
   }
+  dbfs_log::storage().info(
+      "Buffer pool: {} frames (max {}), huge pages: {}, NUMA: {}, "
+      "eviction policy: {}, I/O engine: {}",
+      frameCount(), maxFrameCount(), hugePageModeName(), numaModeName(),
+      frame_directory_.evictionPolicy().name(), io_engine_->name());
+  if (background_writer_delay_ms_ > 0 && background_writer_max_pages_ > 0) {
+    background_writer_ = std::thread([this] { runBackgroundWriter(); });
+  }
 };
 
-uint16_t BufferPool::createPage(PageKind kind, File& file,
-                                uint16_t right_most_child_page_id) {
-  uint16_t page_id = file.allocateNextPageId();
-  auto [frame_id, frame_ptr] = acquireFrame(true);
+PageId BufferPool::createPage(PageKind kind, File& file,
+                              PageId right_most_child_page_id) {
+  PageId page_id = file.allocateNextPageId();
+  auto [frame_id, frame_ptr] =
+      acquireFrame(true, PageTable::packKey(file.getFileId(), page_id));
 
-  auto page = std::make_unique<Page>(
+  frame_directory_.registerResidentPage(
+      frame_id, page_id, file.getFileId(), file.getFilePath(),
       Page::initializeNew(frame_ptr, kind, right_most_child_page_id, page_id));
-  frame_directory_.registerResidentPage(frame_id, page_id, file.getFilePath(),
-                                        std::move(page));
   const char* kind_label = "unknown";
   switch (kind) {
     case PageKind::Heap:
@@ -101,8 +209,29 @@ uint16_t BufferPool::createPage(PageKind kind, File& file,
   return page_id;
 }
 
-Page* BufferPool::pinPage(int page_id, File& file) {
+Page* BufferPool::pinPage(PageId page_id, File& file,
+                          BufferAccessStrategy* strategy) {
+  return pinFrame(page_id, file, strategy).page;
+}
+
+ReadPageGuard BufferPool::readPage(PageId page_id, File& file,
+                                   BufferAccessStrategy* strategy) {
+  const PinnedFrame pinned = pinFrame(page_id, file, strategy);
+  return ReadPageGuard(frame_directory_, pinned.frame_id, pinned.page);
+}
+
+WritePageGuard BufferPool::writePage(PageId page_id, File& file,
+                                     BufferAccessStrategy* strategy) {
+  const PinnedFrame pinned = pinFrame(page_id, file, strategy);
+  return WritePageGuard(frame_directory_, pinned.frame_id, pinned.page);
+}
+
+BufferPool::PinnedFrame BufferPool::pinFrame(PageId page_id, File& file,
+                                             BufferAccessStrategy* strategy) {
   stats_.pin_page_calls++;
+  if (strategy != nullptr) {
+    stats_.bulk_read_pins++;
+  }
   if (!file.isPageIDUsed(page_id)) {
     throw std::logic_error(
         fmt::format("BufferPool::pinPage called for uninitialized page ID {} "
@@ -112,42 +241,122 @@ Page* BufferPool::pinPage(int page_id, File& file) {
 
   dbfs_log::storage().debug("Requesting page ID {} from file {}", page_id,
                             file.getFilePath());
-  auto resident_frame_id =
-      frame_directory_.findResidentFrame(page_id, file.getFilePath());
-  if (resident_frame_id.has_value()) {
-    stats_.resident_hits++;
-    int frame_id = resident_frame_id.value();
-    frame_directory_.pin(frame_id);
-    Page* resident_page = frame_directory_.getFrame(frame_id).page.get();
-    logBufferPoolPinEvent(file, page_id, frame_id, *resident_page, true);
-    logBufferPoolStatsIfDue();
-    return resident_page;
-  } else {
+  const std::uint32_t file_id = file.getFileId();
+  auto resident_frame_id = frame_directory_.pinResidentFrame(page_id, file_id);
+  const bool missed = !resident_frame_id.has_value();
+  if (missed) {
     stats_.misses++;
-    auto [frame_id, frame_buffer] = acquireFrame(false);
-    stats_.read_page_into_buffer_calls++;
-    file.readPageIntoBuffer(page_id, frame_buffer);
-    auto page =
-        std::make_unique<Page>(Page::wrapExisting(frame_buffer, page_id));
-    Page* loaded_page = page.get();
-    frame_directory_.registerResidentPage(frame_id, page_id, file.getFilePath(),
-                                          std::move(page));
-    frame_directory_.pin(frame_id);
-    logBufferPoolPinEvent(file, page_id, frame_id, *loaded_page, false);
-    logBufferPoolReadEvent(file, page_id, frame_id, *loaded_page);
-    dbfs_log::storage().debug("Loaded page ID {} into frame ID {}", page_id,
-                              frame_id);
-    logBufferPoolStatsIfDue();
-    return loaded_page;
+    if (read_ahead_pages_ > 0 && isSequentialMiss(file_id, page_id)) {
+      // Read the missed page together with the pages after it.
+      readAhead(file, page_id, strategy);
+      resident_frame_id = frame_directory_.pinResidentFrame(page_id, file_id);
+    }
   }
-};
+  if (!resident_frame_id.has_value()) {
+    auto [frame_id, frame_buffer] =
+        acquireFrame(false, PageTable::packKey(file_id, page_id), strategy);
+    resident_frame_id = frame_directory_.claimFrameForLoad(
+        frame_id, page_id, file_id, file.getFilePath());
+    if (!resident_frame_id.has_value()) {
+      try {
+        stats_.read_page_into_buffer_calls++;
+        file.readPageIntoBuffer(page_id, frame_buffer);
+      } catch (...) {
+        frame_directory_.abortLoad(frame_id);
+        throw;
+      }
+      Page* loaded_page = frame_directory_.completeLoad(
+          frame_id, Page::wrapExisting(frame_buffer, page_id));
+      logBufferPoolPinEvent(file, page_id, frame_id, *loaded_page, false);
+      logBufferPoolReadEvent(file, page_id, frame_id, *loaded_page);
+      dbfs_log::storage().debug("Loaded page ID {} into frame ID {}", page_id,
+                                frame_id);
+      logBufferPoolStatsIfDue();
+      return PinnedFrame{frame_id, loaded_page};
+    }
+    // Another thread published the page while we were acquiring a frame.
+    frame_directory_.releaseFreeFrame(frame_id);
+  } else if (!missed) {
+    stats_.resident_hits++;
+    if (strategy != nullptr) {
+      stats_.bulk_read_resident_hits++;
+    }
+  }
+
+  int frame_id = resident_frame_id.value();
+  Page* resident_page = frame_directory_.waitForLoadedPage(frame_id);
+  if (resident_page == nullptr) {
+    throw std::runtime_error(
+        fmt::format("BufferPool::pinPage: concurrent load of page ID {} in "
+                    "file {} failed",
+                    page_id, file.getFilePath()));
+  }
+  logBufferPoolPinEvent(file, page_id, frame_id, *resident_page, true);
+  logBufferPoolStatsIfDue();
+  return PinnedFrame{frame_id, resident_page};
+}
+
+size_t BufferPool::prefetchPages(File& file,
+                                 const std::vector<PageId>& page_ids,
+                                 BufferAccessStrategy* strategy) {
+  size_t read = 0;
+  for (size_t first = 0; first < page_ids.size(); first += IO_BATCH_FRAMES) {
+    const size_t last = std::min(page_ids.size(), first + IO_BATCH_FRAMES);
+    read += prefetchBatch(file,
+                          std::vector<PageId>(page_ids.begin() + first,
+                                              page_ids.begin() + last),
+                          strategy);
+  }
+  return read;
+}
+
+size_t BufferPool::readAhead(File& file, PageId first_page_id,
+                             BufferAccessStrategy* strategy) {
+  const size_t window = readAheadPages(strategy);
+  if (window == 0 || first_page_id > file.getMaxPageID()) {
+    return 0;
+  }
+  const PageId last_page_id =
+      std::min<PageId>(file.getMaxPageID(), first_page_id + window - 1);
+  std::vector<PageId> page_ids;
+  page_ids.reserve(static_cast<size_t>(last_page_id - first_page_id + 1));
+  for (PageId page_id = first_page_id; page_id <= last_page_id; ++page_id) {
+    page_ids.push_back(page_id);
+  }
+  {
+    std::lock_guard<std::mutex> lock(next_sequential_miss_mutex_);
+    next_sequential_miss_[file.getFileId()] = last_page_id + 1;
+  }
+  stats_.read_ahead_batches++;
+  return prefetchPages(file, page_ids, strategy);
+}
+
+size_t BufferPool::readAheadPages(
+    const BufferAccessStrategy* strategy) const {
+  // A window holds all of its frames at once, so keep it well inside the
+  // pool, which may have been shrunk.
+  const size_t window = std::min(read_ahead_pages_, frameCount() / 4);
+  if (strategy == nullptr) {
+    return window;
+  }
+  return std::min(window, strategy->ringSize() / 2);
+}
+
+std::unique_ptr<BufferAccessStrategy> BufferPool::bulkReadStrategy(
+    File& file) const {
+  if (scan_ring_pages_ == 0 ||
+      static_cast<size_t>(file.getMaxPageID()) <= frameCount() / 4) {
+    return nullptr;
+  }
+  return std::make_unique<BufferAccessStrategy>(scan_ring_pages_);
+}
 
 void BufferPool::unpinPage(Page* page, File& file) {
   if (!page) {
     throw std::invalid_argument("BufferPool::unpinPage called with null page");
   }
   auto resident_frame_id =
-      frame_directory_.findResidentFrame(page->getPageID(), file.getFilePath());
+      frame_directory_.findResidentFrame(page->getPageID(), file.getFileId());
   if (!resident_frame_id.has_value()) {
     throw std::logic_error(
         fmt::format("BufferPool::unpinPage: page ID {} in file {} is not "
@@ -157,50 +366,361 @@ void BufferPool::unpinPage(Page* page, File& file) {
   frame_directory_.unpin(resident_frame_id.value());
 }
 
-BufferPool::~BufferPool() { operator delete(buffer_); }
+BufferPool::~BufferPool() {
+  stopBackgroundWriter();
+}
+
+BufferPoolStats BufferPool::stats() const {
+  BufferPoolStats snapshot;
+  snapshot.pin_page_calls = stats_.pin_page_calls.load();
+  snapshot.resident_hits = stats_.resident_hits.load();
+  snapshot.misses = stats_.misses.load();
+  snapshot.evictions = stats_.evictions.load();
+  snapshot.dirty_evictions = stats_.dirty_evictions.load();
+  snapshot.read_page_into_buffer_calls =
+      stats_.read_page_into_buffer_calls.load();
+  snapshot.zero_out_frame_calls = stats_.zero_out_frame_calls.load();
+  snapshot.background_writer_rounds = stats_.background_writer_rounds.load();
+  snapshot.background_writer_pages_written =
+      stats_.background_writer_pages_written.load();
+  snapshot.background_writer_unflushable_skips =
+      stats_.background_writer_unflushable_skips.load();
+  snapshot.prefetched_pages = stats_.prefetched_pages.load();
+  snapshot.read_ahead_batches = stats_.read_ahead_batches.load();
+  snapshot.bulk_read.pins = stats_.bulk_read_pins.load();
+  snapshot.bulk_read.resident_hits = stats_.bulk_read_resident_hits.load();
+  snapshot.bulk_read.ring_reuses = stats_.bulk_read_ring_reuses.load();
+  snapshot.bulk_read.shared_frames = stats_.bulk_read_shared_frames.load();
+  snapshot.bulk_read.dirty_writes = stats_.bulk_read_dirty_writes.load();
+  return snapshot;
+}
+
+size_t BufferPool::writeBackDirtyPages(size_t max_pages) {
+  std::lock_guard<std::mutex> lock(write_back_mutex_);
+  size_t written = 0;
+  std::vector<int> frame_ids;
+  frame_ids.reserve(IO_BATCH_FRAMES);
+  const size_t frame_count = frameCount();
+  for (size_t scanned = 0; scanned < frame_count && written < max_pages;) {
+    frame_ids.clear();
+    for (; frame_ids.size() < IO_BATCH_FRAMES && scanned < frame_count;
+         ++scanned) {
+      write_back_cursor_ %= frame_count;
+      frame_ids.push_back(static_cast<int>(write_back_cursor_));
+      write_back_cursor_ = (write_back_cursor_ + 1) % frame_count;
+    }
+    written += frame_directory_.writeBackFrames(
+        frame_ids, [&](std::vector<WriteBackCandidate>& candidates) {
+          writeBackBatch(candidates, max_pages - written);
+        });
+  }
+  stats_.background_writer_pages_written += written;
+  return written;
+}
+
+size_t BufferPool::resize(size_t frame_count) {
+  if (frame_count == 0 || frame_count > maxFrameCount()) {
+    throw std::invalid_argument(
+        fmt::format("BufferPool::resize: {} frames is outside 1..{}",
+                    frame_count, maxFrameCount()));
+  }
+  std::lock_guard<std::mutex> lock(resize_mutex_);
+  const size_t old_count = frameCount();
+  if (frame_count >= old_count) {
+    frame_directory_.grow(frame_count);
+  } else {
+    const size_t new_count = frame_directory_.shrink(
+        frame_count,
+        [&](int frame_id, const std::string& file_path, Page& page) {
+          if (writeBackVictim(file_path, page, frame_id)) {
+            stats_.dirty_evictions++;
+          }
+          stats_.evictions++;
+        });
+    if (new_count < old_count) {
+      arena_.release(new_count * FRAME_SIZE_BYTE,
+                     (old_count - new_count) * FRAME_SIZE_BYTE);
+    }
+  }
+  dbfs_log::storage().info("Buffer pool resized from {} to {} frames",
+                           old_count, frameCount());
+  return frameCount();
+}
+
+const char* BufferPool::evictionPolicyName() const {
+  return frame_directory_.evictionPolicy().name();
+}
+
+EvictionPolicyStats BufferPool::evictionPolicyStats() const {
+  return frame_directory_.evictionPolicy().stats();
+}
 
 // private methods
+void BufferPool::runBackgroundWriter() {
+  std::unique_lock<std::mutex> lock(background_writer_mutex_);
+  while (!stop_background_writer_) {
+    background_writer_cv_.wait_for(
+        lock, std::chrono::milliseconds(background_writer_delay_ms_),
+        [this] { return stop_background_writer_; });
+    if (stop_background_writer_) {
+      break;
+    }
+    lock.unlock();
+    try {
+      const size_t written = writeBackDirtyPages(background_writer_max_pages_);
+      stats_.background_writer_rounds++;
+      if (written > 0) {
+        dbfs_log::storage().debug("Background writer wrote {} pages", written);
+      }
+    } catch (const std::exception& e) {
+      // The page stays dirty, so eviction will retry the write inline and
+      // surface the error to a caller.
+      dbfs_log::storage().error("Background writer failed: {}", e.what());
+    }
+    lock.lock();
+  }
+}
+
+void BufferPool::stopBackgroundWriter() {
+  {
+    std::lock_guard<std::mutex> lock(background_writer_mutex_);
+    stop_background_writer_ = true;
+  }
+  background_writer_cv_.notify_all();
+  if (background_writer_.joinable()) {
+    background_writer_.join();
+  }
+}
+
+bool BufferPool::isSequentialMiss(std::uint32_t file_id, PageId page_id) {
+  std::lock_guard<std::mutex> lock(next_sequential_miss_mutex_);
+  auto [next, inserted] =
+      next_sequential_miss_.try_emplace(file_id, INVALID_PAGE_ID);
+  const bool sequential = !inserted && next->second == page_id;
+  next->second = page_id + 1;
+  return sequential;
+}
+
+size_t BufferPool::prefetchBatch(File& file,
+                                 const std::vector<PageId>& page_ids,
+                                 BufferAccessStrategy* strategy) {
+  const std::uint32_t file_id = file.getFileId();
+  std::vector<std::pair<int, PageId>> loads;  // (frame_id, page_id)
+  try {
+    for (const PageId page_id : page_ids) {
+      if (!file.isPageIDUsed(page_id) ||
+          frame_directory_.findResidentFrame(page_id, file_id).has_value()) {
+        continue;
+      }
+      auto [frame_id, frame_buffer] =
+          acquireFrame(false, PageTable::packKey(file_id, page_id), strategy);
+      const auto resident_frame_id = frame_directory_.claimFrameForLoad(
+          frame_id, page_id, file_id, file.getFilePath());
+      if (resident_frame_id.has_value()) {
+        // Loaded by another thread meanwhile; drop the pin it gave us.
+        frame_directory_.unpin(resident_frame_id.value());
+        frame_directory_.releaseFreeFrame(frame_id);
+        continue;
+      }
+      loads.emplace_back(frame_id, page_id);
+    }
+  } catch (...) {
+    for (const auto& [frame_id, page_id] : loads) {
+      frame_directory_.abortLoad(frame_id);
+    }
+    throw;
+  }
+  if (loads.empty()) {
+    return 0;
+  }
+
+  // The claimed frames stay latched by this thread until their read is done,
+  // so completing them here keeps the latch owner and unlocker the same.
+  std::vector<IORequest> batch;
+  batch.reserve(loads.size());
+  try {
+    for (const auto& [frame_id, page_id] : loads) {
+      // A page whose segment does not exist gets fd -1, so its read fails
+      // and the page is skipped below like any failed prefetch.
+      const File::PageLocation location = file.locatePage(page_id, false);
+      batch.push_back(IORequest{IORequest::Op::Read, location.fd,
+                                arena_.data() + frame_id * FRAME_SIZE_BYTE,
+                                Page::PAGE_SIZE_BYTE, location.offset});
+    }
+    io_engine_->submitAndWait(batch);
+  } catch (...) {
+    for (const auto& [frame_id, page_id] : loads) {
+      frame_directory_.abortLoad(frame_id);
+    }
+    throw;
+  }
+
+  size_t read = 0;
+  for (size_t i = 0; i < loads.size(); ++i) {
+    const auto [frame_id, page_id] = loads[i];
+    if (!batch[i].succeeded()) {
+      dbfs_log::storage().warn(
+          "Prefetch of page ID {} in file {} failed: result {}", page_id,
+          file.getFilePath(), batch[i].result);
+      frame_directory_.abortLoad(frame_id);
+      continue;
+    }
+    frame_directory_.completeLoad(frame_id,
+                                  Page::wrapExisting(batch[i].buffer, page_id));
+    frame_directory_.unpin(frame_id);
+    read++;
+  }
+  stats_.read_page_into_buffer_calls += read;
+  stats_.prefetched_pages += read;
+  return read;
+}
+
+void BufferPool::writeBackBatch(std::vector<WriteBackCandidate>& candidates,
+                                size_t max_pages) {
+  // Files stay open until the batch completes so their descriptors do.
+  std::map<std::string, std::unique_ptr<File>> files;
+  std::vector<IORequest> batch;
+  std::vector<WriteBackCandidate*> batched;
+  for (auto& candidate : candidates) {
+    if (batch.size() == max_pages) {
+      break;
+    }
+    // Forcing the WAL here would put an fsync back on somebody's critical
+    // path; the page gets another chance next round.
+    if (!isPageFlushable(*candidate.page)) {
+      stats_.background_writer_unflushable_skips++;
+      continue;
+    }
+    auto [it, inserted] = files.try_emplace(*candidate.file_path);
+    if (inserted) {
+      it->second = File::openIfExists(*candidate.file_path);
+    }
+    if (!it->second) {
+      // The relation was dropped under the page; recreating its file would
+      // resurrect it. Marking the page written drops the change.
+      dbfs_log::storage().warn("Dropping page ID {} of deleted file {}",
+                               candidate.page->getPageID(),
+                               *candidate.file_path);
+      candidate.written = true;
+      continue;
+    }
+    auto& file = it->second;
+    const File::PageLocation location =
+        file->locatePage(candidate.page->getPageID(), true);
+    batch.push_back(IORequest{IORequest::Op::Write, location.fd,
+                              candidate.page->data(), Page::PAGE_SIZE_BYTE,
+                              location.offset});
+    batched.push_back(&candidate);
+  }
+  io_engine_->submitAndWait(batch);
+
+  for (size_t i = 0; i < batch.size(); ++i) {
+    if (batch[i].succeeded()) {
+      batched[i]->written = true;
+      continue;
+    }
+    // The page stays dirty, so eviction will retry the write inline and
+    // surface the error to a caller.
+    dbfs_log::storage().error("Failed to write back page ID {} of {}: {}",
+                              batched[i]->page->getPageID(),
+                              *batched[i]->file_path, batch[i].result);
+  }
+}
+
+size_t BufferPool::discardFile(const std::string& file_path) {
+  const std::optional<std::uint32_t> file_id = File::fileIdOf(file_path);
+  if (!file_id.has_value()) {
+    return 0;
+  }
+  {
+    std::lock_guard<std::mutex> lock(next_sequential_miss_mutex_);
+    next_sequential_miss_.erase(*file_id);
+  }
+  return frame_directory_.discardFile(*file_id);
+}
+
 bool BufferPool::isPageFlushable(const Page& page) const {
-  std::uint64_t page_lsn = page.getPageLSN();
-  std::uint64_t flushed_lsn = wal_.getFlushedLSN();
-  return page_lsn <= flushed_lsn;
+  // pageLSN is the end of the page's latest record, so compare it with the
+  // end of the durable log rather than the start of its last record.
+  return page.getPageLSN() <= wal_.getDurableEndLSN();
 }
 
-void BufferPool::evictOnePage() {
-  auto victim_opt = frame_directory_.findVictimFrame();
-  if (!victim_opt.has_value()) {
-    // TODO: we should sleep or kill queries.
-    throw std::runtime_error(
-        "No victim frame found for eviction. All frames are pinned.");
-  }
-  int victim_frame_id = victim_opt.value();
-  auto& victim_frame = frame_directory_.getFrame(victim_frame_id);
-  int evict_page_id = victim_frame.page_id;
-  const bool dirty = victim_frame.page->isDirty();
-  logBufferPoolEvictEvent(victim_frame.file_path, evict_page_id,
-                          victim_frame_id, *victim_frame.page, dirty);
+int BufferPool::evictOnePage(std::optional<PageKey> incoming) {
+  // A candidate can be pinned by another thread between selection and
+  // eviction, so retry until one sticks. Each failed attempt means some other
+  // thread made progress.
+  for (;;) {
+    auto victim_opt = frame_directory_.findVictimFrame(incoming);
+    if (!victim_opt.has_value()) {
+      // TODO: we should sleep or kill queries.
+      throw std::runtime_error(
+          "No victim frame found for eviction. All frames are pinned.");
+    }
+    int victim_frame_id = victim_opt.value();
+    bool dirty = false;
+    const bool evicted = frame_directory_.evictFrame(
+        victim_frame_id, [&](const std::string& file_path, Page& page) {
+          dirty = writeBackVictim(file_path, page, victim_frame_id);
+        });
+    if (!evicted) {
+      continue;
+    }
+    if (dirty) {
+      stats_.dirty_evictions++;
+    }
+    stats_.evictions++;
+    dbfs_log::storage().debug("Evicted page from frame ID {}",
+                              victim_frame_id);
+    return victim_frame_id;
+  }
+};
+
+bool BufferPool::reuseRingFrame(const BufferAccessStrategy::Slot& slot) {
+  bool dirty = false;
+  const bool evicted = frame_directory_.evictFrame(
+      slot.frame_id,
+      [&](const std::string& file_path, Page& page) {
+        dirty = writeBackVictim(file_path, page, slot.frame_id);
+      },
+      slot.key);
+  if (!evicted) {
+    return false;
+  }
   if (dirty) {
     stats_.dirty_evictions++;
-    if (!isPageFlushable(*victim_frame.page)) {
-      wal_.flush();
-      if (!isPageFlushable(*victim_frame.page)) {
-        // TODO: fix for multithreading later.
-        throw std::runtime_error("Victim page ID " +
-                                 std::to_string(evict_page_id) +
-                                 " is dirty and not flushable. This should not "
-                                 "happen in single-threaded execution.");
-      }
-    }
-    File file(victim_frame.file_path);
-    file.writePageFromBuffer(evict_page_id, victim_frame.page->data());
+    stats_.bulk_read_dirty_writes++;
   }
   stats_.evictions++;
-  frame_directory_.unregisterResidentPage(victim_frame_id);
-  dbfs_log::storage().debug("Evicted page ID {} from frame ID {}",
-                            evict_page_id, victim_frame_id);
-};
+  return true;
+}
 
-void BufferPool::logBufferPoolPinEvent(const File& file, int page_id,
+bool BufferPool::writeBackVictim(const std::string& file_path, Page& page,
+                                 int frame_id) {
+  const PageId evict_page_id = page.getPageID();
+  const bool dirty = page.isDirty();
+  logBufferPoolEvictEvent(file_path, evict_page_id, frame_id, page, dirty);
+  if (!dirty) {
+    return false;
+  }
+  if (!isPageFlushable(page)) {
+    wal_.flush();
+    if (!isPageFlushable(page)) {
+      throw std::runtime_error(
+          "Victim page ID " + std::to_string(evict_page_id) +
+          " is dirty and not flushable even after a WAL flush.");
+    }
+  }
+  const std::unique_ptr<File> file = File::openIfExists(file_path);
+  if (!file) {
+    dbfs_log::storage().warn("Dropping page ID {} of deleted file {}",
+                             evict_page_id, file_path);
+    return false;
+  }
+  file->writePageFromBuffer(evict_page_id, page.data());
+  return true;
+}
+
+void BufferPool::logBufferPoolPinEvent(const File& file, PageId page_id,
                                        int frame_id, const Page& page,
                                        bool hit) {
   if (!buffer_pool_event_log_enabled_) {
@@ -214,7 +734,7 @@ void BufferPool::logBufferPoolPinEvent(const File& file, int page_id,
       pageKindLabel(page.kind()), page.isDirty() ? 1 : 0, hit ? 1 : 0));
 }
 
-void BufferPool::logBufferPoolReadEvent(const File& file, int page_id,
+void BufferPool::logBufferPoolReadEvent(const File& file, PageId page_id,
                                         int frame_id, const Page& page) {
   if (!buffer_pool_event_log_enabled_) {
     return;
@@ -228,7 +748,7 @@ void BufferPool::logBufferPoolReadEvent(const File& file, int page_id,
 }
 
 void BufferPool::logBufferPoolEvictEvent(const std::string& file_path,
-                                         int page_id, int frame_id,
+                                         PageId page_id, int frame_id,
                                          const Page& page, bool dirty) {
   if (!buffer_pool_event_log_enabled_) {
     return;
@@ -247,6 +767,7 @@ void BufferPool::writeBufferPoolEvent(const std::string& event) {
                            now.time_since_epoch())
                            .count();
   if (buffer_pool_event_file_log_enabled_) {
+    std::lock_guard<std::mutex> lock(buffer_pool_event_log_mutex_);
     buffer_pool_event_log_file_ << "logged_at_unix_ms=" << unix_ms << " "
                                 << event << "\n";
     return;
@@ -259,33 +780,44 @@ void BufferPool::zeroOutFrame(int frame_id) {
   stats_.zero_out_frame_calls++;
   dbfs_log::storage().debug("Zeroing out frame ID: {}", frame_id);
   char* frame_buffer =
-      static_cast<char*>(buffer_) + frame_id * BufferPool::FRAME_SIZE_BYTE;
+      arena_.data() + frame_id * BufferPool::FRAME_SIZE_BYTE;
   std::memset(frame_buffer, 0, BufferPool::FRAME_SIZE_BYTE);
 };
 
-std::pair<int, char*> BufferPool::acquireFrame(bool zero_frame) {
-  auto free_frame = frame_directory_.reserveFreeFrame();
-  if (!free_frame.has_value()) {
-    dbfs_log::storage().debug("No free frame available, attempting eviction");
-    evictOnePage();
-    free_frame = frame_directory_.reserveFreeFrame();
-    if (!free_frame.has_value()) {
-      // TODO: this should happen under multithreading when other thread theives
-      // the frame right after eviction. Find a way around later.
-      throw std::runtime_error(
-          "Failed to acquire a free frame even after eviction. This should not "
-          "happen in single-threaded execution.");
+std::pair<int, char*> BufferPool::acquireFrame(
+    bool zero_frame, std::optional<PageKey> incoming,
+    BufferAccessStrategy* strategy) {
+  std::optional<int> free_frame;
+  BufferAccessStrategy::Slot* slot = nullptr;
+  if (strategy != nullptr && incoming.has_value()) {
+    slot = &strategy->nextSlot();
+    if (slot->frame_id != -1 && reuseRingFrame(*slot)) {
+      free_frame = slot->frame_id;
+      stats_.bulk_read_ring_reuses++;
     } else {
-      dbfs_log::storage().debug("Eviction reclaimed free frame {}",
-                                free_frame.value());
+      stats_.bulk_read_shared_frames++;
     }
   }
+  if (!free_frame.has_value()) {
+    free_frame = frame_directory_.reserveFreeFrame();
+  }
+  if (!free_frame.has_value()) {
+    dbfs_log::storage().debug("No free frame available, attempting eviction");
+    // The evicted frame is handed to us directly instead of going through the
+    // free list, so another thread cannot take it in between.
+    free_frame = evictOnePage(incoming);
+    dbfs_log::storage().debug("Eviction reclaimed free frame {}",
+                              free_frame.value());
+  }
   int frame_id = free_frame.value();
+  if (slot != nullptr) {
+    *slot = BufferAccessStrategy::Slot{frame_id, incoming.value()};
+  }
   if (zero_frame) {
     zeroOutFrame(frame_id);
   }
   char* frame_buffer =
-      static_cast<char*>(buffer_) + frame_id * BufferPool::FRAME_SIZE_BYTE;
+      arena_.data() + frame_id * BufferPool::FRAME_SIZE_BYTE;
   return {frame_id, frame_buffer};
 }
 
@@ -294,6 +826,11 @@ void BufferPool::logBufferPoolStatsIfDue() {
     return;
   }
 
+  std::unique_lock<std::mutex> lock(buffer_pool_stats_log_mutex_,
+                                    std::try_to_lock);
+  if (!lock.owns_lock()) {
+    return;
+  }
   auto now = std::chrono::steady_clock::now();
   if (last_buffer_pool_stats_log_at_ !=
           std::chrono::steady_clock::time_point() &&
@@ -303,6 +840,8 @@ void BufferPool::logBufferPoolStatsIfDue() {
   }
   last_buffer_pool_stats_log_at_ = now;
   const auto frame_stats = frame_directory_.collectStats();
+  const auto& eviction_policy = frame_directory_.evictionPolicy();
+  const auto policy_stats = eviction_policy.stats();
 
   dbfs_log::storage().info(
       "buffer_pool_stats pin_page_calls={} resident_hits={} misses={} "
@@ -312,10 +851,14 @@ void BufferPool::logBufferPoolStatsIfDue() {
       "resident_leaf_index_pages={} resident_internal_index_pages={} "
       "pinned_heap_pages={} pinned_leaf_index_pages={} "
       "pinned_internal_index_pages={} dirty_heap_pages={} "
-      "dirty_leaf_index_pages={} dirty_internal_index_pages={}",
-      stats_.pin_page_calls, stats_.resident_hits, stats_.misses,
-      stats_.evictions, stats_.dirty_evictions,
-      stats_.read_page_into_buffer_calls, stats_.zero_out_frame_calls,
+      "dirty_leaf_index_pages={} dirty_internal_index_pages={} "
+      "eviction_policy={} policy_hits={} policy_misses={} "
+      "policy_ghost_hits={} policy_evictions={} {} bgwriter_rounds={} "
+      "bgwriter_pages_written={} bgwriter_unflushable_skips={}",
+      stats_.pin_page_calls.load(), stats_.resident_hits.load(),
+      stats_.misses.load(), stats_.evictions.load(),
+      stats_.dirty_evictions.load(), stats_.read_page_into_buffer_calls.load(),
+      stats_.zero_out_frame_calls.load(),
       frame_stats.frames_free, frame_stats.frames_resident,
       frame_stats.frames_pinned, frame_stats.frames_evictable,
       frame_stats.resident_heap_pages, frame_stats.resident_leaf_index_pages,
@@ -323,5 +866,10 @@ void BufferPool::logBufferPoolStatsIfDue() {
       frame_stats.pinned_leaf_index_pages,
       frame_stats.pinned_internal_index_pages, frame_stats.dirty_heap_pages,
       frame_stats.dirty_leaf_index_pages,
-      frame_stats.dirty_internal_index_pages);
+      frame_stats.dirty_internal_index_pages, eviction_policy.name(),
+      policy_stats.hits, policy_stats.misses, policy_stats.ghost_hits,
+      policy_stats.evictions, eviction_policy.describeState(),
+      stats_.background_writer_rounds.load(),
+      stats_.background_writer_pages_written.load(),
+      stats_.background_writer_unflushable_skips.load());
 }
@@ -1,18 +1,44 @@
 #pragma once
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "buffer_access_strategy.h"
+#include "eviction_policy.h"
+#include "frame_arena.h"
 #include "frame_directory.h"
+#include "page_guard.h"
 #include "storage/disk/file.h"
+#include "storage/disk/io_engine.h"
 #include "storage/page/page.h"
 
 class WAL;
 
+// Counters for the pins made through one kind of BufferAccessStrategy.
+struct AccessStrategyStats {
+  std::uint64_t pins = 0;
+  std::uint64_t resident_hits = 0;
+  // Misses, including read-ahead, that recycled one of the ring's frames.
+  std::uint64_t ring_reuses = 0;
+  // Misses that took a frame from the shared pool instead: the ring was
+  // still filling, or its frame was pinned or had been evicted meanwhile.
+  std::uint64_t shared_frames = 0;
+  // Dirty pages written back to recycle a ring frame.
+  std::uint64_t dirty_writes = 0;
+};
+
 struct BufferPoolStats {
   std::uint64_t pin_page_calls = 0;
   std::uint64_t resident_hits = 0;
@@ -21,41 +47,250 @@ struct BufferPoolStats {
   std::uint64_t dirty_evictions = 0;
   std::uint64_t read_page_into_buffer_calls = 0;
   std::uint64_t zero_out_frame_calls = 0;
+  std::uint64_t background_writer_rounds = 0;
+  std::uint64_t background_writer_pages_written = 0;
+  // Dirty unpinned pages the writer left alone because their pageLSN was not
+  // yet durable in the WAL.
+  std::uint64_t background_writer_unflushable_skips = 0;
+  // Pages read by prefetchPages(), also counted in
+  // read_page_into_buffer_calls.
+  std::uint64_t prefetched_pages = 0;
+  // Read-ahead batches, whether hinted by a scan or started by a detected
+  // sequential miss.
+  std::uint64_t read_ahead_batches = 0;
+  // Pins made with a bulkReadStrategy(); also counted above.
+  AccessStrategyStats bulk_read;
 };
 
+/**
+ * BufferPool is safe to call from many threads at once: page lookup, pinning
+ * and eviction are synchronized inside FrameDirectory, and the counters are
+ * atomics. It does not latch page contents for callers; concurrent writers to
+ * the same page still need to be serialized above the pool.
+ */
 class BufferPool {
  public:
-  static constexpr size_t MAX_FRAME_COUNT = 16384;
-  static constexpr uint16_t HAS_NO_CHILD = -1;
+  static constexpr size_t FRAME_SIZE_BYTE = 4096 * 2;
+  static constexpr size_t DEFAULT_FRAME_COUNT = 16384;
+  // Fixed cap on the pool's address space reservation, whatever the config.
+  static constexpr size_t MAX_POOL_SIZE_BYTE = size_t{256} << 30;
+  static constexpr PageId HAS_NO_CHILD = INVALID_PAGE_ID;
+  /**
+   * The pool starts with DBFS_BUFFER_POOL_SIZE_MB of frames (default 128)
+   * and can be resized online up to DBFS_BUFFER_POOL_MAX_SIZE_MB (default
+   * the starting size), at most MAX_POOL_SIZE_BYTE. Address space for the
+   * maximum is reserved up front; memory is only committed as frames are
+   * used.
+   *
+   * DBFS_BUFFER_POOL_HUGE_PAGES (off, transparent or hugetlb; default
+   * transparent) and DBFS_BUFFER_POOL_NUMA (off, interleave or partition;
+   * default off) control how that memory is backed; see FrameArena.
+   *
+   * The eviction policy is read from DBFS_BUFFER_POOL_EVICTION_POLICY
+   * (clock, lru-k, 2q or arc; default clock). DBFS_BUFFER_POOL_LRU_K sets K
+   * for lru-k (default 2).
+   *
+   * A background writer cleans dirty pages ahead of eviction. It wakes every
+   * DBFS_BUFFER_POOL_BGWRITER_DELAY_MS (default 200; 0 disables it) and
+   * writes at most DBFS_BUFFER_POOL_BGWRITER_MAX_PAGES pages per round
+   * (default 100).
+   *
+   * Prefetch reads and background write-back go through an IOEngine chosen
+   * by DBFS_IO_ENGINE (auto, io_uring or threads; default auto, which falls
+   * back to threads when io_uring is unavailable). DBFS_IO_THREADS sizes the
+   * thread pool (default 4).
+   *
+   * Sequential scans read DBFS_BUFFER_POOL_READ_AHEAD_PAGES pages ahead
+   * (default 32; 0 disables read-ahead).
+   *
+   * Scans of files larger than a quarter of the pool load their pages into
+   * a ring of DBFS_BUFFER_POOL_SCAN_RING_PAGES frames (default 128) instead
+   * of the whole pool; see bulkReadStrategy().
+   */
   explicit BufferPool(WAL& wal);
-  Page* pinPage(int page_id, File& file);
+  BufferPool(WAL& wal, EvictionPolicyKind eviction_policy);
+  // Sizes in frames; max_frame_count 0 means frame_count.
+  BufferPool(WAL& wal, EvictionPolicyKind eviction_policy,
+             size_t frame_count, size_t max_frame_count);
+  /**
+   * Pins the page, loading it on a miss. With a strategy, a miss loads the
+   * page into the strategy's ring rather than evicting from the whole pool.
+   */
+  Page* pinPage(PageId page_id, File& file,
+                BufferAccessStrategy* strategy = nullptr);
+  /**
+   * Pins the page like pinPage() and returns it in a guard holding its page
+   * latch shared (readPage) or exclusively (writePage). The guard unpins by
+   * frame id when it goes away, so prefer these to pinPage()/unpinPage().
+   */
+  ReadPageGuard readPage(PageId page_id, File& file,
+                         BufferAccessStrategy* strategy = nullptr);
+  WritePageGuard writePage(PageId page_id, File& file,
+                           BufferAccessStrategy* strategy = nullptr);
+  /**
+   * Loads the listed pages of file that are not resident yet, with all of
+   * their reads in flight at once, and leaves them unpinned. A later
+   * pinPage() on them is a hit. Threads that pin one of the pages while it is
+   * being read wait for it as for any load. Page ids past the end of the file
+   * are ignored. Returns the number of pages read.
+   */
+  size_t prefetchPages(File& file, const std::vector<PageId>& page_ids,
+                       BufferAccessStrategy* strategy = nullptr);
+  /**
+   * Read-ahead hint from a sequential scan that is about to reach
+   * first_page_id: prefetches the next readAheadPages() pages of file from
+   * there on the caller's thread. Scans call it once per window; pinPage()
+   * also starts read-ahead by itself when it sees misses on consecutive
+   * pages of a file. The window is capped at a quarter of the pool, and
+   * with a strategy at half its ring, so a window never recycles its own
+   * frames. Returns the number of
+   * pages read.
+   */
+  size_t readAhead(File& file, PageId first_page_id,
+                   BufferAccessStrategy* strategy = nullptr);
+  // Read-ahead window, for the given strategy if any.
+  size_t readAheadPages(const BufferAccessStrategy* strategy = nullptr) const;
+  /**
+   * Ring strategy for a sequential scan of file, or nullptr when the file
+   * fits comfortably in the pool and should be cached as usual. The caller
+   * owns the strategy and passes it to every pin of the scan.
+   */
+  std::unique_ptr<BufferAccessStrategy> bulkReadStrategy(File& file) const;
+  /**
+   * Drops the resident pages of file_path without writing them back, so
+   * that the file can be deleted. DROP TABLE calls this before removing the
+   * table's files; otherwise write-back of its dirty pages would bring the
+   * files back. None of the pages may be pinned. Returns the number of pages
+   * dropped.
+   */
+  size_t discardFile(const std::string& file_path);
+  // Unpins a page from pinPage(); this looks the page up again.
   void unpinPage(Page* page, File& file);
-  uint16_t createPage(PageKind kind, File& file,
-                      uint16_t right_most_child_page_id = HAS_NO_CHILD);
-  const BufferPoolStats& stats() const { return stats_; }
+  PageId createPage(PageKind kind, File& file,
+                    PageId right_most_child_page_id = HAS_NO_CHILD);
+  // Snapshot of the counters; individual fields may be read at slightly
+  // different instants while other threads keep running.
+  BufferPoolStats stats() const;
+  /**
+   * Writes back up to max_pages unpinned dirty pages whose pageLSN is already
+   * durable, continuing the walk over the frames where the previous call
+   * stopped. Never flushes the WAL itself. Pages are written in batches
+   * through the I/O engine. Returns the number of pages written. This is one
+   * round of the background writer.
+   */
+  size_t writeBackDirtyPages(size_t max_pages);
+  /**
+   * Dirty resident pages with their recLSN, for a fuzzy checkpoint. Pages
+   * can be written back while this runs; callers must keep pages from being
+   * modified if they need an exact recLSN for every page.
+   */
+  std::vector<DirtyPageInfo> dirtyPages() const {
+    return frame_directory_.collectDirtyPages();
+  }
+  size_t frameCount() const { return frame_directory_.frameCount(); }
+  size_t maxFrameCount() const { return frame_directory_.maxFrameCount(); }
+  /**
+   * Grows or shrinks the pool to frame_count frames (1 to maxFrameCount()).
+   * Growing takes effect at once. Shrinking evicts the pages in the frames
+   * that go away, writing dirty ones back, and returns their memory to the
+   * OS; it stops early at a frame that is pinned or being loaded. Returns
+   * the new frame count.
+   */
+  size_t resize(size_t frame_count);
+  const char* evictionPolicyName() const;
+  const char* ioEngineName() const { return io_engine_->name(); }
+  // Huge page and NUMA modes in effect, after any fallback.
+  const char* hugePageModeName() const {
+    return ::hugePageModeName(arena_.hugePageMode());
+  }
+  const char* numaModeName() const { return ::numaModeName(arena_.numaMode()); }
+  EvictionPolicyStats evictionPolicyStats() const;
   ~BufferPool();
 
  private:
-  static constexpr size_t BUFFER_SIZE_BYTE = 4096 * 2 * 16384;
-  static constexpr size_t FRAME_SIZE_BYTE = 4096 * 2;
-  static constexpr size_t MAX_PAGE_COUNT = 16384;
-  void* buffer_;
+  // Frames latched together by one write-back or prefetch batch.
+  static constexpr size_t IO_BATCH_FRAMES = 64;
+  struct AtomicStats {
+    std::atomic<std::uint64_t> pin_page_calls{0};
+    std::atomic<std::uint64_t> resident_hits{0};
+    std::atomic<std::uint64_t> misses{0};
+    std::atomic<std::uint64_t> evictions{0};
+    std::atomic<std::uint64_t> dirty_evictions{0};
+    std::atomic<std::uint64_t> read_page_into_buffer_calls{0};
+    std::atomic<std::uint64_t> zero_out_frame_calls{0};
+    std::atomic<std::uint64_t> background_writer_rounds{0};
+    std::atomic<std::uint64_t> background_writer_pages_written{0};
+    std::atomic<std::uint64_t> background_writer_unflushable_skips{0};
+    std::atomic<std::uint64_t> prefetched_pages{0};
+    std::atomic<std::uint64_t> read_ahead_batches{0};
+    std::atomic<std::uint64_t> bulk_read_pins{0};
+    std::atomic<std::uint64_t> bulk_read_resident_hits{0};
+    std::atomic<std::uint64_t> bulk_read_ring_reuses{0};
+    std::atomic<std::uint64_t> bulk_read_shared_frames{0};
+    std::atomic<std::uint64_t> bulk_read_dirty_writes{0};
+  };
+  // Sized for the maximum frame count; frames past frameCount() are not
+  // backed by memory.
+  FrameArena arena_;
   WAL& wal_;
-  BufferPoolStats stats_;
+  AtomicStats stats_;
   std::uint64_t buffer_pool_stats_log_interval_ms_;
   bool buffer_pool_event_log_enabled_;
   bool buffer_pool_event_file_log_enabled_;
   std::ofstream buffer_pool_event_log_file_;
-  std::uint64_t buffer_pool_event_id_;
+  std::mutex buffer_pool_event_log_mutex_;
+  std::atomic<std::uint64_t> buffer_pool_event_id_;
   std::chrono::steady_clock::time_point last_buffer_pool_stats_log_at_;
-  void evictOnePage();
+  std::mutex buffer_pool_stats_log_mutex_;
+  // Serializes resize(), so a shrink's memory release cannot race a grow.
+  std::mutex resize_mutex_;
+  std::unique_ptr<IOEngine> io_engine_;
+  size_t read_ahead_pages_;
+  size_t scan_ring_pages_;
+  // Per file id, the miss that would continue a sequential run: the page
+  // after the last miss, or after the last read-ahead window. Only touched
+  // on misses.
+  std::unordered_map<std::uint32_t, PageId> next_sequential_miss_;
+  std::mutex next_sequential_miss_mutex_;
+  std::uint64_t background_writer_delay_ms_;
+  size_t background_writer_max_pages_;
+  // Next frame the write-back walk looks at; guarded by write_back_mutex_.
+  size_t write_back_cursor_ = 0;
+  std::mutex write_back_mutex_;
+  bool stop_background_writer_ = false;
+  std::mutex background_writer_mutex_;
+  std::condition_variable background_writer_cv_;
+  std::thread background_writer_;
+  void runBackgroundWriter();
+  void stopBackgroundWriter();
+  struct PinnedFrame {
+    int frame_id;
+    Page* page;
+  };
+  PinnedFrame pinFrame(PageId page_id, File& file,
+                       BufferAccessStrategy* strategy);
+  // Records a miss and returns whether it continues a sequential run.
+  bool isSequentialMiss(std::uint32_t file_id, PageId page_id);
+  size_t prefetchBatch(File& file, const std::vector<PageId>& page_ids,
+                       BufferAccessStrategy* strategy);
+  // Writes back the flushable candidates, at most max_pages of them.
+  void writeBackBatch(std::vector<WriteBackCandidate>& candidates,
+                      size_t max_pages);
+  int evictOnePage(std::optional<PageKey> incoming);
+  // Takes back the frame a ring slot last loaded, if it is still there.
+  bool reuseRingFrame(const BufferAccessStrategy::Slot& slot);
+  // Writes a dirty victim back before its frame is reused, flushing the WAL
+  // first if needed. A page whose file is gone is dropped. Returns whether
+  // the page was written.
+  bool writeBackVictim(const std::string& file_path, Page& page,
+                       int frame_id);
   void zeroOutFrame(int frame_id);
   void logBufferPoolStatsIfDue();
-  void logBufferPoolPinEvent(const File& file, int page_id, int frame_id,
+  void logBufferPoolPinEvent(const File& file, PageId page_id, int frame_id,
                              const Page& page, bool hit);
-  void logBufferPoolReadEvent(const File& file, int page_id, int frame_id,
+  void logBufferPoolReadEvent(const File& file, PageId page_id, int frame_id,
                               const Page& page);
-  void logBufferPoolEvictEvent(const std::string& file_path, int page_id,
+  void logBufferPoolEvictEvent(const std::string& file_path, PageId page_id,
                                int frame_id, const Page& page, bool dirty);
   void writeBufferPoolEvent(const std::string& event);
   // Design Intent:
@@ -64,9 +299,14 @@ class BufferPool {
   //   - No polymorphism needed for FrameDirectory itself
   //   - They are inseparable (SRP: separate responsibilities, but coupled
   //   lifecycle)
-  // Future: Eviction strategies (FIFO/LRU/Clock) will be injected into
-  // FrameDirectory via Strategy pattern
+  // Eviction strategies (CLOCK/LRU-K/2Q/ARC) are injected into
+  // FrameDirectory as an EvictionPolicy.
   FrameDirectory frame_directory_;
-  std::pair<int, char*> acquireFrame(bool zero_frame);
+  // incoming is the page that will occupy the frame; see
+  // FrameDirectory::findVictimFrame. With a strategy the frame comes from
+  // its ring when possible and is recorded there.
+  std::pair<int, char*> acquireFrame(bool zero_frame,
+                                     std::optional<PageKey> incoming,
+                                     BufferAccessStrategy* strategy = nullptr);
   bool isPageFlushable(const Page& page) const;
 };
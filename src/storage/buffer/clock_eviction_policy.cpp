@@ -0,0 +1,83 @@
+#include "clock_eviction_policy.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "logging.h"
+
+ClockEvictionPolicy::ClockEvictionPolicy(size_t frame_count)
+    : max_frame_count_(frame_count),
+      resident_(new std::atomic<bool>[frame_count]),
+      referenced_(new std::atomic<bool>[frame_count]),
+      frame_count_(frame_count) {
+  for (size_t i = 0; i < max_frame_count_; ++i) {
+    resident_[i].store(false);
+    referenced_[i].store(false);
+  }
+}
+
+void ClockEvictionPolicy::recordAdmission(int frame_id, PageKey /*key*/) {
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  // A new page starts without a second chance, as in the classic algorithm.
+  referenced_[frame_id].store(false, std::memory_order_relaxed);
+  resident_[frame_id].store(true, std::memory_order_release);
+}
+
+void ClockEvictionPolicy::recordHit(int frame_id) {
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  referenced_[frame_id].store(true, std::memory_order_relaxed);
+}
+
+void ClockEvictionPolicy::recordEviction(int frame_id) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  recordRemoval(frame_id);
+}
+
+void ClockEvictionPolicy::recordRemoval(int frame_id) {
+  resident_[frame_id].store(false, std::memory_order_release);
+  referenced_[frame_id].store(false, std::memory_order_relaxed);
+}
+
+void ClockEvictionPolicy::setFrameCount(size_t frame_count) {
+  std::lock_guard<std::mutex> lock(hand_mutex_);
+  frame_count_ = std::min(frame_count, max_frame_count_);
+  if (hand_ >= frame_count_) {
+    hand_ = 0;
+  }
+}
+
+std::optional<int> ClockEvictionPolicy::pickVictim(
+    const CanEvict& can_evict, std::optional<PageKey> /*incoming*/) {
+  std::lock_guard<std::mutex> lock(hand_mutex_);
+  // Two sweeps: the first may only clear reference bits.
+  for (size_t step = 0; step < 2 * frame_count_; ++step) {
+    const int frame_id = static_cast<int>(hand_);
+    hand_ = (hand_ + 1) % frame_count_;
+    if (!resident_[frame_id].load(std::memory_order_acquire)) {
+      continue;
+    }
+    if (referenced_[frame_id].exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    if (can_evict(frame_id)) {
+      return frame_id;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string ClockEvictionPolicy::describeState() const {
+  size_t resident = 0;
+  size_t referenced = 0;
+  for (size_t i = 0; i < max_frame_count_; ++i) {
+    if (resident_[i].load(std::memory_order_relaxed)) {
+      resident++;
+      if (referenced_[i].load(std::memory_order_relaxed)) {
+        referenced++;
+      }
+    }
+  }
+  return fmt::format("resident={} referenced={}", resident, referenced);
+}
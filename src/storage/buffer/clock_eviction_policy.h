@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "eviction_policy.h"
+
+/**
+ * CLOCK (second chance). A hit only sets the frame's reference bit, so the pin
+ * hit path never takes a lock. The hand clears reference bits as it passes and
+ * stops at the first evictable frame whose bit is already clear; each frame
+ * costs at most one extra sweep step per hit, so selection is amortized O(1).
+ */
+class ClockEvictionPolicy : public EvictionPolicy {
+ public:
+  explicit ClockEvictionPolicy(size_t frame_count);
+
+  const char* name() const override { return "clock"; }
+  void recordAdmission(int frame_id, PageKey key) override;
+  void recordHit(int frame_id) override;
+  void recordEviction(int frame_id) override;
+  void recordRemoval(int frame_id) override;
+  void setFrameCount(size_t frame_count) override;
+  std::optional<int> pickVictim(const CanEvict& can_evict,
+                                std::optional<PageKey> incoming) override;
+  std::string describeState() const override;
+
+ private:
+  // Frames the arrays hold; the hand only sweeps the first frame_count_.
+  size_t max_frame_count_;
+  std::unique_ptr<std::atomic<bool>[]> resident_;
+  std::unique_ptr<std::atomic<bool>[]> referenced_;
+  std::mutex hand_mutex_;
+  size_t frame_count_;
+  size_t hand_ = 0;
+};
@@ -0,0 +1,56 @@
+#include "eviction_policy.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "arc_eviction_policy.h"
+#include "clock_eviction_policy.h"
+#include "logging.h"
+#include "lru_k_eviction_policy.h"
+#include "two_queue_eviction_policy.h"
+#include "util.h"
+
+EvictionPolicyStats EvictionPolicy::stats() const {
+  EvictionPolicyStats snapshot;
+  snapshot.hits = hits_.load();
+  snapshot.misses = misses_.load();
+  snapshot.ghost_hits = ghost_hits_.load();
+  snapshot.evictions = evictions_.load();
+  return snapshot;
+}
+
+EvictionPolicyKind evictionPolicyKindFromString(const std::string& name) {
+  const std::string lowered = dbfs_util::toLower(name);
+  if (lowered == "clock") {
+    return EvictionPolicyKind::Clock;
+  }
+  if (lowered == "lru-k" || lowered == "lruk") {
+    return EvictionPolicyKind::LRUK;
+  }
+  if (lowered == "2q") {
+    return EvictionPolicyKind::TwoQueue;
+  }
+  if (lowered == "arc") {
+    return EvictionPolicyKind::ARC;
+  }
+  throw std::invalid_argument(fmt::format(
+      "Unknown eviction policy '{}' (expected clock, lru-k, 2q or arc)",
+      name));
+}
+
+std::unique_ptr<EvictionPolicy> makeEvictionPolicy(EvictionPolicyKind kind,
+                                                   size_t frame_count,
+                                                   size_t lru_k) {
+  switch (kind) {
+    case EvictionPolicyKind::Clock:
+      return std::make_unique<ClockEvictionPolicy>(frame_count);
+    case EvictionPolicyKind::LRUK:
+      return std::make_unique<LRUKEvictionPolicy>(frame_count, lru_k);
+    case EvictionPolicyKind::TwoQueue:
+      return std::make_unique<TwoQueueEvictionPolicy>(frame_count);
+    case EvictionPolicyKind::ARC:
+      return std::make_unique<ARCEvictionPolicy>(frame_count);
+  }
+  throw std::invalid_argument("Unknown eviction policy kind");
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// (file_id, page_id) packed by PageTable::packKey. Policies that keep history
+// for pages that are no longer resident (ghost entries) remember them by key.
+using PageKey = std::uint64_t;
+
+enum class EvictionPolicyKind { Clock, LRUK, TwoQueue, ARC };
+
+struct EvictionPolicyStats {
+  // Pins of a page the policy already tracked as resident.
+  std::uint64_t hits = 0;
+  // Pages admitted into a frame (page loads and newly created pages).
+  std::uint64_t misses = 0;
+  // Admissions of a page the policy still remembered from an earlier eviction.
+  std::uint64_t ghost_hits = 0;
+  std::uint64_t evictions = 0;
+};
+
+/**
+ * Replacement policy used by FrameDirectory to choose eviction victims.
+ *
+ * FrameDirectory reports the life cycle of every frame (admission, hit,
+ * eviction, removal) and asks for a victim when it runs out of free frames.
+ * pickVictim() only proposes a frame: the directory still has to evict it,
+ * which can fail if another thread pins it first, and only then reports
+ * recordEviction().
+ *
+ * Implementations are internally synchronized. recordHit() is on the pin hit
+ * path, so list-based policies only try-lock there and drop the recency
+ * update when another thread holds the policy mutex.
+ */
+class EvictionPolicy {
+ public:
+  using CanEvict = std::function<bool(int frame_id)>;
+
+  virtual ~EvictionPolicy() = default;
+  virtual const char* name() const = 0;
+
+  virtual void recordAdmission(int frame_id, PageKey key) = 0;
+  virtual void recordHit(int frame_id) = 0;
+  virtual void recordEviction(int frame_id) = 0;
+  // The frame was emptied without an eviction decision (e.g. failed load).
+  virtual void recordRemoval(int frame_id) = 0;
+  /**
+   * The pool now has frame_count frames, at most the count the policy was
+   * built for. Frames at or above frame_count are empty. Policies rescale
+   * their list and ghost targets to the new size.
+   */
+  virtual void setFrameCount(size_t frame_count) = 0;
+  /**
+   * Proposes an evictable frame. incoming is the page the freed frame will
+   * hold, when known; ARC uses it to decide which list to shrink.
+   */
+  virtual std::optional<int> pickVictim(const CanEvict& can_evict,
+                                        std::optional<PageKey> incoming) = 0;
+  // Policy-specific sizes for the periodic stats log, e.g. "t1=.. b1=..".
+  virtual std::string describeState() const = 0;
+
+  EvictionPolicyStats stats() const;
+
+ protected:
+  std::atomic<std::uint64_t> hits_{0};
+  std::atomic<std::uint64_t> misses_{0};
+  std::atomic<std::uint64_t> ghost_hits_{0};
+  std::atomic<std::uint64_t> evictions_{0};
+};
+
+/**
+ * Selects the policy from a name as used by DBFS_BUFFER_POOL_EVICTION_POLICY:
+ * "clock", "lru-k", "2q" or "arc" (case-insensitive).
+ */
+EvictionPolicyKind evictionPolicyKindFromString(const std::string& name);
+// frame_count is the most frames the policy will ever track; see
+// EvictionPolicy::setFrameCount.
+std::unique_ptr<EvictionPolicy> makeEvictionPolicy(EvictionPolicyKind kind,
+                                                   size_t frame_count,
+                                                   size_t lru_k = 2);
+
+/**
+ * Intrusive doubly-linked list over frame ids. Front is most recently used,
+ * back is the next eviction candidate. All operations are O(1).
+ */
+class FrameList {
+ public:
+  static constexpr int NONE = -1;
+  explicit FrameList(size_t frame_count)
+      : prev_(frame_count, NONE),
+        next_(frame_count, NONE),
+        linked_(frame_count, false) {}
+
+  bool contains(int frame_id) const { return linked_[frame_id]; }
+  size_t size() const { return size_; }
+  int back() const { return tail_; }
+  // Next candidate after frame_id when walking from back to front.
+  int towardFront(int frame_id) const { return prev_[frame_id]; }
+
+  void pushFront(int frame_id) {
+    prev_[frame_id] = NONE;
+    next_[frame_id] = head_;
+    if (head_ != NONE) {
+      prev_[head_] = frame_id;
+    }
+    head_ = frame_id;
+    if (tail_ == NONE) {
+      tail_ = frame_id;
+    }
+    linked_[frame_id] = true;
+    size_++;
+  }
+
+  void remove(int frame_id) {
+    if (!linked_[frame_id]) {
+      return;
+    }
+    const int prev = prev_[frame_id];
+    const int next = next_[frame_id];
+    if (prev != NONE) {
+      next_[prev] = next;
+    } else {
+      head_ = next;
+    }
+    if (next != NONE) {
+      prev_[next] = prev;
+    } else {
+      tail_ = prev;
+    }
+    linked_[frame_id] = false;
+    size_--;
+  }
+
+  void moveToFront(int frame_id) {
+    remove(frame_id);
+    pushFront(frame_id);
+  }
+
+ private:
+  std::vector<int> prev_;
+  std::vector<int> next_;
+  std::vector<bool> linked_;
+  int head_ = NONE;
+  int tail_ = NONE;
+  size_t size_ = 0;
+};
+
+/**
+ * LRU list of page keys that are no longer resident. Callers bound its size.
+ */
+class GhostList {
+ public:
+  bool contains(PageKey key) const { return index_.count(key) != 0; }
+  size_t size() const { return keys_.size(); }
+  // Least recently evicted key; only valid when size() > 0.
+  PageKey back() const { return keys_.back(); }
+
+  void pushFront(PageKey key) {
+    erase(key);
+    keys_.push_front(key);
+    index_[key] = keys_.begin();
+  }
+
+  bool erase(PageKey key) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+      return false;
+    }
+    keys_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  void popBack() {
+    if (keys_.empty()) {
+      return;
+    }
+    index_.erase(keys_.back());
+    keys_.pop_back();
+  }
+
+ private:
+  std::list<PageKey> keys_;
+  std::unordered_map<PageKey, std::list<PageKey>::iterator> index_;
+};
@@ -0,0 +1,335 @@
+#include "frame_arena.h"
+
+#include <linux/mempolicy.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#ifdef DBFS_HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+#include "logging.h"
+#include "util.h"
+
+namespace {
+
+constexpr size_t kDefaultHugePageSize = size_t{2} << 20;
+
+size_t roundUp(size_t value, size_t unit) {
+  return (value + unit - 1) / unit * unit;
+}
+
+size_t systemPageSize() { return static_cast<size_t>(::sysconf(_SC_PAGESIZE)); }
+
+// The default huge page size, from the "Hugepagesize:" line of meminfo.
+size_t hugePageSize() {
+  std::ifstream meminfo("/proc/meminfo");
+  std::string key;
+  while (meminfo >> key) {
+    if (key == "Hugepagesize:") {
+      size_t kib = 0;
+      if (meminfo >> kib && kib > 0) {
+        return kib << 10;
+      }
+      break;
+    }
+    meminfo.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+  }
+  return kDefaultHugePageSize;
+}
+
+#ifdef DBFS_HAVE_LIBNUMA
+
+std::vector<int> onlineNodes() {
+  std::vector<int> nodes;
+  if (numa_available() < 0) {
+    return nodes;
+  }
+  for (int node = 0; node <= numa_max_node(); ++node) {
+    if (numa_bitmask_isbitset(numa_nodes_ptr, static_cast<unsigned>(node))) {
+      nodes.push_back(node);
+    }
+  }
+  return nodes;
+}
+
+bool interleaveOnNodes(char* start, size_t length,
+                       const std::vector<int>& nodes) {
+  bitmask* mask = numa_allocate_nodemask();
+  for (const int node : nodes) {
+    numa_bitmask_setbit(mask, static_cast<unsigned>(node));
+  }
+  numa_interleave_memory(start, length, mask);
+  numa_free_nodemask(mask);
+  return true;
+}
+
+bool bindToNode(char* start, size_t length, int node) {
+  numa_tonode_memory(start, length, node);
+  return true;
+}
+
+#else
+
+constexpr size_t kMaxNodes = 1024;
+constexpr size_t kBitsPerWord = 8 * sizeof(unsigned long);
+
+// Online nodes as listed in sysfs, e.g. "0-1,3".
+std::vector<int> onlineNodes() {
+  std::vector<int> nodes;
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string list;
+  if (!std::getline(online, list)) {
+    return nodes;
+  }
+  std::stringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    const size_t dash = range.find('-');
+    try {
+      const int first = std::stoi(range.substr(0, dash));
+      const int last = dash == std::string::npos
+                           ? first
+                           : std::stoi(range.substr(dash + 1));
+      for (int node = first; node <= last; ++node) {
+        nodes.push_back(node);
+      }
+    } catch (...) {
+      return {};
+    }
+  }
+  return nodes;
+}
+
+bool mbindToNodes(char* start, size_t length, int mode,
+                  const std::vector<int>& nodes) {
+  unsigned long mask[kMaxNodes / kBitsPerWord] = {};
+  for (const int node : nodes) {
+    if (node < 0 || static_cast<size_t>(node) >= kMaxNodes) {
+      return false;
+    }
+    mask[node / kBitsPerWord] |= 1UL << (node % kBitsPerWord);
+  }
+  // The kernel drops the last bit of maxnode, hence the + 1.
+  return ::syscall(SYS_mbind, start, length, mode, mask, kMaxNodes + 1, 0) ==
+         0;
+}
+
+bool interleaveOnNodes(char* start, size_t length,
+                       const std::vector<int>& nodes) {
+  return mbindToNodes(start, length, MPOL_INTERLEAVE, nodes);
+}
+
+bool bindToNode(char* start, size_t length, int node) {
+  return mbindToNodes(start, length, MPOL_BIND, {node});
+}
+
+#endif
+
+}  // namespace
+
+HugePageMode hugePageModeFromString(const std::string& name) {
+  const std::string mode = dbfs_util::toLower(name);
+  if (mode == "off") {
+    return HugePageMode::Off;
+  }
+  if (mode == "transparent" || mode == "thp") {
+    return HugePageMode::Transparent;
+  }
+  if (mode == "hugetlb") {
+    return HugePageMode::HugeTLB;
+  }
+  throw std::invalid_argument(fmt::format(
+      "Unknown huge page mode '{}' (expected off, transparent or hugetlb)",
+      name));
+}
+
+const char* hugePageModeName(HugePageMode mode) {
+  switch (mode) {
+    case HugePageMode::Off:
+      return "off";
+    case HugePageMode::Transparent:
+      return "transparent";
+    case HugePageMode::HugeTLB:
+      return "hugetlb";
+  }
+  return "unknown";
+}
+
+NumaMode numaModeFromString(const std::string& name) {
+  const std::string mode = dbfs_util::toLower(name);
+  if (mode == "off") {
+    return NumaMode::Off;
+  }
+  if (mode == "interleave") {
+    return NumaMode::Interleave;
+  }
+  if (mode == "partition") {
+    return NumaMode::Partition;
+  }
+  throw std::invalid_argument(fmt::format(
+      "Unknown NUMA mode '{}' (expected off, interleave or partition)", name));
+}
+
+const char* numaModeName(NumaMode mode) {
+  switch (mode) {
+    case NumaMode::Off:
+      return "off";
+    case NumaMode::Interleave:
+      return "interleave";
+    case NumaMode::Partition:
+      return "partition";
+  }
+  return "unknown";
+}
+
+FrameArena::FrameArena(size_t size_byte, HugePageMode huge_pages,
+                       NumaMode numa)
+    : size_byte_(size_byte) {
+  if (size_byte_ == 0) {
+    throw std::invalid_argument("FrameArena needs a non-zero size");
+  }
+  map(huge_pages);
+  placeOnNodes(numa);
+}
+
+FrameArena::~FrameArena() {
+  if (base_ != nullptr) {
+    ::munmap(base_, mapping_size_);
+  }
+}
+
+int FrameArena::nodeOf(size_t offset) const {
+  if (numa_ != NumaMode::Partition) {
+    return -1;
+  }
+  return nodes_[std::min(offset / partition_size_, nodes_.size() - 1)];
+}
+
+void FrameArena::release(size_t offset, size_t length) {
+  const size_t start = roundUp(offset, page_size_);
+  const size_t end =
+      std::min(offset + length, mapping_size_) / page_size_ * page_size_;
+  if (start >= end) {
+    return;
+  }
+  if (::madvise(base_ + start, end - start, MADV_DONTNEED) != 0) {
+    dbfs_log::storage().warn("Could not release {} KiB of frame memory: {}",
+                             (end - start) >> 10, std::strerror(errno));
+  }
+}
+
+void FrameArena::map(HugePageMode huge_pages) {
+  if (huge_pages == HugePageMode::HugeTLB) {
+    const size_t huge_page_size = hugePageSize();
+    const size_t length = roundUp(size_byte_, huge_page_size);
+    // No MAP_NORESERVE: the huge pages are reserved now, so a shortfall
+    // fails here instead of as a SIGBUS on first touch.
+    void* memory =
+        ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (memory != MAP_FAILED) {
+      base_ = static_cast<char*>(memory);
+      mapping_size_ = length;
+      page_size_ = huge_page_size;
+      huge_pages_ = HugePageMode::HugeTLB;
+      return;
+    }
+    dbfs_log::storage().warn(
+        "MAP_HUGETLB failed for {} MiB ({}); using transparent huge pages",
+        length >> 20, std::strerror(errno));
+    huge_pages = HugePageMode::Transparent;
+  }
+
+  const size_t page_size = systemPageSize();
+  const size_t alignment =
+      huge_pages == HugePageMode::Transparent ? hugePageSize() : page_size;
+  const size_t length = roundUp(size_byte_, alignment);
+  // Reserve extra so the start can be aligned, then unmap the slack.
+  const size_t reserved = length + alignment - page_size;
+  void* memory =
+      ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (memory == MAP_FAILED) {
+    throw std::system_error(
+        errno, std::generic_category(),
+        fmt::format("failed to reserve {} MiB for the buffer pool",
+                    length >> 20));
+  }
+  char* start = static_cast<char*>(memory);
+  char* aligned = reinterpret_cast<char*>(
+      roundUp(reinterpret_cast<std::uintptr_t>(start), alignment));
+  if (aligned > start) {
+    ::munmap(start, static_cast<size_t>(aligned - start));
+  }
+  char* reserved_end = start + reserved;
+  if (reserved_end > aligned + length) {
+    ::munmap(aligned + length,
+             static_cast<size_t>(reserved_end - (aligned + length)));
+  }
+  base_ = aligned;
+  mapping_size_ = length;
+  page_size_ = page_size;
+  huge_pages_ = HugePageMode::Off;
+  if (huge_pages == HugePageMode::Transparent) {
+    if (::madvise(base_, mapping_size_, MADV_HUGEPAGE) == 0) {
+      huge_pages_ = HugePageMode::Transparent;
+    } else {
+      dbfs_log::storage().info("Transparent huge pages unavailable: {}",
+                               std::strerror(errno));
+    }
+  }
+}
+
+void FrameArena::placeOnNodes(NumaMode numa) {
+  if (numa == NumaMode::Off) {
+    return;
+  }
+  std::vector<int> nodes = onlineNodes();
+  if (nodes.size() < 2) {
+    dbfs_log::storage().info("NUMA mode {} ignored: {} online node(s)",
+                             numaModeName(numa), nodes.size());
+    return;
+  }
+
+  bool placed = true;
+  size_t partition_size = 0;
+  if (numa == NumaMode::Interleave) {
+    placed = interleaveOnNodes(base_, mapping_size_, nodes);
+  } else {
+    partition_size =
+        roundUp(roundUp(mapping_size_, nodes.size()) / nodes.size(),
+                page_size_);
+    for (size_t i = 0; i < nodes.size() && placed; ++i) {
+      const size_t offset = i * partition_size;
+      if (offset >= mapping_size_) {
+        break;
+      }
+      placed = bindToNode(base_ + offset,
+                          std::min(partition_size, mapping_size_ - offset),
+                          nodes[i]);
+    }
+  }
+  if (!placed) {
+    dbfs_log::storage().warn("NUMA mode {} failed: {}", numaModeName(numa),
+                             std::strerror(errno));
+    return;
+  }
+  numa_ = numa;
+  nodes_ = std::move(nodes);
+  partition_size_ = partition_size;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+enum class HugePageMode { Off, Transparent, HugeTLB };
+enum class NumaMode { Off, Interleave, Partition };
+
+/**
+ * Selects the mode from a name as used by DBFS_BUFFER_POOL_HUGE_PAGES: "off",
+ * "transparent" or "hugetlb" (case-insensitive).
+ */
+HugePageMode hugePageModeFromString(const std::string& name);
+const char* hugePageModeName(HugePageMode mode);
+/**
+ * Selects the mode from a name as used by DBFS_BUFFER_POOL_NUMA: "off",
+ * "interleave" or "partition" (case-insensitive).
+ */
+NumaMode numaModeFromString(const std::string& name);
+const char* numaModeName(NumaMode mode);
+
+/**
+ * The buffer pool's frame memory: one anonymous mapping for the pool's
+ * maximum size, of which only the touched part is ever committed.
+ *
+ * Huge pages cut the TLB misses of a pool that spans gigabytes:
+ * - Transparent aligns the mapping to the huge page size and asks for
+ *   transparent huge pages with madvise(MADV_HUGEPAGE).
+ * - HugeTLB maps preallocated huge pages with MAP_HUGETLB. The kernel
+ *   reserves them for the whole mapping up front, so a shortfall shows up
+ *   here and not as a fault later. It falls back to Transparent, which falls
+ *   back to Off, and hugePageMode() reports what is in effect.
+ *
+ * NUMA placement is set before any frame is touched:
+ * - Interleave spreads the pages round-robin over the online nodes.
+ * - Partition binds the i-th contiguous share of the arena to the i-th
+ *   node; nodeOf() tells which node an offset belongs to.
+ * libnuma is used when the build found it (DBFS_HAVE_LIBNUMA); otherwise
+ * the arena reads the node list from sysfs and calls mbind(2) itself. On a
+ * single-node machine the NUMA mode is Off.
+ */
+class FrameArena {
+ public:
+  FrameArena(size_t size_byte, HugePageMode huge_pages, NumaMode numa);
+  ~FrameArena();
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  char* data() const { return base_; }
+  size_t size() const { return size_byte_; }
+  HugePageMode hugePageMode() const { return huge_pages_; }
+  NumaMode numaMode() const { return numa_; }
+  // Online node the offset is bound to in Partition mode, else -1.
+  int nodeOf(size_t offset) const;
+  /**
+   * Returns the memory of [offset, offset + length) to the OS; it reads as
+   * zeros when touched again. Only the whole pages of the mapping's page
+   * size inside the range are released.
+   */
+  void release(size_t offset, size_t length);
+
+ private:
+  void map(HugePageMode huge_pages);
+  void placeOnNodes(NumaMode numa);
+
+  size_t size_byte_;
+  char* base_ = nullptr;
+  // size_byte_ rounded up to the alignment the huge page mode needs.
+  size_t mapping_size_ = 0;
+  // Granularity of release(): the huge page size for HugeTLB.
+  size_t page_size_ = 0;
+  HugePageMode huge_pages_ = HugePageMode::Off;
+  NumaMode numa_ = NumaMode::Off;
+  std::vector<int> nodes_;
+  size_t partition_size_ = 0;
+};
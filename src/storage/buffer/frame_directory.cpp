@@ -1,137 +1,496 @@
 #include "frame_directory.h"
 
+#include <algorithm>
+#include <functional>
 #include <optional>
+#include <stdexcept>
+#include <string>
 #include <utility>
 
 #include "logging.h"
-FrameDirectory::FrameDirectory() {
-  for (size_t i = 0; i < MAX_FRAME_COUNT; ++i) {
-    free_frames_.insert(static_cast<int>(i));
+
+FrameDirectory::FrameDirectory(
+    std::unique_ptr<EvictionPolicy> eviction_policy, size_t frame_count,
+    size_t max_frame_count)
+    : max_frame_count_(std::max(frame_count, max_frame_count)),
+      frame_chunks_(new std::unique_ptr<Frame[]>[(max_frame_count_ +
+                                                  FRAME_CHUNK_SIZE - 1) /
+                                                 FRAME_CHUNK_SIZE]),
+      eviction_policy_(eviction_policy != nullptr
+                           ? std::move(eviction_policy)
+                           : makeEvictionPolicy(EvictionPolicyKind::Clock,
+                                                max_frame_count_)) {
+  if (frame_count == 0) {
+    throw std::invalid_argument("FrameDirectory needs at least one frame");
+  }
+  for (auto& partition : page_table_partitions_) {
+    partition.page_to_frame =
+        PageTable(2 * frame_count / PAGE_TABLE_PARTITION_COUNT);
+  }
+  grow(frame_count);
+}
+
+void FrameDirectory::grow(size_t frame_count) {
+  std::lock_guard<std::mutex> resize_lock(resize_mutex_);
+  const size_t old_count = frame_count_.load();
+  if (frame_count > max_frame_count_) {
+    throw std::invalid_argument(
+        fmt::format("Cannot grow to {} frames; the maximum is {}",
+                    frame_count, max_frame_count_));
+  }
+  if (frame_count <= old_count) {
+    return;
+  }
+  for (; allocated_frame_count_ < frame_count;
+       allocated_frame_count_ += FRAME_CHUNK_SIZE) {
+    frame_chunks_[allocated_frame_count_ / FRAME_CHUNK_SIZE] =
+        std::make_unique<Frame[]>(FRAME_CHUNK_SIZE);
+  }
+  eviction_policy_->setFrameCount(frame_count);
+  frame_count_.store(frame_count);
+  std::lock_guard<std::mutex> lock(free_frames_mutex_);
+  free_frames_.reserve(free_frames_.size() + frame_count - old_count);
+  // Lowest ids on top, so a fresh directory hands out frame 0 first.
+  for (size_t i = frame_count; i > old_count; --i) {
+    free_frames_.push_back(static_cast<int>(i - 1));
+  }
+}
+
+size_t FrameDirectory::shrink(
+    size_t frame_count,
+    const std::function<void(int frame_id, const std::string& file_path,
+                             Page& page)>& before_evict) {
+  std::lock_guard<std::mutex> resize_lock(resize_mutex_);
+  const size_t old_count = frame_count_.load();
+  frame_count = std::max<size_t>(frame_count, 1);
+  if (frame_count >= old_count) {
+    return old_count;
+  }
+  // Stop new victims and free-list hand-outs in the retiring range first.
+  frame_count_.store(frame_count);
+  eviction_policy_->setFrameCount(frame_count);
+  std::vector<bool> was_free(old_count - frame_count, false);
+  {
+    std::lock_guard<std::mutex> lock(free_frames_mutex_);
+    auto kept = std::remove_if(
+        free_frames_.begin(), free_frames_.end(), [&](int frame_id) {
+          if (static_cast<size_t>(frame_id) < frame_count) {
+            return false;
+          }
+          was_free[frame_id - frame_count] = true;
+          return true;
+        });
+    free_frames_.erase(kept, free_frames_.end());
+  }
+
+  size_t new_count = old_count;
+  auto finish = [&] {
+    if (new_count > frame_count) {
+      std::lock_guard<std::mutex> lock(free_frames_mutex_);
+      for (size_t i = frame_count; i < new_count; ++i) {
+        if (was_free[i - frame_count]) {
+          free_frames_.push_back(static_cast<int>(i));
+        }
+      }
+    }
+    eviction_policy_->setFrameCount(new_count);
+    frame_count_.store(new_count);
+  };
+  try {
+    for (; new_count > frame_count; --new_count) {
+      const int frame_id = static_cast<int>(new_count - 1);
+      if (was_free[frame_id - frame_count]) {
+        continue;
+      }
+      const bool evicted = evictFrame(
+          frame_id, [&](const std::string& file_path, Page& page) {
+            before_evict(frame_id, file_path, page);
+          });
+      if (!evicted) {
+        break;
+      }
+    }
+  } catch (...) {
+    finish();
+    throw;
+  }
+  finish();
+  return new_count;
+}
+
+const std::string* FrameDirectory::internFilePath(
+    std::uint32_t file_id, const std::string& file_path) {
+  {
+    std::shared_lock<std::shared_mutex> lock(file_paths_mutex_);
+    auto it = file_paths_.find(file_id);
+    if (it != file_paths_.end()) {
+      return &it->second;
+    }
   }
+  std::unique_lock<std::shared_mutex> lock(file_paths_mutex_);
+  return &file_paths_.try_emplace(file_id, file_path).first->second;
+}
+
+FrameDirectory::PageTablePartition& FrameDirectory::partitionFor(
+    PageId page_id, std::uint32_t file_id) {
+  // The table probes with the low hash bits, so partition by the high ones.
+  const std::uint64_t hash = PageTable::hash(file_id, page_id);
+  return page_table_partitions_[(hash >> 32) % PAGE_TABLE_PARTITION_COUNT];
 }
 
 std::optional<int> FrameDirectory::reserveFreeFrame() {
+  std::lock_guard<std::mutex> lock(free_frames_mutex_);
   if (free_frames_.empty()) {
     return std::nullopt;
   }
 
-  int frame_id = *free_frames_.begin();
-  free_frames_.erase(free_frames_.begin());
+  int frame_id = free_frames_.back();
+  free_frames_.pop_back();
   dbfs_log::storage().debug("Found free frame {}", frame_id);
   return frame_id;
 }
 
-std::optional<int> FrameDirectory::findResidentFrame(
-    int page_id, const std::string& file_path) {
-  auto key = std::make_pair(page_id, file_path);
-  auto resident_frame = page_to_frame_.find(key);
-  if (resident_frame != page_to_frame_.end()) {
-    return resident_frame->second;
+void FrameDirectory::releaseFreeFrame(int frame_id) {
+  std::lock_guard<std::mutex> lock(free_frames_mutex_);
+  free_frames_.push_back(frame_id);
+}
+
+std::optional<int> FrameDirectory::findResidentFrame(PageId page_id,
+                                                     std::uint32_t file_id) {
+  auto& partition = partitionFor(page_id, file_id);
+  std::lock_guard<std::mutex> lock(partition.mutex);
+  return partition.page_to_frame.find(file_id, page_id);
+}
+
+std::optional<int> FrameDirectory::pinResidentFrame(PageId page_id,
+                                                    std::uint32_t file_id) {
+  auto& partition = partitionFor(page_id, file_id);
+  std::lock_guard<std::mutex> lock(partition.mutex);
+  auto resident_frame = partition.page_to_frame.find(file_id, page_id);
+  if (resident_frame.has_value()) {
+    frameAt(resident_frame.value()).pin_count.fetch_add(1);
+    eviction_policy_->recordHit(resident_frame.value());
   }
-  return std::nullopt;
+  return resident_frame;
 }
 
-void FrameDirectory::registerResidentPage(int frame_id, int page_id,
+void FrameDirectory::registerResidentPage(int frame_id, PageId page_id,
+                                          std::uint32_t file_id,
                                           const std::string& file_path,
-                                          std::unique_ptr<Page> page) {
-  frames_[frame_id].page = std::move(page);
-  frames_[frame_id].page_id = page_id;
-  frames_[frame_id].file_path = file_path;
-  frames_[frame_id].pin_count = 0;
+                                          const Page& page) {
+  auto& frame = frameAt(frame_id);
+  const std::string* interned_path = internFilePath(file_id, file_path);
+  {
+    std::unique_lock<std::shared_mutex> latch(frame.latch);
+    frame.page.emplace(page);
+    frame.page_id = page_id;
+    frame.file_id = file_id;
+    frame.file_path = interned_path;
+    frame.pin_count.store(0);
+    eviction_policy_->recordAdmission(frame_id,
+                                      PageTable::packKey(file_id, page_id));
+  }
 
-  auto key = std::make_pair(page_id, file_path);
-  page_to_frame_[key] = frame_id;
+  auto& partition = partitionFor(page_id, file_id);
+  {
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    partition.page_to_frame.insert(file_id, page_id, frame_id);
+  }
 
   dbfs_log::storage().debug("Registered page {} from {} in frame {}", page_id,
                             file_path, frame_id);
 }
 
 void FrameDirectory::unregisterResidentPage(int frame_id) {
-  auto key =
-      std::make_pair(frames_[frame_id].page_id, frames_[frame_id].file_path);
-  page_to_frame_.erase(key);
-
-  frames_[frame_id].clear();
+  auto& frame = frameAt(frame_id);
+  {
+    std::unique_lock<std::shared_mutex> latch(frame.latch);
+    // A reserved frame that never got a page has no mapping to drop.
+    if (frame.page_id != INVALID_PAGE_ID) {
+      auto& partition = partitionFor(frame.page_id, frame.file_id);
+      std::lock_guard<std::mutex> lock(partition.mutex);
+      partition.page_to_frame.erase(frame.file_id, frame.page_id);
+      eviction_policy_->recordRemoval(frame_id);
+    }
+    frame.clear();
+  }
 
-  free_frames_.insert(frame_id);
+  releaseFreeFrame(frame_id);
 
   dbfs_log::storage().debug("Unregistered and deleted page from frame {}",
                             frame_id);
 }
 
+size_t FrameDirectory::discardFile(std::uint32_t file_id) {
+  // Keeps shrink() from retiring frames while they go back on the free list.
+  std::lock_guard<std::mutex> resize_lock(resize_mutex_);
+  size_t discarded = 0;
+  const size_t frame_count = frameCount();
+  for (size_t i = 0; i < frame_count; ++i) {
+    const int frame_id = static_cast<int>(i);
+    auto& frame = frameAt(frame_id);
+    {
+      std::unique_lock<std::shared_mutex> latch(frame.latch);
+      if (frame.page_id == INVALID_PAGE_ID || frame.file_id != file_id) {
+        continue;
+      }
+      auto& partition = partitionFor(frame.page_id, frame.file_id);
+      {
+        // Pins are taken under the partition mutex, so none can slip in
+        // between this check and the erase.
+        std::lock_guard<std::mutex> lock(partition.mutex);
+        if (frame.pin_count.load() != 0) {
+          throw std::logic_error("cannot discard page ID " +
+                                 std::to_string(frame.page_id) + " of " +
+                                 *frame.file_path + " while it is pinned");
+        }
+        partition.page_to_frame.erase(frame.file_id, frame.page_id);
+      }
+      eviction_policy_->recordRemoval(frame_id);
+      frame.clear();
+    }
+    releaseFreeFrame(frame_id);
+    discarded++;
+  }
+  {
+    std::unique_lock<std::shared_mutex> lock(file_paths_mutex_);
+    file_paths_.erase(file_id);
+  }
+  dbfs_log::storage().debug("Discarded {} pages of file ID {}", discarded,
+                            file_id);
+  return discarded;
+}
+
+std::optional<int> FrameDirectory::claimFrameForLoad(
+    int frame_id, PageId page_id, std::uint32_t file_id,
+    const std::string& file_path) {
+  const std::string* interned_path = internFilePath(file_id, file_path);
+  auto& partition = partitionFor(page_id, file_id);
+  std::lock_guard<std::mutex> lock(partition.mutex);
+  auto resident_frame = partition.page_to_frame.find(file_id, page_id);
+  if (resident_frame.has_value()) {
+    frameAt(resident_frame.value()).pin_count.fetch_add(1);
+    eviction_policy_->recordHit(resident_frame.value());
+    return resident_frame;
+  }
+
+  auto& frame = frameAt(frame_id);
+  frame.latch.lock();
+  frame.page_id = page_id;
+  frame.file_id = file_id;
+  frame.file_path = interned_path;
+  frame.pin_count.store(1);
+  partition.page_to_frame.insert(file_id, page_id, frame_id);
+  // Admit under the partition mutex so that a waiter's recordHit() cannot
+  // reach the policy before the admission does.
+  eviction_policy_->recordAdmission(frame_id,
+                                    PageTable::packKey(file_id, page_id));
+  return std::nullopt;
+}
+
+Page* FrameDirectory::completeLoad(int frame_id, const Page& page) {
+  auto& frame = frameAt(frame_id);
+  Page* loaded_page = &frame.page.emplace(page);
+  frame.latch.unlock();
+  return loaded_page;
+}
+
+void FrameDirectory::abortLoad(int frame_id) {
+  auto& frame = frameAt(frame_id);
+  auto& partition = partitionFor(frame.page_id, frame.file_id);
+  {
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    partition.page_to_frame.erase(frame.file_id, frame.page_id);
+  }
+  eviction_policy_->recordRemoval(frame_id);
+  frame.page.reset();
+  frame.page_id = INVALID_PAGE_ID;
+  frame.file_id = 0;
+  frame.file_path = nullptr;
+  const int remaining_pins = frame.pin_count.fetch_sub(1) - 1;
+  frame.latch.unlock();
+  // Threads that found the frame while it was loading still hold pins; the
+  // last one to let go returns the frame.
+  if (remaining_pins == 0) {
+    releaseFreeFrame(frame_id);
+  }
+}
+
+Page* FrameDirectory::waitForLoadedPage(int frame_id) {
+  auto& frame = frameAt(frame_id);
+  {
+    std::shared_lock<std::shared_mutex> latch(frame.latch);
+    if (frame.page.has_value()) {
+      return &*frame.page;
+    }
+  }
+  if (frame.pin_count.fetch_sub(1) == 1) {
+    releaseFreeFrame(frame_id);
+  }
+  return nullptr;
+}
+
 void FrameDirectory::pin(int frame_id) {
-  frames_[frame_id].pin_count++;
+  const int pin_count = frameAt(frame_id).pin_count.fetch_add(1) + 1;
   dbfs_log::storage().debug("Marked frame {} as pinned, count = {}", frame_id,
-                            frames_[frame_id].pin_count);
+                            pin_count);
 }
 
 void FrameDirectory::unpin(int frame_id) {
-  if (frames_[frame_id].pin_count > 0) {
-    frames_[frame_id].pin_count--;
+  auto& pin_count = frameAt(frame_id).pin_count;
+  int current = pin_count.load();
+  while (current > 0 &&
+         !pin_count.compare_exchange_weak(current, current - 1)) {
+  }
+  if (current > 0) {
     dbfs_log::storage().debug("Marked frame {} as unpinned, count = {}",
-                              frame_id, frames_[frame_id].pin_count);
+                              frame_id, current - 1);
   }
 }
 
 bool FrameDirectory::isPinned(int frame_id) const {
-  return frames_[frame_id].pin_count > 0;
+  return frameAt(frame_id).pin_count.load() > 0;
 }
 
 bool FrameDirectory::isEvictable(int frame_id) const {
-  return frames_[frame_id].pin_count == 0 && frames_[frame_id].page != nullptr;
+  return frameAt(frame_id).pin_count.load() == 0 &&
+         frameAt(frame_id).page.has_value();
 }
 
-std::optional<int> FrameDirectory::findVictimFrame() {
-  std::optional<int> first_dirty_victim;
-
-  for (size_t scanned = 0; scanned < MAX_FRAME_COUNT; ++scanned) {
-    const int frame_id =
-        static_cast<int>((next_victim_frame_ + scanned) % MAX_FRAME_COUNT);
-    if (!isEvictable(frame_id)) {
-      continue;
-    }
-
-    if (frames_[frame_id].page->isDirty()) {
-      if (!first_dirty_victim.has_value()) {
-        first_dirty_victim = frame_id;
-      }
-      continue;
-    }
-
-    next_victim_frame_ = (static_cast<size_t>(frame_id) + 1) % MAX_FRAME_COUNT;
-    dbfs_log::storage().debug("Found clean victim frame {}", frame_id);
-    return frame_id;
+bool FrameDirectory::canEvictWithoutBlocking(int frame_id) const {
+  // Frames being retired by shrink() are not handed out as victims.
+  if (static_cast<size_t>(frame_id) >= frame_count_.load() ||
+      frameAt(frame_id).pin_count.load() != 0) {
+    return false;
   }
+  // A frame whose latch is busy is being loaded, evicted or registered by
+  // another thread; it is not a candidate right now.
+  std::shared_lock<std::shared_mutex> latch(frameAt(frame_id).latch,
+                                            std::try_to_lock);
+  return latch.owns_lock() && isEvictable(frame_id);
+}
 
-  if (first_dirty_victim.has_value()) {
-    const int frame_id = first_dirty_victim.value();
-    next_victim_frame_ = (static_cast<size_t>(frame_id) + 1) % MAX_FRAME_COUNT;
-    dbfs_log::storage().debug("Found dirty victim frame {}", frame_id);
-    return frame_id;
+std::optional<int> FrameDirectory::findVictimFrame(
+    std::optional<PageKey> incoming) {
+  // Dirty and clean pages are treated alike: preferring clean victims evicts
+  // the few recently loaded pages over and over and destroys locality (see
+  // docs/engineering-notes/2026-06-analyze-naive-eviction-policy.md).
+  auto victim = eviction_policy_->pickVictim(
+      [this](int frame_id) { return canEvictWithoutBlocking(frame_id); },
+      incoming);
+  if (victim.has_value()) {
+    dbfs_log::storage().debug("{} policy chose victim frame {}",
+                              eviction_policy_->name(), victim.value());
+    return victim;
   }
 
   // Dump frame directory state to help debugging why no victim exists
   std::string dump = "FrameDirectory dump: ";
-  for (size_t i = 0; i < MAX_FRAME_COUNT; ++i) {
-    dump += fmt::format("[id={} pin={} has_page={}] ", i, frames_[i].pin_count,
-                        frames_[i].page != nullptr);
+  for (size_t i = 0; i < frameCount(); ++i) {
+    dump += fmt::format("[id={} pin={}] ", i,
+                        frameAt(static_cast<int>(i)).pin_count.load());
   }
   dbfs_log::storage().warn(
       "No evictable frames found (all pinned or empty). {}", dump);
   return std::nullopt;
 }
 
+bool FrameDirectory::evictFrame(
+    int frame_id,
+    const std::function<void(const std::string& file_path, Page& page)>&
+        before_evict,
+    std::optional<PageKey> expected) {
+  auto& frame = frameAt(frame_id);
+  std::unique_lock<std::shared_mutex> latch(frame.latch, std::defer_lock);
+  if (!expected.has_value()) {
+    latch.lock();
+  } else if (!latch.try_lock()) {
+    return false;
+  }
+  if (!isEvictable(frame_id)) {
+    return false;
+  }
+  if (expected.has_value() &&
+      PageTable::packKey(frame.file_id, frame.page_id) != *expected) {
+    return false;
+  }
+
+  // Pinners arriving now block on the latch, so nobody modifies the page
+  // while it is written back.
+  before_evict(*frame.file_path, *frame.page);
+  frame.page->clearDirty();
+
+  auto& partition = partitionFor(frame.page_id, frame.file_id);
+  {
+    std::lock_guard<std::mutex> lock(partition.mutex);
+    if (frame.pin_count.load() != 0) {
+      // Somebody pinned the page during write-back; it stays resident (and is
+      // now clean).
+      return false;
+    }
+    partition.page_to_frame.erase(frame.file_id, frame.page_id);
+  }
+  eviction_policy_->recordEviction(frame_id);
+  frame.clear();
+  return true;
+}
+
+size_t FrameDirectory::writeBackFrames(
+    const std::vector<int>& frame_ids,
+    const std::function<void(std::vector<WriteBackCandidate>& candidates)>&
+        write_back) {
+  // Only try-locks are taken here, so holding several latches at once cannot
+  // deadlock with threads that block on one of them.
+  std::vector<std::unique_lock<std::shared_mutex>> latches;
+  std::vector<WriteBackCandidate> candidates;
+  latches.reserve(frame_ids.size());
+  candidates.reserve(frame_ids.size());
+  for (const int frame_id : frame_ids) {
+    auto& frame = frameAt(frame_id);
+    if (frame.pin_count.load() != 0) {
+      continue;
+    }
+    std::unique_lock<std::shared_mutex> latch(frame.latch, std::try_to_lock);
+    // Re-check under the latch: a pin taken after this point has to wait for
+    // the latch before it can touch the page.
+    if (!latch.owns_lock() || !isEvictable(frame_id) ||
+        !frame.page->isDirty()) {
+      continue;
+    }
+    latches.push_back(std::move(latch));
+    candidates.push_back(
+        WriteBackCandidate{frame.file_path, &*frame.page});
+  }
+  if (candidates.empty()) {
+    return 0;
+  }
+
+  write_back(candidates);
+  size_t written = 0;
+  for (auto& candidate : candidates) {
+    if (candidate.written) {
+      candidate.page->clearDirty();
+      written++;
+    }
+  }
+  return written;
+}
+
 FrameDirectoryStats FrameDirectory::collectStats() const {
   FrameDirectoryStats stats;
 
-  for (const auto& frame : frames_) {
-    if (frame.page == nullptr) {
+  const size_t frame_count = frameCount();
+  for (size_t i = 0; i < frame_count; ++i) {
+    const Frame& frame = frameAt(static_cast<int>(i));
+    std::shared_lock<std::shared_mutex> latch(frame.latch);
+    if (!frame.page.has_value()) {
       stats.frames_free++;
       continue;
     }
 
+    const bool pinned = frame.pin_count.load() > 0;
     stats.frames_resident++;
-    if (frame.pin_count > 0) {
+    if (pinned) {
       stats.frames_pinned++;
     } else {
       stats.frames_evictable++;
@@ -140,7 +499,7 @@ FrameDirectoryStats FrameDirectory::collectStats() const {
     switch (frame.page->kind()) {
       case PageKind::Heap:
         stats.resident_heap_pages++;
-        if (frame.pin_count > 0) {
+        if (pinned) {
           stats.pinned_heap_pages++;
         }
         if (frame.page->isDirty()) {
@@ -149,7 +508,7 @@ FrameDirectoryStats FrameDirectory::collectStats() const {
         break;
       case PageKind::LeafIndex:
         stats.resident_leaf_index_pages++;
-        if (frame.pin_count > 0) {
+        if (pinned) {
           stats.pinned_leaf_index_pages++;
         }
         if (frame.page->isDirty()) {
@@ -158,7 +517,7 @@ FrameDirectoryStats FrameDirectory::collectStats() const {
         break;
       case PageKind::InternalIndex:
         stats.resident_internal_index_pages++;
-        if (frame.pin_count > 0) {
+        if (pinned) {
           stats.pinned_internal_index_pages++;
         }
         if (frame.page->isDirty()) {
@@ -171,10 +530,25 @@ FrameDirectoryStats FrameDirectory::collectStats() const {
   return stats;
 }
 
+std::vector<DirtyPageInfo> FrameDirectory::collectDirtyPages() const {
+  std::vector<DirtyPageInfo> dirty_pages;
+  const size_t frame_count = frameCount();
+  for (size_t i = 0; i < frame_count; ++i) {
+    const Frame& frame = frameAt(static_cast<int>(i));
+    std::shared_lock<std::shared_mutex> latch(frame.latch);
+    if (!frame.page.has_value() || !frame.page->isDirty()) {
+      continue;
+    }
+    dirty_pages.push_back(DirtyPageInfo{*frame.file_path, frame.page_id,
+                                        frame.page->getRecLSN()});
+  }
+  return dirty_pages;
+}
+
 const FrameDirectory::Frame& FrameDirectory::getFrame(int frame_id) const {
-  return frames_[frame_id];
+  return frameAt(frame_id);
 }
 
 FrameDirectory::Frame& FrameDirectory::getFrame(int frame_id) {
-  return frames_[frame_id];
+  return frameAt(frame_id);
 }
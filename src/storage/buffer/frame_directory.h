@@ -1,12 +1,19 @@
 #pragma once
 #include <array>
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
-#include <map>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
+#include <shared_mutex>
 #include <string>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 
+#include "eviction_policy.h"
+#include "page_table.h"
 #include "storage/page/page.h"
 
 struct FrameDirectoryStats {
@@ -28,38 +35,188 @@ struct FrameDirectoryStats {
   std::uint64_t dirty_internal_index_pages = 0;
 };
 
+// One dirty resident page, as collected for a checkpoint.
+struct DirtyPageInfo {
+  std::string file_path;
+  PageId page_id;
+  // Page::NO_REC_LSN for pages whose changes are not logged (index pages).
+  std::uint64_t rec_lsn;
+};
+
+// A latched dirty page offered to FrameDirectory::writeBackFrames' callback,
+// which sets written for the pages it wrote.
+struct WriteBackCandidate {
+  const std::string* file_path;
+  Page* page;
+  bool written = false;
+};
+
+/**
+ * Thread-safety:
+ * - The page table is split into PAGE_TABLE_PARTITION_COUNT partitions, each
+ *   guarded by its own mutex. A lookup only serializes with other lookups that
+ *   hash to the same partition. Pages are keyed by (file_id, page_id), where
+ *   file_id is the compact id File assigns per path, so the hit path neither
+ *   copies nor compares path strings.
+ * - pin_count is atomic. Pins are only taken under the partition mutex so
+ *   that eviction can check "unpinned" and remove the mapping atomically;
+ *   unpins are a plain atomic decrement.
+ * - Each frame has a latch. It is held exclusively while the frame metadata
+ *   changes or while its page is being read from disk / written back, and
+ *   pinners take it shared to wait for such an operation to finish.
+ * - Lock order is frame latch -> partition mutex -> eviction policy mutex.
+ *   The only place that locks a latch under a partition mutex is claiming a
+ *   freshly reserved frame, which nobody else can be waiting on. The policy
+ *   only try-locks latches while choosing a victim.
+ * - Frames live in fixed-size chunks that are allocated as the directory
+ *   grows and never move or get freed, so a frame id stays valid for the
+ *   directory's lifetime. The chunk table is sized for max_frame_count up
+ *   front, so looking up a frame takes no lock.
+ *
+ * Frames hold their Page descriptor inline and refer to an interned copy of
+ * the file path, so loading a page into a frame allocates nothing. Each
+ * frame is cache-line aligned, with the fields victim selection reads in its
+ * first line and each latch in a line of its own, so a chunk is one
+ * contiguous array the eviction scan walks without false sharing between
+ * neighbours.
+ *
+ * Besides the frame latch, each frame has a page latch that PageGuard holds
+ * over the page contents. The directory itself never takes it.
+ */
 class FrameDirectory {
  public:
-  static constexpr size_t MAX_FRAME_COUNT = 16384;
+  static constexpr size_t DEFAULT_FRAME_COUNT = 16384;
+  static constexpr size_t PAGE_TABLE_PARTITION_COUNT = 16;
+  static constexpr size_t CACHE_LINE_SIZE = 64;
 
  private:
-  struct Frame {
-    std::unique_ptr<Page> page = nullptr;
-    int page_id = -1;
-    std::string file_path;
-    int pin_count = 0;
+  struct alignas(CACHE_LINE_SIZE) Frame {
+    std::atomic<int> pin_count{0};
+    PageId page_id = INVALID_PAGE_ID;
+    std::uint32_t file_id = 0;
+    // Interned by the directory; only needed to write the page back on
+    // eviction.
+    const std::string* file_path = nullptr;
+    // Empty while the frame is free or its page is being read.
+    std::optional<Page> page;
+    alignas(CACHE_LINE_SIZE) mutable std::shared_mutex latch;
+    alignas(CACHE_LINE_SIZE) mutable std::shared_mutex page_latch;
 
-    void clear() { *this = Frame{}; }
+    void clear() {
+      page.reset();
+      page_id = INVALID_PAGE_ID;
+      file_id = 0;
+      file_path = nullptr;
+      pin_count.store(0);
+    }
   };
-  std::array<Frame, MAX_FRAME_COUNT> frames_;
-  std::map<std::pair<int, std::string>, int> page_to_frame_;
-  // optimization to find free frames in O(1) and avoid sequential search.
-  std::unordered_set<int> free_frames_;
-  size_t next_victim_frame_ = 0;
+  struct PageTablePartition {
+    std::mutex mutex;
+    PageTable page_to_frame;
+  };
+  static constexpr size_t FRAME_CHUNK_SIZE = 4096;
+  size_t max_frame_count_;
+  std::unique_ptr<std::unique_ptr<Frame[]>[]> frame_chunks_;
+  // Frames in use; ids at or above it are retired. Written under
+  // resize_mutex_ after the chunks it covers are allocated.
+  std::atomic<size_t> frame_count_{0};
+  size_t allocated_frame_count_ = 0;
+  std::mutex resize_mutex_;
+  std::array<PageTablePartition, PAGE_TABLE_PARTITION_COUNT>
+      page_table_partitions_;
+  // LIFO stack so that a frame released by eviction is the next one reused.
+  std::vector<int> free_frames_;
+  std::mutex free_frames_mutex_;
+  std::unique_ptr<EvictionPolicy> eviction_policy_;
+  // file_id -> path. Frames point at the entries, so an entry is only
+  // removed once discardFile() has emptied every frame of its file.
+  std::unordered_map<std::uint32_t, std::string> file_paths_;
+  mutable std::shared_mutex file_paths_mutex_;
 
+  Frame& frameAt(int frame_id) const {
+    return frame_chunks_[static_cast<size_t>(frame_id) / FRAME_CHUNK_SIZE]
+                        [static_cast<size_t>(frame_id) % FRAME_CHUNK_SIZE];
+  }
+  PageTablePartition& partitionFor(PageId page_id, std::uint32_t file_id);
+  // Only allocates the first time a file_id is seen.
+  const std::string* internFilePath(std::uint32_t file_id,
+                                    const std::string& file_path);
   bool isEvictable(int frame_id) const;
+  bool canEvictWithoutBlocking(int frame_id) const;
 
  public:
-  FrameDirectory();
+  /**
+   * Starts with frame_count frames and can grow to max_frame_count (0 means
+   * frame_count). A given policy must have been built for max_frame_count
+   * frames; CLOCK is used when none is given.
+   */
+  explicit FrameDirectory(
+      std::unique_ptr<EvictionPolicy> eviction_policy = nullptr,
+      size_t frame_count = DEFAULT_FRAME_COUNT, size_t max_frame_count = 0);
+
+  size_t frameCount() const { return frame_count_.load(); }
+  size_t maxFrameCount() const { return max_frame_count_; }
+  /**
+   * Adds empty frames up to frame_count (at most maxFrameCount()) and makes
+   * them available to reserveFreeFrame().
+   */
+  void grow(size_t frame_count);
+  /**
+   * Retires the frames at or above frame_count, top down. Free frames are
+   * taken off the free list and resident pages are evicted, going through
+   * before_evict (with the frame id) as in evictFrame(). Stops at the first
+   * frame that is pinned or being loaded, and keeps that frame and
+   * everything below it. Returns the new frame count.
+   */
+  size_t shrink(size_t frame_count,
+                const std::function<void(int frame_id,
+                                         const std::string& file_path,
+                                         Page& page)>& before_evict);
 
   std::optional<int> reserveFreeFrame();
-  std::optional<int> findResidentFrame(int page_id,
-                                       const std::string& file_path);
+  // Returns a reserved but never registered frame to the free list.
+  void releaseFreeFrame(int frame_id);
+  std::optional<int> findResidentFrame(PageId page_id, std::uint32_t file_id);
+  /**
+   * Looks up the frame holding (file_id, page_id) and pins it in the same
+   * critical section, so the frame cannot be evicted between the two steps.
+   */
+  std::optional<int> pinResidentFrame(PageId page_id, std::uint32_t file_id);
 
-  void registerResidentPage(int frame_id, int page_id,
-                            const std::string& file_path,
-                            std::unique_ptr<Page> page);
+  // The page descriptor is copied into the frame.
+  void registerResidentPage(int frame_id, PageId page_id, std::uint32_t file_id,
+                            const std::string& file_path, const Page& page);
   void unregisterResidentPage(int frame_id);
+  /**
+   * Drops every page of file_id from the pool without writing it back, for a
+   * relation whose files are about to be deleted. Waits for loads and
+   * write-backs in flight on those frames. Throws std::logic_error if one of
+   * the pages is pinned. Also forgets the file's path, so the id can be
+   * given to another file afterwards. Returns the number of pages dropped.
+   */
+  size_t discardFile(std::uint32_t file_id);
+
+  /**
+   * Publishes a reserved frame as the home of (file_id, page_id) before its
+   * contents are read, so concurrent misses on the same page do not issue a
+   * second read. Returns the frame of a page that another thread published
+   * first (already pinned for the caller), or std::nullopt when the caller
+   * now owns the load: the frame is pinned once and its latch is held
+   * exclusively until completeLoad() or abortLoad().
+   */
+  std::optional<int> claimFrameForLoad(int frame_id, PageId page_id,
+                                       std::uint32_t file_id,
+                                       const std::string& file_path);
+  // Copies the loaded page's descriptor into the frame and releases the
+  // latch. Returns the frame's descriptor.
+  Page* completeLoad(int frame_id, const Page& page);
+  void abortLoad(int frame_id);
+  /**
+   * Waits until a pinned frame is no longer being loaded. Returns nullptr if
+   * the load failed, in which case the caller's pin has been dropped.
+   */
+  Page* waitForLoadedPage(int frame_id);
+
   /**
    * We use explicit pin/unpin.
    * Although Intuitively, for a buffer pool, eviction depends on "safe to reuse
@@ -70,9 +227,48 @@ class FrameDirectory {
   void pin(int frame_id);
   void unpin(int frame_id);
   bool isPinned(int frame_id) const;
+  // Latch over the contents of the page in the frame; see PageGuard.
+  std::shared_mutex& pageLatch(int frame_id) const {
+    return frameAt(frame_id).page_latch;
+  }
 
-  std::optional<int> findVictimFrame();
+  /**
+   * Asks the eviction policy for an unpinned, loaded frame. incoming is the
+   * page that will be loaded into the freed frame, when known.
+   */
+  std::optional<int> findVictimFrame(
+      std::optional<PageKey> incoming = std::nullopt);
+  /**
+   * Removes an unpinned page from the frame and keeps the frame reserved for
+   * the caller. The page is handed to before_evict (which writes it back if
+   * dirty) while the mapping is still published, so a concurrent miss cannot
+   * read a stale on-disk image. Returns false if the frame got pinned or
+   * emptied meanwhile.
+   *
+   * With expected, the frame is only evicted if it still holds that page,
+   * and a busy latch fails the call instead of being waited for; this is
+   * how a BufferAccessStrategy ring takes back a frame it used before.
+   */
+  bool evictFrame(int frame_id,
+                  const std::function<void(const std::string& file_path,
+                                           Page& page)>& before_evict,
+                  std::optional<PageKey> expected = std::nullopt);
+  /**
+   * Writes unpinned dirty pages back without evicting them, for the
+   * background writer. Every candidate among frame_ids is latched
+   * exclusively and all of them are handed to write_back at once, so their
+   * writes can be in flight together; a thread that pins one of the pages
+   * meanwhile waits until the batch finishes. Frames whose latch is busy are
+   * skipped instead of waited for. Pages that write_back marks written are
+   * marked clean; returns their number.
+   */
+  size_t writeBackFrames(
+      const std::vector<int>& frame_ids,
+      const std::function<void(std::vector<WriteBackCandidate>& candidates)>&
+          write_back);
   FrameDirectoryStats collectStats() const;
+  std::vector<DirtyPageInfo> collectDirtyPages() const;
+  const EvictionPolicy& evictionPolicy() const { return *eviction_policy_; }
 
   const Frame& getFrame(int frame_id) const;
   Frame& getFrame(int frame_id);
@@ -0,0 +1,125 @@
+#include "lru_k_eviction_policy.h"
+
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "logging.h"
+
+LRUKEvictionPolicy::LRUKEvictionPolicy(size_t frame_count, size_t k)
+    : frame_count_(frame_count),
+      k_(k),
+      keys_(frame_count, 0),
+      history_(frame_count) {
+  if (k_ == 0) {
+    throw std::invalid_argument("LRU-K requires K >= 1");
+  }
+}
+
+LRUKEvictionPolicy::Rank LRUKEvictionPolicy::rankOf(int frame_id) const {
+  const auto& history = history_[frame_id];
+  if (history.size() < k_) {
+    return Rank{0, history.back(), frame_id};
+  }
+  return Rank{1, history.front(), frame_id};
+}
+
+void LRUKEvictionPolicy::recordAccessLocked(int frame_id) {
+  auto& history = history_[frame_id];
+  if (!history.empty()) {
+    order_.erase(rankOf(frame_id));
+  }
+  if (history.size() == k_) {
+    history.erase(history.begin());
+  }
+  history.push_back(++now_);
+  order_.insert(rankOf(frame_id));
+}
+
+void LRUKEvictionPolicy::untrackLocked(int frame_id) {
+  if (history_[frame_id].empty()) {
+    return;
+  }
+  order_.erase(rankOf(frame_id));
+  history_[frame_id].clear();
+}
+
+void LRUKEvictionPolicy::recordAdmission(int frame_id, PageKey key) {
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  untrackLocked(frame_id);
+  keys_[frame_id] = key;
+  auto retained = retained_history_.find(key);
+  if (retained != retained_history_.end()) {
+    ghost_hits_.fetch_add(1, std::memory_order_relaxed);
+    history_[frame_id] = std::move(retained->second);
+    retained_history_.erase(retained);
+    retained_order_.erase(key);
+    order_.insert(rankOf(frame_id));
+  }
+  recordAccessLocked(frame_id);
+}
+
+void LRUKEvictionPolicy::recordHit(int frame_id) {
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  if (!lock.owns_lock() || history_[frame_id].empty()) {
+    return;
+  }
+  recordAccessLocked(frame_id);
+}
+
+void LRUKEvictionPolicy::recordEviction(int frame_id) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (history_[frame_id].empty()) {
+    return;
+  }
+  const PageKey key = keys_[frame_id];
+  order_.erase(rankOf(frame_id));
+  retained_history_[key] = std::move(history_[frame_id]);
+  history_[frame_id].clear();
+  retained_order_.pushFront(key);
+  if (retained_order_.size() > frame_count_) {
+    retained_history_.erase(retained_order_.back());
+    retained_order_.popBack();
+  }
+}
+
+void LRUKEvictionPolicy::recordRemoval(int frame_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  untrackLocked(frame_id);
+}
+
+void LRUKEvictionPolicy::setFrameCount(size_t frame_count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  frame_count_ = frame_count;
+  while (retained_order_.size() > frame_count_) {
+    retained_history_.erase(retained_order_.back());
+    retained_order_.popBack();
+  }
+}
+
+std::optional<int> LRUKEvictionPolicy::pickVictim(
+    const CanEvict& can_evict, std::optional<PageKey> /*incoming*/) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (const Rank& rank : order_) {
+    const int frame_id = std::get<2>(rank);
+    if (can_evict(frame_id)) {
+      return frame_id;
+    }
+  }
+  return std::nullopt;
+}
+
+std::string LRUKEvictionPolicy::describeState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t with_k_accesses = 0;
+  for (const Rank& rank : order_) {
+    with_k_accesses += std::get<0>(rank);
+  }
+  return fmt::format("k={} resident={} with_k_accesses={} retained={}", k_,
+                     order_.size(), with_k_accesses, retained_order_.size());
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "eviction_policy.h"
+
+/**
+ * LRU-K (O'Neil et al.). The victim is the page whose K-th most recent access
+ * lies furthest in the past; pages with fewer than K accesses have an infinite
+ * backward K-distance and go first, oldest last access first. Access history
+ * of evicted pages is retained for up to frame_count pages, so a page that
+ * comes back soon is ranked by its full history (counted as a ghost hit).
+ *
+ * Frames are kept ordered by rank, so the victim is the first evictable entry
+ * of the order; a hit re-ranks the frame in O(log n).
+ */
+class LRUKEvictionPolicy : public EvictionPolicy {
+ public:
+  LRUKEvictionPolicy(size_t frame_count, size_t k);
+
+  const char* name() const override { return "lru-k"; }
+  void recordAdmission(int frame_id, PageKey key) override;
+  void recordHit(int frame_id) override;
+  void recordEviction(int frame_id) override;
+  void recordRemoval(int frame_id) override;
+  void setFrameCount(size_t frame_count) override;
+  std::optional<int> pickVictim(const CanEvict& can_evict,
+                                std::optional<PageKey> incoming) override;
+  std::string describeState() const override;
+
+ private:
+  // (has K accesses, ranking timestamp, frame id); smallest is evicted first.
+  using Rank = std::tuple<int, std::uint64_t, int>;
+
+  Rank rankOf(int frame_id) const;
+  void recordAccessLocked(int frame_id);
+  void untrackLocked(int frame_id);
+
+  size_t frame_count_;
+  size_t k_;
+  mutable std::mutex mutex_;
+  std::uint64_t now_ = 0;
+  std::vector<PageKey> keys_;
+  // Last K access times per frame, oldest first. Empty when not resident.
+  std::vector<std::vector<std::uint64_t>> history_;
+  std::set<Rank> order_;
+  std::unordered_map<PageKey, std::vector<std::uint64_t>> retained_history_;
+  GhostList retained_order_;
+};
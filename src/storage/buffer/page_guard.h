@@ -0,0 +1,87 @@
+#pragma once
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+
+#include "frame_directory.h"
+#include "storage/page/page.h"
+
+/**
+ * A pinned page together with its page latch, released together when the
+ * guard goes out of scope. Obtained from BufferPool::readPage() (latch held
+ * shared) or BufferPool::writePage() (latch held exclusively).
+ *
+ * The guard carries the frame id, so releasing it neither looks the page up
+ * again nor needs the File. Guards are move-only; a moved-from or released
+ * guard is empty.
+ *
+ * The page latch protects page contents against other guard holders. It is
+ * separate from the frame latch FrameDirectory takes while loading or
+ * writing back a page, and the pin keeps the page resident, so holding a
+ * guard never blocks eviction of other pages. The latch is not recursive: a
+ * thread must not take a second guard on a page it already holds, in either
+ * mode.
+ *
+ * A read guard still hands out a non-const Page, since the page wrappers
+ * (LeafIndexPage, InternalIndexPage) take one; holders must only read the
+ * contents.
+ */
+template <typename Latch>
+class PageGuard {
+ public:
+  PageGuard() = default;
+  PageGuard(const PageGuard&) = delete;
+  PageGuard& operator=(const PageGuard&) = delete;
+  PageGuard(PageGuard&& other) noexcept
+      : directory_(std::exchange(other.directory_, nullptr)),
+        frame_id_(std::exchange(other.frame_id_, -1)),
+        page_(std::exchange(other.page_, nullptr)),
+        latch_(std::move(other.latch_)) {}
+  PageGuard& operator=(PageGuard&& other) noexcept {
+    if (this != &other) {
+      release();
+      directory_ = std::exchange(other.directory_, nullptr);
+      frame_id_ = std::exchange(other.frame_id_, -1);
+      page_ = std::exchange(other.page_, nullptr);
+      latch_ = std::move(other.latch_);
+    }
+    return *this;
+  }
+  ~PageGuard() { release(); }
+
+  Page* get() const { return page_; }
+  Page& operator*() const { return *page_; }
+  Page* operator->() const { return page_; }
+  explicit operator bool() const { return page_ != nullptr; }
+  int frameId() const { return frame_id_; }
+
+  // Drops the latch and the pin before the guard goes out of scope.
+  void release() {
+    if (page_ == nullptr) {
+      return;
+    }
+    // Unlatch first: once unpinned, the frame may be handed to another page.
+    latch_.unlock();
+    directory_->unpin(frame_id_);
+    directory_ = nullptr;
+    frame_id_ = -1;
+    page_ = nullptr;
+  }
+
+ private:
+  friend class BufferPool;
+  // Takes over a pin the caller already holds and latches the page.
+  PageGuard(FrameDirectory& directory, int frame_id, Page* page)
+      : directory_(&directory),
+        frame_id_(frame_id),
+        page_(page),
+        latch_(directory.pageLatch(frame_id)) {}
+
+  FrameDirectory* directory_ = nullptr;
+  int frame_id_ = -1;
+  Page* page_ = nullptr;
+  Latch latch_;
+};
+
+using ReadPageGuard = PageGuard<std::shared_lock<std::shared_mutex>>;
+using WritePageGuard = PageGuard<std::unique_lock<std::shared_mutex>>;
@@ -0,0 +1,112 @@
+#include "page_table.h"
+
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+size_t roundUpToPowerOfTwo(size_t value) {
+  size_t capacity = 1;
+  while (capacity < value) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
+
+}  // namespace
+
+PageTable::PageTable(size_t initial_capacity)
+    : slots_(roundUpToPowerOfTwo(initial_capacity < 2 ? 2 : initial_capacity)),
+      mask_(slots_.size() - 1) {}
+
+std::uint64_t PageTable::packKey(std::uint32_t file_id, PageId page_id) {
+  if (page_id > MAX_PAGE_ID || file_id > MAX_FILE_ID) {
+    throw std::invalid_argument("PageTable: page or file id out of range");
+  }
+  return (static_cast<std::uint64_t>(file_id) << PAGE_ID_BITS) | page_id;
+}
+
+// splitmix64 finalizer.
+std::uint64_t PageTable::mix(std::uint64_t key) {
+  key ^= key >> 30;
+  key *= 0xbf58476d1ce4e5b9ULL;
+  key ^= key >> 27;
+  key *= 0x94d049bb133111ebULL;
+  key ^= key >> 31;
+  return key;
+}
+
+std::uint64_t PageTable::hash(std::uint32_t file_id, PageId page_id) {
+  return mix(packKey(file_id, page_id));
+}
+
+size_t PageTable::findSlot(std::uint64_t key) const {
+  size_t slot = static_cast<size_t>(mix(key)) & mask_;
+  while (slots_[slot].key != EMPTY_KEY && slots_[slot].key != key) {
+    slot = (slot + 1) & mask_;
+  }
+  return slot;
+}
+
+std::optional<int> PageTable::find(std::uint32_t file_id,
+                                   PageId page_id) const {
+  const Slot& slot = slots_[findSlot(packKey(file_id, page_id))];
+  if (slot.key == EMPTY_KEY) {
+    return std::nullopt;
+  }
+  return slot.frame_id;
+}
+
+void PageTable::insert(std::uint32_t file_id, PageId page_id, int frame_id) {
+  // Keep the load factor at or below 1/2 so linear probes stay short.
+  if ((size_ + 1) * 2 > slots_.size()) {
+    grow();
+  }
+  const std::uint64_t key = packKey(file_id, page_id);
+  Slot& slot = slots_[findSlot(key)];
+  if (slot.key == EMPTY_KEY) {
+    slot.key = key;
+    size_++;
+  }
+  slot.frame_id = frame_id;
+}
+
+bool PageTable::erase(std::uint32_t file_id, PageId page_id) {
+  size_t hole = findSlot(packKey(file_id, page_id));
+  if (slots_[hole].key == EMPTY_KEY) {
+    return false;
+  }
+
+  // Backward-shift deletion: move later entries of the same probe run into the
+  // hole unless their home slot lies cyclically in (hole, next].
+  size_t next = hole;
+  for (;;) {
+    next = (next + 1) & mask_;
+    if (slots_[next].key == EMPTY_KEY) {
+      break;
+    }
+    const size_t home = static_cast<size_t>(mix(slots_[next].key)) & mask_;
+    const bool home_between_hole_and_next =
+        hole <= next ? (hole < home && home <= next)
+                     : (hole < home || home <= next);
+    if (!home_between_hole_and_next) {
+      slots_[hole] = slots_[next];
+      hole = next;
+    }
+  }
+  slots_[hole] = Slot{};
+  size_--;
+  return true;
+}
+
+void PageTable::grow() {
+  std::vector<Slot> old_slots(slots_.size() * 2);
+  old_slots.swap(slots_);
+  mask_ = slots_.size() - 1;
+  for (const Slot& slot : old_slots) {
+    if (slot.key != EMPTY_KEY) {
+      slots_[findSlot(slot.key)] = slot;
+    }
+  }
+}
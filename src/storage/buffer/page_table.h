@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "storage/page/page_id.h"
+
+/**
+ * Open-addressing hash table from (file_id, page_id) to a frame id.
+ *
+ * Both ids are packed into one 64-bit key, so a probe is an integer compare and
+ * a hit touches a single cache line in the common case. Collisions use linear
+ * probing and deletion uses backward shifting, so there are no tombstones and
+ * probe sequences do not degrade under eviction churn.
+ *
+ * Not synchronized: FrameDirectory guards each instance with its partition
+ * mutex.
+ */
+class PageTable {
+ public:
+  explicit PageTable(size_t initial_capacity = 64);
+
+  /**
+   * Mixes (file_id, page_id) into a well-distributed 64-bit hash. The low bits
+   * pick the probe start; callers may use the high bits to pick a partition.
+   */
+  static std::uint64_t hash(std::uint32_t file_id, PageId page_id);
+  // The packed 64-bit key; also used by eviction policies to remember pages.
+  // The file id takes the high 16 bits and the page id the low 48, which
+  // File's segment limit keeps every page id within.
+  static std::uint64_t packKey(std::uint32_t file_id, PageId page_id);
+  static constexpr int PAGE_ID_BITS = 48;
+  static constexpr PageId MAX_PAGE_ID = (PageId{1} << PAGE_ID_BITS) - 1;
+  static constexpr std::uint32_t MAX_FILE_ID = 0xFFFF;
+
+  std::optional<int> find(std::uint32_t file_id, PageId page_id) const;
+  // Inserts the mapping, overwriting an existing one for the same key.
+  void insert(std::uint32_t file_id, PageId page_id, int frame_id);
+  bool erase(std::uint32_t file_id, PageId page_id);
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr std::uint64_t EMPTY_KEY = ~std::uint64_t{0};
+  struct Slot {
+    std::uint64_t key = EMPTY_KEY;
+    int frame_id = -1;
+  };
+
+  static std::uint64_t mix(std::uint64_t key);
+  size_t findSlot(std::uint64_t key) const;
+  void grow();
+
+  std::vector<Slot> slots_;
+  size_t mask_;
+  size_t size_ = 0;
+};
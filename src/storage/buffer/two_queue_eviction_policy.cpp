@@ -0,0 +1,98 @@
+#include "two_queue_eviction_policy.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <string>
+
+#include "logging.h"
+
+TwoQueueEvictionPolicy::TwoQueueEvictionPolicy(size_t frame_count)
+    : a1in_target_(std::max<size_t>(1, frame_count / 4)),
+      a1out_capacity_(std::max<size_t>(1, frame_count / 2)),
+      keys_(frame_count, 0),
+      a1in_(frame_count),
+      am_(frame_count) {}
+
+void TwoQueueEvictionPolicy::recordAdmission(int frame_id, PageKey key) {
+  misses_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  a1in_.remove(frame_id);
+  am_.remove(frame_id);
+  keys_[frame_id] = key;
+  if (a1out_.erase(key)) {
+    ghost_hits_.fetch_add(1, std::memory_order_relaxed);
+    am_.pushFront(frame_id);
+  } else {
+    a1in_.pushFront(frame_id);
+  }
+}
+
+void TwoQueueEvictionPolicy::recordHit(int frame_id) {
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+  // Hits in A1in are deliberately ignored: correlated references right after
+  // admission should not make a page look hot.
+  if (lock.owns_lock() && am_.contains(frame_id)) {
+    am_.moveToFront(frame_id);
+  }
+}
+
+void TwoQueueEvictionPolicy::recordEviction(int frame_id) {
+  evictions_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (a1in_.contains(frame_id)) {
+    a1in_.remove(frame_id);
+    a1out_.pushFront(keys_[frame_id]);
+    if (a1out_.size() > a1out_capacity_) {
+      a1out_.popBack();
+    }
+  } else {
+    am_.remove(frame_id);
+  }
+}
+
+void TwoQueueEvictionPolicy::recordRemoval(int frame_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  a1in_.remove(frame_id);
+  am_.remove(frame_id);
+}
+
+void TwoQueueEvictionPolicy::setFrameCount(size_t frame_count) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  a1in_target_ = std::max<size_t>(1, frame_count / 4);
+  a1out_capacity_ = std::max<size_t>(1, frame_count / 2);
+  while (a1out_.size() > a1out_capacity_) {
+    a1out_.popBack();
+  }
+}
+
+std::optional<int> TwoQueueEvictionPolicy::firstEvictable(
+    const FrameList& list, const CanEvict& can_evict) const {
+  for (int frame_id = list.back(); frame_id != FrameList::NONE;
+       frame_id = list.towardFront(frame_id)) {
+    if (can_evict(frame_id)) {
+      return frame_id;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional<int> TwoQueueEvictionPolicy::pickVictim(
+    const CanEvict& can_evict, std::optional<PageKey> /*incoming*/) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  const bool prefer_a1in = a1in_.size() > a1in_target_ || am_.size() == 0;
+  const FrameList& first = prefer_a1in ? a1in_ : am_;
+  const FrameList& second = prefer_a1in ? am_ : a1in_;
+  auto victim = firstEvictable(first, can_evict);
+  if (!victim.has_value()) {
+    victim = firstEvictable(second, can_evict);
+  }
+  return victim;
+}
+
+std::string TwoQueueEvictionPolicy::describeState() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return fmt::format("a1in={} am={} a1out={}", a1in_.size(), am_.size(),
+                     a1out_.size());
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "eviction_policy.h"
+
+/**
+ * Full 2Q (Johnson and Shasha). New pages enter the FIFO A1in; hits there do
+ * not promote, so a single scan cannot flush the hot set. Pages evicted from
+ * A1in are remembered in the ghost queue A1out, and a page admitted again
+ * while still in A1out goes straight to the LRU list Am. A1in is sized to 25%
+ * of the frames and A1out to 50%, the values recommended by the paper.
+ */
+class TwoQueueEvictionPolicy : public EvictionPolicy {
+ public:
+  explicit TwoQueueEvictionPolicy(size_t frame_count);
+
+  const char* name() const override { return "2q"; }
+  void recordAdmission(int frame_id, PageKey key) override;
+  void recordHit(int frame_id) override;
+  void recordEviction(int frame_id) override;
+  void recordRemoval(int frame_id) override;
+  void setFrameCount(size_t frame_count) override;
+  std::optional<int> pickVictim(const CanEvict& can_evict,
+                                std::optional<PageKey> incoming) override;
+  std::string describeState() const override;
+
+ private:
+  std::optional<int> firstEvictable(const FrameList& list,
+                                    const CanEvict& can_evict) const;
+
+  size_t a1in_target_;
+  size_t a1out_capacity_;
+  mutable std::mutex mutex_;
+  std::vector<PageKey> keys_;
+  FrameList a1in_;
+  FrameList am_;
+  GhostList a1out_;
+};
@@ -1,22 +1,88 @@
 #include "file.h"
 
+#include <fcntl.h>
 #include <spdlog/spdlog.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
 #include <filesystem>
-#include <fstream>
-#include <limits>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <system_error>
 #include <unordered_map>
+#include <vector>
 
 #include "logging.h"
 #include "storage/page/page.h"
+#include "util.h"
+
+namespace {
+
+// pread/pwrite may transfer fewer bytes than asked or be interrupted; loop
+// until the whole range is done. Returns false on end of file.
+bool readFully(int fd, char* buffer, size_t size, off_t offset) {
+  while (size > 0) {
+    const ssize_t result = ::pread(fd, buffer, size, offset);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    if (result == 0) {
+      errno = 0;
+      return false;
+    }
+    buffer += result;
+    size -= static_cast<size_t>(result);
+    offset += result;
+  }
+  return true;
+}
+
+bool writeFully(int fd, const char* buffer, size_t size, off_t offset) {
+  while (size > 0) {
+    const ssize_t result = ::pwrite(fd, buffer, size, offset);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return false;
+    }
+    buffer += result;
+    size -= static_cast<size_t>(result);
+    offset += result;
+  }
+  return true;
+}
+
+// Segment 0 is the path itself, segment k the path with suffix ".k".
+std::string segmentPathOf(const std::string& file_path, size_t segment) {
+  return segment == 0 ? file_path
+                      : file_path + "." + std::to_string(segment);
+}
+
+// Pages per segment for new relations: DBFS_SEGMENT_SIZE_MB, 1 to 65536.
+PageId pagesPerSegmentFromEnv() {
+  const std::uint64_t mb = std::clamp<std::uint64_t>(
+      dbfs_util::unsignedFromEnv("DBFS_SEGMENT_SIZE_MB", 1024), 1, 65536);
+  return mb * (1 << 20) / Page::PAGE_SIZE_BYTE;
+}
+
+}  // namespace
 
 std::unordered_map<std::string, std::weak_ptr<File::SharedState>>
     File::state_cache_;
+std::unordered_map<std::string, std::uint32_t> File::file_ids_;
+std::vector<std::uint32_t> File::free_file_ids_;
+std::mutex File::state_cache_mutex_;
 
 void File::invalidateCache(const std::string& file_path) {
+  std::lock_guard<std::mutex> lock(state_cache_mutex_);
   auto cached = state_cache_.find(file_path);
   if (cached == state_cache_.end()) {
     return;
@@ -31,70 +97,151 @@ void File::invalidateCache(const std::string& file_path) {
   state_cache_.erase(cached);
 }
 
-bool File::isPageIDUsed(uint16_t page_id) const {
+void File::remove(const std::string& file_path) {
+  invalidateCache(file_path);
+  for (size_t segment = 0; segment < MAX_SEGMENT_COUNT; ++segment) {
+    const std::string path = segmentPathOf(file_path, segment);
+    std::error_code error;
+    const bool removed = std::filesystem::remove(path, error);
+    if (error) {
+      throw std::runtime_error("failed to remove file: " + path + ": " +
+                               error.message());
+    }
+    if (!removed && segment > 0) {
+      break;
+    }
+  }
+}
+
+bool File::isPageIDUsed(PageId page_id) const {
   return page_id <= state_->max_page_id;
 }
 
-uint16_t File::allocateNextPageId() {
-  if (state_->max_page_id == std::numeric_limits<uint16_t>::max()) {
-    throw std::overflow_error("page ID overflow");
-  }
-  state_->max_page_id += 1;
+PageId File::allocateNextPageId() {
+  const PageId page_limit = state_->pages_per_segment * MAX_SEGMENT_COUNT;
+  PageId current = state_->max_page_id.load();
+  do {
+    if (current + 1 >= page_limit) {
+      throw std::overflow_error("page ID overflow");
+    }
+  } while (!state_->max_page_id.compare_exchange_weak(current, current + 1));
   state_->header_dirty = true;
-  return state_->max_page_id;
+  return current + 1;
 }
 
 void File::writeHeader() {
-  initializeStreamIfClosed();
+  const int fd = openSegmentLocked(0, true);
 
   char buffer[File::HEADDER_SIZE_BYTE];
   std::memset(buffer, 0, sizeof(buffer));
 
-  std::memcpy(buffer, &state_->max_page_id, sizeof(uint16_t));
-  std::memcpy(buffer + File::MAX_PAGE_ID_SIZE_BYTE, &state_->root_page_id,
-              sizeof(uint16_t));
-
-  state_->stream->seekp(0, std::ios::beg);
-  if (!*state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to seek file when writing header: " +
-                             file_path_);
-  }
-
-  state_->stream->write(buffer, sizeof(buffer));
-  if (!*state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to write header: " + file_path_);
+  const PageId max_page_id = state_->max_page_id.load();
+  const PageId root_page_id = state_->root_page_id.load();
+  std::memcpy(buffer + File::MAX_PAGE_ID_OFFSET, &max_page_id, sizeof(PageId));
+  std::memcpy(buffer + File::ROOT_PAGE_ID_OFFSET, &root_page_id,
+              sizeof(PageId));
+  std::memcpy(buffer + File::PAGES_PER_SEGMENT_OFFSET,
+              &state_->pages_per_segment, sizeof(PageId));
+
+  if (!writeFully(fd, buffer, sizeof(buffer), 0)) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to write header: " + file_path_);
   }
   dbfs_log::storage().debug(
       "Wrote header for file {}: max_page_id {}, root_page_id {}", file_path_,
-      state_->max_page_id, state_->root_page_id);
+      max_page_id, root_page_id);
 
-  state_->stream->clear();
   state_->header_dirty = false;
 }
 
+std::string File::segmentPath(size_t segment) const {
+  return segmentPathOf(file_path_, segment);
+}
+
+int File::segmentDescriptor(size_t segment, bool create) {
+  const int fd = state_->segment_fds[segment].load(std::memory_order_acquire);
+  if (fd != -1) {
+    return fd;
+  }
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  return openSegmentLocked(segment, create);
+}
+
 /**
- * Ensures `stream_` refers to an open stream for `file_path_`.
+ * Opens a segment of `file_path_` if it is not open yet. The caller holds
+ * `state_->mutex`. Creating a segment first brings the one before it to full
+ * size, durably, so that only the last segment can be short even after a
+ * crash.
  */
-void File::initializeStreamIfClosed() {
+int File::openSegmentLocked(size_t segment, bool create) {
   if (!state_) {
     throw std::runtime_error("file state is not initialized: " + file_path_);
   }
 
-  if (state_->stream && state_->stream->is_open()) {
-    return;
+  int fd = state_->segment_fds[segment].load(std::memory_order_acquire);
+  if (fd != -1) {
+    return fd;
+  }
+
+  if (create && segment > 0) {
+    const int previous_fd = openSegmentLocked(segment - 1, true);
+    const off_t segment_size =
+        static_cast<off_t>(File::HEADDER_SIZE_BYTE) +
+        static_cast<off_t>(state_->pages_per_segment * Page::PAGE_SIZE_BYTE);
+    struct stat previous_stat {};
+    if (::fstat(previous_fd, &previous_stat) != 0 ||
+        (previous_stat.st_size < segment_size &&
+         (::ftruncate(previous_fd, segment_size) != 0 ||
+          ::fsync(previous_fd) != 0))) {
+      throw std::system_error(errno, std::generic_category(),
+                              "failed to extend segment: " +
+                                  segmentPath(segment - 1));
+    }
   }
 
-  state_->stream.reset();
+  const std::string path = segmentPath(segment);
+  fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC | (create ? O_CREAT : 0),
+              0644);
+  if (fd == -1) {
+    if (!create && errno == ENOENT) {
+      return -1;
+    }
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to open file: " + path);
+  }
+  state_->segment_fds[segment].store(fd, std::memory_order_release);
+  state_->opened_segment_count =
+      std::max(state_->opened_segment_count, segment + 1);
+  return fd;
+}
 
-  auto new_stream = std::make_shared<std::fstream>(
-      file_path_, std::ios::in | std::ios::out | std::ios::binary);
-  if (!*new_stream) {
-    throw std::runtime_error("failed to open file: " + file_path_);
+File::PageLocation File::locatePage(PageId page_id, bool for_write) {
+  const PageId pages_per_segment = state_->pages_per_segment;
+  const PageId segment = page_id / pages_per_segment;
+  if (segment >= MAX_SEGMENT_COUNT) {
+    throw std::out_of_range("page ID " + std::to_string(page_id) +
+                            " is past the last segment of " + file_path_);
   }
+  return PageLocation{
+      segmentDescriptor(static_cast<size_t>(segment), for_write),
+      static_cast<off_t>(File::HEADDER_SIZE_BYTE) +
+          static_cast<off_t>((page_id % pages_per_segment) *
+                             Page::PAGE_SIZE_BYTE)};
+}
 
-  state_->stream = new_stream;
+void File::sync() {
+  std::lock_guard<std::mutex> lock(state_->mutex);
+  if (state_->header_dirty) {
+    writeHeader();
+  }
+  for (size_t segment = 0; segment < state_->opened_segment_count;
+       ++segment) {
+    const int fd = state_->segment_fds[segment].load();
+    if (fd != -1 && ::fsync(fd) != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "failed to fsync file: " + segmentPath(segment));
+    }
+  }
 }
 
 void File::close() {
@@ -102,6 +249,8 @@ void File::close() {
     return;
   }
 
+  std::lock_guard<std::mutex> cache_lock(state_cache_mutex_);
+  std::lock_guard<std::mutex> lock(state_->mutex);
   if (state_->header_dirty) {
     try {
       writeHeader();
@@ -109,12 +258,12 @@ void File::close() {
       dbfs_log::storage().error(
           "failed to write header for file {} during close: {}", file_path_,
           ex.what());
-      // fall through and still attempt to close the stream
+      // fall through and still attempt to close the descriptor
     } catch (...) {
       dbfs_log::storage().error(
           "failed to write header for file {} during close: unknown error",
           file_path_);
-      // fall through and still attempt to close the stream
+      // fall through and still attempt to close the descriptor
     }
   }
 
@@ -122,18 +271,18 @@ void File::close() {
     return;
   }
 
-  if (!state_->stream) {
-    state_cache_.erase(file_path_);
-    return;
+  bool close_failed = false;
+  for (size_t segment = 0; segment < state_->opened_segment_count;
+       ++segment) {
+    const int fd = state_->segment_fds[segment].exchange(-1);
+    if (fd != -1 && ::close(fd) != 0) {
+      close_failed = true;
+    }
   }
-
-  state_->stream->clear();
-  state_->stream->flush();
-  state_->stream->close();
-
-  if (state_->stream->fail()) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to close file: " + file_path_);
+  state_->opened_segment_count = 0;
+  if (close_failed) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to close file: " + file_path_);
   }
 
   auto cached = state_cache_.find(file_path_);
@@ -143,8 +292,6 @@ void File::close() {
       state_cache_.erase(cached);
     }
   }
-
-  state_->stream.reset();
 }
 
 File::~File() {
@@ -159,7 +306,69 @@ File::~File() {
   }
 }
 
-File::File(const std::string& file_path) : file_path_(file_path) {
+File::File(const std::string& file_path) : File(file_path, true) {}
+
+std::unique_ptr<File> File::openIfExists(const std::string& file_path) {
+  std::unique_ptr<File> file(new File(file_path, false));
+  if (!file->state_) {
+    return nullptr;
+  }
+  return file;
+}
+
+std::uint32_t File::fileIdLocked(const std::string& file_path) {
+  const auto assigned = file_ids_.find(file_path);
+  if (assigned != file_ids_.end()) {
+    return assigned->second;
+  }
+  std::uint32_t file_id;
+  if (!free_file_ids_.empty()) {
+    file_id = free_file_ids_.back();
+    free_file_ids_.pop_back();
+  } else {
+    // Ids start at 1; every id handed out so far is assigned or free.
+    file_id = static_cast<std::uint32_t>(file_ids_.size() +
+                                         free_file_ids_.size() + 1);
+    if (file_id > MAX_FILE_ID) {
+      throw std::overflow_error("file ID overflow: " + file_path);
+    }
+  }
+  file_ids_.emplace(file_path, file_id);
+  return file_id;
+}
+
+void File::releaseFileId(const std::string& file_path) {
+  std::lock_guard<std::mutex> lock(state_cache_mutex_);
+  const auto cached = state_cache_.find(file_path);
+  if (cached != state_cache_.end() && cached->second.lock()) {
+    throw std::logic_error("cannot release file ID while file is open: " +
+                           file_path);
+  }
+  const auto assigned = file_ids_.find(file_path);
+  if (assigned == file_ids_.end()) {
+    return;
+  }
+  free_file_ids_.push_back(assigned->second);
+  file_ids_.erase(assigned);
+}
+
+std::optional<std::uint32_t> File::fileIdOf(const std::string& file_path) {
+  std::lock_guard<std::mutex> lock(state_cache_mutex_);
+  const auto it = file_ids_.find(file_path);
+  if (it == file_ids_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+File::File(const std::string& file_path, bool create)
+    : file_path_(file_path) {
+  std::lock_guard<std::mutex> cache_lock(state_cache_mutex_);
+  // A path that is not opened gets no id.
+  if (!create && !std::filesystem::exists(file_path_)) {
+    return;
+  }
+  file_id_ = fileIdLocked(file_path_);
   const auto cached = state_cache_.find(file_path_);
   if (cached != state_cache_.end()) {
     auto existing = cached->second.lock();
@@ -178,33 +387,54 @@ File::File(const std::string& file_path) : file_path_(file_path) {
       is_new_file);
 
   if (!is_new_file) {
-    initializeStreamIfClosed();
+    const int fd = openSegmentLocked(0, false);
 
     // update max_page_id_ by reading the file header if the file already
-    // exists.
-    state_->stream->seekg(0, std::ios::beg);
+    // exists. A file shorter than the header reads as zeros.
     std::unique_ptr<char[]> header_buffer =
         std::make_unique<char[]>(File::HEADDER_SIZE_BYTE);
-    state_->stream->read(header_buffer.get(), File::HEADDER_SIZE_BYTE);
-    state_->max_page_id = readValue<uint16_t>(header_buffer.get());
+    std::memset(header_buffer.get(), 0, File::HEADDER_SIZE_BYTE);
+    const ssize_t header_bytes =
+        ::pread(fd, header_buffer.get(), File::HEADDER_SIZE_BYTE, 0);
+    if (header_bytes < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "failed to read header: " + file_path_);
+    }
+    state_->max_page_id =
+        readValue<PageId>(header_buffer.get() + File::MAX_PAGE_ID_OFFSET);
     state_->root_page_id =
-        readValue<uint16_t>(header_buffer.get() + File::MAX_PAGE_ID_SIZE_BYTE);
+        readValue<PageId>(header_buffer.get() + File::ROOT_PAGE_ID_OFFSET);
+    state_->pages_per_segment = readValue<PageId>(
+        header_buffer.get() + File::PAGES_PER_SEGMENT_OFFSET);
+    if (state_->pages_per_segment == 0) {
+      state_->pages_per_segment = pagesPerSegmentFromEnv();
+    }
     dbfs_log::storage().debug(
         "opened existing file: {}, max_page_id loaded from header: {}, "
-        "root_page_id loaded from header: {}",
-        file_path_, state_->max_page_id, state_->root_page_id);
+        "root_page_id loaded from header: {}, pages per segment: {}",
+        file_path_, state_->max_page_id.load(), state_->root_page_id.load(),
+        state_->pages_per_segment);
   } else {
-    std::ofstream creator(file_path_, std::ios::binary | std::ios::trunc);
-    if (!creator) {
-      throw std::runtime_error("failed to create file: " + file_path_);
+    const int fd = ::open(file_path_.c_str(),
+                          O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+      throw std::system_error(errno, std::generic_category(),
+                              "failed to create file: " + file_path_);
     }
     dbfs_log::storage().debug("created new file: {}", file_path_);
-    creator.close();
-
-    initializeStreamIfClosed();
+    state_->segment_fds[0].store(fd, std::memory_order_release);
+    state_->opened_segment_count = 1;
+    // Segments left over from an earlier file at this path would otherwise
+    // be reused as they are.
+    for (size_t segment = 1; segment < MAX_SEGMENT_COUNT; ++segment) {
+      if (!std::filesystem::remove(segmentPath(segment))) {
+        break;
+      }
+    }
     // For a new file, header has not been written yet.
     state_->max_page_id = 0;
     state_->root_page_id = 0;
+    state_->pages_per_segment = pagesPerSegmentFromEnv();
     state_->header_dirty = true;
   }
 
@@ -212,44 +442,46 @@ File::File(const std::string& file_path) : file_path_(file_path) {
 }
 
 // this method should be called only from buffer pool in prod.
-void File::writePageFromBuffer(uint16_t const page_id, char* buffer) {
-  initializeStreamIfClosed();
-
-  const std::streamoff offset =
-      static_cast<std::streamoff>(File::HEADDER_SIZE_BYTE) +
-      static_cast<std::streamoff>(page_id) * Page::PAGE_SIZE_BYTE;
-  state_->stream->seekp(offset, std::ios::beg);
-  if (!state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to seek file: " + file_path_);
+void File::writePageFromBuffer(PageId const page_id, char* buffer) {
+  const PageLocation location = locatePage(page_id, true);
+  if (!writeFully(location.fd, buffer, Page::PAGE_SIZE_BYTE,
+                  location.offset)) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to write page: " + file_path_);
   }
-
-  state_->stream->write(buffer, Page::PAGE_SIZE_BYTE);
-  if (!state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to write page: " + file_path_);
-  }
-
-  state_->stream->clear();
 }
 
-void File::readPageIntoBuffer(uint16_t const page_id, char* buffer) {
-  initializeStreamIfClosed();
-
-  const std::streamoff offset =
-      static_cast<std::streamoff>(File::HEADDER_SIZE_BYTE) +
-      static_cast<std::streamoff>(page_id) * Page::PAGE_SIZE_BYTE;
-  state_->stream->seekg(offset, std::ios::beg);
-  if (!state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to seek file: " + file_path_);
+size_t File::pageCountOnDisk() {
+  // Every segment but the last is full, so only the last one needs a size.
+  size_t last_segment = 0;
+  while (last_segment + 1 < MAX_SEGMENT_COUNT &&
+         std::filesystem::exists(segmentPath(last_segment + 1))) {
+    ++last_segment;
   }
-
-  state_->stream->read(buffer, Page::PAGE_SIZE_BYTE);
-  if (!state_->stream) {
-    state_->stream->clear();
-    throw std::runtime_error("failed to read page: " + file_path_);
+  struct stat file_stat {};
+  if (::fstat(segmentDescriptor(last_segment, false), &file_stat) != 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to determine file size: " +
+                                segmentPath(last_segment));
   }
+  const size_t file_size = static_cast<size_t>(file_stat.st_size);
+  const size_t earlier_pages = last_segment * state_->pages_per_segment;
+  if (file_size <= File::HEADDER_SIZE_BYTE) {
+    return earlier_pages;
+  }
+  return earlier_pages +
+         (file_size - File::HEADDER_SIZE_BYTE) / Page::PAGE_SIZE_BYTE;
+}
 
-  state_->stream->clear();
-}
\ No newline at end of file
+void File::readPageIntoBuffer(PageId const page_id, char* buffer) {
+  const PageLocation location = locatePage(page_id, false);
+  if (location.fd == -1 ||
+      !readFully(location.fd, buffer, Page::PAGE_SIZE_BYTE, location.offset)) {
+    if (location.fd == -1 || errno == 0) {
+      throw std::runtime_error("failed to read page: " + file_path_ +
+                               " (past end of file)");
+    }
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to read page: " + file_path_);
+  }
+}
@@ -1,50 +1,138 @@
 #pragma once
 #include <spdlog/spdlog.h>
+#include <sys/types.h>
 
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <fstream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include "storage/page/page_id.h"
 /**
  * The same file can be accessed by multiple buffer pool frames, so we can cache
- * the file stream in memory to avoid opening the same file multiple times. File
- * class should not own memory, it just provides utility functions to read/write
- * pages from/to the buffer pool.
+ * the file descriptor in memory to avoid opening the same file multiple times.
+ * File class should not own memory, it just provides utility functions to
+ * read/write pages from/to the buffer pool.
+ *
+ * File objects for the same path may be used from several threads at once.
+ * Pages are read and written with pread/pwrite at their own offsets, so there
+ * is no shared seek position and page I/O on one file does not serialize. The
+ * header fields are atomics, so page-id allocation runs concurrently as well.
+ *
+ * A relation is stored as a chain of segment files of pagesPerSegment()
+ * pages each: the path itself, then path.1, path.2 and so on. Every segment
+ * starts with a HEADDER_SIZE_BYTE area, which holds the file header in the
+ * first one and is unused in the others. Segments are created when a page in
+ * them is first written; all but the last one are kept at full size, so a
+ * page that was never written reads as zeros, as a hole would in one file.
+ * The segment size is fixed when the relation is created, from
+ * DBFS_SEGMENT_SIZE_MB (default 1024), and recorded in the header.
  */
 class File {
  private:
+  static constexpr size_t MAX_SEGMENT_COUNT = 4096;
   struct SharedState {
-    std::shared_ptr<std::fstream> stream;
-    uint16_t max_page_id = 0;
-    uint16_t root_page_id = 0;
-    bool header_dirty = false;
+    SharedState() {
+      for (auto& fd : segment_fds) {
+        fd.store(-1, std::memory_order_relaxed);
+      }
+    }
+    // Guards opening and closing segments and header writes.
+    std::mutex mutex;
+    // Per segment, its descriptor once opened, -1 before.
+    std::array<std::atomic<int>, MAX_SEGMENT_COUNT> segment_fds;
+    // Segments below this may be open; guarded by mutex.
+    size_t opened_segment_count = 0;
+    std::atomic<PageId> max_page_id{0};
+    std::atomic<PageId> root_page_id{0};
+    // Fixed once the header is read or created.
+    PageId pages_per_segment = 0;
+    std::atomic<bool> header_dirty{false};
   };
 
   static std::unordered_map<std::string, std::weak_ptr<SharedState>>
       state_cache_;
+  // Path -> compact id, assigned the first time a path is opened and kept
+  // until releaseFileId() so ids stay stable across close/reopen.
+  static std::unordered_map<std::string, std::uint32_t> file_ids_;
+  // Released ids, handed out again before new ones.
+  static std::vector<std::uint32_t> free_file_ids_;
+  // Guards state_cache_, file_ids_ and free_file_ids_.
+  static std::mutex state_cache_mutex_;
 
   std::shared_ptr<SharedState> state_;
   std::string file_path_;
+  std::uint32_t file_id_ = 0;
   void writeHeader();
+  std::string segmentPath(size_t segment) const;
+  // Descriptor of a segment, opening it on first use. With create, the
+  // segment and those before it are created as needed; without, -1 if it
+  // does not exist.
+  int segmentDescriptor(size_t segment, bool create);
+  int openSegmentLocked(size_t segment, bool create);
+  // Id of a path, assigning one if it has none; state_cache_mutex_ held.
+  static std::uint32_t fileIdLocked(const std::string& file_path);
+  // Without create, a missing file is left alone and state_ stays empty.
+  File(const std::string& file_path, bool create);
 
  public:
   static constexpr size_t HEADDER_SIZE_BYTE = 256;
-  static constexpr size_t MAX_PAGE_ID_SIZE_BYTE = 2;
+  // Header fields, each 8 bytes.
+  static constexpr size_t MAX_PAGE_ID_OFFSET = 0;
+  static constexpr size_t ROOT_PAGE_ID_OFFSET = 8;
+  static constexpr size_t PAGES_PER_SEGMENT_OFFSET = 16;
+  static constexpr std::uint32_t MAX_FILE_ID = 0xFFFF;
   static void invalidateCache(const std::string& file_path);
-  uint16_t allocateNextPageId();
-  bool isPageIDUsed(uint16_t page_id) const;
+  // Deletes the file and all of its segments. No File may be open on it.
+  static void remove(const std::string& file_path);
+  PageId allocateNextPageId();
+  bool isPageIDUsed(PageId page_id) const;
   File(const std::string& file_path);
+  // Opens the file only if it exists, unlike the constructor, which creates
+  // it; nullptr otherwise.
+  static std::unique_ptr<File> openIfExists(const std::string& file_path);
+  // Id given to the path when it was first opened in this process, if any.
+  static std::optional<std::uint32_t> fileIdOf(const std::string& file_path);
+  /**
+   * Frees the id of a deleted path for reuse by other paths. Nothing may
+   * refer to the old id any more: no File is open on the path and the buffer
+   * pool holds none of its pages (see BufferPool::discardFile).
+   */
+  static void releaseFileId(const std::string& file_path);
   ~File();
-  void initializeStreamIfClosed();
   void close();
-  void readPageIntoBuffer(uint16_t const page_id, char* buffer);
-  void writePageFromBuffer(uint16_t const page_id, char* buffer);
-  std::string getFilePath() const { return file_path_; }
-  uint16_t getMaxPageID() const { return state_->max_page_id; }
-  uint16_t getRootPageID() const { return state_->root_page_id; }
-  void setRootPageID(uint16_t root_page_id) {
+  // Writes the header if it changed and fsyncs every segment opened so far,
+  // so that pages written so far survive a crash. Checkpoints call this.
+  void sync();
+  void readPageIntoBuffer(PageId const page_id, char* buffer);
+  // Where a page lives on disk: its segment's descriptor, shared by every
+  // File for this path, and its byte offset there. For callers that batch
+  // page I/O through an IOEngine; the descriptor is valid until the last File
+  // closes. Locating a page for writing creates its segment; for reading, fd
+  // is -1 when the segment does not exist.
+  struct PageLocation {
+    int fd;
+    off_t offset;
+  };
+  PageLocation locatePage(PageId page_id, bool for_write);
+  void writePageFromBuffer(PageId const page_id, char* buffer);
+  // Number of whole pages currently in the file, which after a crash can be
+  // fewer or more than the header's max_page_id + 1.
+  size_t pageCountOnDisk();
+  const std::string& getFilePath() const { return file_path_; }
+  // Process-local id of this path; the buffer pool keys frames by it, in
+  // 16 bits.
+  std::uint32_t getFileId() const { return file_id_; }
+  PageId pagesPerSegment() const { return state_->pages_per_segment; }
+  PageId getMaxPageID() const { return state_->max_page_id; }
+  PageId getRootPageID() const { return state_->root_page_id; }
+  void setRootPageID(PageId root_page_id) {
     state_->root_page_id = root_page_id;
     state_->header_dirty = true;
   };
@@ -0,0 +1,181 @@
+#include "storage/disk/free_space_map.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+std::unordered_map<std::string, std::shared_ptr<FreeSpaceMap>>
+    FreeSpaceMap::maps_;
+std::mutex FreeSpaceMap::maps_mutex_;
+
+std::string FreeSpaceMap::pathFor(const std::string& heap_path) {
+  return heap_path + ".fsm";
+}
+
+std::shared_ptr<FreeSpaceMap> FreeSpaceMap::forHeap(
+    const std::string& heap_path) {
+  std::lock_guard<std::mutex> lock(maps_mutex_);
+  auto& map = maps_[heap_path];
+  if (!map) {
+    map.reset(new FreeSpaceMap(pathFor(heap_path)));
+    map->load();
+  }
+  return map;
+}
+
+void FreeSpaceMap::remove(const std::string& heap_path) {
+  std::lock_guard<std::mutex> lock(maps_mutex_);
+  maps_.erase(heap_path);
+  std::error_code error;
+  std::filesystem::remove(pathFor(heap_path), error);
+  if (error) {
+    throw std::runtime_error("failed to remove free-space map: " +
+                             pathFor(heap_path) + ": " + error.message());
+  }
+}
+
+FreeSpaceMap::FreeSpaceMap(std::string path) : path_(std::move(path)) {}
+
+void FreeSpaceMap::load() {
+  std::ifstream input(path_, std::ios::binary);
+  if (!input.is_open()) {
+    return;
+  }
+  categories_.assign(std::istreambuf_iterator<char>(input),
+                     std::istreambuf_iterator<char>());
+  for (PageId page_id = 0; page_id < categories_.size(); ++page_id) {
+    std::uint8_t& category = categories_[page_id];
+    if (category >= CATEGORY_COUNT) {
+      category = 0;
+    } else if (category > 0) {
+      candidates_[category].push_back(page_id);
+    }
+  }
+}
+
+void FreeSpaceMap::update(PageId page_id, size_t free_bytes) {
+  const auto category = static_cast<std::uint8_t>(
+      std::min(free_bytes / CATEGORY_BYTES, CATEGORY_COUNT - 1));
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (page_id >= categories_.size()) {
+    if (category == 0) {
+      return;
+    }
+    categories_.resize(page_id + 1, 0);
+  }
+  if (categories_[page_id] == category) {
+    return;
+  }
+  categories_[page_id] = category;
+  dirty_ = true;
+  if (category == 0) {
+    return;
+  }
+  std::vector<PageId>& candidates = candidates_[category];
+  candidates.push_back(page_id);
+  if (candidates.size() > 2 * categories_.size() + 64) {
+    rebuildCandidates(category);
+  }
+}
+
+std::optional<PageId> FreeSpaceMap::findPage(size_t needed_bytes) {
+  const size_t needed_category =
+      std::max<size_t>(1, (needed_bytes + CATEGORY_BYTES - 1) / CATEGORY_BYTES);
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (size_t category = needed_category; category < CATEGORY_COUNT;
+       ++category) {
+    std::vector<PageId>& candidates = candidates_[category];
+    while (!candidates.empty()) {
+      const PageId page_id = candidates.back();
+      if (categories_[page_id] == category) {
+        return page_id;
+      }
+      candidates.pop_back();
+    }
+  }
+  return std::nullopt;
+}
+
+void FreeSpaceMap::clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  categories_.clear();
+  for (auto& candidates : candidates_) {
+    candidates.clear();
+  }
+  vacuum_queue_.clear();
+  vacuum_queued_.clear();
+  dirty_ = true;
+}
+
+void FreeSpaceMap::save() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!dirty_) {
+    return;
+  }
+  // Written aside and renamed, so a crash leaves the old map or the new one.
+  const std::string temp_path = path_ + ".tmp";
+  {
+    std::ofstream output(temp_path, std::ios::binary | std::ios::trunc);
+    output.write(reinterpret_cast<const char*>(categories_.data()),
+                 static_cast<std::streamsize>(categories_.size()));
+    if (!output.good()) {
+      throw std::runtime_error("failed to write free-space map: " +
+                               temp_path);
+    }
+  }
+  std::filesystem::rename(temp_path, path_);
+  dirty_ = false;
+}
+
+std::uint8_t FreeSpaceMap::categoryOf(PageId page_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return page_id < categories_.size() ? categories_[page_id] : 0;
+}
+
+void FreeSpaceMap::addVacuumCandidate(PageId page_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (page_id >= vacuum_queued_.size()) {
+    vacuum_queued_.resize(page_id + 1, false);
+  }
+  if (vacuum_queued_[page_id]) {
+    return;
+  }
+  vacuum_queued_[page_id] = true;
+  vacuum_queue_.push_back(page_id);
+}
+
+std::vector<PageId> FreeSpaceMap::takeVacuumCandidates(size_t max_pages) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<PageId> pages;
+  while (pages.size() < max_pages && !vacuum_queue_.empty()) {
+    const PageId page_id = vacuum_queue_.front();
+    vacuum_queue_.pop_front();
+    vacuum_queued_[page_id] = false;
+    pages.push_back(page_id);
+  }
+  return pages;
+}
+
+bool FreeSpaceMap::anyVacuumCandidates() {
+  std::lock_guard<std::mutex> maps_lock(maps_mutex_);
+  for (const auto& [heap_path, map] : maps_) {
+    std::lock_guard<std::mutex> lock(map->mutex_);
+    if (!map->vacuum_queue_.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FreeSpaceMap::rebuildCandidates(std::uint8_t category) {
+  std::vector<PageId>& candidates = candidates_[category];
+  candidates.clear();
+  for (PageId page_id = 0; page_id < categories_.size(); ++page_id) {
+    if (categories_[page_id] == category) {
+      candidates.push_back(page_id);
+    }
+  }
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/page/page_id.h"
+
+/**
+ * Free-space map of a heap file: for every page, a coarse bucket of how many
+ * bytes an insert can still use there, so inserts find a page with room in
+ * constant time instead of only trying the last page.
+ *
+ * A page's category is its free bytes divided by CATEGORY_BYTES, rounded
+ * down and capped at CATEGORY_COUNT - 1. Per category, a stack holds the
+ * pages that entered it; findPage() pops entries whose page has since moved
+ * to another category, and rebuilds a stack that grew far past the page
+ * count. Stacks put the page freed last on top, whose page is most likely
+ * still in the buffer pool.
+ *
+ * The map is only a hint. HeapFile updates it after every insert, delete and
+ * redo, and an insert that does not fit on the page it was given corrects
+ * the entry and asks again. One map per heap path is shared by all HeapFiles
+ * for the life of the process; it is saved to the heap path plus ".fsm" at
+ * checkpoints and loaded on first use, pages past its end counting as full.
+ *
+ * It also queues the pages a delete left dead cells on, for the vacuum to
+ * compact. The queue is not saved: pages still queued at a crash are only
+ * compacted by the inserts that need their space.
+ */
+class FreeSpaceMap {
+ public:
+  static constexpr size_t CATEGORY_COUNT = 16;
+  static constexpr size_t CATEGORY_BYTES = 256;
+
+  static std::string pathFor(const std::string& heap_path);
+  // The map of the heap at heap_path, loaded from its file on first use.
+  static std::shared_ptr<FreeSpaceMap> forHeap(const std::string& heap_path);
+  // Forgets the heap's map and deletes its file, for a dropped heap.
+  static void remove(const std::string& heap_path);
+
+  // Records that page_id has free_bytes free.
+  void update(PageId page_id, size_t free_bytes);
+  /**
+   * A page that had at least needed_bytes free when it was last updated,
+   * from the smallest category that guarantees it. nullopt if there is none,
+   * or if needed_bytes is more than the top category guarantees.
+   */
+  std::optional<PageId> findPage(size_t needed_bytes);
+  // Forgets every page, for a heap file that was created anew.
+  void clear();
+  // Writes the map to its file if it changed since it was loaded or saved.
+  void save();
+
+  std::uint8_t categoryOf(PageId page_id);
+
+  // Queues page_id for the vacuum unless it is queued already.
+  void addVacuumCandidate(PageId page_id);
+  // Dequeues up to max_pages pages for the vacuum, oldest first.
+  std::vector<PageId> takeVacuumCandidates(size_t max_pages);
+  // Whether any heap's map has pages queued for the vacuum.
+  static bool anyVacuumCandidates();
+
+ private:
+  explicit FreeSpaceMap(std::string path);
+  void load();
+  void rebuildCandidates(std::uint8_t category);
+
+  static std::unordered_map<std::string, std::shared_ptr<FreeSpaceMap>>
+      maps_;
+  static std::mutex maps_mutex_;
+
+  std::mutex mutex_;
+  std::string path_;
+  // Per page, its category.
+  std::vector<std::uint8_t> categories_;
+  // Per category above 0, pages that entered it, most recent last. Entries
+  // whose page left the category are dropped lazily.
+  std::array<std::vector<PageId>, CATEGORY_COUNT> candidates_;
+  bool dirty_ = false;
+  std::deque<PageId> vacuum_queue_;
+  // Per page, whether it is in vacuum_queue_.
+  std::vector<bool> vacuum_queued_;
+};
@@ -0,0 +1,75 @@
+#include "io_engine.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "io_uring_io_engine.h"
+#include "logging.h"
+#include "thread_pool_io_engine.h"
+#include "util.h"
+
+void completeBlocking(IORequest& request) {
+  size_t done = request.result > 0 ? static_cast<size_t>(request.result) : 0;
+  while (done < request.length) {
+    const ssize_t result =
+        request.op == IORequest::Op::Read
+            ? ::pread(request.fd, request.buffer + done, request.length - done,
+                      request.offset + static_cast<off_t>(done))
+            : ::pwrite(request.fd, request.buffer + done,
+                       request.length - done,
+                       request.offset + static_cast<off_t>(done));
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      request.result = -errno;
+      return;
+    }
+    if (result == 0) {
+      break;
+    }
+    done += static_cast<size_t>(result);
+  }
+  request.result = static_cast<long>(done);
+}
+
+IOEngineKind ioEngineKindFromString(const std::string& name) {
+  const std::string lowered = dbfs_util::toLower(name);
+  if (lowered == "auto") {
+    return IOEngineKind::Auto;
+  }
+  if (lowered == "io_uring" || lowered == "iouring") {
+    return IOEngineKind::IOUring;
+  }
+  if (lowered == "threads") {
+    return IOEngineKind::ThreadPool;
+  }
+  throw std::invalid_argument(fmt::format(
+      "Unknown I/O engine '{}' (expected auto, io_uring or threads)", name));
+}
+
+std::unique_ptr<IOEngine> makeIOEngine(IOEngineKind kind,
+                                       size_t thread_count) {
+  switch (kind) {
+    case IOEngineKind::Auto:
+    case IOEngineKind::IOUring: {
+      auto engine = IOUringIOEngine::tryCreate();
+      if (engine) {
+        return engine;
+      }
+      if (kind == IOEngineKind::IOUring) {
+        throw std::runtime_error("io_uring is not available on this system");
+      }
+      dbfs_log::storage().info(
+          "io_uring is not available; using the thread pool I/O engine");
+      return std::make_unique<ThreadPoolIOEngine>(thread_count);
+    }
+    case IOEngineKind::ThreadPool:
+      return std::make_unique<ThreadPoolIOEngine>(thread_count);
+  }
+  throw std::invalid_argument("Unknown I/O engine kind");
+}
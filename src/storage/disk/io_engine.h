@@ -0,0 +1,61 @@
+#pragma once
+#include <sys/types.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class IOEngineKind { Auto, IOUring, ThreadPool };
+
+/**
+ * One positional read or write of a page-sized range. result is set when the
+ * request completes: the number of bytes transferred, or -errno.
+ */
+struct IORequest {
+  enum class Op { Read, Write };
+  Op op;
+  int fd;
+  char* buffer;
+  size_t length;
+  off_t offset;
+  long result = 0;
+
+  bool succeeded() const { return result == static_cast<long>(length); }
+};
+
+/**
+ * Issues a batch of page reads or writes with all of them in flight at once,
+ * so a caller that needs several pages waits for roughly one I/O latency
+ * instead of one per page.
+ *
+ * submitAndWait() blocks the calling thread until every request of the batch
+ * has completed; the buffers are owned by the caller and must stay valid
+ * until then. Engines are safe to use from several threads at once. A failed
+ * request does not affect the others in its batch.
+ */
+class IOEngine {
+ public:
+  virtual ~IOEngine() = default;
+  virtual const char* name() const = 0;
+  virtual void submitAndWait(std::vector<IORequest>& batch) = 0;
+};
+
+/**
+ * Finishes a request with blocking pread/pwrite, continuing after the bytes
+ * it already transferred (a positive result). Stops early at end of file.
+ */
+void completeBlocking(IORequest& request);
+
+/**
+ * Selects the engine from a name as used by DBFS_IO_ENGINE: "auto",
+ * "io_uring" or "threads" (case-insensitive).
+ */
+IOEngineKind ioEngineKindFromString(const std::string& name);
+/**
+ * Auto uses io_uring when the kernel allows it and falls back to the thread
+ * pool otherwise. Asking for io_uring explicitly throws if it is unavailable.
+ * thread_count only applies to the thread pool.
+ */
+std::unique_ptr<IOEngine> makeIOEngine(IOEngineKind kind,
+                                       size_t thread_count = 4);
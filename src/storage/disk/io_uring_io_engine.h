@@ -0,0 +1,52 @@
+#pragma once
+#include <linux/io_uring.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "io_engine.h"
+
+/**
+ * io_uring engine, driven through the raw system calls so that it needs no
+ * library. A batch is placed in the submission ring as a whole and handed to
+ * the kernel with a single io_uring_enter(), which then also waits for the
+ * completions. One ring is shared; concurrent batches take turns on it.
+ */
+class IOUringIOEngine : public IOEngine {
+ public:
+  /**
+   * Returns nullptr if the kernel does not support io_uring or does not let
+   * this process use it (e.g. seccomp or kernel.io_uring_disabled).
+   */
+  static std::unique_ptr<IOUringIOEngine> tryCreate(unsigned entries = 64);
+  ~IOUringIOEngine() override;
+
+  const char* name() const override { return "io_uring"; }
+  void submitAndWait(std::vector<IORequest>& batch) override;
+
+ private:
+  IOUringIOEngine() = default;
+  // Runs requests [first, first + count), count <= sq_entries_.
+  void runChunk(std::vector<IORequest>& batch, size_t first, size_t count);
+
+  int ring_fd_ = -1;
+  unsigned sq_entries_ = 0;
+  void* sq_ring_ = nullptr;
+  size_t sq_ring_bytes_ = 0;
+  void* cq_ring_ = nullptr;
+  size_t cq_ring_bytes_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_bytes_ = 0;
+
+  unsigned* sq_tail_ = nullptr;
+  unsigned* sq_mask_ = nullptr;
+  unsigned* sq_array_ = nullptr;
+  unsigned* cq_head_ = nullptr;
+  unsigned* cq_tail_ = nullptr;
+  unsigned* cq_mask_ = nullptr;
+  io_uring_cqe* cqes_ = nullptr;
+
+  std::mutex ring_mutex_;
+};
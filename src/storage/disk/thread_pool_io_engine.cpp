@@ -0,0 +1,63 @@
+#include "thread_pool_io_engine.h"
+
+#include <algorithm>
+
+ThreadPoolIOEngine::ThreadPoolIOEngine(size_t thread_count) {
+  thread_count = std::max<size_t>(thread_count, 1);
+  workers_.reserve(thread_count);
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers_.emplace_back([this] { runWorker(); });
+  }
+}
+
+ThreadPoolIOEngine::~ThreadPoolIOEngine() {
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    stopping_ = true;
+  }
+  queue_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIOEngine::submitAndWait(std::vector<IORequest>& batch) {
+  if (batch.empty()) {
+    return;
+  }
+  Batch pending;
+  pending.remaining = batch.size();
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    for (auto& request : batch) {
+      queue_.push_back(Task{&request, &pending});
+    }
+  }
+  queue_cv_.notify_all();
+
+  std::unique_lock<std::mutex> lock(pending.mutex);
+  pending.done.wait(lock, [&] { return pending.remaining == 0; });
+}
+
+void ThreadPoolIOEngine::runWorker() {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      queue_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      task = queue_.front();
+      queue_.pop_front();
+    }
+    task.request->result = 0;
+    completeBlocking(*task.request);
+    // Notify under the mutex: the submitter destroys the batch as soon as it
+    // sees remaining == 0.
+    std::lock_guard<std::mutex> lock(task.batch->mutex);
+    if (--task.batch->remaining == 0) {
+      task.batch->done.notify_all();
+    }
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "io_engine.h"
+
+/**
+ * Portable engine: a fixed set of worker threads each runs blocking
+ * pread/pwrite calls, so up to thread_count requests of a batch are in
+ * flight together. Used where io_uring is not available.
+ */
+class ThreadPoolIOEngine : public IOEngine {
+ public:
+  explicit ThreadPoolIOEngine(size_t thread_count);
+  ~ThreadPoolIOEngine() override;
+
+  const char* name() const override { return "threads"; }
+  void submitAndWait(std::vector<IORequest>& batch) override;
+
+ private:
+  struct Batch {
+    std::mutex mutex;
+    std::condition_variable done;
+    size_t remaining = 0;
+  };
+  struct Task {
+    IORequest* request;
+    Batch* batch;
+  };
+
+  void runWorker();
+
+  std::mutex queue_mutex_;
+  std::condition_variable queue_cv_;
+  std::deque<Task> queue_;
+  bool stopping_ = false;
+  std::vector<std::thread> workers_;
+};
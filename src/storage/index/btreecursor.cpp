@@ -9,6 +9,7 @@
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -24,8 +25,8 @@ namespace {
 void dumpIndexPage(const Page& page, std::ostream& os) {
   os << "=== Page " << page.getPageID() << " ("
      << (page.isLeaf() ? "leaf" : "internal") << ") ===\n";
-  os << "parent=" << page.getParentPageID()
-     << " slotCount=" << static_cast<int>(page.slotCount());
+  os << "slotCount=" << static_cast<int>(page.slotCount())
+     << " keyPrefix=" << index_key::formatForDebug(page.keyPrefix());
   if (!page.isLeaf()) {
     os << " rightMostChild="
        << InternalIndexPage(const_cast<Page&>(page)).rightMostChildPageId();
@@ -97,50 +98,118 @@ std::optional<int> insertCellWithCompaction(Page& page, const Cell& cell) {
   return page.insertCell(cell);
 }
 
-}  // namespace
+// Latches the current root page. A root split replaces the root while
+// holding the old root's write latch, so a root id that is unchanged once its
+// page is latched is still the root.
+template <typename Guard>
+Guard latchPage(BufferPool& pool, File& index_file, PageId page_id) {
+  if constexpr (std::is_same_v<Guard, ReadPageGuard>) {
+    return pool.readPage(page_id, index_file);
+  } else {
+    return pool.writePage(page_id, index_file);
+  }
+}
+
+template <typename Guard>
+Guard latchRoot(BufferPool& pool, File& index_file) {
+  while (true) {
+    const PageId root_page_id = index_file.getRootPageID();
+    Guard root = latchPage<Guard>(pool, index_file, root_page_id);
+    if (index_file.getRootPageID() == root_page_id) {
+      return root;
+    }
+  }
+}
 
 /**
- * Traverses the B-tree to find the leaf page that may contain `key`.
- *
- * @param pool Buffer pool used to pin and unpin index pages during traversal.
- * @param indexFile Index file whose root page seeds the traversal.
- * @param key Search key to route through internal nodes.
- * @return Page ID of the leaf page where `key` should reside.
- *
- * As a side effect, each visited page is annotated with its parent page ID for
- * later split handling.
+ * Descends to the leaf that may contain key by latch coupling: each internal
+ * page is read-latched until its child is latched, so the child cannot be
+ * split in between. The leaf is returned latched as LeafGuard. A leaf seen
+ * under a read latch is latched again in write mode while its parent is still
+ * held, which is safe because only a writer holding the parent splits it.
  */
-int BTreeCursor::findLeafPageID(BufferPool& pool, File& indexFile,
-                                const std::string& key) {
-  int page_id = indexFile.getRootPageID();
-  int parent_page_id = Page::HAS_NO_PARENT;
-  while (true) {
-    dbfs_log::index().debug(
-        "Traversing to find leaf page for key {}: currently at page ID {} in "
-        "index file {}.",
-        index_key::formatForDebug(key), page_id, indexFile.getFilePath());
-    Page* page = pool.pinPage(page_id, indexFile);
-    page->setParentPageID(parent_page_id);
-    if (page->isLeaf()) {
-      dbfs_log::index().debug("Found leaf page ID {} for key {} in index {}",
-                              page_id, index_key::formatForDebug(key),
-                              indexFile.getFilePath());
-      pool.unpinPage(page, indexFile);
-      break;
+template <typename LeafGuard>
+LeafGuard latchLeaf(BufferPool& pool, File& index_file,
+                    const std::string& key) {
+  constexpr bool kReadLeaf = std::is_same_v<LeafGuard, ReadPageGuard>;
+  ReadPageGuard page = latchRoot<ReadPageGuard>(pool, index_file);
+  if (page->isLeaf()) {
+    if constexpr (kReadLeaf) {
+      return page;
+    } else {
+      // The root cannot be write-latched while it is read-latched.
+      page.release();
+      WritePageGuard leaf = latchRoot<WritePageGuard>(pool, index_file);
+      if (leaf->isLeaf()) {
+        return leaf;
+      }
+      // The root leaf was split meanwhile; descend from the new root.
+      leaf.release();
+      return latchLeaf<LeafGuard>(pool, index_file, key);
     }
+  }
 
-    InternalIndexPage internal(*page);
-    int child_page_id = internal.findChildPage(key);
-    pool.unpinPage(page, indexFile);
+  while (true) {
+    const PageId child_page_id = InternalIndexPage(*page).findChildPage(key);
     dbfs_log::index().debug("The child page ID of page ID {} for key {} is {}",
-                            page_id, index_key::formatForDebug(key),
+                            page->getPageID(), index_key::formatForDebug(key),
                             child_page_id);
-    parent_page_id = page_id;
-    page_id = child_page_id;
+    ReadPageGuard child = pool.readPage(child_page_id, index_file);
+    if (!child->isLeaf()) {
+      page = std::move(child);
+      continue;
+    }
+    dbfs_log::index().debug("Found leaf page ID {} for key {} in index {}",
+                            child_page_id, index_key::formatForDebug(key),
+                            index_file.getFilePath());
+    if constexpr (kReadLeaf) {
+      return child;
+    } else {
+      child.release();
+      return pool.writePage(child_page_id, index_file);
+    }
   }
-  return page_id;
 }
 
+struct PathPage {
+  WritePageGuard page;
+  BTreeCursor::KeyRange range;
+};
+
+// Free bytes that let a page take any one cell without splitting: the
+// largest leaf cell, which is larger than a separator of the same key, and
+// its slot pointer.
+constexpr size_t SPLIT_SAFE_FREE_BYTES =
+    Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(PageId) +
+    sizeof(uint16_t) + index_key::MAX_KEY_SIZE + Page::CELL_POINTER_SIZE;
+
+/**
+ * Write-latches the path from the root down to the leaf that may contain
+ * key, with the key range each page is routed, for an insert that has to
+ * split the leaf. Latches are crabbed: once a page has SPLIT_SAFE_FREE_BYTES
+ * free, a split below it stops there, so its ancestors are released. The
+ * first page of the path is then that page rather than the root.
+ */
+std::vector<PathPage> latchPath(BufferPool& pool, File& index_file,
+                                const std::string& key) {
+  std::vector<PathPage> path;
+  path.push_back(
+      PathPage{latchRoot<WritePageGuard>(pool, index_file), {}});
+  while (!path.back().page->isLeaf()) {
+    BTreeCursor::KeyRange range = path.back().range;
+    const PageId child_page_id =
+        InternalIndexPage(*path.back().page).findChildPage(key, range);
+    path.push_back(
+        PathPage{pool.writePage(child_page_id, index_file), std::move(range)});
+    if (path.back().page->freeGapBytes() >= SPLIT_SAFE_FREE_BYTES) {
+      path.erase(path.begin(), path.end() - 1);
+    }
+  }
+  return path;
+}
+
+}  // namespace
+
 /**
  * Traverses the B-tree to find all index entries inside the given boundaries.
  * @param pool Buffer pool used to pin and unpin index pages during traversal.
@@ -155,57 +224,103 @@ std::vector<IndexEntry> BTreeCursor::findEntries(
     bool do_invalidate) {
   const auto& [left_boundary, right_boundary] = boundaries;
 
-  // NOTE: we decided not to invalidate intermediate nodes during traversal for
-  // now. we will come back to this when we start to support concurrency.
-
-  // find traversal start point based on left boundary.
-  int page_id;
-  if (left_boundary.composite_key.empty()) {
-    page_id = findLeafPageID(pool, indexFile, "");
-  } else {
-    page_id = findLeafPageID(pool, indexFile, left_boundary.composite_key);
+  // Invalidating entries modifies the leaves, so they need the write latch.
+  if (do_invalidate) {
+    return scanLeaves(
+        latchLeaf<WritePageGuard>(pool, indexFile,
+                                  left_boundary.composite_key),
+        pool, indexFile, boundaries, true);
   }
+  return scanLeaves(
+      latchLeaf<ReadPageGuard>(pool, indexFile, left_boundary.composite_key),
+      pool, indexFile, boundaries, false);
+}
 
-  // leaf page traversal
+template <typename Guard>
+std::vector<IndexEntry> BTreeCursor::scanLeaves(
+    Guard leaf_page, BufferPool& pool, File& indexFile,
+    const std::pair<Boundary, Boundary>& boundaries, bool do_invalidate) {
+  const auto& [left_boundary, right_boundary] = boundaries;
   std::vector<IndexEntry> matching_entries;
-  while (page_id != LeafIndexPage::NO_RIGHT_SIBLING) {
-    Page* leaf_page = pool.pinPage(page_id, indexFile);
+  while (true) {
     LeafIndexPage leaf(*leaf_page);
     auto [next_page, entries] =
         leaf.findEntries(left_boundary, right_boundary, do_invalidate);
-    pool.unpinPage(leaf_page, indexFile);
     matching_entries.insert(matching_entries.end(), entries.begin(),
                             entries.end());
-    page_id = next_page;
+    if (next_page == LeafIndexPage::NO_RIGHT_SIBLING) {
+      return matching_entries;
+    }
+    // Latch the sibling before letting go of this leaf, so a split of the
+    // sibling cannot move entries behind the scan.
+    leaf_page = latchPage<Guard>(pool, indexFile, next_page);
   }
-
-  return matching_entries;
 }
 
 void BTreeCursor::insertIntoIndex(BufferPool& pool, File& indexFile,
-                                  const std::string& key, uint16_t heap_page_id,
+                                  const std::string& key, PageId heap_page_id,
                                   uint16_t slot_id) {
+  index_key::checkKeySize(key);
   dbfs_log::index().debug(
       "Inserting index entry for key {} pointing to heap page ID {}, slot ID "
       "{} into index file {}.",
       index_key::formatForDebug(key), heap_page_id, slot_id,
       indexFile.getFilePath());
-  int target_page_id = findLeafPageID(pool, indexFile, key);
-  Page* target_page = pool.pinPage(target_page_id, indexFile);
+
+  // Optimistic pass: most inserts fit in the leaf, which is the only page
+  // write-latched.
+  {
+    WritePageGuard leaf = latchLeaf<WritePageGuard>(pool, indexFile, key);
+    if (insertCellWithCompaction(*leaf, LeafCell(key, heap_page_id, slot_id))
+            .has_value()) {
+      dbfs_log::index().debug(
+          "Inserted index entry for key {} pointing to heap page ID {}, slot "
+          "ID {}.",
+          index_key::formatForDebug(key), heap_page_id, slot_id);
+      return;
+    }
+  }
+
+  // The leaf is full. Latch the path again, down from the lowest page that
+  // can take a separator, and split upwards; the path stack stands in for
+  // parent pointers. The leaf may have been split by someone else in
+  // between, in which case the insert simply fits now.
+  std::vector<PathPage> path = latchPath(pool, indexFile, key);
   std::unique_ptr<Cell> cell_to_insert =
       std::make_unique<LeafCell>(key, heap_page_id, slot_id);
 
   while (true) {
     auto inserted_slot_id =
-        insertCellWithCompaction(*target_page, *cell_to_insert);
+        insertCellWithCompaction(*path.back().page, *cell_to_insert);
     if (inserted_slot_id.has_value()) {
-      pool.unpinPage(target_page, indexFile);
       break;
     }
 
-    Page* parent_page = ensureParentPage(pool, indexFile, *target_page);
-    SplitResult split_result =
-        splitPage(pool, indexFile, target_page, parent_page);
+    if (path.size() == 1) {
+      if (path.back().page->getPageID() != indexFile.getRootPageID()) {
+        // latchPath keeps a page other than the root first only if any
+        // cell fits in it.
+        throw std::logic_error(
+            "BTreeCursor::insertIntoIndex: split-safe page did not take the "
+            "cell");
+      }
+      // Splitting the root: put a new root above it. It is published while
+      // the old root is still write-latched, so traversals that latched the
+      // old root as root retry from the new one.
+      const PageId old_root_page_id = path.back().page->getPageID();
+      const PageId new_root_page_id = pool.createPage(
+          PageKind::InternalIndex, indexFile, old_root_page_id);
+      dbfs_log::index().debug("Created new root page ID {} above page ID {}.",
+                              new_root_page_id, old_root_page_id);
+      path.insert(path.begin(),
+                  PathPage{pool.writePage(new_root_page_id, indexFile), {}});
+      indexFile.setRootPageID(new_root_page_id);
+    }
+
+    Page* target_page = path.back().page.get();
+    Page* parent_page = path[path.size() - 2].page.get();
+    SplitResult split_result = splitPage(pool, indexFile, target_page,
+                                         parent_page, path.back().range);
     const IntermediateCell& separator_cell = split_result.separator_cell;
 
     // find page to be inserted by comparing the separator key with the key to
@@ -213,30 +328,25 @@ void BTreeCursor::insertIntoIndex(BufferPool& pool, File& indexFile,
     // left child, and right_page_id points to the child for keys greater than
     // the separator.
     Page* retry_page = target_page;
-    Page* pinned_retry_page = nullptr;
-    const uint16_t retry_page_id =
+    WritePageGuard other_retry_page;
+    const PageId retry_page_id =
         index_key::compare(cell_to_insert->key(), separator_cell.key()) <= 0
             ? separator_cell.page_id()
             : split_result.right_page_id;
     if (retry_page_id != target_page->getPageID()) {
-      pinned_retry_page = pool.pinPage(retry_page_id, indexFile);
-      retry_page = pinned_retry_page;
+      other_retry_page = pool.writePage(retry_page_id, indexFile);
+      retry_page = other_retry_page.get();
     }
 
     inserted_slot_id = insertCellWithCompaction(*retry_page, *cell_to_insert);
-    if (pinned_retry_page != nullptr) {
-      pool.unpinPage(pinned_retry_page, indexFile);
-    }
     if (!inserted_slot_id.has_value()) {
-      pool.unpinPage(parent_page, indexFile);
-      pool.unpinPage(target_page, indexFile);
       throw std::logic_error(
           "BTreeCursor::insertIntoIndex: insertion failed even after split");
     }
 
-    pool.unpinPage(target_page, indexFile);
+    other_retry_page.release();
     cell_to_insert = std::make_unique<IntermediateCell>(separator_cell);
-    target_page = parent_page;
+    path.pop_back();
   }
 
   dbfs_log::index().debug(
@@ -245,30 +355,17 @@ void BTreeCursor::insertIntoIndex(BufferPool& pool, File& indexFile,
       index_key::formatForDebug(key), heap_page_id, slot_id);
 }
 
-/**
- * @brief creates parent page if the old_page is the initial page of the btree.
- * @param txn The transaction performing the insert.
- * @return parent page of old_page, which is the new root page of the btree.
- */
-Page* BTreeCursor::ensureParentPage(BufferPool& pool, File& index_file,
-                                    Page& old_page) {
-  int parent_page_id;
-  if (old_page.getParentPageID() == Page::HAS_NO_PARENT) {
-    dbfs_log::index().debug(
-        "Initialized Parent Page for page ID {} because it has no parent but "
-        "root page.",
-        old_page.getPageID());
-    int new_root_page_id = pool.createPage(PageKind::InternalIndex, index_file,
-                                           old_page.getPageID());
-    index_file.setRootPageID(new_root_page_id);
-    old_page.setParentPageID(new_root_page_id);
-    parent_page_id = new_root_page_id;
-  } else {
-    parent_page_id = old_page.getParentPageID();
+std::string BTreeCursor::KeyRange::commonPrefix() const {
+  if (!low.has_value() || !high.has_value()) {
+    return "";
   }
-
-  Page* parent_page = pool.pinPage(parent_page_id, index_file);
-  return parent_page;
+  size_t common = 0;
+  while (common < low->size() && common < high->size() &&
+         common < Page::MAX_KEY_PREFIX_SIZE &&
+         (*low)[common] == (*high)[common]) {
+    ++common;
+  }
+  return low->substr(0, common);
 }
 
 /**
@@ -279,13 +376,15 @@ Page* BTreeCursor::ensureParentPage(BufferPool& pool, File& index_file,
  * @param index_file Index file to which the pages belong.
  * @param old_page The page to split.
  * @param separate_key The key to separate the old page and the new page.
+ * @param range The key range of old_page, which the two halves divide; each
+ * half gets the common prefix of its part as key prefix.
  * @return the separator cell to be inserted into the parent page.
  */
 BTreeCursor::SplitResult BTreeCursor::splitLeafPage(
     BufferPool& pool, File& index_file, Page& old_page,
-    const std::string& separate_key) {
-  uint16_t new_page_id = pool.createPage(PageKind::LeafIndex, index_file);
-  Page* new_page = pool.pinPage(new_page_id, index_file);
+    const std::string& separate_key, const KeyRange& range) {
+  PageId new_page_id = pool.createPage(PageKind::LeafIndex, index_file);
+  WritePageGuard new_page = pool.writePage(new_page_id, index_file);
 
   LeafIndexPage old_leaf(old_page);
   LeafIndexPage new_leaf(*new_page);
@@ -293,45 +392,52 @@ BTreeCursor::SplitResult BTreeCursor::splitLeafPage(
   old_leaf.setRightSiblingPageId(new_page_id);
   old_leaf.transferAndCompactTo(new_leaf, separate_key);
 
-  pool.unpinPage(new_page, index_file);
-  return SplitResult{
-      IntermediateCell(static_cast<uint16_t>(old_page.getPageID()),
-                       separate_key),
-      new_page_id};
+  // The parent only needs a key between the two halves, not a whole one.
+  const std::string separator =
+      new_page->slotCount() == 0
+          ? separate_key
+          : index_key::shortestSeparator(separate_key,
+                                         new_page->indexKeyAt(0));
+  old_leaf.setKeyPrefix(KeyRange{range.low, separator}.commonPrefix());
+  new_leaf.setKeyPrefix(KeyRange{separator, range.high}.commonPrefix());
+
+  return SplitResult{IntermediateCell(old_page.getPageID(), separator),
+                     new_page_id};
 }
 
 BTreeCursor::SplitResult BTreeCursor::splitInternalPage(
     BufferPool& pool, File& index_file, Page& old_page,
-    const std::string& separate_key) {
-  uint16_t new_page_id = pool.createPage(PageKind::InternalIndex, index_file);
-  Page* new_page = pool.pinPage(new_page_id, index_file);
+    const std::string& separate_key, const KeyRange& range) {
+  PageId new_page_id = pool.createPage(PageKind::InternalIndex, index_file);
+  WritePageGuard new_page = pool.writePage(new_page_id, index_file);
 
   InternalIndexPage old_internal(old_page);
   InternalIndexPage new_internal(*new_page);
   old_internal.transferAndCompactTo(new_internal, separate_key);
+  new_internal.setKeyPrefix(KeyRange{range.low, separate_key}.commonPrefix());
+  old_internal.setKeyPrefix(KeyRange{separate_key, range.high}.commonPrefix());
 
-  pool.unpinPage(new_page, index_file);
   return SplitResult{IntermediateCell(new_page_id, separate_key),
-                     static_cast<uint16_t>(old_page.getPageID())};
+                     old_page.getPageID()};
 }
 
 BTreeCursor::SplitResult BTreeCursor::splitPage(BufferPool& pool,
                                                 File& index_file,
                                                 Page* old_page,
-                                                Page* parent_page) {
+                                                Page* parent_page,
+                                                const KeyRange& range) {
   dbfs_log::index().debug("Split old page and rewire pointer.");
   SplitResult split_result =
       old_page->isLeaf()
           ? splitLeafPage(pool, index_file, *old_page,
-                          LeafCell::getKey(old_page->getSplitKeyCellStart()))
-          : splitInternalPage(
-                pool, index_file, *old_page,
-                IntermediateCell::getKey(old_page->getSplitKeyCellStart()));
+                          old_page->getSplitKey(), range)
+          : splitInternalPage(pool, index_file, *old_page,
+                              old_page->getSplitKey(), range);
 
   // Since cell on internalindexpage points to the leaf page larger then its value, we have to replace child page ID
   if (split_result.right_page_id != old_page->getPageID()) {
     InternalIndexPage parent(*parent_page);
-    if (!parent.replaceChildPageId(static_cast<uint16_t>(old_page->getPageID()),
+    if (!parent.replaceChildPageId(old_page->getPageID(),
                                    split_result.right_page_id)) {
       throw std::logic_error(
           "BTreeCursor::splitPage: parent did not reference split page");
@@ -343,21 +449,20 @@ BTreeCursor::SplitResult BTreeCursor::splitPage(BufferPool& pool,
 
 void BTreeCursor::dumpTree(BufferPool& pool, File& indexFile,
                            std::ostream& os) {
-  const uint16_t max_page_id = indexFile.getMaxPageID();
-  for (uint16_t page_id = 0; page_id <= max_page_id; ++page_id) {
+  const PageId max_page_id = indexFile.getMaxPageID();
+  for (PageId page_id = 0; page_id <= max_page_id; ++page_id) {
     if (!indexFile.isPageIDUsed(page_id)) {
       continue;
     }
 
-    Page* page = pool.pinPage(page_id, indexFile);
+    ReadPageGuard page = pool.readPage(page_id, indexFile);
     dumpIndexPage(*page, os);
-    pool.unpinPage(page, indexFile);
   }
 }
 
 /** check if key is inside the boundary */
 bool BTreeCursor::isInsideBoundary(std::string_view key,
-                                   BTreeCursor::Boundary boundary,
+                                   const BTreeCursor::Boundary& boundary,
                                    bool is_boundary_left) {
   const std::string_view boundary_key = boundary.composite_key;
   const std::size_t compare_size = std::min(key.size(), boundary_key.size());
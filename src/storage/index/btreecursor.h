@@ -18,6 +18,13 @@
  * ./data/<table>.{index,db}. File is responsible for page-ID allocation and
  * persistence (e.g., maintaining the high-water mark), while BufferPool
  * provides page caching.
+ *
+ * Operations run concurrently on one index through page guards. Traversals
+ * crab down with read latches, holding a page until its child is latched;
+ * an insert write-latches only its leaf unless the leaf has to split. It then
+ * crabs down again with write latches, releasing the pages above any page
+ * with room for the largest cell (index_key::MAX_KEY_SIZE bounds keys), and
+ * splits upwards along the pages it kept.
  */
 class BTreeCursor {
  public:
@@ -27,29 +34,46 @@ class BTreeCursor {
   };
   struct SplitResult {
     IntermediateCell separator_cell;
-    uint16_t right_page_id;
+    PageId right_page_id;
+  };
+  /**
+   * The keys a page can be routed: greater than low and at most high, the
+   * separators on either side of it in its parent (or further up). An absent
+   * bound is open. All such keys share the common prefix of the bounds,
+   * which index pages store once instead of in every cell.
+   */
+  struct KeyRange {
+    std::optional<std::string> low;
+    std::optional<std::string> high;
+    std::string commonPrefix() const;
   };
   static std::vector<IndexEntry> findEntries(
       BufferPool& pool, File& indexFile,
       std::pair<Boundary, Boundary> boundaries, bool do_invalidate);
-  static int findLeafPageID(BufferPool& pool, File& indexFile,
-                            const std::string& key);
   static SplitResult splitPage(BufferPool& pool, File& indexFile,
-                               Page* old_page, Page* parent_page);
+                               Page* old_page, Page* parent_page,
+                               const KeyRange& range);
+  // Throws if key is longer than index_key::MAX_KEY_SIZE.
   static void insertIntoIndex(BufferPool& pool, File& indexFile,
-                              const std::string& key, uint16_t heap_page_id,
+                              const std::string& key, PageId heap_page_id,
                               uint16_t slot_id);
   static SplitResult splitLeafPage(BufferPool& pool, File& index_file,
                                    Page& old_page,
-                                   const std::string& separate_key);
+                                   const std::string& separate_key,
+                                   const KeyRange& range);
   static SplitResult splitInternalPage(BufferPool& pool, File& index_file,
                                        Page& old_page,
-                                       const std::string& separate_key);
-  static Page* ensureParentPage(BufferPool& pool, File& index_file,
-                                Page& old_page);
-  static bool isInsideBoundary(std::string_view key, Boundary boundary,
+                                       const std::string& separate_key,
+                                       const KeyRange& range);
+  static bool isInsideBoundary(std::string_view key, const Boundary& boundary,
                                bool is_boundary_left);
 
+ private:
+  template <typename Guard>
+  static std::vector<IndexEntry> scanLeaves(
+      Guard leaf_page, BufferPool& pool, File& indexFile,
+      const std::pair<Boundary, Boundary>& boundaries, bool do_invalidate);
+
  public:
   static void dumpTree(BufferPool& pool, File& indexFile, std::ostream& os);
 };
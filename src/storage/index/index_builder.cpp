@@ -0,0 +1,405 @@
+#include "index_builder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "index_key.h"
+#include "logging.h"
+#include "storage/index/btreecursor.h"
+#include "storage/index/index_page.h"
+#include "storage/index/intermediate_cell.h"
+#include "storage/index/leaf_cell.h"
+#include "storage/page/page.h"
+#include "util.h"
+
+namespace {
+
+bool entryLess(const IndexEntry& lhs, const IndexEntry& rhs) {
+  const int order = index_key::compare(lhs.key, rhs.key);
+  if (order != 0) {
+    return order < 0;
+  }
+  if (lhs.rid.heap_page_id != rhs.rid.heap_page_id) {
+    return lhs.rid.heap_page_id < rhs.rid.heap_page_id;
+  }
+  return lhs.rid.slot_id < rhs.rid.slot_id;
+}
+
+// Run files hold entries back to back: key size, key, heap page id, slot id.
+void writeEntry(std::ofstream& out, const IndexEntry& entry) {
+  const auto key_size = static_cast<uint16_t>(entry.key.size());
+  out.write(reinterpret_cast<const char*>(&key_size), sizeof(key_size));
+  out.write(entry.key.data(), key_size);
+  out.write(reinterpret_cast<const char*>(&entry.rid.heap_page_id),
+            sizeof(entry.rid.heap_page_id));
+  out.write(reinterpret_cast<const char*>(&entry.rid.slot_id),
+            sizeof(entry.rid.slot_id));
+}
+
+bool readEntry(std::ifstream& in, IndexEntry& entry) {
+  uint16_t key_size = 0;
+  if (!in.read(reinterpret_cast<char*>(&key_size), sizeof(key_size))) {
+    return false;
+  }
+  entry.key.resize(key_size);
+  in.read(entry.key.data(), key_size);
+  in.read(reinterpret_cast<char*>(&entry.rid.heap_page_id),
+          sizeof(entry.rid.heap_page_id));
+  in.read(reinterpret_cast<char*>(&entry.rid.slot_id),
+          sizeof(entry.rid.slot_id));
+  if (!in) {
+    throw std::runtime_error("IndexBuilder: truncated sort run");
+  }
+  return true;
+}
+
+// Bytes a cell takes on a page whose key prefix is prefix_size bytes long,
+// counting its slot pointer.
+size_t cellBytes(const Cell& cell, size_t prefix_size) {
+  return cell.payloadSize() - prefix_size + Page::CELL_POINTER_SIZE;
+}
+
+// Size of BTreeCursor::KeyRange{low, high}.commonPrefix(), without copying
+// the bounds.
+size_t commonPrefixSize(const std::optional<std::string>& low,
+                        const std::optional<std::string>& high) {
+  if (!low.has_value() || !high.has_value()) {
+    return 0;
+  }
+  const size_t limit =
+      std::min({low->size(), high->size(), Page::MAX_KEY_PREFIX_SIZE});
+  size_t common = 0;
+  while (common < limit && (*low)[common] == (*high)[common]) {
+    ++common;
+  }
+  return common;
+}
+
+/**
+ * Packs a sorted entry stream into pages, writing each page as soon as it is
+ * finished. Every level keeps only the page it is filling.
+ *
+ * Whether one more cell fits a page depends on the page's key prefix, the
+ * common prefix of its key range, and that range ends at the separator to
+ * the next page. A leaf therefore decides on an entry once it has seen the
+ * entry after it: the candidate page is the leaf so far plus that entry,
+ * closed by the separator between the two. An internal page decides on a
+ * child as it arrives, since the child carries its own high key, which is
+ * the separator the page would end at if the child were its right-most one.
+ * Either way, every page written is one that was checked under its actual
+ * prefix.
+ */
+class TreeWriter {
+ public:
+  TreeWriter(File& index_file, int fill_factor_percent)
+      : index_file_(index_file),
+        page_budget_bytes_(
+            Page::HEADDER_SIZE_BYTE +
+            (Page::PAGE_SIZE_BYTE - Page::HEADDER_SIZE_BYTE) *
+                static_cast<size_t>(fill_factor_percent) / 100) {}
+
+  void add(IndexEntry entry) {
+    LeafCell cell(std::move(entry.key), entry.rid.heap_page_id,
+                  entry.rid.slot_id);
+    if (!lookahead_.has_value()) {
+      lookahead_ = std::move(cell);
+      return;
+    }
+    const std::string high =
+        index_key::shortestSeparator(lookahead_->key(), cell.key());
+    if (!leaf_cells_.empty() && !fitsLeaf(high)) {
+      closeLeaf();
+    }
+    pushLookahead();
+    lookahead_ = std::move(cell);
+  }
+
+  // Writes the remaining pages and returns the root page id.
+  PageId finish() {
+    if (!lookahead_.has_value()) {
+      // No entries: page 0 stays the empty root leaf.
+      return leaf_page_id_;
+    }
+    // The last leaf's range is open above, so it gets no key prefix.
+    if (!leaf_cells_.empty() && !fitsLeaf(std::nullopt)) {
+      closeLeaf();
+    }
+    pushLookahead();
+    lookahead_.reset();
+    return closeLevel(0, writeLeaf(std::nullopt));
+  }
+
+  size_t leafCount() const { return leaf_count_; }
+  size_t height() const { return levels_.size() + 1; }
+
+ private:
+  struct Level {
+    // Children of the page being filled, each with the high key of its
+    // range; all of them become cells once another child follows.
+    std::vector<IntermediateCell> children;
+    size_t children_bytes = 0;
+    std::optional<std::string> low;
+  };
+
+  bool fits(size_t cell_bytes, size_t cell_count,
+            const std::optional<std::string>& low,
+            const std::optional<std::string>& high) const {
+    const size_t prefix_size = commonPrefixSize(low, high);
+    return Page::HEADDER_SIZE_BYTE + cell_bytes - cell_count * prefix_size <=
+           page_budget_bytes_;
+  }
+
+  bool fitsLeaf(const std::optional<std::string>& high) const {
+    return fits(leaf_bytes_ + cellBytes(*lookahead_, 0),
+                leaf_cells_.size() + 1, leaf_low_, high);
+  }
+
+  void pushLookahead() {
+    leaf_bytes_ += cellBytes(*lookahead_, 0);
+    leaf_cells_.push_back(std::move(*lookahead_));
+  }
+
+  // Ends the current leaf before the lookahead entry and passes it up.
+  void closeLeaf() {
+    const std::string high = index_key::shortestSeparator(
+        leaf_cells_.back().key(), lookahead_->key());
+    addChild(0, writeLeaf(high), high);
+  }
+
+  // Writes the current leaf, whose range ends at high, and starts the next.
+  PageId writeLeaf(const std::optional<std::string>& high) {
+    const PageId page_id = leaf_page_id_;
+    const PageId right_sibling = high.has_value()
+                                     ? index_file_.allocateNextPageId()
+                                     : LeafIndexPage::NO_RIGHT_SIBLING;
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    Page page = Page::initializeNew(buffer.data(), PageKind::LeafIndex,
+                                    right_sibling, page_id);
+    const std::string key_prefix =
+        BTreeCursor::KeyRange{leaf_low_, high}.commonPrefix();
+    if (!LeafIndexPage(page).fillWith(leaf_cells_, key_prefix)) {
+      throw std::logic_error("IndexBuilder: leaf cells do not fit a page");
+    }
+    index_file_.writePageFromBuffer(page_id, buffer.data());
+    ++leaf_count_;
+
+    leaf_cells_.clear();
+    leaf_bytes_ = 0;
+    leaf_low_ = high;
+    leaf_page_id_ = right_sibling;
+    return page_id;
+  }
+
+  // Passes a finished page of the level below, whose range ends at high,
+  // to level.
+  void addChild(size_t level, PageId page_id, const std::string& high) {
+    if (level == levels_.size()) {
+      levels_.emplace_back();
+    }
+    Level& current = levels_[level];
+    IntermediateCell child(page_id, high);
+    // The candidate page holds the children so far as cells and this child
+    // as its right-most one, so it ends at the child's high key.
+    if (current.children.size() >= 2 &&
+        !fits(current.children_bytes, current.children.size(), current.low,
+              high)) {
+      IntermediateCell right_most = std::move(current.children.back());
+      current.children.pop_back();
+      writeNode(level, right_most);
+    }
+    current.children_bytes += cellBytes(child, 0);
+    current.children.push_back(std::move(child));
+  }
+
+  // Writes the children of level as a page ending at right_most's high key,
+  // with right_most as its right-most child, and passes the page up.
+  void writeNode(size_t level, const IntermediateCell& right_most) {
+    Level& current = levels_[level];
+    const PageId page_id = writeInternal(
+        current.children, right_most.page_id(), current.low, right_most.key());
+    current.children.clear();
+    current.children_bytes = 0;
+    current.low = right_most.key();
+    addChild(level + 1, page_id, right_most.key());
+  }
+
+  /**
+   * Passes the last page of the level below to level, which closes it, and
+   * then the levels above. Returns the root page id.
+   */
+  PageId closeLevel(size_t level, PageId last_page_id) {
+    if (level == levels_.size()) {
+      // The level below ended with a single page: that is the root.
+      return last_page_id;
+    }
+    Level& current = levels_[level];
+    // The last page is open above, so it gets no key prefix. If the children
+    // do not all fit in it, the page before it takes all but the last of
+    // them, which leaves two children for the last page.
+    if (current.children.size() >= 3 &&
+        !fits(current.children_bytes, current.children.size(), current.low,
+              std::nullopt)) {
+      IntermediateCell last_child = std::move(current.children.back());
+      current.children.pop_back();
+      IntermediateCell right_most = std::move(current.children.back());
+      current.children.pop_back();
+      writeNode(level, right_most);
+      current.children_bytes = cellBytes(last_child, 0);
+      current.children.push_back(std::move(last_child));
+    }
+    const PageId page_id = writeInternal(current.children, last_page_id,
+                                         current.low, std::nullopt);
+    return closeLevel(level + 1, page_id);
+  }
+
+  PageId writeInternal(const std::vector<IntermediateCell>& cells,
+                       PageId right_most_child_page_id,
+                       const std::optional<std::string>& low,
+                       const std::optional<std::string>& high) {
+    const PageId page_id = index_file_.allocateNextPageId();
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    Page page = Page::initializeNew(buffer.data(), PageKind::InternalIndex,
+                                    right_most_child_page_id, page_id);
+    if (!InternalIndexPage(page).fillWith(
+            cells, BTreeCursor::KeyRange{low, high}.commonPrefix())) {
+      throw std::logic_error(
+          "IndexBuilder: separator cells do not fit a page");
+    }
+    index_file_.writePageFromBuffer(page_id, buffer.data());
+    return page_id;
+  }
+
+  File& index_file_;
+  const size_t page_budget_bytes_;
+  // The entry after the current leaf's last one, not yet placed.
+  std::optional<LeafCell> lookahead_;
+  std::vector<LeafCell> leaf_cells_;
+  size_t leaf_bytes_ = 0;
+  std::optional<std::string> leaf_low_;
+  // The first leaf reuses the empty root leaf at page 0.
+  PageId leaf_page_id_ = 0;
+  size_t leaf_count_ = 0;
+  // Internal levels, bottom up; a deque so that references to a level stay
+  // valid while a level above is added.
+  std::deque<Level> levels_;
+};
+
+// A sorted run being merged, positioned at its smallest unmerged entry.
+struct RunCursor {
+  std::ifstream in;
+  IndexEntry head;
+};
+
+}  // namespace
+
+IndexBuilder::Options IndexBuilder::optionsFromEnv() {
+  Options options;
+  options.fill_factor_percent = static_cast<int>(std::clamp<std::uint64_t>(
+      dbfs_util::unsignedFromEnv(
+          "DBFS_INDEX_FILL_FACTOR",
+          static_cast<std::uint64_t>(options.fill_factor_percent)),
+      10, 100));
+  options.sort_memory_bytes =
+      static_cast<size_t>(dbfs_util::unsignedFromEnv(
+          "DBFS_INDEX_BUILD_SORT_MEMORY_MB", options.sort_memory_bytes >> 20))
+      << 20;
+  return options;
+}
+
+IndexBuilder::IndexBuilder(File& index_file, Options options)
+    : index_file_(index_file), options_(options) {}
+
+IndexBuilder::~IndexBuilder() { removeRuns(); }
+
+void IndexBuilder::add(std::string key, RID rid) {
+  index_key::checkKeySize(key);
+  entry_bytes_ += sizeof(IndexEntry) + key.size();
+  entries_.push_back(IndexEntry{std::move(key), rid});
+  ++entry_count_;
+  if (entry_bytes_ > options_.sort_memory_bytes) {
+    spillRun();
+  }
+}
+
+void IndexBuilder::spillRun() {
+  std::sort(entries_.begin(), entries_.end(), entryLess);
+  const std::string path =
+      index_file_.getFilePath() + ".run" + std::to_string(run_paths_.size());
+  run_paths_.push_back(path);
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  for (const IndexEntry& entry : entries_) {
+    writeEntry(out, entry);
+  }
+  out.close();
+  if (!out) {
+    throw std::runtime_error("IndexBuilder: failed to write sort run " + path);
+  }
+  entries_.clear();
+  entry_bytes_ = 0;
+}
+
+void IndexBuilder::removeRuns() {
+  for (const std::string& path : run_paths_) {
+    std::error_code error;
+    std::filesystem::remove(path, error);
+  }
+  run_paths_.clear();
+}
+
+size_t IndexBuilder::finish() {
+  TreeWriter writer(index_file_, options_.fill_factor_percent);
+  const size_t run_count = run_paths_.size();
+  if (run_paths_.empty()) {
+    std::sort(entries_.begin(), entries_.end(), entryLess);
+    for (IndexEntry& entry : entries_) {
+      writer.add(std::move(entry));
+    }
+  } else {
+    if (!entries_.empty()) {
+      spillRun();
+    }
+    // k-way merge of the runs, smallest head first.
+    std::vector<RunCursor> runs(run_paths_.size());
+    auto later = [&runs](size_t lhs, size_t rhs) {
+      return entryLess(runs[rhs].head, runs[lhs].head);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heads(
+        later);
+    for (size_t idx = 0; idx < runs.size(); ++idx) {
+      runs[idx].in.open(run_paths_[idx], std::ios::binary);
+      if (readEntry(runs[idx].in, runs[idx].head)) {
+        heads.push(idx);
+      }
+    }
+    while (!heads.empty()) {
+      const size_t idx = heads.top();
+      heads.pop();
+      writer.add(std::move(runs[idx].head));
+      if (readEntry(runs[idx].in, runs[idx].head)) {
+        heads.push(idx);
+      }
+    }
+  }
+  entries_.clear();
+  entries_.shrink_to_fit();
+  removeRuns();
+
+  const PageId root_page_id = writer.finish();
+  index_file_.setRootPageID(root_page_id);
+  dbfs_log::index().info(
+      "Bulk loaded {} entries into index {}: {} leaves, height {}, {} sort "
+      "runs.",
+      entry_count_, index_file_.getFilePath(), writer.leafCount(),
+      writer.height(), run_count);
+  return entry_count_;
+}
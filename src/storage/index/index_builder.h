@@ -0,0 +1,67 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "storage/disk/file.h"
+#include "storage/index/rid.h"
+
+/**
+ * IndexBuilder loads a B+tree index bottom-up from entries added in any
+ * order, for CREATE INDEX and recovery's index rebuild, instead of inserting
+ * them one at a time through BTreeCursor.
+ *
+ * Entries are sorted by key, then RID, in memory. Whenever the unsorted
+ * entries outgrow the sort memory budget they are sorted and spilled to a
+ * run file next to the index, and finish() merges the runs. The sorted
+ * stream is packed into leaves from left to right, each filled up to the
+ * fill factor, and every finished page passes its page id and separator to
+ * the level above, so all internal levels are built in the same pass. Pages
+ * are written straight to the file in the order they are finished, bypassing
+ * the buffer pool; the buffer pool must not hold pages of the index.
+ *
+ * The pages are laid out as BTreeCursor keeps them: leaves link to their
+ * right siblings, separators between leaves are suffix-truncated, and every
+ * page stores the common prefix of its key range once.
+ */
+class IndexBuilder {
+ public:
+  struct Options {
+    // Percentage of a page's cell area to fill; the rest is left free so
+    // that later inserts do not split every page right away.
+    int fill_factor_percent = 90;
+    // Bytes of entries sorted in memory before they are spilled to a run.
+    size_t sort_memory_bytes = size_t{64} << 20;
+  };
+  // DBFS_INDEX_FILL_FACTOR (percent, 10 to 100) and
+  // DBFS_INDEX_BUILD_SORT_MEMORY_MB, with the defaults above.
+  static Options optionsFromEnv();
+
+  // index_file must be a new index: only the empty root leaf at page 0,
+  // which becomes the leftmost leaf.
+  explicit IndexBuilder(File& index_file, Options options = optionsFromEnv());
+  IndexBuilder(const IndexBuilder&) = delete;
+  IndexBuilder& operator=(const IndexBuilder&) = delete;
+  ~IndexBuilder();
+
+  // Throws if key is longer than index_key::MAX_KEY_SIZE.
+  void add(std::string key, RID rid);
+  /**
+   * Writes the tree and makes its top page the root of the index file.
+   * Returns the number of entries loaded. Call it once, after the last add.
+   */
+  size_t finish();
+  // Runs spilled to disk so far.
+  size_t runCount() const { return run_paths_.size(); }
+
+ private:
+  void spillRun();
+  void removeRuns();
+
+  File& index_file_;
+  Options options_;
+  std::vector<IndexEntry> entries_;
+  size_t entry_bytes_ = 0;
+  size_t entry_count_ = 0;
+  std::vector<std::string> run_paths_;
+};
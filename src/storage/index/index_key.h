@@ -122,6 +122,18 @@ inline std::string encodeRow(const Schema& schema, const TypedRow& row,
   return encoded;
 }
 
+// Longest key an index takes. Bounds every cell, separators included, so an
+// index page with room for the largest cell cannot be split by an insert.
+inline constexpr std::size_t MAX_KEY_SIZE = 512;
+
+inline void checkKeySize(std::string_view key) {
+  if (key.size() > MAX_KEY_SIZE) {
+    throw std::runtime_error("Index key of " + std::to_string(key.size()) +
+                             " bytes exceeds the " +
+                             std::to_string(MAX_KEY_SIZE) + "-byte limit.");
+  }
+}
+
 inline int compare(std::string_view lhs, std::string_view rhs) {
   const int result = lhs.compare(rhs);
   if (result < 0) {
@@ -133,6 +145,24 @@ inline int compare(std::string_view lhs, std::string_view rhs) {
   return 0;
 }
 
+/**
+ * Suffix truncation: the shortest key s with left_max <= s < right_min, to
+ * separate two leaves. That is the shortest prefix of right_min that sorts
+ * after left_max, unless only right_min itself does.
+ */
+inline std::string shortestSeparator(std::string_view left_max,
+                                     std::string_view right_min) {
+  size_t common = 0;
+  while (common < left_max.size() && common < right_min.size() &&
+         left_max[common] == right_min[common]) {
+    ++common;
+  }
+  if (common + 1 < right_min.size()) {
+    return std::string(right_min.substr(0, common + 1));
+  }
+  return std::string(left_max);
+}
+
 inline std::string formatForDebug(std::string_view key) {
   static constexpr char kHex[] = "0123456789abcdef";
   std::string formatted;
@@ -1,25 +1,43 @@
 #include "index_page.h"
 
-#include <algorithm>
 #include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "index_key.h"
 #include "logging.h"
 #include "storage/index/btreecursor.h"
 
+namespace {
+
+// Decodes the valid cells of an index page in slot order, which is key order.
+template <typename IndexCell>
+std::vector<IndexCell> validCells(const Page& page) {
+  std::vector<IndexCell> cells;
+  cells.reserve(page.slotCount());
+  for (int idx = 0; idx < page.slotCount(); ++idx) {
+    const char* cell_data = page.slotCellStartUnchecked(idx);
+    if (Cell::isValid(cell_data)) {
+      cells.push_back(IndexCell::decodeCell(cell_data, page.keyPrefix()));
+    }
+  }
+  return cells;
+}
+
+}  // namespace
+
 LeafCell LeafIndexPage::cellAt(int slot_id) const {
-  return LeafCell::decodeCell(page_.getSlotCellStart(slot_id));
+  return LeafCell::decodeCell(page_.slotCellStartUnchecked(slot_id),
+                              page_.keyPrefix());
 }
 
 bool LeafIndexPage::hasKey(const std::string& key) const {
-  for (int idx = 0; idx < page_.getSlotCount(); ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-    LeafCell cell = cellAt(idx);
-    if (index_key::compare(cell.key(), key) == 0) {
+  const int slot_count = page_.slotCount();
+  for (int idx = page_.lowerBoundSlot(key);
+       idx < slot_count && page_.compareKeyAt(idx, key) == 0; ++idx) {
+    if (Cell::isValid(page_.slotCellStartUnchecked(idx))) {
       return true;
     }
   }
@@ -35,163 +53,107 @@ bool LeafIndexPage::hasKey(const std::string& key) const {
  * indicating we can stop searching.
  *
  */
-std::pair<uint16_t, std::vector<IndexEntry>> LeafIndexPage::findEntries(
+std::pair<PageId, std::vector<IndexEntry>> LeafIndexPage::findEntries(
     BTreeCursor::Boundary left_boundary, BTreeCursor::Boundary right_boundary,
     bool do_invalidate) {
   std::vector<IndexEntry> matching_entries;
-  bool need_to_scan_next_page = true;
-  for (int idx = 0; idx < page_.getSlotCount(); ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
+  // Keys inside the left boundary form a suffix of the sorted slots, and keys
+  // inside the right boundary a prefix, so the matches are one run of slots.
+  // An inclusive left boundary admits exactly the keys not less than it.
+  const int slot_count = page_.getSlotCount();
+  const int first_slot =
+      left_boundary.is_inclusive
+          ? page_.lowerBoundSlot(left_boundary.composite_key)
+          : page_.partitionSlots([&left_boundary](std::string_view key) {
+              return !BTreeCursor::isInsideBoundary(key, left_boundary, true);
+            });
+  for (int idx = first_slot; idx < slot_count; ++idx) {
+    LeafCell cell = cellAt(idx);
+    if (!BTreeCursor::isInsideBoundary(cell.key(), right_boundary, false)) {
+      return std::make_pair(LeafIndexPage::NO_RIGHT_SIBLING, matching_entries);
+    }
+    if (!Cell::isValid(page_.slotCellStartUnchecked(idx))) {
       dbfs_log::index().debug(
           "LeafIndexPage::findEntries skipping invalid slot {}", idx);
       continue;
     }
-    LeafCell cell = cellAt(idx);
-    if (BTreeCursor::isInsideBoundary(cell.key(), left_boundary, true) &&
-        BTreeCursor::isInsideBoundary(cell.key(), right_boundary, false)) {
-      if (do_invalidate) {
-        page_.invalidateSlot(idx);
-      }
-      matching_entries.push_back(
-          IndexEntry{cell.key(), RID{cell.heap_page_id(), cell.slot_id()}});
-    } else if (!BTreeCursor::isInsideBoundary(cell.key(), right_boundary,
-                                              false)) {
-      need_to_scan_next_page = false;
+    if (do_invalidate) {
+      page_.invalidateSlot(idx);
     }
+    matching_entries.push_back(
+        IndexEntry{cell.key(), RID{cell.heap_page_id(), cell.slot_id()}});
   }
-  if (need_to_scan_next_page) {
-    return std::make_pair(this->getRightSiblingPageId(), matching_entries);
-  } else {
-    return std::make_pair(LeafIndexPage::NO_RIGHT_SIBLING, matching_entries);
-  }
+  return std::make_pair(this->getRightSiblingPageId(), matching_entries);
 }
 
-void LeafIndexPage::compact() {
-  const uint16_t old_slot_count = page_.getSlotCount();
-  std::vector<LeafCell> cells;
-  cells.reserve(old_slot_count);
-  for (uint16_t idx = 0; idx < old_slot_count; ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-    cells.push_back(cellAt(idx));
-  }
-
-  const uint16_t new_slot_count = static_cast<uint16_t>(cells.size());
-  uint16_t write_offset = static_cast<uint16_t>(Page::PAGE_SIZE_BYTE);
-  for (uint16_t idx = 0; idx < new_slot_count; ++idx) {
-    const LeafCell& cell = cells[idx];
-    write_offset = static_cast<uint16_t>(write_offset - cell.payloadSize());
-    char* cell_destination = page_.data() + write_offset;
-    std::vector<std::byte> serialized = cell.serialize();
-    std::memcpy(cell_destination, serialized.data(), serialized.size());
+void LeafIndexPage::compact() { setKeyPrefix(std::string(page_.keyPrefix())); }
 
-    char* slot_pointer =
-        page_.data() + Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * idx;
-    std::memcpy(slot_pointer, &write_offset, sizeof(uint16_t));
+void LeafIndexPage::setKeyPrefix(const std::string& key_prefix) {
+  if (!page_.rebuildIndexCells(validCells<LeafCell>(page_), key_prefix)) {
+    throw std::logic_error(
+        "LeafIndexPage::setKeyPrefix: cells no longer fit the page");
   }
+}
 
-  page_.updateSlotCount(new_slot_count);
-  page_.updateSlotDirectoryOffset(write_offset);
-  page_.markDirty();
+bool LeafIndexPage::fillWith(const std::vector<LeafCell>& cells,
+                             const std::string& key_prefix) {
+  return page_.rebuildIndexCells(cells, key_prefix);
 }
 
 void LeafIndexPage::transferAndCompactTo(LeafIndexPage& dst,
                                          const std::string& separate_key) {
-  const int slot_count = page_.getSlotCount();
-  for (int idx = 0; idx < slot_count; ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-
-    const std::string cell_key = LeafCell::getKey(cell_data);
-    if (index_key::compare(cell_key, separate_key) > 0) {
-      dst.page_.insertCell(LeafCell::decodeCell(cell_data));
-      page_.invalidateSlot(idx);
-    }
-  }
-
-  uint16_t old_slot_count = page_.getSlotCount();
-
-  std::vector<LeafCell> cells;
-  cells.reserve(old_slot_count);
-  for (int i = 0; i < old_slot_count; ++i) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(i);
-    if (!Cell::isValid(cell_data)) {
-      continue;
+  std::vector<LeafCell> kept_cells;
+  std::vector<LeafCell> moved_cells;
+  for (LeafCell& cell : validCells<LeafCell>(page_)) {
+    if (index_key::compare(cell.key(), separate_key) > 0) {
+      moved_cells.push_back(std::move(cell));
+    } else {
+      kept_cells.push_back(std::move(cell));
     }
-    cells.push_back(cellAt(i));
   }
 
-  const uint16_t new_slot_count = static_cast<uint16_t>(cells.size());
-  if (new_slot_count == 0) {
+  if (kept_cells.empty()) {
     throw std::logic_error(
         "LeafIndexPage::transferAndCompactTo: new_slot_count == 0 (not "
         "implemented)");
   }
 
-  uint16_t write_offset = static_cast<uint16_t>(Page::PAGE_SIZE_BYTE);
-  for (uint16_t idx = 0; idx < new_slot_count; ++idx) {
-    const LeafCell& cell = cells[idx];
-    const uint16_t payload_size = static_cast<uint16_t>(cell.payloadSize());
-    write_offset = static_cast<uint16_t>(write_offset - payload_size);
-    char* cell_destination = page_.data() + write_offset;
-    std::vector<std::byte> serialized = cell.serialize();
-    std::memcpy(cell_destination, serialized.data(), serialized.size());
-
-    char* slot_pointer =
-        page_.data() + Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * idx;
-    std::memcpy(slot_pointer, &write_offset, sizeof(uint16_t));
+  // Both halves keep this page's key prefix until the caller narrows it.
+  if (!dst.page_.rebuildIndexCells(moved_cells, page_.keyPrefix()) ||
+      !page_.rebuildIndexCells(kept_cells, page_.keyPrefix())) {
+    throw std::logic_error(
+        "LeafIndexPage::transferAndCompactTo: cells do not fit after split");
   }
 
-  page_.updateSlotCount(new_slot_count);
-  page_.updateSlotDirectoryOffset(write_offset);
-  page_.markDirty();
-
   dbfs_log::index().info(
       "Completed transfer and compaction of LeafIndexPage. New slot count: {}, "
       "new slot directory offset: {}",
-      new_slot_count, write_offset);
+      page_.getSlotCount(), page_.getSlotDirectoryOffset());
 }
 
 IntermediateCell InternalIndexPage::cellAt(int slot_id) const {
-  return IntermediateCell::decodeCell(page_.getSlotCellStart(slot_id));
+  return IntermediateCell::decodeCell(page_.slotCellStartUnchecked(slot_id),
+                                      page_.keyPrefix());
 }
 
-uint16_t InternalIndexPage::rightMostChildPageId() const {
+PageId InternalIndexPage::rightMostChildPageId() const {
   return page_.rightMostChildPageId();
 }
 
 /**
  * returns the child page ID to follow for a given key
  * The child page ID is determined based on the separator keys in the internal
- * index page. The function iterates through the valid separator cells in the
- * page and compares their keys with the given key. It returns the page ID of
- * the first separator cell whose key is greater than or equal to the given key.
+ * index page. Since the slot pointers are sorted by key, the function binary
+ * searches them for the first separator cell whose key is greater than or
+ * equal to the given key and returns its page ID, skipping invalidated cells.
  * If no such separator cell is found, it returns the rightmost child page ID.
  */
-uint16_t InternalIndexPage::findChildPage(const std::string& key) {
-  std::vector<IntermediateCell> cells;
-  cells.reserve(page_.getSlotCount());
-  for (int idx = 0; idx < page_.getSlotCount(); ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-    cells.push_back(cellAt(idx));
-  }
-
-  std::sort(cells.begin(), cells.end(),
-            [](const IntermediateCell& a, const IntermediateCell& b) {
-              return index_key::compare(a.key(), b.key()) < 0;
-            });
-
-  for (const IntermediateCell& cell : cells) {
-    if (index_key::compare(cell.key(), key) >= 0) {
-      return cell.page_id();
+PageId InternalIndexPage::findChildPage(const std::string& key) {
+  const int slot_count = page_.getSlotCount();
+  for (int idx = page_.lowerBoundSlot(key); idx < slot_count; ++idx) {
+    const char* cell_data = page_.slotCellStartUnchecked(idx);
+    if (Cell::isValid(cell_data)) {
+      return IntermediateCell::getPageId(cell_data);
     }
   }
   dbfs_log::index().debug(
@@ -200,11 +162,35 @@ uint16_t InternalIndexPage::findChildPage(const std::string& key) {
   return rightMostChildPageId();
 }
 
+/**
+ * Like findChildPage(key), and narrows range, which holds the key range of
+ * this page, to that of the child: the separators on either side of it.
+ */
+PageId InternalIndexPage::findChildPage(const std::string& key,
+                                        BTreeCursor::KeyRange& range) {
+  const int slot_count = page_.getSlotCount();
+  const int bound = page_.lowerBoundSlot(key);
+  for (int idx = bound - 1; idx >= 0; --idx) {
+    if (Cell::isValid(page_.slotCellStartUnchecked(idx))) {
+      range.low = page_.indexKeyAt(idx);
+      break;
+    }
+  }
+  for (int idx = bound; idx < slot_count; ++idx) {
+    const char* cell_data = page_.slotCellStartUnchecked(idx);
+    if (Cell::isValid(cell_data)) {
+      range.high = page_.indexKeyAt(idx);
+      return IntermediateCell::getPageId(cell_data);
+    }
+  }
+  return rightMostChildPageId();
+}
+
 /**
  * Replace Cell which points to old_page_id from new_page_id
  */
-bool InternalIndexPage::replaceChildPageId(uint16_t old_page_id,
-                                           uint16_t new_page_id) {
+bool InternalIndexPage::replaceChildPageId(PageId old_page_id,
+                                           PageId new_page_id) {
   if (page_.rightMostChildPageId() == old_page_id) {
     page_.setRightMostChildPageId(new_page_id);
     page_.markDirty();
@@ -218,11 +204,11 @@ bool InternalIndexPage::replaceChildPageId(uint16_t old_page_id,
     }
 
     char* page_id_data = cell_data + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t);
-    if (readValue<uint16_t>(page_id_data) != old_page_id) {
+    if (readValue<PageId>(page_id_data) != old_page_id) {
       continue;
     }
 
-    std::memcpy(page_id_data, &new_page_id, sizeof(uint16_t));
+    std::memcpy(page_id_data, &new_page_id, sizeof(PageId));
     page_.markDirty();
     return true;
   }
@@ -231,56 +217,36 @@ bool InternalIndexPage::replaceChildPageId(uint16_t old_page_id,
 }
 
 void InternalIndexPage::compact() {
-  const uint16_t old_slot_count = page_.getSlotCount();
-  std::vector<IntermediateCell> cells;
-  cells.reserve(old_slot_count);
-  for (uint16_t idx = 0; idx < old_slot_count; ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-    cells.push_back(cellAt(idx));
-  }
-
-  const uint16_t new_slot_count = static_cast<uint16_t>(cells.size());
-  uint16_t write_offset = static_cast<uint16_t>(Page::PAGE_SIZE_BYTE);
-  for (uint16_t idx = 0; idx < new_slot_count; ++idx) {
-    const IntermediateCell& cell = cells[idx];
-    write_offset = static_cast<uint16_t>(write_offset - cell.payloadSize());
-    char* cell_destination = page_.data() + write_offset;
-    std::vector<std::byte> serialized = cell.serialize();
-    std::memcpy(cell_destination, serialized.data(), serialized.size());
+  setKeyPrefix(std::string(page_.keyPrefix()));
+}
 
-    char* slot_pointer =
-        page_.data() + Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * idx;
-    std::memcpy(slot_pointer, &write_offset, sizeof(uint16_t));
+void InternalIndexPage::setKeyPrefix(const std::string& key_prefix) {
+  if (!page_.rebuildIndexCells(validCells<IntermediateCell>(page_),
+                               key_prefix)) {
+    throw std::logic_error(
+        "InternalIndexPage::setKeyPrefix: cells no longer fit the page");
   }
+}
 
-  page_.updateSlotCount(new_slot_count);
-  page_.updateSlotDirectoryOffset(write_offset);
-  page_.markDirty();
+bool InternalIndexPage::fillWith(const std::vector<IntermediateCell>& cells,
+                                 const std::string& key_prefix) {
+  return page_.rebuildIndexCells(cells, key_prefix);
 }
 
 void InternalIndexPage::transferAndCompactTo(InternalIndexPage& dst,
                                              const std::string& separate_key) {
-  const uint16_t original_right_most_child = page_.rightMostChildPageId();
+  const PageId original_right_most_child = page_.rightMostChildPageId();
   std::optional<IntermediateCell> separator_cell;
-
-  const int slot_count = page_.getSlotCount();
-  for (int idx = 0; idx < slot_count; ++idx) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-
-    const std::string cell_key = IntermediateCell::getKey(cell_data);
-    const int compare = index_key::compare(cell_key, separate_key);
+  std::vector<IntermediateCell> kept_cells;
+  std::vector<IntermediateCell> moved_cells;
+  for (IntermediateCell& cell : validCells<IntermediateCell>(page_)) {
+    const int compare = index_key::compare(cell.key(), separate_key);
     if (compare < 0) {
-      dst.page_.insertCell(IntermediateCell::decodeCell(cell_data));
-      page_.invalidateSlot(idx);
+      moved_cells.push_back(std::move(cell));
     } else if (compare == 0) {
-      separator_cell = IntermediateCell::decodeCell(cell_data);
-      page_.invalidateSlot(idx);
+      separator_cell = std::move(cell);
+    } else {
+      kept_cells.push_back(std::move(cell));
     }
   }
 
@@ -288,50 +254,24 @@ void InternalIndexPage::transferAndCompactTo(InternalIndexPage& dst,
     throw std::logic_error(
         "InternalIndexPage::transferAndCompactTo: separator cell not found");
   }
-
-  dst.page_.setRightMostChildPageId(separator_cell->page_id());
-  dst.page_.markDirty();
-  page_.setRightMostChildPageId(original_right_most_child);
-
-  uint16_t old_slot_count = page_.getSlotCount();
-
-  std::vector<IntermediateCell> cells;
-  cells.reserve(old_slot_count);
-  for (int i = 0; i < old_slot_count; ++i) {
-    char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(i);
-    if (!Cell::isValid(cell_data)) {
-      continue;
-    }
-    cells.push_back(cellAt(i));
-  }
-
-  const uint16_t new_slot_count = static_cast<uint16_t>(cells.size());
-  if (new_slot_count == 0) {
+  if (kept_cells.empty()) {
     throw std::logic_error(
         "InternalIndexPage::transferAndCompactTo: new_slot_count == 0 (not "
         "implemented)");
   }
 
-  uint16_t write_offset = static_cast<uint16_t>(Page::PAGE_SIZE_BYTE);
-  for (uint16_t idx = 0; idx < new_slot_count; ++idx) {
-    const IntermediateCell& cell = cells[idx];
-    const uint16_t payload_size = static_cast<uint16_t>(cell.payloadSize());
-    write_offset = static_cast<uint16_t>(write_offset - payload_size);
-    char* cell_destination = page_.data() + write_offset;
-    std::vector<std::byte> serialized = cell.serialize();
-    std::memcpy(cell_destination, serialized.data(), serialized.size());
-
-    char* slot_pointer =
-        page_.data() + Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * idx;
-    std::memcpy(slot_pointer, &write_offset, sizeof(uint16_t));
+  dst.page_.setRightMostChildPageId(separator_cell->page_id());
+  page_.setRightMostChildPageId(original_right_most_child);
+  // Both halves keep this page's key prefix until the caller narrows it.
+  if (!dst.page_.rebuildIndexCells(moved_cells, page_.keyPrefix()) ||
+      !page_.rebuildIndexCells(kept_cells, page_.keyPrefix())) {
+    throw std::logic_error(
+        "InternalIndexPage::transferAndCompactTo: cells do not fit after "
+        "split");
   }
 
-  page_.updateSlotCount(new_slot_count);
-  page_.updateSlotDirectoryOffset(write_offset);
-  page_.markDirty();
-
   dbfs_log::index().info(
       "Completed transfer and compaction of InternalIndexPage. New slot count: "
       "{}, new slot directory offset: {}",
-      new_slot_count, write_offset);
+      page_.getSlotCount(), page_.getSlotDirectoryOffset());
 }
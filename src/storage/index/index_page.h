@@ -3,6 +3,7 @@
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 #include "index_key.h"
 #include "intermediate_cell.h"
@@ -16,8 +17,8 @@
 
 class LeafIndexPage {
  public:
-  static constexpr uint16_t NO_RIGHT_SIBLING =
-      65535;  // special page ID indicating no right sibling for leaf pages.
+  // special page ID indicating no right sibling for leaf pages.
+  static constexpr PageId NO_RIGHT_SIBLING = INVALID_PAGE_ID;
   explicit LeafIndexPage(Page& page) : page_(page) {
     if (!page_.isLeaf()) {
       throw std::logic_error("LeafIndexPage constructed with non-leaf Page");
@@ -29,19 +30,27 @@ class LeafIndexPage {
 
   LeafCell cellAt(int slot_id) const;
   bool hasKey(const std::string& key) const;
-  std::pair<uint16_t, std::vector<IndexEntry>> findEntries(
+  std::pair<PageId, std::vector<IndexEntry>> findEntries(
       BTreeCursor::Boundary left_boundary, BTreeCursor::Boundary right_boundary,
       bool do_invalidate);
   void compact();
+  // Re-encodes the page under key_prefix, which every key the page can be
+  // routed must start with: the common prefix of its key range's bounds.
+  void setKeyPrefix(const std::string& key_prefix);
+  // Replaces the page contents with cells, sorted by key and starting with
+  // key_prefix, for bulk loading. False, leaving the page as it was, if they
+  // do not fit.
+  bool fillWith(const std::vector<LeafCell>& cells,
+                const std::string& key_prefix);
   void getRightSidePageID();
 
   void transferAndCompactTo(LeafIndexPage& dst,
                             const std::string& separate_key);
 
-  uint16_t getRightSiblingPageId() {
+  PageId getRightSiblingPageId() {
     return this->page_.rightMostChildPageId();
   }
-  void setRightSiblingPageId(uint16_t page_id) {
+  void setRightSiblingPageId(PageId page_id) {
     this->page_.setRightMostChildPageId(page_id);
     this->page_.markDirty();
   }
@@ -62,35 +71,30 @@ class InternalIndexPage {
   const Page& page() const { return page_; }
 
   IntermediateCell cellAt(int slot_id) const;
-  uint16_t rightMostChildPageId() const;
-  uint16_t findChildPage(const std::string& key);
-  bool replaceChildPageId(uint16_t old_page_id, uint16_t new_page_id);
+  PageId rightMostChildPageId() const;
+  PageId findChildPage(const std::string& key);
+  PageId findChildPage(const std::string& key, BTreeCursor::KeyRange& range);
+  bool replaceChildPageId(PageId old_page_id, PageId new_page_id);
   void compact();
+  // See LeafIndexPage::setKeyPrefix.
+  void setKeyPrefix(const std::string& key_prefix);
+  // See LeafIndexPage::fillWith.
+  bool fillWith(const std::vector<IntermediateCell>& cells,
+                const std::string& key_prefix);
   void transferAndCompactTo(InternalIndexPage& dst,
                             const std::string& separate_key);
-  uint16_t leftMostChildPageId() const {
-    std::optional<IntermediateCell> leftmost;
-
-    for (int idx = 0; idx < page_.getSlotCount(); ++idx) {
-      char* cell_data = page_.data() + page_.getCellOffsetOnXthPointer(idx);
-      if (!Cell::isValid(cell_data)) {
-        continue;
-      }
-
-      IntermediateCell cell = cellAt(idx);
-      if (!leftmost.has_value() ||
-          index_key::compare(cell.key(), leftmost->key()) < 0) {
-        leftmost = cell;
+  PageId leftMostChildPageId() const {
+    // Slots are sorted by key, so the first valid one has the smallest key.
+    for (int idx = 0; idx < page_.slotCount(); ++idx) {
+      const char* cell_data = page_.slotCellStartUnchecked(idx);
+      if (Cell::isValid(cell_data)) {
+        return IntermediateCell::getPageId(cell_data);
       }
     }
 
-    if (!leftmost.has_value()) {
-      throw std::logic_error(
-          "InternalIndexPage::leftMostChildPageId: internal page has no valid "
-          "separator cell");
-    }
-
-    return leftmost->page_id();
+    throw std::logic_error(
+        "InternalIndexPage::leftMostChildPageId: internal page has no valid "
+        "separator cell");
   }
 
  private:
@@ -4,36 +4,53 @@
 
 /**
  * The structure of intermediate cell is as follows:
- * | key size (2 bytes) | page ID (2 bytes) | key bytes |
+ * | key size (2 bytes) | page ID (8 bytes) | key bytes |
+ * On an index page, the key bytes are what follows the page's key prefix.
  */
-IntermediateCell IntermediateCell::decodeCell(char* data_p) {
+IntermediateCell IntermediateCell::decodeCell(const char* data_p,
+                                              std::string_view key_prefix) {
   data_p += Cell::FLAG_FIELD_SIZE;
   uint16_t key_size = readValue<uint16_t>(data_p);
-  char* page_id_p = data_p + sizeof(uint16_t);
-  uint16_t cell_pageID = readValue<uint16_t>(page_id_p);
-  char* key_p = page_id_p + sizeof(uint16_t);
-  std::string cell_key(key_p, key_p + key_size);
+  const char* page_id_p = data_p + sizeof(uint16_t);
+  PageId cell_pageID = readValue<PageId>(page_id_p);
+  const char* key_p = page_id_p + sizeof(PageId);
+  std::string cell_key;
+  cell_key.reserve(key_prefix.size() + key_size);
+  cell_key.append(key_prefix);
+  cell_key.append(key_p, key_size);
   return IntermediateCell(cell_pageID, std::move(cell_key));
 }
 
 std::string IntermediateCell::getKey(const char* data_p) {
-  // Skip: FLAG (1 byte) + key_size (2 bytes) + page_id (2 bytes)
+  return std::string(getKeyView(data_p));
+}
+
+std::string_view IntermediateCell::getKeyView(const char* data_p) {
+  // Skip: FLAG (1 byte) + key_size (2 bytes) + page_id (8 bytes)
   const uint16_t key_size = readValue<uint16_t>(data_p + Cell::FLAG_FIELD_SIZE);
-  const char* key_p = data_p + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) * 2;
-  return std::string(key_p, key_p + key_size);
+  const char* key_p =
+      data_p + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(PageId);
+  return std::string_view(key_p, key_size);
 }
 
-std::vector<std::byte> IntermediateCell::serialize() const {
-  std::vector<std::byte> buffer(payloadSize());
+PageId IntermediateCell::getPageId(const char* data_p) {
+  return readValue<PageId>(data_p + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t));
+}
+
+std::vector<std::byte> IntermediateCell::serializeKeySuffix(
+    size_t key_prefix_size) const {
+  const uint16_t suffix_size =
+      static_cast<uint16_t>(key_size_ - key_prefix_size);
+  std::vector<std::byte> buffer(payloadSize() - key_prefix_size);
   char* dst = reinterpret_cast<char*>(buffer.data());
   uint8_t flags = 0;
   std::memcpy(dst, &flags, Cell::FLAG_FIELD_SIZE);
   dst += Cell::FLAG_FIELD_SIZE;
-  std::memcpy(dst, &key_size_, sizeof(uint16_t));
-  dst += sizeof(uint16_t);
-  std::memcpy(dst, &page_id_, sizeof(uint16_t));
+  std::memcpy(dst, &suffix_size, sizeof(uint16_t));
   dst += sizeof(uint16_t);
-  std::memcpy(dst, key_.data(), key_.size());
+  std::memcpy(dst, &page_id_, sizeof(PageId));
+  dst += sizeof(PageId);
+  std::memcpy(dst, key_.data() + key_prefix_size, suffix_size);
 
   return buffer;
 }
\ No newline at end of file
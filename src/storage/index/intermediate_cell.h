@@ -2,28 +2,40 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 #include "storage/page/cell.h"
+#include "storage/page/page_id.h"
 
 class IntermediateCell : public Cell {
  private:
   uint16_t key_size_;
-  uint16_t page_id_;
+  PageId page_id_;
   std::string key_;
 
  public:
-  static IntermediateCell decodeCell(char* data_p);
+  // Cells on an index page hold only the key suffix; pass the page's key
+  // prefix to get the full key back.
+  static IntermediateCell decodeCell(const char* data_p,
+                       std::string_view key_prefix = {});
   static std::string getKey(const char* data_p);
+  // The key bytes in place, without copying them out of the page.
+  static std::string_view getKeyView(const char* data_p);
+  static PageId getPageId(const char* data_p);
   const std::string& key() const override { return key_; }
-  uint16_t page_id() const { return page_id_; }
+  PageId page_id() const { return page_id_; }
   uint16_t key_size() const { return key_size_; }
   size_t payloadSize() const override {
-    return Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(uint16_t) +
+    return Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(PageId) +
            key_size_;
   }
-  std::vector<std::byte> serialize() const override;
+  std::vector<std::byte> serialize() const override {
+    return serializeKeySuffix(0);
+  }
+  std::vector<std::byte> serializeKeySuffix(
+      size_t key_prefix_size) const override;
   CellKind kind() const override { return CellKind::Intermediate; }
-  IntermediateCell(uint16_t page_id, std::string key)
+  IntermediateCell(PageId page_id, std::string key)
       : key_size_(static_cast<uint16_t>(key.size())),
         page_id_(page_id),
         key_(std::move(key)) {}
@@ -4,44 +4,57 @@
 
 /**
  * The structure of leaf cell is as follows:
- * | key size (2 bytes) | heap page ID (2 bytes) | slot ID (2 bytes) | key
+ * | key size (2 bytes) | heap page ID (8 bytes) | slot ID (2 bytes) | key
  * bytes |
+ * On an index page, the key bytes are what follows the page's key prefix.
  */
-LeafCell LeafCell::decodeCell(char* data_p) {
+LeafCell LeafCell::decodeCell(const char* data_p,
+                              std::string_view key_prefix) {
   data_p += Cell::FLAG_FIELD_SIZE;
   uint16_t key_size = readValue<uint16_t>(data_p);
   data_p += sizeof(uint16_t);
 
-  uint16_t heap_page_id = readValue<uint16_t>(data_p);
-  data_p += sizeof(uint16_t);
+  PageId heap_page_id = readValue<PageId>(data_p);
+  data_p += sizeof(PageId);
 
   uint16_t slot_id = readValue<uint16_t>(data_p);
   data_p += sizeof(uint16_t);
 
-  std::string key(data_p, data_p + key_size);
+  std::string key;
+  key.reserve(key_prefix.size() + key_size);
+  key.append(key_prefix);
+  key.append(data_p, key_size);
   return LeafCell(std::move(key), heap_page_id, slot_id);
 }
 
 std::string LeafCell::getKey(const char* data_p) {
+  return std::string(getKeyView(data_p));
+}
+
+std::string_view LeafCell::getKeyView(const char* data_p) {
   const uint16_t key_size = readValue<uint16_t>(data_p + Cell::FLAG_FIELD_SIZE);
-  const char* key_p = data_p + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) * 3;
-  return std::string(key_p, key_p + key_size);
+  const char* key_p = data_p + Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) * 2 +
+                      sizeof(PageId);
+  return std::string_view(key_p, key_size);
 }
 
-std::vector<std::byte> LeafCell::serialize() const {
-  std::vector<std::byte> buffer(payloadSize());
+std::vector<std::byte> LeafCell::serializeKeySuffix(
+    size_t key_prefix_size) const {
+  const uint16_t suffix_size =
+      static_cast<uint16_t>(key_size_ - key_prefix_size);
+  std::vector<std::byte> buffer(payloadSize() - key_prefix_size);
   char* dst = reinterpret_cast<char*>(buffer.data());
   uint8_t flags = 0;
   std::memcpy(dst, &flags, Cell::FLAG_FIELD_SIZE);
   dst += Cell::FLAG_FIELD_SIZE;
 
-  std::memcpy(dst, &key_size_, sizeof(uint16_t));
-  dst += sizeof(uint16_t);
-  std::memcpy(dst, &heap_page_id_, sizeof(uint16_t));
+  std::memcpy(dst, &suffix_size, sizeof(uint16_t));
   dst += sizeof(uint16_t);
+  std::memcpy(dst, &heap_page_id_, sizeof(PageId));
+  dst += sizeof(PageId);
   std::memcpy(dst, &slot_id_, sizeof(uint16_t));
   dst += sizeof(uint16_t);
-  std::memcpy(dst, key_.data(), key_.size());
+  std::memcpy(dst, key_.data() + key_prefix_size, suffix_size);
 
   return buffer;
 }
@@ -2,32 +2,43 @@
 #include <cstdint>
 #include <cstring>
 #include <string>
+#include <string_view>
 
 #include "storage/page/cell.h"
+#include "storage/page/page_id.h"
 
 class LeafCell : public Cell {
  private:
   uint16_t key_size_;
-  uint16_t heap_page_id_;
+  PageId heap_page_id_;
   uint16_t slot_id_;
   std::string key_;
 
  public:
-  static LeafCell decodeCell(char* data_p);
+  // Cells on an index page hold only the key suffix; pass the page's key
+  // prefix to get the full key back.
+  static LeafCell decodeCell(const char* data_p,
+                       std::string_view key_prefix = {});
   static std::string getKey(const char* data_p);
-  LeafCell(std::string key, uint16_t heap_page_id, uint16_t slot_id)
+  // The key bytes in place, without copying them out of the page.
+  static std::string_view getKeyView(const char* data_p);
+  LeafCell(std::string key, PageId heap_page_id, uint16_t slot_id)
       : key_size_(static_cast<uint16_t>(key.size())),
         heap_page_id_(heap_page_id),
         slot_id_(slot_id),
         key_(std::move(key)) {}
 
   const std::string& key() const override { return key_; }
-  uint16_t heap_page_id() const { return heap_page_id_; }
+  PageId heap_page_id() const { return heap_page_id_; }
   uint16_t slot_id() const { return slot_id_; }
   size_t payloadSize() const override {
-    return Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(uint16_t) +
+    return Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(PageId) +
            sizeof(uint16_t) + key_size_;
   }
-  std::vector<std::byte> serialize() const override;
+  std::vector<std::byte> serialize() const override {
+    return serializeKeySuffix(0);
+  }
+  std::vector<std::byte> serializeKeySuffix(
+      size_t key_prefix_size) const override;
   CellKind kind() const override { return CellKind::Leaf; }
 };
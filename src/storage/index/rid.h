@@ -3,8 +3,10 @@
 #include <cstdint>
 #include <string>
 
+#include "storage/page/page_id.h"
+
 struct RID {
-  uint16_t heap_page_id;
+  PageId heap_page_id;
   uint16_t slot_id;
 };
 
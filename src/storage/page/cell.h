@@ -37,6 +37,10 @@ class Cell {
   virtual ~Cell() = default;
   virtual size_t payloadSize() const = 0;
   virtual std::vector<std::byte> serialize() const = 0;
+  // Index cells only: serializes the cell without the first key_prefix_size
+  // key bytes, which an index page stores once for all its cells.
+  virtual std::vector<std::byte> serializeKeySuffix(
+      size_t key_prefix_size) const = 0;
   virtual CellKind kind() const = 0;
   virtual const std::string& key() const = 0;
 };
@@ -4,9 +4,12 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <limits>
 #include <optional>
 #include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
@@ -15,22 +18,46 @@
 #include "storage/index/leaf_cell.h"
 #include "storage/record/record_cell.h"
 
-namespace {}  // namespace
+namespace {
+
+// The first (up to) 8 bytes of a key suffix as a big-endian word, zero
+// padded, so that comparing words compares the bytes.
+std::uint64_t keyWord(std::string_view bytes) {
+  std::uint64_t word = 0;
+  std::memcpy(&word, bytes.data(), std::min(bytes.size(), sizeof(word)));
+  return __builtin_bswap64(word);
+}
+
+int sign(int value) { return (value > 0) - (value < 0); }
+
+// Orders the prefix of an index page against the start of a searched key:
+// -1 or 1 when every key on the page sorts before or after it, 0 when it
+// starts with the prefix.
+int comparePrefix(std::string_view prefix, std::string_view key) {
+  const size_t common = std::min(prefix.size(), key.size());
+  const int order =
+      sign(prefix.substr(0, common).compare(key.substr(0, common)));
+  if (order != 0) {
+    return order;
+  }
+  return key.size() < prefix.size() ? 1 : 0;
+}
+
+}  // namespace
 
 Page Page::initializeNew(char* page_buffer, PageKind kind,
-                         uint16_t right_most_child_page_id, uint16_t page_id) {
+                         PageId right_most_child_page_id, PageId page_id) {
   return Page(page_buffer, kind, right_most_child_page_id, page_id);
 }
 
-Page Page::wrapExisting(char* page_buffer, uint16_t page_id) {
+Page Page::wrapExisting(char* page_buffer, PageId page_id) {
   return Page(page_buffer, page_id);
 }
 
-Page::Page(char* page_buffer, PageKind kind, uint16_t right_most_child_page_id,
-           uint16_t page_id)
+Page::Page(char* page_buffer, PageKind kind, PageId right_most_child_page_id,
+           PageId page_id)
     : is_dirty_(false),
       page_id_(page_id),
-      parent_page_id_(-1),
       page_buffer_(page_buffer) {
   updateNodeTypeFlag(kind);
   updateSlotCount(0);
@@ -43,16 +70,38 @@ Page::Page(char* page_buffer, PageKind kind, uint16_t right_most_child_page_id,
     // TODO: fix method name to avoid confusion.
     setRightMostChildPageId(right_most_child_page_id);
   }
+  if (kind != PageKind::Heap) {
+    page_buffer_[KEY_PREFIX_SIZE_OFFSET] = 0;
+    setKeySuffixWidth(VARIABLE_KEY_SUFFIX);
+  } else {
+    setReclaimableBytes(0);
+    setFirstFreeSlot(0);
+    page_buffer_[FREE_SLOT_OFFSET] = Cell::FLAG_INVALID_MASK;
+    page_buffer_[DEAD_CELL_OFFSET] = Cell::FLAG_INVALID_MASK;
+  }
   updatePageLSN(0);
   markDirty();
 }
 
-Page::Page(char* page_buffer, uint16_t page_id)
+Page::Page(char* page_buffer, PageId page_id)
     : is_dirty_(false),
       page_id_(page_id),
-      parent_page_id_(-1),
       page_buffer_(page_buffer) {}
 
+Page::Page(const Page& other)
+    : is_dirty_(other.is_dirty_.load()),
+      rec_lsn_(other.rec_lsn_.load()),
+      page_id_(other.page_id_),
+      page_buffer_(other.page_buffer_) {}
+
+Page& Page::operator=(const Page& other) {
+  is_dirty_.store(other.is_dirty_.load());
+  rec_lsn_.store(other.rec_lsn_.load());
+  page_id_ = other.page_id_;
+  page_buffer_ = other.page_buffer_;
+  return *this;
+}
+
 /**
  * Attempts to append a serialized cell to this page.
  *
@@ -61,7 +110,8 @@ Page::Page(char* page_buffer, uint16_t page_id)
  *         `std::nullopt` otherwise.
  *
  * On success, this method updates the slot directory, advances the payload
- * boundary, and marks the page dirty.
+ * boundary, and marks the page dirty. Heap pages reuse their lowest free
+ * slot before adding one.
  */
 std::optional<int> Page::insertCell(
     const std::vector<std::byte>& serialized_cell) {
@@ -73,14 +123,24 @@ std::optional<int> Page::insertCell(
   dbfs_log::storage().debug(
       "Attempting to insert serialized cell into page ID {}", getPageID());
 
-  const size_t cell_content_start_offset = getSlotDirectoryOffset();
   const size_t existing_slot_end_offset =
       Page::HEADDER_SIZE_BYTE +
       Page::CELL_POINTER_SIZE * (static_cast<size_t>(getSlotCount()));
+  // Heap inserts take the lowest free slot, which needs no new cell pointer.
+  const std::optional<uint16_t> free_slot =
+      cell == nullptr && kind() == PageKind::Heap ? findFreeSlot()
+                                                  : std::nullopt;
+  const size_t needed_offset =
+      existing_slot_end_offset +
+      (free_slot ? 0 : Page::CELL_POINTER_SIZE) + serialized_cell.size();
+  if (cell == nullptr && kind() == PageKind::Heap &&
+      getSlotDirectoryOffset() < needed_offset && reclaimableBytes() > 0 &&
+      getSlotDirectoryOffset() + reclaimableBytes() >= needed_offset) {
+    compactHeapCells();
+  }
+  const size_t cell_content_start_offset = getSlotDirectoryOffset();
 
-  if (cell_content_start_offset < existing_slot_end_offset +
-                                      Page::CELL_POINTER_SIZE +
-                                      serialized_cell.size()) {
+  if (cell_content_start_offset < needed_offset) {
     dbfs_log::storage().debug(
         "This page does not have enough space to insert the cell anymore.");
     return std::nullopt;
@@ -99,34 +159,20 @@ std::optional<int> Page::insertCell(
 
   std::memcpy(cell_data_start, serialized_cell.data(), serialized_cell.size());
 
-  // For internal index page, we need to keep the cell pointers sorted by key in
-  // ascending order, so we need to find the correct position to insert the new
-  // cell pointer and shift the existing cell pointers if necessary.
+  // Index pages keep the cell pointers, invalidated ones included, sorted by
+  // key in ascending order, so we binary search for the position after the
+  // last key not greater than the new one and shift the pointers behind it.
   char* insert_slot_pointer = page_buffer_ + existing_slot_end_offset;
   int inserted_slot_id = getSlotCount();
   if (cell != nullptr && (cell->kind() == CellKind::Intermediate ||
                           cell->kind() == CellKind::Leaf)) {
     int slot_count = getSlotCount();
-    int insert_position = 0;
-    while (insert_position < slot_count) {
-      char* existing_cell_data_start =
-          page_buffer_ + getCellOffsetOnXthPointer(insert_position);
-
-      // skip the invalid cell, since we're never going to use them.
-      if (!Cell::isValid(existing_cell_data_start)) {
-        insert_position++;
-        continue;
-      }
-      std::string existing_cell_key;
-      if (cell->kind() == CellKind::Intermediate) {
-        existing_cell_key = IntermediateCell::getKey(existing_cell_data_start);
-      } else {
-        existing_cell_key = LeafCell::getKey(existing_cell_data_start);
-      }
-      if (cell->key() < existing_cell_key) {
-        break;
-      }
-      insert_position++;
+    const int insert_position = upperBoundSlot(cell->key());
+    const size_t suffix_size = cell->key().size() - keyPrefix().size();
+    if (slot_count == 0 && suffix_size <= MAX_FIXED_KEY_SUFFIX) {
+      setKeySuffixWidth(static_cast<uint8_t>(suffix_size));
+    } else if (slot_count == 0 || keySuffixWidth() != suffix_size) {
+      setKeySuffixWidth(VARIABLE_KEY_SUFFIX);
     }
     if (insert_position < slot_count) {
       // shift the existing cell pointers to the right to make space for the new
@@ -141,12 +187,20 @@ std::optional<int> Page::insertCell(
     insert_slot_pointer = page_buffer_ + Page::HEADDER_SIZE_BYTE +
                           Page::CELL_POINTER_SIZE * insert_position;
     inserted_slot_id = insert_position;
+  } else if (free_slot) {
+    insert_slot_pointer = page_buffer_ + Page::HEADDER_SIZE_BYTE +
+                          Page::CELL_POINTER_SIZE * *free_slot;
+    inserted_slot_id = *free_slot;
   }
   std::memcpy(insert_slot_pointer, &new_cell_start_offset, sizeof(uint16_t));
 
   // update headder.
   updateSlotDirectoryOffset(new_cell_start_offset);
-  updateSlotCount(getSlotCount() + 1);
+  if (free_slot) {
+    setFirstFreeSlot(static_cast<uint16_t>(*free_slot + 1));
+  } else {
+    updateSlotCount(getSlotCount() + 1);
+  }
 
   this->markDirty();
 
@@ -160,10 +214,158 @@ std::optional<int> Page::insertCell(
 std::optional<int> Page::insertCell(const Cell& cell) {
   dbfs_log::storage().debug("Attempting to insert {} cell into page ID {}",
                             static_cast<int>(cell.kind()), getPageID());
-  std::vector<std::byte> serialized_data = cell.serialize();
+  const std::string_view prefix = keyPrefix();
+  if (comparePrefix(prefix, cell.key()) != 0) {
+    // Keys are routed to the page by its parent's separators, whose common
+    // prefix the page's prefix is, so this is a routing bug.
+    throw std::logic_error(
+        "Page::insertCell: key outside the key prefix of page " +
+        std::to_string(getPageID()));
+  }
+  std::vector<std::byte> serialized_data =
+      cell.serializeKeySuffix(prefix.size());
   return insertCell(serialized_data, &cell);
 }
 
+template <typename IndexCell>
+bool Page::rebuildIndexCells(const std::vector<IndexCell>& cells,
+                             std::string_view key_prefix) {
+  if (key_prefix.size() > MAX_KEY_PREFIX_SIZE) {
+    throw std::logic_error("Page::rebuildIndexCells: key prefix too long");
+  }
+  size_t needed_bytes = Page::HEADDER_SIZE_BYTE;
+  for (const IndexCell& cell : cells) {
+    if (comparePrefix(key_prefix, cell.key()) != 0) {
+      throw std::logic_error(
+          "Page::rebuildIndexCells: key outside the key prefix");
+    }
+    needed_bytes +=
+        cell.payloadSize() - key_prefix.size() + Page::CELL_POINTER_SIZE;
+  }
+  if (needed_bytes > Page::PAGE_SIZE_BYTE) {
+    return false;
+  }
+
+  uint8_t suffix_width = VARIABLE_KEY_SUFFIX;
+  if (!cells.empty() &&
+      cells.front().key().size() - key_prefix.size() <= MAX_FIXED_KEY_SUFFIX) {
+    suffix_width =
+        static_cast<uint8_t>(cells.front().key().size() - key_prefix.size());
+  }
+  uint16_t write_offset = static_cast<uint16_t>(Page::PAGE_SIZE_BYTE);
+  for (size_t idx = 0; idx < cells.size(); ++idx) {
+    const IndexCell& cell = cells[idx];
+    if (cell.key().size() - key_prefix.size() != suffix_width) {
+      suffix_width = VARIABLE_KEY_SUFFIX;
+    }
+    std::vector<std::byte> serialized =
+        cell.serializeKeySuffix(key_prefix.size());
+    write_offset = static_cast<uint16_t>(write_offset - serialized.size());
+    std::memcpy(page_buffer_ + write_offset, serialized.data(),
+                serialized.size());
+    char* slot_pointer =
+        page_buffer_ + Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * idx;
+    std::memcpy(slot_pointer, &write_offset, sizeof(uint16_t));
+  }
+
+  updateSlotCount(static_cast<uint16_t>(cells.size()));
+  updateSlotDirectoryOffset(write_offset);
+  // key_prefix may view this page's own header.
+  std::memmove(page_buffer_ + KEY_PREFIX_OFFSET, key_prefix.data(),
+               key_prefix.size());
+  page_buffer_[KEY_PREFIX_SIZE_OFFSET] = static_cast<char>(key_prefix.size());
+  setKeySuffixWidth(suffix_width);
+  markDirty();
+  return true;
+}
+
+template bool Page::rebuildIndexCells(const std::vector<LeafCell>& cells,
+                                      std::string_view key_prefix);
+template bool Page::rebuildIndexCells(
+    const std::vector<IntermediateCell>& cells, std::string_view key_prefix);
+
+std::string_view Page::keyPrefix() const {
+  return std::string_view(
+      page_buffer_ + KEY_PREFIX_OFFSET,
+      readValue<uint8_t>(page_buffer_ + KEY_PREFIX_SIZE_OFFSET));
+}
+
+uint8_t Page::keySuffixWidth() const {
+  return readValue<uint8_t>(page_buffer_ + KEY_SUFFIX_WIDTH_OFFSET);
+}
+
+void Page::setKeySuffixWidth(uint8_t width) {
+  std::memcpy(page_buffer_ + KEY_SUFFIX_WIDTH_OFFSET, &width, sizeof(width));
+}
+
+std::string Page::indexKeyAt(int slot_id) const {
+  std::string key(keyPrefix());
+  key.append(keySuffixAt(slot_id));
+  return key;
+}
+
+int Page::compareKeyAt(int slot_id, std::string_view key) const {
+  const std::string_view prefix = keyPrefix();
+  const int prefix_order = comparePrefix(prefix, key);
+  if (prefix_order != 0) {
+    return prefix_order;
+  }
+  return sign(keySuffixAt(slot_id).compare(key.substr(prefix.size())));
+}
+
+int Page::lowerBoundSlot(std::string_view key) const {
+  const std::string_view prefix = keyPrefix();
+  const int prefix_order = comparePrefix(prefix, key);
+  if (prefix_order != 0) {
+    return prefix_order < 0 ? slotCount() : 0;
+  }
+  return boundSlotBySuffix(key.substr(prefix.size()), false);
+}
+
+int Page::upperBoundSlot(std::string_view key) const {
+  const std::string_view prefix = keyPrefix();
+  const int prefix_order = comparePrefix(prefix, key);
+  if (prefix_order != 0) {
+    return prefix_order < 0 ? slotCount() : 0;
+  }
+  return boundSlotBySuffix(key.substr(prefix.size()), true);
+}
+
+int Page::boundSlotBySuffix(std::string_view key_suffix, bool upper) const {
+  int low = 0;
+  int high = slotCount();
+  const uint8_t width = keySuffixWidth();
+  if (width != VARIABLE_KEY_SUFFIX) {
+    // Fixed-width suffixes, as all-integer keys have: one word comparison
+    // per probe, and the lengths only break ties.
+    const std::uint64_t key_word = keyWord(key_suffix);
+    const int length_order =
+        sign(static_cast<int>(width) - static_cast<int>(key_suffix.size()));
+    while (low < high) {
+      const int middle = low + (high - low) / 2;
+      const std::uint64_t word = keyWord(keySuffixAt(middle));
+      const int order =
+          word != key_word ? (word < key_word ? -1 : 1) : length_order;
+      if (order < 0 || (upper && order == 0)) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    return low;
+  }
+  while (low < high) {
+    const int middle = low + (high - low) / 2;
+    const int order = keySuffixAt(middle).compare(key_suffix);
+    if (order < 0 || (upper && order == 0)) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
 // private methods
 uint16_t Page::getCellOffsetOnXthPointer(int x) {
   char* slot_pointer =
@@ -171,6 +373,13 @@ uint16_t Page::getCellOffsetOnXthPointer(int x) {
   return readValue<uint16_t>(slot_pointer);
 }
 
+std::string_view Page::keySuffixAt(int slot_id) const {
+  const char* cell_data = slotCellStartUnchecked(slot_id);
+  return kind() == PageKind::InternalIndex
+             ? IntermediateCell::getKeyView(cell_data)
+             : LeafCell::getKeyView(cell_data);
+}
+
 char* Page::getSlotCellStart(int slot_id) {
   char* cell_data = page_buffer_ + getCellOffsetOnXthPointer(slot_id);
   if (!Cell::isValid(cell_data)) {
@@ -180,13 +389,13 @@ char* Page::getSlotCellStart(int slot_id) {
 }
 
 /**
- * This method is used for page splitting. It returns the cell that should be
+ * This method is used for page splitting. It returns the key that should be
  * used as the split key. The split key is typically the middle key of the page,
  * but if the middle key is invalid, we will try to find the next valid key
  * until we find one or we reach the end of the page.
- * @return pointer to the cell to be used for page separation.
+ * @return the full key (prefix included) to be used for page separation.
  */
-char* Page::getSplitKeyCellStart() {
+std::string Page::getSplitKey() {
   // Since the cell pointers are sorted, just return the key value of the cell
   // that the middle slot pointer points to.
   int middle_slot_index = getSlotCount() / 2;
@@ -194,7 +403,7 @@ char* Page::getSplitKeyCellStart() {
     char* cell_data =
         page_buffer_ + getCellOffsetOnXthPointer(middle_slot_index);
     if (Cell::isValid(cell_data)) {
-      return cell_data;
+      return indexKeyAt(middle_slot_index);
     }
     middle_slot_index++;
     if (middle_slot_index >= getSlotCount()) {
@@ -205,11 +414,141 @@ char* Page::getSplitKeyCellStart() {
 }
 
 void Page::invalidateSlot(uint16_t slot_id) {
-  char* cell_data = page_buffer_ + getCellOffsetOnXthPointer(slot_id);
+  const uint16_t offset = getCellOffsetOnXthPointer(slot_id);
+  char* cell_data = page_buffer_ + offset;
+  if (kind() == PageKind::Heap && Cell::isValid(cell_data)) {
+    setReclaimableBytes(static_cast<uint16_t>(
+        reclaimableBytes() + RecordCellView(cell_data).cellSize()));
+  }
   Cell::markInvalid(cell_data);
   markDirty();
 }
 
+size_t Page::heapFreeBytes() const {
+  if (!isInitialized()) {
+    return 0;
+  }
+  return freeGapBytes() + reclaimableBytes();
+}
+
+size_t Page::freeGapBytes() const {
+  const size_t slot_end_offset =
+      Page::HEADDER_SIZE_BYTE + Page::CELL_POINTER_SIZE * slotCount();
+  const size_t cell_start_offset =
+      readValue<uint16_t>(page_buffer_ + SLOT_DIRECTORY_OFFSET);
+  return cell_start_offset > slot_end_offset
+             ? cell_start_offset - slot_end_offset
+             : 0;
+}
+
+uint16_t Page::compactHeapCells(bool release_dead_slots) {
+  const uint16_t slot_count = getSlotCount();
+  const uint16_t cell_area_start = getSlotDirectoryOffset();
+  std::vector<std::pair<uint16_t, uint16_t>> cells;  // (offset, slot id)
+  cells.reserve(slot_count);
+  for (uint16_t slot_id = 0; slot_id < slot_count; ++slot_id) {
+    const uint16_t offset = getCellOffsetOnXthPointer(slot_id);
+    if (offset >= cell_area_start) {
+      cells.emplace_back(offset, slot_id);
+    }
+  }
+  std::sort(cells.begin(), cells.end());
+
+  // Copy the live cells, highest first, so they keep their order.
+  char compacted[Page::PAGE_SIZE_BYTE];
+  size_t write_offset = Page::PAGE_SIZE_BYTE;
+  uint16_t released = 0;
+  for (size_t i = cells.size(); i-- > 0;) {
+    const auto [offset, slot_id] = cells[i];
+    uint16_t new_offset =
+        release_dead_slots ? FREE_SLOT_OFFSET : DEAD_CELL_OFFSET;
+    if (Cell::isValid(page_buffer_ + offset)) {
+      const size_t end =
+          i + 1 < cells.size() ? cells[i + 1].first : Page::PAGE_SIZE_BYTE;
+      write_offset -= end - offset;
+      std::memcpy(compacted + write_offset, page_buffer_ + offset,
+                  end - offset);
+      new_offset = static_cast<uint16_t>(write_offset);
+    } else if (release_dead_slots) {
+      ++released;
+    }
+    std::memcpy(page_buffer_ + Page::HEADDER_SIZE_BYTE +
+                    Page::CELL_POINTER_SIZE * slot_id,
+                &new_offset, sizeof(uint16_t));
+  }
+  std::memcpy(page_buffer_ + write_offset, compacted + write_offset,
+              Page::PAGE_SIZE_BYTE - write_offset);
+  updateSlotDirectoryOffset(static_cast<uint16_t>(write_offset));
+  setReclaimableBytes(0);
+  page_buffer_[FREE_SLOT_OFFSET] = Cell::FLAG_INVALID_MASK;
+  page_buffer_[DEAD_CELL_OFFSET] = Cell::FLAG_INVALID_MASK;
+  markDirty();
+  if (!release_dead_slots) {
+    return 0;
+  }
+
+  // Free the slots earlier compactions left dead, then drop the free slots
+  // at the end of the slot array.
+  uint16_t first_free = slot_count;
+  uint16_t new_slot_count = 0;
+  for (uint16_t slot_id = 0; slot_id < slot_count; ++slot_id) {
+    uint16_t offset = getCellOffsetOnXthPointer(slot_id);
+    if (offset == DEAD_CELL_OFFSET) {
+      offset = FREE_SLOT_OFFSET;
+      std::memcpy(page_buffer_ + Page::HEADDER_SIZE_BYTE +
+                      Page::CELL_POINTER_SIZE * slot_id,
+                  &offset, sizeof(uint16_t));
+      ++released;
+    }
+    if (offset == FREE_SLOT_OFFSET) {
+      first_free = std::min(first_free, slot_id);
+    } else {
+      new_slot_count = static_cast<uint16_t>(slot_id + 1);
+    }
+  }
+  updateSlotCount(new_slot_count);
+  setFirstFreeSlot(std::min(first_free, new_slot_count));
+  return released;
+}
+
+bool Page::hasDeadSlots() const {
+  const char* dead_cell = page_buffer_ + DEAD_CELL_OFFSET;
+  for (uint16_t slot_id = 0; slot_id < slotCount(); ++slot_id) {
+    if (slotCellStartUnchecked(slot_id) == dead_cell) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::optional<uint16_t> Page::findFreeSlot() const {
+  const char* free_slot = page_buffer_ + FREE_SLOT_OFFSET;
+  for (uint16_t slot_id = firstFreeSlot(); slot_id < slotCount(); ++slot_id) {
+    if (slotCellStartUnchecked(slot_id) == free_slot) {
+      return slot_id;
+    }
+  }
+  return std::nullopt;
+}
+
+uint16_t Page::reclaimableBytes() const {
+  return readValue<uint16_t>(page_buffer_ + RECLAIMABLE_BYTES_OFFSET);
+}
+
+void Page::setReclaimableBytes(uint16_t bytes) {
+  std::memcpy(page_buffer_ + RECLAIMABLE_BYTES_OFFSET, &bytes,
+              sizeof(uint16_t));
+}
+
+uint16_t Page::firstFreeSlot() const {
+  return readValue<uint16_t>(page_buffer_ + FIRST_FREE_SLOT_OFFSET);
+}
+
+void Page::setFirstFreeSlot(uint16_t slot_id) {
+  std::memcpy(page_buffer_ + FIRST_FREE_SLOT_OFFSET, &slot_id,
+              sizeof(uint16_t));
+}
+
 uint16_t Page::getSlotCount() {
   return readValue<uint16_t>(page_buffer_ + SLOT_COUNT_OFFSET);
 }
@@ -276,13 +615,17 @@ const char* Page::slotCellStartUnchecked(int slot_id) const {
                              Page::CELL_POINTER_SIZE * slot_id);
 }
 
-uint16_t Page::rightMostChildPageId() const {
-  return readValue<uint16_t>(page_buffer_ + RIGHT_MOST_CHILD_POINTER_OFFSET);
+PageId Page::rightMostChildPageId() const {
+  return readValue<PageId>(page_buffer_ + RIGHT_MOST_CHILD_POINTER_OFFSET);
 }
 
-void Page::setRightMostChildPageId(uint16_t page_id) {
+void Page::setRightMostChildPageId(PageId page_id) {
   std::memcpy(page_buffer_ + RIGHT_MOST_CHILD_POINTER_OFFSET, &page_id,
-              sizeof(uint16_t));
+              sizeof(PageId));
+}
+
+bool Page::isInitialized() const {
+  return readValue<uint16_t>(page_buffer_ + SLOT_DIRECTORY_OFFSET) != 0;
 }
 
 std::uint64_t Page::getPageLSN() const {
@@ -1,9 +1,14 @@
 #pragma once
+#include <atomic>
+#include <cstdint>
 #include <optional>
+#include <string>
+#include <string_view>
 #include <utility>
 #include <vector>
 
 #include "cell.h"
+#include "page_id.h"
 
 class LeafIndexPage;
 class InternalIndexPage;
@@ -18,13 +23,36 @@ enum class PageKind { Heap, LeafIndex, InternalIndex };
  *   page, 2 for heap page.
  * - slot count (2 bytes): the number of cells in the page.
  * - slot directory offset (2 bytes): the offset of the start of the cell area.
- * - intermediate pages : right-most child pointer (2 bytes): valid
- *   - leaf pages : right sibling page id (2 bytes)
- * - page LSN (8 bytes): LSN of the latest WAL record whose effects are
- * reflected in this page (used for WAL / recovery coordination). The remaining
- * bytes in the 256-byte header are reserved for future use.
+ * - intermediate pages : right-most child pointer (8 bytes): valid
+ *   - leaf pages : right sibling page id (8 bytes)
+ * - page LSN (8 bytes): end LSN (the byte offset just past the record) of
+ * the latest WAL record whose effects are reflected in this page, 0 if none.
+ * Used for WAL / recovery coordination: a record is already applied iff its
+ * LSN is below the page LSN.
+ * - index pages : key prefix size (1 byte), key suffix width (1 byte) and the
+ *   key prefix bytes (up to MAX_KEY_PREFIX_SIZE). Every key on the page starts
+ *   with the prefix, and cells store only the rest. The suffix width is set
+ *   when all suffixes have the same length of at most 8 bytes, so searches
+ *   can compare them as integers; otherwise it is VARIABLE_KEY_SUFFIX.
+ * - heap pages : reclaimable bytes (2 bytes, after the key prefix area), the
+ *   size of the invalidated cells still in the cell area, then the first
+ *   free slot (2 bytes): no slot below it is free.
+ * - the header's last two bytes are invalid cell flags that heap slots point
+ *   to once their cells are reclaimed: the free slot flag, then the dead
+ *   cell flag.
+ * The remaining bytes in the 256-byte header are reserved for future use.
+ *
+ * Heap cells never move while their page has room. When an insert does not
+ * fit but invalidated cells would make room, the live cells are packed
+ * against the end of the page and the freed slots keep pointing at the dead
+ * cell flag. Slot ids are RIDs, so such a dead slot is only made free, and
+ * reused by the next insert, once the vacuum knows nothing holds its RID any
+ * more; see compactHeapCells().
  */
 class Page {
+ public:
+  static constexpr size_t MAX_KEY_PREFIX_SIZE = 128;
+
  private:
   static constexpr size_t NODE_TYPE_FLAG_OFFSET = 0;
   static constexpr size_t SLOT_COUNT_OFFSET =
@@ -34,44 +62,109 @@ class Page {
   static constexpr size_t RIGHT_MOST_CHILD_POINTER_OFFSET =
       SLOT_DIRECTORY_OFFSET + sizeof(uint16_t);
   static constexpr size_t PAGE_LSN_OFFSET =
-      RIGHT_MOST_CHILD_POINTER_OFFSET + sizeof(uint16_t);
+      RIGHT_MOST_CHILD_POINTER_OFFSET + sizeof(PageId);
+  static constexpr size_t KEY_PREFIX_SIZE_OFFSET =
+      PAGE_LSN_OFFSET + sizeof(std::uint64_t);
+  static constexpr size_t KEY_SUFFIX_WIDTH_OFFSET =
+      KEY_PREFIX_SIZE_OFFSET + sizeof(uint8_t);
+  static constexpr size_t KEY_PREFIX_OFFSET =
+      KEY_SUFFIX_WIDTH_OFFSET + sizeof(uint8_t);
+  // Past the key prefix bytes of index pages.
+  static constexpr size_t RECLAIMABLE_BYTES_OFFSET =
+      KEY_PREFIX_OFFSET + MAX_KEY_PREFIX_SIZE;
+  static constexpr size_t FIRST_FREE_SLOT_OFFSET =
+      RECLAIMABLE_BYTES_OFFSET + sizeof(uint16_t);
+  // The last two bytes of the header.
+  static constexpr size_t FREE_SLOT_OFFSET = 254;
+  static constexpr size_t DEAD_CELL_OFFSET = 255;
+  static_assert(FIRST_FREE_SLOT_OFFSET + sizeof(uint16_t) <= FREE_SLOT_OFFSET,
+                "the key prefix area overlaps the heap header fields");
+  static constexpr uint8_t VARIABLE_KEY_SUFFIX = 0xFF;
+  static constexpr size_t MAX_FIXED_KEY_SUFFIX = sizeof(std::uint64_t);
   uint16_t getCellOffsetOnXthPointer(int x);
   uint16_t getSlotCount();
   uint16_t getSlotDirectoryOffset();
   void updateSlotCount(uint16_t new_count);
   void updateSlotDirectoryOffset(uint16_t new_offset);
   void updateNodeTypeFlag(PageKind kind);
-  uint16_t rightMostChildPageId() const;
-  void setRightMostChildPageId(uint16_t page_id);
+  PageId rightMostChildPageId() const;
+  void setRightMostChildPageId(PageId page_id);
   void updatePageLSN(std::uint64_t lsn);
+  void setReclaimableBytes(uint16_t bytes);
+  uint16_t firstFreeSlot() const;
+  void setFirstFreeSlot(uint16_t slot_id);
+  // Heap pages: the lowest free slot, if any.
+  std::optional<uint16_t> findFreeSlot() const;
   std::optional<int> insertCell(const std::vector<std::byte>& serialized_cell,
                                 const Cell* cell);
-  bool is_dirty_ = false;
-  int page_id_ = -1;
-  int parent_page_id_ = HAS_NO_PARENT;
+  // Key bytes an index page slot stores after the key prefix, viewed in
+  // place.
+  std::string_view keySuffixAt(int slot_id) const;
+  uint8_t keySuffixWidth() const;
+  void setKeySuffixWidth(uint8_t width);
+  // Slot search over key suffixes, for a key that starts with the prefix.
+  int boundSlotBySuffix(std::string_view key_suffix, bool upper) const;
+  /**
+   * Replaces the contents of an index page with cells, which must be sorted
+   * by key and all start with key_prefix; the prefix is stored once and the
+   * cells hold only the rest of their keys. Returns false, leaving the page
+   * unchanged, if the cells do not fit.
+   */
+  template <typename IndexCell>
+  bool rebuildIndexCells(const std::vector<IndexCell>& cells,
+                         std::string_view key_prefix);
+  /**
+   * Index pages keep every slot pointer, including those of invalidated
+   * cells, in ascending key order, so the slot directory can be binary
+   * searched. Returns the first slot for which is_before(key) is false;
+   * is_before must hold for a prefix of the slots and not after it.
+   */
+  template <typename IsBefore>
+  int partitionSlots(IsBefore is_before) const {
+    std::string key(keyPrefix());
+    const size_t prefix_size = key.size();
+    int low = 0;
+    int high = slotCount();
+    while (low < high) {
+      const int middle = low + (high - low) / 2;
+      key.resize(prefix_size);
+      key.append(keySuffixAt(middle));
+      if (is_before(std::string_view(key))) {
+        low = middle + 1;
+      } else {
+        high = middle;
+      }
+    }
+    return low;
+  }
+  // Read by eviction and traversal on other threads while the page is
+  // pinned, hence atomic.
+  std::atomic<bool> is_dirty_{false};
+  // Set by the pinned writer, read by checkpoints.
+  std::atomic<std::uint64_t> rec_lsn_{~std::uint64_t{0}};
+  PageId page_id_ = INVALID_PAGE_ID;
 
   friend class LeafIndexPage;
   friend class InternalIndexPage;
 
  public:
-  static constexpr int HAS_NO_PARENT = -1;
   static constexpr size_t HEADDER_SIZE_BYTE = 256;
   static Page initializeNew(char* page_buffer, PageKind kind,
-                            uint16_t right_most_child_page_id,
-                            uint16_t page_id);
-  static Page wrapExisting(char* page_buffer, uint16_t page_id);
+                            PageId right_most_child_page_id,
+                            PageId page_id);
+  static Page wrapExisting(char* page_buffer, PageId page_id);
+  Page(const Page& other);
+  Page& operator=(const Page& other);
   void markDirty() { is_dirty_ = true; };
-  void clearDirty() { is_dirty_ = false; };
-  bool isDirty() const { return is_dirty_; };
-  int getPageID() const { return page_id_; };
-  int getParentPageID() const { return parent_page_id_; };
-  // parent pageID will be collected on traversal (at least) for now.
-  void setParentPageID(int parent_page_id) {
-    parent_page_id_ = parent_page_id;
+  void clearDirty() {
+    is_dirty_ = false;
+    rec_lsn_ = NO_REC_LSN;
   };
+  bool isDirty() const { return is_dirty_; };
+  PageId getPageID() const { return page_id_; };
   PageKind kind() const;
   bool isLeaf() const;
-  char* getSplitKeyCellStart();
+  std::string getSplitKey();
   static constexpr size_t PAGE_SIZE_BYTE = 4096;
   static constexpr size_t CELL_POINTER_SIZE = sizeof(uint16_t);
   char* data() { return page_buffer_; }
@@ -83,7 +176,53 @@ class Page {
   std::optional<int> insertCell(const std::vector<std::byte>& serialized_cell);
   std::optional<int> insertCell(const Cell& cell);
   void invalidateSlot(uint16_t slot_id);
+  /**
+   * Heap pages: bytes an insert can use, a new slot pointer included. Counts
+   * the space of invalidated cells, which insertCell reclaims by compacting
+   * the page when it needs it. 0 for a page that is not initialized.
+   */
+  size_t heapFreeBytes() const;
+  // Bytes between the slot pointers and the cells, which an insert can use
+  // without compacting, its slot pointer included.
+  size_t freeGapBytes() const;
+  // Heap pages: bytes of invalidated cells that compaction would free.
+  uint16_t reclaimableBytes() const;
+  /**
+   * Heap pages: packs the live cells against the page end, keeping their
+   * slot ids, and points the slots of invalidated cells at DEAD_CELL_OFFSET.
+   *
+   * With release_dead_slots, those slots and the ones earlier compactions
+   * left dead become free instead, and free slots at the end of the slot
+   * array are dropped. insertCell() takes the lowest free slot before it
+   * adds one, so only pass it when no RID of a dead slot can still be in
+   * use. Returns the number of slots made free.
+   */
+  uint16_t compactHeapCells(bool release_dead_slots = false);
+  // Heap pages: whether a slot is dead, i.e. reclaimed but not yet free.
+  bool hasDeadSlots() const;
+  // Index pages: the prefix every key on the page starts with.
+  std::string_view keyPrefix() const;
+  // Index pages: the full key of a slot, valid or not.
+  std::string indexKeyAt(int slot_id) const;
+  // Index pages: compares the key of a slot with key, as index_key::compare.
+  int compareKeyAt(int slot_id, std::string_view key) const;
+  // Index pages: the first slot whose key is not less than key.
+  int lowerBoundSlot(std::string_view key) const;
+  // Index pages: the first slot whose key is greater than key.
+  int upperBoundSlot(std::string_view key) const;
+  // False for a page read from a hole in its file, which is all zeros;
+  // initialized pages always have a non-zero slot directory offset.
+  bool isInitialized() const;
   std::uint64_t getPageLSN() const;
+  static constexpr std::uint64_t NO_REC_LSN = ~std::uint64_t{0};
+  // LSN of the first logged change since the page was last written back
+  // (its recLSN), NO_REC_LSN if none. Kept in memory for checkpoints.
+  std::uint64_t getRecLSN() const { return rec_lsn_; }
+  void noteRecLSN(std::uint64_t lsn) {
+    if (rec_lsn_ == NO_REC_LSN) {
+      rec_lsn_ = lsn;
+    }
+  }
   void setPageLSN(std::uint64_t lsn) {
     updatePageLSN(lsn);
     markDirty();
@@ -92,7 +231,7 @@ class Page {
 
  private:
   char* page_buffer_;
-  Page(char* page_buffer, PageKind kind, uint16_t right_most_child_page_id,
-       uint16_t page_id);
-  Page(char* page_buffer, uint16_t page_id);
+  Page(char* page_buffer, PageKind kind, PageId right_most_child_page_id,
+       PageId page_id);
+  Page(char* page_buffer, PageId page_id);
 };
@@ -0,0 +1,12 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * Number of a page within its relation file. Page ids are 64 bits wherever
+ * they are stored (file headers, page headers, index cells, RIDs and WAL
+ * records), so a relation is bounded by its segment files, not by its ids.
+ */
+using PageId = std::uint64_t;
+
+// No page: a missing right sibling or child, or an empty buffer frame.
+constexpr PageId INVALID_PAGE_ID = ~PageId{0};
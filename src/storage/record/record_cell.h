@@ -17,7 +17,9 @@
  *  - byte[0]: per-cell flags (bit0 = invalid)
  *  - byte[1..2]: variable-length payload begin offset(y)
  *  - byte[3..6]: NULL bit map
- *  - byte[7..y-1]: fixed-length payload bytes
+ *  - byte[7..8]: cell size in bytes, so a page can tell how much an
+ *    invalidated cell frees without knowing the schema
+ *  - byte[9..y-1]: fixed-length payload bytes
  *  - byte[y..]: variable-length payload bytes
  *    - variable-column end offset table (uint16_t * var_count)
  *    - variable-length payload bytes
@@ -34,8 +36,10 @@
  */
 
 struct RecordCellLayout {
-  static constexpr uint16_t HEADER_SIZE_BYTE =
+  static constexpr uint16_t CELL_SIZE_OFFSET =
       Cell::FLAG_FIELD_SIZE + sizeof(uint16_t) + sizeof(uint32_t);
+  static constexpr uint16_t HEADER_SIZE_BYTE =
+      CELL_SIZE_OFFSET + sizeof(uint16_t);
 };
 
 class RecordCellView {
@@ -50,6 +54,11 @@ class RecordCellView {
     return (null_bitmap & (1u << x)) != 0;
   }
 
+  uint16_t cellSize() const {
+    return readValue<uint16_t>(cell_start_ +
+                               RecordCellLayout::CELL_SIZE_OFFSET);
+  }
+
   const char* getFixedPayloadBegin() const {
     return cell_start_ + RecordCellLayout::HEADER_SIZE_BYTE;
   }
@@ -1,6 +1,7 @@
 #include "record_serializer.h"
 
 #include <cstring>
+#include <limits>
 #include <stdexcept>
 
 namespace {
@@ -133,9 +134,13 @@ RecordSerializer::RecordSerializer(const Schema& schema, const TypedRow& row)
   const uint16_t variable_length_payload_begin_offset = static_cast<uint16_t>(
       RecordCellLayout::HEADER_SIZE_BYTE + fixed_payload_size);
 
-  serialized_bytes_.resize(RecordCellLayout::HEADER_SIZE_BYTE +
-                           fixed_payload_size + variable_table_size +
-                           variable_payload_data_size);
+  const std::size_t cell_size = RecordCellLayout::HEADER_SIZE_BYTE +
+                                fixed_payload_size + variable_table_size +
+                                variable_payload_data_size;
+  if (cell_size > std::numeric_limits<uint16_t>::max()) {
+    throw std::runtime_error("Record is too large to serialize.");
+  }
+  serialized_bytes_.resize(cell_size);
 
   char* dst = reinterpret_cast<char*>(serialized_bytes_.data());
 
@@ -150,6 +155,10 @@ RecordSerializer::RecordSerializer(const Schema& schema, const TypedRow& row)
   std::memcpy(dst, &null_bitmap, sizeof(uint32_t));
   dst += sizeof(uint32_t);
 
+  const uint16_t stored_cell_size = static_cast<uint16_t>(cell_size);
+  std::memcpy(dst, &stored_cell_size, sizeof(uint16_t));
+  dst += sizeof(uint16_t);
+
   char* fixed_payload_dst = dst;
   char* variable_table_dst = reinterpret_cast<char*>(serialized_bytes_.data()) +
                              variable_length_payload_begin_offset;
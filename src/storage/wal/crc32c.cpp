@@ -0,0 +1,60 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+namespace crc32c {
+
+namespace {
+
+constexpr std::uint32_t POLYNOMIAL = 0x82F63B78;  // Reflected 0x1EDC6F41.
+
+using Tables = std::array<std::array<std::uint32_t, 256>, 8>;
+
+constexpr Tables makeTables() {
+  Tables tables{};
+  for (std::uint32_t byte = 0; byte < 256; ++byte) {
+    std::uint32_t crc = byte;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  // tables[k][b] is the CRC of b followed by k zero bytes.
+  for (std::uint32_t byte = 0; byte < 256; ++byte) {
+    for (size_t k = 1; k < 8; ++k) {
+      const std::uint32_t previous = tables[k - 1][byte];
+      tables[k][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables TABLES = makeTables();
+
+}  // namespace
+
+std::uint32_t extend(std::uint32_t crc, const std::byte* data,
+                     std::size_t size) {
+  const auto* p = reinterpret_cast<const unsigned char*>(data);
+  crc = ~crc;
+  while (size >= 8) {
+    std::uint32_t low = 0;
+    std::uint32_t high = 0;
+    std::memcpy(&low, p, sizeof(low));
+    std::memcpy(&high, p + 4, sizeof(high));
+    low ^= crc;
+    crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^
+          TABLES[5][(low >> 16) & 0xFF] ^ TABLES[4][low >> 24] ^
+          TABLES[3][high & 0xFF] ^ TABLES[2][(high >> 8) & 0xFF] ^
+          TABLES[1][(high >> 16) & 0xFF] ^ TABLES[0][high >> 24];
+    p += 8;
+    size -= 8;
+  }
+  while (size-- > 0) {
+    crc = (crc >> 8) ^ TABLES[0][(crc ^ *p++) & 0xFF];
+  }
+  return ~crc;
+}
+
+}  // namespace crc32c
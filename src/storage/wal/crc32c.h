@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crc32c {
+
+// CRC-32C (Castagnoli) of size bytes at data, continuing from crc, which is
+// 0 for the first chunk. Table-driven, eight bytes per step.
+std::uint32_t extend(std::uint32_t crc, const std::byte* data,
+                     std::size_t size);
+
+inline std::uint32_t value(const std::byte* data, std::size_t size) {
+  return extend(0, data, size);
+}
+
+}  // namespace crc32c
@@ -6,9 +6,9 @@ LSNAllocator::LSNAllocator(LSNAllocator::value_type start) noexcept
 LSNAllocator::value_type LSNAllocator::allocate(
     std::size_t record_size_bytes) noexcept {
   const auto delta = static_cast<value_type>(record_size_bytes);
-  return next_.fetch_add(delta, std::memory_order_relaxed);
+  return next_.fetch_add(delta, std::memory_order_acq_rel);
 }
 
 LSNAllocator::value_type LSNAllocator::current() const noexcept {
-  return next_.load(std::memory_order_relaxed);
+  return next_.load(std::memory_order_acquire);
 }
\ No newline at end of file
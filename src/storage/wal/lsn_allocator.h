@@ -17,6 +17,9 @@
  * - allocate() is safe to call from multiple writer threads.
  * - Internally it uses an atomic fetch_add to ensure unique,
  *   strictly increasing LSNs without external locking.
+ * - allocate() releases and current() acquires, so a thread that observes
+ *   an allocation through current() also sees what the allocating thread
+ *   wrote before allocate() (the WAL's insertion slot reservation).
  */
 class LSNAllocator {
  public:
@@ -1,131 +1,432 @@
 #include "wal.h"
 
 #include <fcntl.h>
+#include <spdlog/spdlog.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
-#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+#include <string>
 #include <system_error>
+#include <vector>
+
+#include "logging.h"
+#include "util.h"
+#include "wal_directory.h"
+#include "wal_reader.h"
 
 namespace {
 
+// Cuts the log at end_lsn: the segment holding it is shortened and later
+// segments are removed.
+void truncateLogAt(const std::string& wal_dir,
+                   const std::vector<WALSegment>& segments,
+                   std::uint64_t end_lsn) {
+  for (const WALSegment& segment : segments) {
+    if (segment.start_lsn >= end_lsn) {
+      std::filesystem::remove(segment.path);
+    } else if (segment.start_lsn + segment.size_bytes > end_lsn) {
+      std::filesystem::resize_file(segment.path, end_lsn - segment.start_lsn);
+    }
+  }
+  WALDirectory::syncDirectory(wal_dir);
+}
+
 std::pair<std::uint64_t, std::uint64_t> readWalBootstrapState(
-    const std::string& wal_path) {
-  std::ifstream wal_file(wal_path, std::ios::binary | std::ios::ate);
-  if (!wal_file) {
-    throw std::system_error(errno ? errno : ENOENT, std::generic_category(),
-                            "Failed to open existing WAL file");
+    const std::string& wal_dir) {
+  if (!std::filesystem::is_directory(wal_dir)) {
+    throw std::system_error(ENOENT, std::generic_category(),
+                            "Failed to open existing WAL directory");
+  }
+  // Everything before the latest checkpoint is known to be complete, so
+  // startup only has to read from there.
+  std::uint64_t start_lsn = 0;
+  if (const auto checkpoint_lsn = WALDirectory::readCheckpointLSN(wal_dir)) {
+    start_lsn = *checkpoint_lsn;
+  } else if (const auto segments = WALDirectory::listSegments(wal_dir);
+             !segments.empty()) {
+    start_lsn = segments.front().start_lsn;
   }
 
-  const auto file_size = wal_file.tellg();
-  if (file_size < 0) {
-    throw std::runtime_error("Failed to determine WAL size during bootstrap");
+  WALReader reader(wal_dir, start_lsn);
+  std::uint64_t last_record_lsn = 0;
+  while (const auto record = reader.next()) {
+    last_record_lsn = record->get_lsn();
   }
 
-  const auto next_lsn = static_cast<std::uint64_t>(file_size);
-  if (next_lsn == 0) {
-    return {0, 0};
+  const std::uint64_t next_lsn = reader.validEndLSN();
+  if (reader.hasTornTail()) {
+    // Bytes past the last complete record were never acknowledged to a
+    // committer, so drop them and append from the end of the valid log.
+    dbfs_log::storage().warn(
+        "Truncating torn WAL tail of {} bytes at LSN {} in {}",
+        reader.endOfSegmentsLSN() - next_lsn, next_lsn, wal_dir);
+    truncateLogAt(wal_dir, reader.segments(), next_lsn);
   }
+  return {next_lsn, last_record_lsn};
+}
 
-  wal_file.seekg(0, std::ios::beg);
+size_t ringCapacityFromEnv() {
+  constexpr std::uint64_t kDefaultBytes = 4 << 20;
+  constexpr std::uint64_t kMinBytes = 64 << 10;
+  std::uint64_t bytes =
+      dbfs_util::unsignedFromEnv("DBFS_WAL_BUFFER_BYTES", kDefaultBytes);
+  bytes = std::max(bytes, kMinBytes);
+  size_t capacity = 1;
+  while (capacity < bytes) {
+    capacity <<= 1;
+  }
+  return capacity;
+}
 
-  std::uint64_t offset = 0;
-  std::uint64_t last_record_lsn = 0;
+std::uint64_t segmentBytesFromEnv() {
+  constexpr std::uint64_t kDefaultBytes = 16 << 20;
+  constexpr std::uint64_t kMinBytes = 64 << 10;
+  return std::max(
+      dbfs_util::unsignedFromEnv("DBFS_WAL_SEGMENT_BYTES", kDefaultBytes),
+      kMinBytes);
+}
 
-  while (offset < next_lsn) {
-    if (next_lsn - offset < WALRecord::header_size_bytes()) {
-      throw std::runtime_error("Incomplete WAL header during bootstrap");
-    }
+}  // namespace
 
-    wal_file.read(reinterpret_cast<char*>(&last_record_lsn),
-                  sizeof(last_record_lsn));
-    uint32_t body_size = 0;
-    // We already consumed the leading LSN field, so skip only the remaining
-    // header bytes between it and body_size (record type + page id).
-    wal_file.seekg(WALRecord::body_size_offset_bytes() - sizeof(uint64_t),
-                   std::ios::cur);
-    wal_file.read(reinterpret_cast<char*>(&body_size), sizeof(body_size));
+std::unique_ptr<WAL> WAL::initializeNew(const std::string& wal_dir) {
+  if (!std::filesystem::create_directory(wal_dir)) {
+    throw std::system_error(EEXIST, std::generic_category(),
+                            "WAL directory already exists: " + wal_dir);
+  }
+  return std::unique_ptr<WAL>(new WAL(wal_dir, 0, 0));
+}
 
-    offset += WALRecord::header_size_bytes();
-    if (next_lsn - offset < body_size) {
-      throw std::runtime_error("Incomplete WAL record body during bootstrap");
-    }
+std::unique_ptr<WAL> WAL::openExisting(const std::string& wal_dir) {
+  const auto [next_lsn, durable_lsn] = readWalBootstrapState(wal_dir);
+  return std::unique_ptr<WAL>(new WAL(wal_dir, next_lsn, durable_lsn));
+}
 
-    wal_file.seekg(body_size, std::ios::cur);
-    offset += body_size;
+WAL::WAL(const std::string& wal_dir, std::uint64_t next_lsn,
+         std::uint64_t durable_lsn)
+    : wal_dir_(wal_dir),
+      segment_bytes_(segmentBytesFromEnv()),
+      allocator_(next_lsn),
+      ring_capacity_(ringCapacityFromEnv()),
+      ring_(new std::byte[ring_capacity_]),
+      durable_end_lsn_(next_lsn),
+      flush_threshold_bytes_(ring_capacity_ / 4),
+      flushed_lsn_(durable_lsn),
+      flush_interval_(
+          dbfs_util::unsignedFromEnv("DBFS_WAL_FLUSH_INTERVAL_MS", 10)),
+      group_commit_delay_(
+          dbfs_util::unsignedFromEnv("DBFS_WAL_GROUP_COMMIT_DELAY_US", 0)) {
+  openSegmentForAppend(next_lsn);
+  if (flush_interval_.count() == 0) {
+    flush_interval_ = std::chrono::milliseconds(10);
   }
+  flusher_ = std::thread([this] { runFlusher(); });
+}
 
-  return {next_lsn, last_record_lsn};
+WAL::~WAL() {
+  stopFlusher();
+  try {
+    flush();
+  } catch (const std::exception& e) {
+    dbfs_log::storage().error("Failed to flush WAL on close: {}", e.what());
+  }
+  ::close(segment_fd_);
 }
 
-}  // namespace
+std::uint64_t WAL::write(WALRecord::RecordType type, uint32_t relation_id,
+                         PageId page_id, const std::vector<std::byte>& body) {
+  const size_t size = WALRecord::size_bytes(body);
+  if (size > ring_capacity_) {
+    throw std::invalid_argument(
+        fmt::format("WAL record of {} bytes does not fit the {}-byte log "
+                    "buffer (DBFS_WAL_BUFFER_BYTES)",
+                    size, ring_capacity_));
+  }
+
+  InsertionSlot& slot = claimInsertionSlot();
+  const std::uint64_t lsn = allocator_.allocate(size);
+  // Until the slot is freed, the flusher writes nothing at or past lsn.
+  slot.inserting_at.store(lsn, std::memory_order_release);
+
+  try {
+    waitForRingSpace(lsn + size);
+  } catch (...) {
+    slot.inserting_at.store(SLOT_FREE, std::memory_order_release);
+    throw;
+  }
+
+  std::array<std::byte, WALRecord::header_size_bytes()> header;
+  WALRecord::encodeHeader(header.data(), lsn, type, relation_id, page_id,
+                          body.data(), static_cast<uint32_t>(body.size()));
+  copyIntoRing(lsn, header.data(), header.size());
+  copyIntoRing(lsn + header.size(), body.data(), body.size());
+  records_written_.fetch_add(1, std::memory_order_relaxed);
+  bytes_written_.fetch_add(size, std::memory_order_relaxed);
+  // Only the writer that crosses the threshold wakes the flusher. Checked
+  // while the slot still holds lsn, so durable_end_lsn_ cannot be past it.
+  const std::uint64_t durable_end =
+      durable_end_lsn_.load(std::memory_order_acquire);
+  const bool wake_flusher = lsn - durable_end < flush_threshold_bytes_ &&
+                            lsn + size - durable_end >= flush_threshold_bytes_;
+  slot.inserting_at.store(SLOT_FREE, std::memory_order_release);
 
-std::unique_ptr<WAL> WAL::initializeNew(const std::string& wal_path) {
-  return std::unique_ptr<WAL>(
-      new WAL(wal_path, 0, 0, O_CREAT | O_EXCL | O_WRONLY));
+  if (wake_flusher) {
+    flusher_cv_.notify_one();
+  }
+  return lsn;
 }
 
-std::unique_ptr<WAL> WAL::openExisting(const std::string& wal_path) {
-  const auto [next_lsn, durable_lsn] = readWalBootstrapState(wal_path);
-  return std::unique_ptr<WAL>(
-      new WAL(wal_path, next_lsn, durable_lsn, O_WRONLY | O_APPEND));
+WAL::InsertionSlot& WAL::claimInsertionSlot() {
+  // Start at a per-thread slot so that writers rarely collide on the CAS.
+  static thread_local const size_t home =
+      std::hash<std::thread::id>{}(std::this_thread::get_id()) %
+      INSERTION_SLOT_COUNT;
+  for (;;) {
+    for (size_t i = 0; i < INSERTION_SLOT_COUNT; ++i) {
+      InsertionSlot& slot =
+          insertion_slots_[(home + i) % INSERTION_SLOT_COUNT];
+      std::uint64_t expected = SLOT_FREE;
+      if (slot.inserting_at.compare_exchange_strong(
+              expected, SLOT_RESERVING, std::memory_order_acq_rel)) {
+        return slot;
+      }
+    }
+    // More writers than slots.
+    std::this_thread::yield();
+  }
 }
 
-WAL::WAL(const std::string& wal_path, std::uint64_t next_lsn,
-         std::uint64_t durable_lsn, int open_flags)
-    : wal_fd_(-1),
-      allocator_(next_lsn),
-      last_lsn_written_(durable_lsn),
-      flushed_lsn_(durable_lsn) {
-  int fd = ::open(wal_path.c_str(), open_flags, 0644);
-  if (fd == -1) {
-    throw std::system_error(errno, std::generic_category(),
-                            "Failed to open WAL file");
+void WAL::waitForRingSpace(std::uint64_t record_end_lsn) {
+  if (record_end_lsn <=
+      durable_end_lsn_.load(std::memory_order_acquire) + ring_capacity_) {
+    return;
+  }
+  // The ring is full: ask the flusher to free space. Our own slot bounds the
+  // flushable prefix, but everything before it fits, so the flusher can
+  // always get far enough.
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  stats_.buffer_full_waits++;
+  const std::uint64_t needed_end = record_end_lsn - ring_capacity_;
+  while (durable_end_lsn_.load(std::memory_order_acquire) < needed_end) {
+    if (flush_error_ != nullptr) {
+      std::rethrow_exception(flush_error_);
+    }
+    if (stop_flusher_) {
+      throw std::runtime_error("WAL closed while waiting for log buffer space");
+    }
+    commit_requested_end_lsn_ =
+        std::max(commit_requested_end_lsn_, needed_end);
+    flusher_cv_.notify_one();
+    durable_cv_.wait(lock);
   }
-  wal_fd_ = fd;
 }
 
-void WAL::write(WALRecord::RecordType type, uint16_t page_id,
-                const std::vector<std::byte>& body) {
-  const auto size = WALRecord::size_bytes(body);
-  const auto lsn = allocator_.allocate(size);
-  WALRecord record(lsn, type, page_id, body);
-  std::vector<std::byte> bytes = record.serialize();
+void WAL::copyIntoRing(std::uint64_t lsn, const std::byte* data,
+                       size_t size) {
+  const size_t pos = lsn & (ring_capacity_ - 1);
+  const size_t first = std::min(size, ring_capacity_ - pos);
+  std::memcpy(ring_.get() + pos, data, first);
+  std::memcpy(ring_.get(), data + first, size - first);
+}
+
+void WAL::copyFromRing(std::uint64_t lsn, std::byte* out, size_t size) const {
+  const size_t pos = lsn & (ring_capacity_ - 1);
+  const size_t first = std::min(size, ring_capacity_ - pos);
+  std::memcpy(out, ring_.get() + pos, first);
+  std::memcpy(out + first, ring_.get(), size - first);
+}
+
+std::uint64_t WAL::publishedEndLSN() const {
+  // Read the allocator before the slots: a writer marks its slot RESERVING
+  // before allocating, so any record below this end is either complete or
+  // visible in a slot.
+  std::uint64_t end = allocator_.current();
+  for (const InsertionSlot& slot : insertion_slots_) {
+    std::uint64_t inserting_at =
+        slot.inserting_at.load(std::memory_order_acquire);
+    while (inserting_at == SLOT_RESERVING) {
+      std::this_thread::yield();
+      inserting_at = slot.inserting_at.load(std::memory_order_acquire);
+    }
+    if (inserting_at != SLOT_FREE) {
+      end = std::min(end, inserting_at);
+    }
+  }
+  return end;
+}
 
+WAL::CommitHandle WAL::requestCommit() {
+  const std::uint64_t end_lsn = allocator_.current();
+  if (end_lsn <= durable_end_lsn_.load(std::memory_order_acquire)) {
+    return CommitHandle(*this, end_lsn);
+  }
   {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    buffer_.insert(buffer_.end(), bytes.begin(), bytes.end());
-    last_lsn_written_ = record.get_lsn();
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    commit_requested_end_lsn_ = std::max(commit_requested_end_lsn_, end_lsn);
+  }
+  flusher_cv_.notify_one();
+  return CommitHandle(*this, end_lsn);
+}
 
-    if (buffer_.size() < flush_threshold_bytes_) {
-      return;
+void WAL::waitForDurable(std::uint64_t end_lsn) const {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  auto durable = [&] {
+    return durable_end_lsn_.load(std::memory_order_acquire) >= end_lsn;
+  };
+  if (durable()) {
+    return;
+  }
+  stats_.commit_waits++;
+  if (commit_requested_end_lsn_ < end_lsn) {
+    commit_requested_end_lsn_ = end_lsn;
+    flusher_cv_.notify_one();
+  }
+  durable_cv_.wait(lock, [&] {
+    return durable() || flush_error_ != nullptr || stop_flusher_;
+  });
+  if (durable()) {
+    return;
+  }
+  if (flush_error_ != nullptr) {
+    std::rethrow_exception(flush_error_);
+  }
+  throw std::runtime_error("WAL closed before the commit became durable");
+}
+
+bool WAL::CommitHandle::isDurable() const {
+  return wal_->durable_end_lsn_.load(std::memory_order_acquire) >= end_lsn_;
+}
+
+void WAL::CommitHandle::wait() const { wal_->waitForDurable(end_lsn_); }
+
+void WAL::runFlusher() {
+  std::unique_lock<std::mutex> lock(state_mutex_);
+  auto buffered_bytes = [this] {
+    return allocator_.current() -
+           durable_end_lsn_.load(std::memory_order_acquire);
+  };
+  while (!stop_flusher_ && flush_error_ == nullptr) {
+    // Time trigger: wake up at least every flush_interval_ even without
+    // commits, so buffered records do not sit in memory indefinitely.
+    flusher_cv_.wait_for(lock, flush_interval_, [&] {
+      return stop_flusher_ ||
+             commit_requested_end_lsn_ >
+                 durable_end_lsn_.load(std::memory_order_acquire) ||
+             buffered_bytes() >= flush_threshold_bytes_;
+    });
+    if (stop_flusher_) {
+      break;
+    }
+    if (buffered_bytes() == 0) {
+      continue;
+    }
+    if (group_commit_delay_.count() > 0 &&
+        buffered_bytes() < flush_threshold_bytes_) {
+      flusher_cv_.wait_for(lock, group_commit_delay_, [&] {
+        return stop_flusher_ || buffered_bytes() >= flush_threshold_bytes_;
+      });
+    }
+
+    lock.unlock();
+    const std::uint64_t before =
+        durable_end_lsn_.load(std::memory_order_acquire);
+    try {
+      flushBuffered();
+    } catch (const std::exception& e) {
+      dbfs_log::storage().error("WAL flusher failed: {}", e.what());
+    }
+    if (durable_end_lsn_.load(std::memory_order_acquire) == before) {
+      // The oldest record is still being copied; let its writer finish.
+      std::this_thread::yield();
     }
+    lock.lock();
   }
+}
 
-  // TODO: file I/O should be async.
-  this->flush();
+void WAL::stopFlusher() {
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stop_flusher_ = true;
+  }
+  flusher_cv_.notify_all();
+  durable_cv_.notify_all();
+  if (flusher_.joinable()) {
+    flusher_.join();
+  }
 }
 
 void WAL::flush() {
-  std::vector<std::byte> local_buffer;
+  // Records appended before the call may still be being copied by other
+  // writers; keep flushing until all of them are durable.
+  const std::uint64_t target = allocator_.current();
+  while (durable_end_lsn_.load(std::memory_order_acquire) < target) {
+    const std::uint64_t before =
+        durable_end_lsn_.load(std::memory_order_acquire);
+    flushBuffered();
+    if (durable_end_lsn_.load(std::memory_order_acquire) == before) {
+      std::this_thread::yield();
+    }
+  }
+}
 
-  // batching / checkpointing lsn to flush up to allow last_lsn_written_ be
-  // updated by writers concurrently.
-  std::uint64_t flush_upto = 0;
-  {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    if (buffer_.empty()) {
+void WAL::openSegmentForAppend(std::uint64_t next_lsn) {
+  const std::vector<WALSegment> segments = WALDirectory::listSegments(wal_dir_);
+  if (!segments.empty()) {
+    const WALSegment& last = segments.back();
+    if (last.start_lsn + last.size_bytes == next_lsn &&
+        next_lsn < last.start_lsn + segment_bytes_) {
+      segment_fd_ = ::open(last.path.c_str(), O_WRONLY | O_APPEND);
+      if (segment_fd_ == -1) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Failed to open WAL segment " + last.path);
+      }
+      segment_start_lsn_ = last.start_lsn;
       return;
     }
-    local_buffer.swap(buffer_);
-    flush_upto = last_lsn_written_;
   }
+  startSegment(next_lsn);
+}
 
-  const std::byte* data = local_buffer.data();
-  std::size_t remaining = local_buffer.size();
+void WAL::startSegment(std::uint64_t start_lsn) {
+  if (segment_fd_ != -1) {
+    if (::fdatasync(segment_fd_) != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Failed to fdatasync WAL segment");
+    }
+    ::close(segment_fd_);
+    segment_fd_ = -1;
+  }
+  const std::string path = WALDirectory::segmentPath(wal_dir_, start_lsn);
+  segment_fd_ = ::open(path.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_APPEND,
+                       0644);
+  if (segment_fd_ == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Failed to create WAL segment " + path);
+  }
+  // The new directory entry must be durable before records in it count as
+  // durable.
+  WALDirectory::syncDirectory(wal_dir_);
+  segment_start_lsn_ = start_lsn;
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  stats_.segments_created++;
+}
 
-  while (remaining > 0) {
-    ssize_t written = ::write(wal_fd_, data, remaining);
+void WAL::writeRingToFile(std::uint64_t from_lsn, std::uint64_t to_lsn) {
+  while (from_lsn < to_lsn) {
+    const std::uint64_t segment_end = segment_start_lsn_ + segment_bytes_;
+    if (from_lsn >= segment_end) {
+      startSegment(from_lsn);
+      continue;
+    }
+    const size_t pos = from_lsn & (ring_capacity_ - 1);
+    const size_t length = static_cast<size_t>(std::min<std::uint64_t>(
+        {to_lsn - from_lsn, ring_capacity_ - pos, segment_end - from_lsn}));
+    ssize_t written = ::write(segment_fd_, ring_.get() + pos, length);
     if (written < 0) {
       if (errno == EINTR) {
         continue;
@@ -133,26 +434,117 @@ void WAL::flush() {
       throw std::system_error(errno, std::generic_category(),
                               "Failed to write WAL data");
     }
-    data += written;
-    remaining -= static_cast<std::size_t>(written);
+    from_lsn += static_cast<std::uint64_t>(written);
   }
+}
 
-  // make sure WAL bytes are durable before updating flushed_lsn_.
-  if (::fsync(wal_fd_) != 0) {
-    throw std::system_error(errno, std::generic_category(),
-                            "Failed to fsync WAL file");
+void WAL::flushBuffered() {
+  std::lock_guard<std::mutex> io_lock(io_mutex_);
+  {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (flush_error_ != nullptr) {
+      std::rethrow_exception(flush_error_);
+    }
+  }
+
+  // durable_end_lsn_ only moves under io_mutex_, and writers never overwrite
+  // ring bytes at or past it until it moves, so [start, end) is stable.
+  const std::uint64_t start = durable_end_lsn_.load(std::memory_order_acquire);
+  const std::uint64_t end = publishedEndLSN();
+  if (end <= start) {
+    return;
+  }
+
+  // Find the start of the last record in the batch for flushed_lsn_.
+  std::uint64_t last_record_lsn = start;
+  for (std::uint64_t offset = start; offset < end;) {
+    std::array<std::byte, WALRecord::header_size_bytes()> header;
+    copyFromRing(offset, header.data(), header.size());
+    uint32_t body_size = 0;
+    std::memcpy(&body_size,
+                header.data() + WALRecord::body_size_offset_bytes(),
+                sizeof(body_size));
+    last_record_lsn = offset;
+    offset += header.size() + body_size;
+  }
+
+  try {
+    writeRingToFile(start, end);
+    // make sure WAL bytes are durable before updating flushed_lsn_. Appends
+    // only need the data and the file size, so fdatasync is enough.
+    if (::fdatasync(segment_fd_) != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Failed to fdatasync WAL file");
+    }
+  } catch (...) {
+    // A partial write would leave a hole in front of later records. Fail
+    // every current and future committer instead.
+    {
+      std::lock_guard<std::mutex> lock(state_mutex_);
+      flush_error_ = std::current_exception();
+    }
+    durable_cv_.notify_all();
+    throw;
   }
 
   // update flushed LSN to tell pages are ready to be flushed up to this LSN.
   {
-    std::lock_guard<std::mutex> lock(buffer_mutex_);
-    if (flush_upto > flushed_lsn_) {
-      flushed_lsn_ = flush_upto;
-    }
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    flushed_lsn_ = std::max(flushed_lsn_, last_record_lsn);
+    durable_end_lsn_.store(end, std::memory_order_release);
+    stats_.flushes++;
   }
+  durable_cv_.notify_all();
 }
 
 std::uint64_t WAL::getFlushedLSN() const {
-  std::lock_guard<std::mutex> lock(buffer_mutex_);
+  std::lock_guard<std::mutex> lock(state_mutex_);
   return flushed_lsn_;
 }
+
+std::uint64_t WAL::getDurableEndLSN() const {
+  return durable_end_lsn_.load(std::memory_order_acquire);
+}
+
+std::uint64_t WAL::writeCheckpoint(const std::vector<std::byte>& body) {
+  const std::uint64_t lsn =
+      write(WALRecord::RecordType::CHECKPOINT, 0, 0, body);
+  flush();
+  WALDirectory::writeCheckpointLSN(wal_dir_, lsn);
+  return lsn;
+}
+
+size_t WAL::removeSegmentsBefore(std::uint64_t lsn) {
+  std::vector<std::string> obsolete;
+  {
+    // Keeps the flusher from starting a segment while we pick.
+    std::lock_guard<std::mutex> io_lock(io_mutex_);
+    const std::vector<WALSegment> segments =
+        WALDirectory::listSegments(wal_dir_);
+    for (size_t i = 0; i + 1 < segments.size(); ++i) {
+      // A segment ends where the next one starts.
+      if (segments[i + 1].start_lsn > lsn ||
+          segments[i].start_lsn == segment_start_lsn_) {
+        break;
+      }
+      obsolete.push_back(segments[i].path);
+    }
+  }
+  for (const std::string& path : obsolete) {
+    std::filesystem::remove(path);
+  }
+  if (!obsolete.empty()) {
+    WALDirectory::syncDirectory(wal_dir_);
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    stats_.segments_removed += obsolete.size();
+  }
+  return obsolete.size();
+}
+
+WALStats WAL::stats() const {
+  std::lock_guard<std::mutex> lock(state_mutex_);
+  WALStats stats = stats_;
+  stats.records_written = records_written_.load(std::memory_order_relaxed);
+  stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+  return stats;
+}
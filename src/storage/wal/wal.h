@@ -1,50 +1,208 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <exception>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
 #include "lsn_allocator.h"
 #include "wal_record.h"
 
+struct WALStats {
+  std::uint64_t records_written = 0;
+  std::uint64_t bytes_written = 0;
+  // write + fdatasync rounds; with group commit this grows slower than the
+  // number of commits.
+  std::uint64_t flushes = 0;
+  std::uint64_t commit_waits = 0;
+  // write() calls that had to wait for the flusher to free ring space.
+  std::uint64_t buffer_full_waits = 0;
+  std::uint64_t segments_created = 0;
+  std::uint64_t segments_removed = 0;
+};
+
 /**
+ * Group-commit WAL.
+ *
+ * The log lives in a directory of segment files of DBFS_WAL_SEGMENT_BYTES
+ * (default 16 MiB), see WALDirectory. A checkpoint records where recovery has
+ * to start, and segments that lie entirely below that point are removed.
+ *
+ * The log buffer is a ring of DBFS_WAL_BUFFER_BYTES (default 4 MiB, rounded
+ * up to a power of two) addressed by LSN: a record at LSN x occupies ring
+ * bytes [x, x + size) modulo the capacity. write() reserves its LSN with
+ * LSNAllocator's fetch_add and serializes the record in place, without a lock
+ * or a temporary buffer. It never does file I/O.
+ *
+ * One flusher thread owns the file I/O: it writes and fdatasync()s the filled
+ * part of the ring when a commit is waiting, when a quarter of the ring is
+ * filled, or every DBFS_WAL_FLUSH_INTERVAL_MS (default 10). Records appended
+ * while a flush is in progress go out together in the next one, so concurrent
+ * committers share fsyncs. DBFS_WAL_GROUP_COMMIT_DELAY_US (default 0) makes
+ * the flusher wait that long after a commit request to gather more records,
+ * like PostgreSQL's commit_delay.
+ *
+ * Publishing (insertion slots, as in PostgreSQL's WAL insertion locks):
+ * - A writer claims one of INSERTION_SLOT_COUNT slots and marks it RESERVING
+ *   before allocating its LSN, then stores the LSN in the slot while it
+ *   copies, and frees the slot when the record is complete.
+ * - The flusher reads the allocator's end first and then every slot; the
+ *   smallest in-progress LSN bounds the prefix it may write. Every byte below
+ *   that bound belongs to a completed record, so only contiguous filled
+ *   prefixes reach the file.
+ *
  * Invariants:
- * - buffer_ only contains records with LSN > flushed_lsn_.
+ * - Ring bytes [durable_end_lsn_, durable_end_lsn_ + capacity) may be written
+ *   by writers; everything below durable_end_lsn_ is on disk. A writer whose
+ *   record would not fit waits for the flusher.
  * - flushed_lsn_ never exceeds the LSN of the last record whose bytes have been
- *   written and fsync'ed to the WAL file.
- * - Multiple writer threads may call write() concurrently; flush() may run
- *   concurrently as well. All shared state updates are serialized by
- *   buffer_mutex_, so there are no data races on buffer_ / last_lsn_written_ /
- *   flushed_lsn_.
+ *   written and fdatasync'ed to the WAL file; durable_end_lsn_ is the byte
+ *   offset just past it.
+ * - Only one thread at a time writes to the file (io_mutex_).
  */
 class WAL {
  public:
-  static std::unique_ptr<WAL> initializeNew(const std::string& wal_path);
-  static std::unique_ptr<WAL> openExisting(const std::string& wal_path);
+  /**
+   * Durability handle for every record appended before it was created. It
+   * refers to the WAL, which must outlive it.
+   */
+  class CommitHandle {
+   public:
+    // Byte offset up to which the log must be durable.
+    std::uint64_t endLSN() const { return end_lsn_; }
+    bool isDurable() const;
+    // Blocks until durable; rethrows a failed flush.
+    void wait() const;
+
+   private:
+    friend class WAL;
+    CommitHandle(const WAL& wal, std::uint64_t end_lsn)
+        : wal_(&wal), end_lsn_(end_lsn) {}
+
+    const WAL* wal_;
+    std::uint64_t end_lsn_;
+  };
 
-  // Makes buffered WAL bytes durable and advances flushed_lsn_.
+  static constexpr size_t INSERTION_SLOT_COUNT = 32;
+
+  // Creates the WAL directory; fails if it already exists.
+  static std::unique_ptr<WAL> initializeNew(const std::string& wal_dir);
+  // Continues after the last complete record; a torn tail left by a crash
+  // is truncated away. Only the log from the latest checkpoint on is read.
+  static std::unique_ptr<WAL> openExisting(const std::string& wal_dir);
+  // Flushes whatever is still buffered and closes the file.
+  ~WAL();
+
+  // Makes buffered WAL bytes durable on the calling thread and advances
+  // flushed_lsn_.
   void flush();
 
   std::uint64_t getFlushedLSN() const;
+  // Byte offset just past the last durable record. A page whose pageLSN (the
+  // end LSN of its latest record) is at or below this may be written back.
+  std::uint64_t getDurableEndLSN() const;
+  // Byte offset just past the last record appended so far.
+  std::uint64_t getEndLSN() const { return allocator_.current(); }
+
+  // Reserves an LSN, serializes the record into the log buffer, and returns
+  // the LSN. Only blocks when the ring is full.
+  std::uint64_t write(WALRecord::RecordType type, uint32_t relation_id,
+                      PageId page_id, const std::vector<std::byte>& body);
 
-  // Allocates an LSN, serializes the record, and may trigger a batch flush.
-  void write(WALRecord::RecordType type, uint16_t page_id,
-             const std::vector<std::byte>& body);
+  /**
+   * Asks the flusher to make everything appended so far durable and returns
+   * a handle to wait on. Callers should release their locks before waiting so
+   * that other writers can join the same flush.
+   */
+  CommitHandle requestCommit();
+  // Blocks until the log is durable up to the byte offset end_lsn.
+  void waitForDurable(std::uint64_t end_lsn) const;
+
+  /**
+   * Appends a CHECKPOINT record with body, makes it durable, and then points
+   * the directory's checkpoint file at it. Returns the record's LSN.
+   */
+  std::uint64_t writeCheckpoint(const std::vector<std::byte>& body);
+  /**
+   * Removes segments that hold no byte at or past lsn. Callers pass the redo
+   * point of a durable checkpoint. The current segment is always kept.
+   * Returns the number of segments removed.
+   */
+  size_t removeSegmentsBefore(std::uint64_t lsn);
+
+  const std::string& directory() const { return wal_dir_; }
+
+  WALStats stats() const;
 
  private:
-  WAL(const std::string& wal_path, std::uint64_t next_lsn,
-      std::uint64_t durable_lsn, int open_flags);
+  static constexpr std::uint64_t SLOT_FREE = ~std::uint64_t{0};
+  static constexpr std::uint64_t SLOT_RESERVING = SLOT_FREE - 1;
+  struct alignas(64) InsertionSlot {
+    std::atomic<std::uint64_t> inserting_at{SLOT_FREE};
+  };
+
+  WAL(const std::string& wal_dir, std::uint64_t next_lsn,
+      std::uint64_t durable_lsn);
+
+  InsertionSlot& claimInsertionSlot();
+  void waitForRingSpace(std::uint64_t record_end_lsn);
+  void copyIntoRing(std::uint64_t lsn, const std::byte* data, size_t size);
+  void copyFromRing(std::uint64_t lsn, std::byte* out, size_t size) const;
+  // End of the longest prefix of the log whose records are all complete.
+  std::uint64_t publishedEndLSN() const;
+  void writeRingToFile(std::uint64_t from_lsn, std::uint64_t to_lsn);
+  // Appends to the last segment if next_lsn is its end and it has room,
+  // otherwise creates a segment starting at next_lsn.
+  void openSegmentForAppend(std::uint64_t next_lsn);
+  // Syncs and closes the current segment and starts one at start_lsn.
+  void startSegment(std::uint64_t start_lsn);
+
+  void runFlusher();
+  void stopFlusher();
+  // Writes and syncs the published part of the ring. Throws on I/O errors,
+  // which also make the WAL unusable (flush_error_).
+  void flushBuffered();
 
-  int wal_fd_;
+  std::string wal_dir_;
+  std::uint64_t segment_bytes_;
+  // Current segment; only touched under io_mutex_ once the WAL is open.
+  int segment_fd_ = -1;
+  std::uint64_t segment_start_lsn_ = 0;
   LSNAllocator allocator_;
-  std::vector<std::byte> buffer_;
-  // Protects buffer_, last_lsn_written_, and flushed_lsn_.
-  mutable std::mutex buffer_mutex_;
-  std::size_t flush_threshold_bytes_ = 1 * 1024 * 1024;
-  std::uint64_t last_lsn_written_{0};
+  size_t ring_capacity_;
+  std::unique_ptr<std::byte[]> ring_;
+  std::array<InsertionSlot, INSERTION_SLOT_COUNT> insertion_slots_;
+  std::atomic<std::uint64_t> durable_end_lsn_{0};
+  std::atomic<std::uint64_t> records_written_{0};
+  std::atomic<std::uint64_t> bytes_written_{0};
+  // Protects the members below; durable_end_lsn_ is only advanced under it.
+  mutable std::mutex state_mutex_;
+  // Serializes write + fdatasync and segment changes between the flusher and
+  // flush() callers.
+  std::mutex io_mutex_;
+  // Wakes the flusher.
+  mutable std::condition_variable flusher_cv_;
+  // Wakes committers and writers waiting for ring space when
+  // durable_end_lsn_ advances or a flush fails.
+  mutable std::condition_variable durable_cv_;
+  size_t flush_threshold_bytes_;
   // LSN of the last record known to be durable.
   std::uint64_t flushed_lsn_{0};
-};
\ No newline at end of file
+  // Highest end LSN a committer or a blocked writer is waiting for.
+  mutable std::uint64_t commit_requested_end_lsn_{0};
+  std::exception_ptr flush_error_;
+  bool stop_flusher_ = false;
+  mutable WALStats stats_;
+  std::chrono::milliseconds flush_interval_;
+  std::chrono::microseconds group_commit_delay_;
+  std::thread flusher_;
+};
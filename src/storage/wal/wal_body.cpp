@@ -1,6 +1,8 @@
 #include "wal_body.h"
 
 #include <cstring>
+#include <stdexcept>
+#include <string>
 
 namespace {
 
@@ -15,6 +17,25 @@ void append_bytes(std::vector<std::byte>& out, const std::byte* data,
   out.insert(out.end(), data, data + size);
 }
 
+// Throws unless buffer holds count more fields of field_size bytes from p.
+void require_fields(const std::vector<std::byte>& buffer, const std::byte* p,
+                    std::size_t count, std::size_t field_size,
+                    const char* decoder) {
+  const auto remaining =
+      static_cast<std::size_t>(buffer.data() + buffer.size() - p);
+  if (remaining / field_size < count) {
+    throw std::runtime_error(std::string(decoder) + ": buffer too small");
+  }
+}
+
+template <class T>
+T read_pod(const std::byte*& p) {
+  T value;
+  std::memcpy(&value, p, sizeof(T));
+  p += sizeof(T);
+  return value;
+}
+
 }  // namespace
 
 std::vector<std::byte> InsertRedoBody::encode() const {
@@ -113,3 +134,76 @@ DeleteRedoBody DeleteRedoBody::decode(const std::vector<std::byte>& buffer) {
   std::memcpy(body.before.data(), p, before_size);
   return body;
 }
+
+std::vector<std::byte> CheckpointBody::encode() const {
+  std::vector<std::byte> out;
+  const auto dirty_page_count = static_cast<uint32_t>(dirty_pages.size());
+  const auto stale_index_count = static_cast<uint32_t>(stale_indexes.size());
+  out.reserve(sizeof(redo_lsn) + sizeof(uint32_t) * 2 +
+              dirty_page_count * (sizeof(uint32_t) + sizeof(PageId) +
+                                  sizeof(uint64_t)) +
+              stale_index_count * sizeof(uint32_t));
+
+  append_pod(out, redo_lsn);
+  append_pod(out, dirty_page_count);
+  for (const DirtyPage& page : dirty_pages) {
+    append_pod(out, page.relation_id);
+    append_pod(out, page.page_id);
+    append_pod(out, page.rec_lsn);
+  }
+  append_pod(out, stale_index_count);
+  for (const uint32_t relation_id : stale_indexes) {
+    append_pod(out, relation_id);
+  }
+  return out;
+}
+
+CheckpointBody CheckpointBody::decode(const std::vector<std::byte>& buffer) {
+  static constexpr const char* DECODER = "CheckpointBody::decode";
+  static constexpr std::size_t DIRTY_PAGE_BYTES =
+      sizeof(uint32_t) + sizeof(PageId) + sizeof(uint64_t);
+  CheckpointBody body{};
+
+  const std::byte* p = buffer.data();
+  require_fields(buffer, p, 1, sizeof(uint64_t) + sizeof(uint32_t), DECODER);
+  body.redo_lsn = read_pod<uint64_t>(p);
+  const auto dirty_page_count = read_pod<uint32_t>(p);
+  require_fields(buffer, p, dirty_page_count, DIRTY_PAGE_BYTES, DECODER);
+  body.dirty_pages.reserve(dirty_page_count);
+  for (uint32_t i = 0; i < dirty_page_count; ++i) {
+    DirtyPage page{};
+    page.relation_id = read_pod<uint32_t>(p);
+    page.page_id = read_pod<PageId>(p);
+    page.rec_lsn = read_pod<uint64_t>(p);
+    body.dirty_pages.push_back(page);
+  }
+  require_fields(buffer, p, 1, sizeof(uint32_t), DECODER);
+  const auto stale_index_count = read_pod<uint32_t>(p);
+  require_fields(buffer, p, stale_index_count, sizeof(uint32_t), DECODER);
+  body.stale_indexes.reserve(stale_index_count);
+  for (uint32_t i = 0; i < stale_index_count; ++i) {
+    body.stale_indexes.push_back(read_pod<uint32_t>(p));
+  }
+  return body;
+}
+
+std::vector<std::byte> CompactRedoBody::encode() const {
+  std::vector<std::byte> out;
+  out.reserve(sizeof(slot_count) + sizeof(reclaimed_bytes) +
+              sizeof(released_slots));
+  append_pod(out, slot_count);
+  append_pod(out, reclaimed_bytes);
+  append_pod(out, released_slots);
+  return out;
+}
+
+CompactRedoBody CompactRedoBody::decode(const std::vector<std::byte>& buffer) {
+  CompactRedoBody body{};
+
+  const std::byte* p = buffer.data();
+  require_fields(buffer, p, 1, 3 * sizeof(uint16_t), "CompactRedoBody::decode");
+  body.slot_count = read_pod<uint16_t>(p);
+  body.reclaimed_bytes = read_pod<uint16_t>(p);
+  body.released_slots = read_pod<uint16_t>(p);
+  return body;
+}
@@ -6,6 +6,8 @@
 #include <variant>
 #include <vector>
 
+#include "storage/page/page_id.h"
+
 struct InsertRedoBody {
   uint16_t offset;
   std::vector<std::byte> tuple;
@@ -39,4 +41,43 @@ struct DeleteRedoBody {
   static DeleteRedoBody decode(const std::vector<std::byte>& buffer);
 };
 
-using WALBody = std::variant<InsertRedoBody, UpdateRedoBody, DeleteRedoBody>;
+/**
+ * Body of a heap page compaction by the vacuum. Compaction is a function of
+ * the page alone, so redo compacts the page again; slot_count is the page's
+ * slot count before it, which redo checks, reclaimed_bytes the bytes the
+ * compaction freed and released_slots the slots it made free for reuse.
+ */
+struct CompactRedoBody {
+  uint16_t slot_count = 0;
+  uint16_t reclaimed_bytes = 0;
+  uint16_t released_slots = 0;
+
+  std::vector<std::byte> encode() const;
+  static CompactRedoBody decode(const std::vector<std::byte>& buffer);
+};
+
+/**
+ * Body of a fuzzy checkpoint. Pages are written back while it is taken, so it
+ * only records where redo has to start: the smallest recLSN (LSN of the first
+ * record since the page was last written back) of the dirty heap pages, or
+ * the log end when none was dirty. Recovery seeds its dirty page table with
+ * dirty_pages and rebuilds the indexes of relations in stale_indexes, whose
+ * unlogged index pages were dirty.
+ */
+struct CheckpointBody {
+  struct DirtyPage {
+    uint32_t relation_id;
+    PageId page_id;
+    uint64_t rec_lsn;
+  };
+
+  uint64_t redo_lsn = 0;
+  std::vector<DirtyPage> dirty_pages;
+  std::vector<uint32_t> stale_indexes;
+
+  std::vector<std::byte> encode() const;
+  static CheckpointBody decode(const std::vector<std::byte>& buffer);
+};
+
+using WALBody = std::variant<InsertRedoBody, UpdateRedoBody, DeleteRedoBody,
+                             CheckpointBody, CompactRedoBody>;
@@ -0,0 +1,107 @@
+#include "wal_directory.h"
+
+#include <fcntl.h>
+#include <spdlog/spdlog.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
+namespace {
+
+constexpr const char* kCheckpointFileName = "checkpoint";
+constexpr size_t kSegmentNameLength = 16;
+
+std::optional<std::uint64_t> parseSegmentName(const std::string& name) {
+  if (name.size() != kSegmentNameLength ||
+      name.find_first_not_of("0123456789abcdef") != std::string::npos) {
+    return std::nullopt;
+  }
+  return std::strtoull(name.c_str(), nullptr, 16);
+}
+
+void syncPath(const std::string& path, int open_flags) {
+  const int fd = ::open(path.c_str(), open_flags);
+  if (fd == -1) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Failed to open " + path + " for fsync");
+  }
+  const int result = ::fsync(fd);
+  const int saved_errno = errno;
+  ::close(fd);
+  if (result != 0) {
+    throw std::system_error(saved_errno, std::generic_category(),
+                            "Failed to fsync " + path);
+  }
+}
+
+}  // namespace
+
+std::string WALDirectory::segmentPath(const std::string& wal_dir,
+                                      std::uint64_t start_lsn) {
+  return (std::filesystem::path(wal_dir) / fmt::format("{:016x}", start_lsn))
+      .string();
+}
+
+std::vector<WALSegment> WALDirectory::listSegments(
+    const std::string& wal_dir) {
+  std::vector<WALSegment> segments;
+  for (const auto& entry : std::filesystem::directory_iterator(wal_dir)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    const auto start_lsn = parseSegmentName(entry.path().filename().string());
+    if (!start_lsn.has_value()) {
+      continue;
+    }
+    segments.push_back(
+        WALSegment{*start_lsn, entry.path().string(), entry.file_size()});
+  }
+  std::sort(segments.begin(), segments.end(),
+            [](const WALSegment& lhs, const WALSegment& rhs) {
+              return lhs.start_lsn < rhs.start_lsn;
+            });
+  return segments;
+}
+
+std::optional<std::uint64_t> WALDirectory::readCheckpointLSN(
+    const std::string& wal_dir) {
+  const std::string path =
+      (std::filesystem::path(wal_dir) / kCheckpointFileName).string();
+  std::ifstream input(path);
+  if (!input.is_open()) {
+    return std::nullopt;
+  }
+  std::uint64_t checkpoint_lsn = 0;
+  if (!(input >> checkpoint_lsn)) {
+    throw std::runtime_error("invalid WAL checkpoint file: " + path);
+  }
+  return checkpoint_lsn;
+}
+
+void WALDirectory::writeCheckpointLSN(const std::string& wal_dir,
+                                      std::uint64_t checkpoint_lsn) {
+  const std::filesystem::path dir(wal_dir);
+  const std::string path = (dir / kCheckpointFileName).string();
+  const std::string temp_path = path + ".tmp";
+  {
+    std::ofstream output(temp_path, std::ios::trunc);
+    output << checkpoint_lsn << '\n';
+    output.flush();
+    if (!output.good()) {
+      throw std::runtime_error("failed to write WAL checkpoint file: " +
+                               temp_path);
+    }
+  }
+  syncPath(temp_path, O_RDONLY);
+  std::filesystem::rename(temp_path, path);
+  syncDirectory(wal_dir);
+}
+
+void WALDirectory::syncDirectory(const std::string& wal_dir) {
+  syncPath(wal_dir, O_RDONLY | O_DIRECTORY);
+}
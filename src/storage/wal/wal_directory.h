@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+struct WALSegment {
+  // LSN of the segment's first byte; also its file name, in hex.
+  std::uint64_t start_lsn;
+  std::string path;
+  std::uint64_t size_bytes;
+};
+
+/**
+ * On-disk layout of a WAL directory.
+ *
+ * The log is split into segment files named after the LSN of their first
+ * byte (16 hex digits, so they sort by name). Concatenated in that order they
+ * form the log; a record may continue from one segment into the next. The
+ * `checkpoint` file holds the LSN of the latest durable checkpoint record,
+ * where startup begins reading.
+ */
+class WALDirectory {
+ public:
+  static std::string segmentPath(const std::string& wal_dir,
+                                 std::uint64_t start_lsn);
+  // Segments ordered by start LSN. Other files are ignored.
+  static std::vector<WALSegment> listSegments(const std::string& wal_dir);
+
+  static std::optional<std::uint64_t> readCheckpointLSN(
+      const std::string& wal_dir);
+  // Replaces the checkpoint file atomically and durably.
+  static void writeCheckpointLSN(const std::string& wal_dir,
+                                 std::uint64_t checkpoint_lsn);
+
+  // fsyncs the directory so that created, renamed and removed entries
+  // survive a crash.
+  static void syncDirectory(const std::string& wal_dir);
+};
@@ -0,0 +1,136 @@
+#include "wal_reader.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <system_error>
+
+WALReader::WALReader(const std::string& wal_dir, std::uint64_t start_lsn)
+    : read_buffer_(std::make_unique<char[]>(READ_BUFFER_BYTES)),
+      position_(start_lsn),
+      offset_(start_lsn) {
+  if (!std::filesystem::is_directory(wal_dir)) {
+    throw std::system_error(ENOENT, std::generic_category(),
+                            "Failed to open existing WAL directory");
+  }
+  segments_ = WALDirectory::listSegments(wal_dir);
+  if (segments_.empty()) {
+    if (start_lsn != 0) {
+      throw std::runtime_error("WAL start LSN is past the end of the log");
+    }
+    return;
+  }
+
+  // The last segment whose start is at or below start_lsn holds it.
+  const auto after = std::upper_bound(
+      segments_.begin(), segments_.end(), start_lsn,
+      [](std::uint64_t lsn, const WALSegment& segment) {
+        return lsn < segment.start_lsn;
+      });
+  if (after == segments_.begin()) {
+    throw std::runtime_error(
+        "WAL start LSN is before the oldest retained segment");
+  }
+  const size_t index = static_cast<size_t>(after - segments_.begin()) - 1;
+  const WALSegment& segment = segments_[index];
+  if (start_lsn > segment.start_lsn + segment.size_bytes) {
+    throw std::runtime_error("WAL start LSN is past the end of its segment");
+  }
+  // The buffer must be installed before the file is opened.
+  file_.rdbuf()->pubsetbuf(read_buffer_.get(), READ_BUFFER_BYTES);
+  openSegment(index, start_lsn);
+}
+
+std::uint64_t WALReader::endOfSegmentsLSN() const {
+  if (segments_.empty()) {
+    return 0;
+  }
+  return segments_.back().start_lsn + segments_.back().size_bytes;
+}
+
+void WALReader::openSegment(size_t index, std::uint64_t position) {
+  file_.close();
+  file_.clear();
+  file_.open(segments_[index].path, std::ios::binary);
+  if (!file_) {
+    throw std::system_error(errno ? errno : ENOENT, std::generic_category(),
+                            "Failed to open WAL segment " +
+                                segments_[index].path);
+  }
+  file_.seekg(static_cast<std::streamoff>(position - segments_[index].start_lsn),
+              std::ios::beg);
+  segment_index_ = index;
+  position_ = position;
+}
+
+bool WALReader::readBytes(std::byte* out, size_t size) {
+  while (size > 0) {
+    if (segments_.empty()) {
+      return false;
+    }
+    const WALSegment& segment = segments_[segment_index_];
+    const std::uint64_t segment_end = segment.start_lsn + segment.size_bytes;
+    if (position_ == segment_end) {
+      // Continue only into a segment that starts exactly here.
+      const size_t next_index = segment_index_ + 1;
+      if (next_index == segments_.size() ||
+          segments_[next_index].start_lsn != segment_end) {
+        return false;
+      }
+      openSegment(next_index, segment_end);
+      continue;
+    }
+    const size_t chunk = static_cast<size_t>(
+        std::min<std::uint64_t>(size, segment_end - position_));
+    if (!file_.read(reinterpret_cast<char*>(out), chunk)) {
+      return false;
+    }
+    position_ += chunk;
+    out += chunk;
+    size -= chunk;
+  }
+  return true;
+}
+
+std::optional<WALRecord> WALReader::next() {
+  if (torn_) {
+    return std::nullopt;
+  }
+
+  std::array<std::byte, WALRecord::header_size_bytes()> header;
+  if (!readBytes(header.data(), header.size())) {
+    // Nothing at all past the last record is the normal end of the log.
+    torn_ = position_ != offset_ || position_ != endOfSegmentsLSN();
+    return std::nullopt;
+  }
+  std::uint64_t lsn = 0;
+  std::uint32_t body_size = 0;
+  std::memcpy(&lsn, header.data(), sizeof(lsn));
+  std::memcpy(&body_size,
+              header.data() + WALRecord::body_size_offset_bytes(),
+              sizeof(body_size));
+  if (lsn != offset_) {
+    torn_ = true;
+    return std::nullopt;
+  }
+
+  const std::uint64_t record_size = header.size() + body_size;
+  std::vector<std::byte> bytes(record_size);
+  std::memcpy(bytes.data(), header.data(), header.size());
+  if (!readBytes(bytes.data() + header.size(), body_size)) {
+    torn_ = true;
+    return std::nullopt;
+  }
+  // A header that reached the disk ahead of part of its body.
+  if (WALRecord::checksum(header.data(), bytes.data() + header.size(),
+                          body_size) !=
+      WALRecord::storedChecksum(header.data())) {
+    torn_ = true;
+    return std::nullopt;
+  }
+  offset_ += record_size;
+  return WALRecord::deserialize(bytes);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "wal_directory.h"
+#include "wal_record.h"
+
+/**
+ * Reads WAL records sequentially from a WAL directory, starting at a byte
+ * offset (LSN). Used by WAL bootstrap and restart recovery. Records that
+ * continue into the next segment are read across the boundary; a gap between
+ * segments ends the log.
+ *
+ * A crash can leave a torn tail: a header or body that was cut short, or
+ * bytes that were never synced. Because an LSN is the record's byte offset,
+ * a record whose stored LSN differs from its offset is treated as torn too,
+ * and so is one whose CRC does not match its header and body.
+ * next() stops at the first torn record, and validEndLSN() is then the end
+ * of the last complete one.
+ */
+class WALReader {
+ public:
+  /**
+   * Throws std::system_error if the directory does not exist and
+   * std::runtime_error if start_lsn is not inside the retained segments,
+   * e.g. because they were removed after a checkpoint.
+   */
+  explicit WALReader(const std::string& wal_dir, std::uint64_t start_lsn = 0);
+
+  std::optional<WALRecord> next();
+
+  // Byte offset just past the last record returned by next().
+  std::uint64_t validEndLSN() const { return offset_; }
+  // True once next() has stopped before the end of the segments.
+  bool hasTornTail() const { return torn_; }
+  // Byte offset just past the last segment's last byte.
+  std::uint64_t endOfSegmentsLSN() const;
+  const std::vector<WALSegment>& segments() const { return segments_; }
+
+ private:
+  static constexpr size_t READ_BUFFER_BYTES = 1 << 20;
+
+  bool readBytes(std::byte* out, size_t size);
+  void openSegment(size_t index, std::uint64_t position);
+
+  std::vector<WALSegment> segments_;
+  std::unique_ptr<char[]> read_buffer_;
+  std::ifstream file_;
+  size_t segment_index_ = 0;
+  // Byte offset the next read starts at.
+  std::uint64_t position_;
+  std::uint64_t offset_;
+  bool torn_ = false;
+};
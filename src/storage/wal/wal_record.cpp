@@ -1,31 +1,48 @@
 #include "wal_record.h"
 
+#include <algorithm>
 #include <cstring>
 #include <stdexcept>
 
-std::vector<std::byte> WALRecord::serialize() const {
-  std::vector<std::byte> serialized_data;
-  serialized_data.reserve(sizeof(lsn_) + sizeof(type_) + sizeof(page_id_) +
-                          sizeof(body_size_) + record_body_.size());
-
-  // Header
-  const auto* p_lsn = reinterpret_cast<const std::byte*>(&lsn_);
-  serialized_data.insert(serialized_data.end(), p_lsn, p_lsn + sizeof(lsn_));
-
-  const auto* p_type = reinterpret_cast<const std::byte*>(&type_);
-  serialized_data.insert(serialized_data.end(), p_type, p_type + sizeof(type_));
+#include "crc32c.h"
+
+void WALRecord::encodeHeader(std::byte* out, uint64_t lsn, RecordType type,
+                             uint32_t relation_id, PageId page_id,
+                             const std::byte* body, uint32_t body_size) {
+  std::byte* p = out;
+  std::memcpy(p, &lsn, sizeof(lsn));
+  p += sizeof(lsn);
+  std::memcpy(p, &type, sizeof(type));
+  p += sizeof(type);
+  std::memcpy(p, &relation_id, sizeof(relation_id));
+  p += sizeof(relation_id);
+  std::memcpy(p, &page_id, sizeof(page_id));
+  p += sizeof(page_id);
+  std::memcpy(p, &body_size, sizeof(body_size));
+  p += sizeof(body_size);
+  const uint32_t crc = checksum(out, body, body_size);
+  std::memcpy(p, &crc, sizeof(crc));
+}
 
-  const auto* p_page = reinterpret_cast<const std::byte*>(&page_id_);
-  serialized_data.insert(serialized_data.end(), p_page,
-                         p_page + sizeof(page_id_));
+uint32_t WALRecord::checksum(const std::byte* header, const std::byte* body,
+                             uint32_t body_size) {
+  return crc32c::extend(crc32c::value(header, crc_offset_bytes()), body,
+                        body_size);
+}
 
-  const auto* p_size = reinterpret_cast<const std::byte*>(&body_size_);
-  serialized_data.insert(serialized_data.end(), p_size,
-                         p_size + sizeof(body_size_));
+uint32_t WALRecord::storedChecksum(const std::byte* header) {
+  uint32_t crc = 0;
+  std::memcpy(&crc, header + crc_offset_bytes(), sizeof(crc));
+  return crc;
+}
 
-  // Body
-  serialized_data.insert(serialized_data.end(), record_body_.begin(),
-                         record_body_.end());
+std::vector<std::byte> WALRecord::serialize() const {
+  std::vector<std::byte> serialized_data(header_size_bytes() +
+                                         record_body_.size());
+  encodeHeader(serialized_data.data(), lsn_, type_, relation_id_, page_id_,
+               record_body_.data(), body_size_);
+  std::copy(record_body_.begin(), record_body_.end(),
+            serialized_data.begin() + header_size_bytes());
   return serialized_data;
 }
 
@@ -42,11 +59,17 @@ WALRecord WALRecord::deserialize(const std::vector<std::byte>& buffer) {
   auto type_value = *reinterpret_cast<const RecordType*>(p);
   p += sizeof(RecordType);
 
-  uint16_t page_id_value = *reinterpret_cast<const uint16_t*>(p);
-  p += sizeof(uint16_t);
+  uint32_t relation_id_value = 0;
+  std::memcpy(&relation_id_value, p, sizeof(uint32_t));
+  p += sizeof(uint32_t);
+
+  PageId page_id_value = 0;
+  std::memcpy(&page_id_value, p, sizeof(PageId));
+  p += sizeof(PageId);
 
   uint32_t body_size_value = *reinterpret_cast<const uint32_t*>(p);
   p += sizeof(uint32_t);
+  p += sizeof(uint32_t);  // CRC, checked by WALReader.
 
   const std::size_t remaining =
       static_cast<std::size_t>(buffer.data() + buffer.size() - p);
@@ -57,7 +80,8 @@ WALRecord WALRecord::deserialize(const std::vector<std::byte>& buffer) {
   std::vector<std::byte> body(body_size_value);
   std::memcpy(body.data(), p, body_size_value);
 
-  return WALRecord(lsn_value, type_value, page_id_value, body);
+  return WALRecord(lsn_value, type_value, relation_id_value, page_id_value,
+                   body);
 }
 
 WALBody decode_body(const WALRecord& record) {
@@ -70,6 +94,10 @@ WALBody decode_body(const WALRecord& record) {
       return UpdateRedoBody::decode(buf);
     case WALRecord::RecordType::DELETE:
       return DeleteRedoBody::decode(buf);
+    case WALRecord::RecordType::CHECKPOINT:
+      return CheckpointBody::decode(buf);
+    case WALRecord::RecordType::COMPACT:
+      return CompactRedoBody::decode(buf);
   }
 
   throw std::logic_error("Unknown WALRecord::RecordType in decode_body");
@@ -8,35 +8,50 @@
 
 class WALRecord {
  public:
-  enum class RecordType : uint8_t { INSERT, UPDATE, DELETE };
+  enum class RecordType : uint8_t {
+    INSERT,
+    UPDATE,
+    DELETE,
+    CHECKPOINT,
+    COMPACT
+  };
 
   static constexpr std::size_t body_size_offset_bytes() {
-    return sizeof(uint64_t) + sizeof(RecordType) + sizeof(uint16_t);
+    return sizeof(uint64_t) + sizeof(RecordType) + sizeof(uint32_t) +
+           sizeof(PageId);
   }
 
-  static constexpr std::size_t header_size_bytes() {
+  static constexpr std::size_t crc_offset_bytes() {
     return body_size_offset_bytes() + sizeof(uint32_t);
   }
 
+  static constexpr std::size_t header_size_bytes() {
+    return crc_offset_bytes() + sizeof(uint32_t);
+  }
+
  private:
   uint64_t lsn_;
   RecordType type_;
-  uint16_t page_id_;
+  // Table the page belongs to (see TableMetadataStore); 0 means unknown.
+  uint32_t relation_id_;
+  PageId page_id_;
   uint32_t body_size_;
   std::vector<std::byte> record_body_;
 
  public:
-  WALRecord(uint64_t lsn, RecordType type, uint16_t page_id,
-            const std::vector<std::byte>& record_body)
+  WALRecord(uint64_t lsn, RecordType type, uint32_t relation_id,
+            PageId page_id, const std::vector<std::byte>& record_body)
       : lsn_(lsn),
         type_(type),
+        relation_id_(relation_id),
         page_id_(page_id),
         body_size_(static_cast<uint32_t>(record_body.size())),
         record_body_(record_body) {}
 
   uint64_t get_lsn() const { return lsn_; }
   RecordType get_type() const { return type_; }
-  uint16_t get_page_id() const { return page_id_; }
+  uint32_t get_relation_id() const { return relation_id_; }
+  PageId get_page_id() const { return page_id_; }
   const std::vector<std::byte>& get_body() const { return record_body_; }
 
   static std::size_t size_bytes(const std::vector<std::byte>& body) {
@@ -45,6 +60,24 @@ class WALRecord {
 
   std::vector<std::byte> serialize() const;
 
+  /**
+   * Writes the header_size_bytes() header of a record with body_size bytes
+   * of body into out, its CRC included. Lets the WAL serialize a record
+   * straight into its log buffer without building a WALRecord.
+   */
+  static void encodeHeader(std::byte* out, uint64_t lsn, RecordType type,
+                           uint32_t relation_id, PageId page_id,
+                           const std::byte* body, uint32_t body_size);
+
+  /**
+   * CRC-32C of a record: its header up to the CRC field, then its body. A
+   * record whose stored CRC differs was not completely written.
+   */
+  static uint32_t checksum(const std::byte* header, const std::byte* body,
+                           uint32_t body_size);
+  // The CRC stored in a serialized header.
+  static uint32_t storedChecksum(const std::byte* header);
+
   static WALRecord deserialize(const std::vector<std::byte>& buffer);
 };
 
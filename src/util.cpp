@@ -0,0 +1,34 @@
+#include "util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+
+namespace dbfs_util {
+
+std::uint64_t unsignedFromEnv(const char* name, std::uint64_t default_value) {
+  const char* env = std::getenv(name);
+  if (env == nullptr || *env == '\0') {
+    return default_value;
+  }
+  try {
+    return std::stoull(env);
+  } catch (...) {
+    return default_value;
+  }
+}
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - start)
+      .count();
+}
+
+std::string toLower(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return value;
+}
+
+}  // namespace dbfs_util
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace dbfs_util {
+
+// Value of the environment variable name as an unsigned integer, or
+// default_value when it is unset, empty or not a number.
+std::uint64_t unsignedFromEnv(const char* name, std::uint64_t default_value);
+
+// Wall time since start on the steady clock, for elapsed_ms in stats.
+double millisecondsSince(std::chrono::steady_clock::time_point start);
+
+// ASCII lowercase copy of value, for case-insensitive option names.
+std::string toLower(std::string value);
+
+}  // namespace dbfs_util
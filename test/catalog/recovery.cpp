@@ -0,0 +1,315 @@
+#include "catalog/recovery.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "catalog/checkpoint.h"
+#include "catalog/table.h"
+#include "storage/buffer/bufferpool.h"
+#include "storage/index/btreecursor.h"
+#include "storage/record/record_serializer.h"
+#include "storage/wal/wal.h"
+
+class RecoveryTest : public ::testing::Test {
+ protected:
+  static constexpr const char* kTableName = "recovery_test_table";
+  static constexpr const char* kWalPath = "recovery_test_table.wal";
+  std::unique_ptr<BufferPool> pool_;
+  std::unique_ptr<WAL> wal_;
+
+  void SetUp() override {
+    std::filesystem::create_directories("data");
+    Table::removeBackingFilesFor(kTableName);
+    std::filesystem::remove_all(kWalPath);
+    wal_ = WAL::initializeNew(kWalPath);
+    pool_ = std::make_unique<BufferPool>(*wal_);
+  }
+
+  void TearDown() override {
+    pool_.reset();
+    wal_.reset();
+    Table::removeBackingFilesFor(kTableName);
+    std::filesystem::remove_all(kWalPath);
+  }
+
+  static Schema schema() {
+    return Schema(std::vector<Column>{Column("id", Column::Type::Integer),
+                                      Column("value", Column::Type::Varchar)});
+  }
+
+  static TypedRow row(int id) {
+    return TypedRow{{id, "value-" + std::to_string(id)}};
+  }
+
+  RID insertRow(Table& table, int id) {
+    const TypedRow typed_row = row(id);
+    const RID rid = table.heapFile().insertRecord(
+        *pool_, *wal_, RecordSerializer(table.schema(), typed_row)
+                           .serializedBytes());
+    BTreeCursor::insertIntoIndex(*pool_, table.requireIndexFile(),
+                                 table.extractIndexKey(typed_row),
+                                 rid.heap_page_id, rid.slot_id);
+    return rid;
+  }
+
+  // Makes the log durable and drops the pool without writing back its dirty
+  // pages, like a crash after the statements were acknowledged.
+  void crash() {
+    wal_->flush();
+    pool_.reset();
+    wal_.reset();
+  }
+
+  void restart() {
+    wal_ = WAL::openExisting(kWalPath);
+    pool_ = std::make_unique<BufferPool>(*wal_);
+  }
+
+  std::optional<std::string> lookUpValue(Table& table, int id) {
+    const std::string key = table.extractIndexKey(row(id));
+    const std::vector<IndexEntry> entries = BTreeCursor::findEntries(
+        *pool_, table.requireIndexFile(), {{key, true}, {key, true}}, false);
+    if (entries.size() != 1) {
+      return std::nullopt;
+    }
+    return table.heapFile()
+        .withCell(*pool_, entries.front().rid,
+                  [&](RecordCellView cell) {
+                    return std::get<Column::VarcharType>(
+                        cell.getTypedRow(table.schema()).values[1]);
+                  })
+        .value_or("");
+  }
+};
+
+TEST_F(RecoveryTest, RedoRestoresRowsAndIndexAfterCrash) {
+  constexpr int kRows = 400;
+  {
+    Table table = Table::initialize(kTableName, schema());
+    table.createIndex({"id"});
+    std::vector<RID> rids;
+    for (int id = 0; id < kRows; ++id) {
+      rids.push_back(insertRow(table, id));
+    }
+    for (int id = 0; id < kRows; id += 2) {
+      table.heapFile().removeRecord(*pool_, *wal_, rids[id]);
+    }
+    ASSERT_GT(table.heapFile().rawFile().getMaxPageID(), 1);
+  }
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.records_scanned, kRows + kRows / 2);
+  EXPECT_EQ(stats.records_redone, stats.records_scanned);
+  EXPECT_EQ(stats.records_without_table, 0u);
+  EXPECT_EQ(stats.indexes_rebuilt, 1u);
+
+  Table table = Table::getTable(kTableName);
+  EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+            static_cast<size_t>(kRows / 2));
+  for (int id = 0; id < kRows; ++id) {
+    if (id % 2 == 0) {
+      EXPECT_FALSE(lookUpValue(table, id).has_value()) << id;
+    } else {
+      EXPECT_EQ(lookUpValue(table, id), "value-" + std::to_string(id));
+    }
+  }
+}
+
+TEST_F(RecoveryTest, ParallelRedoMatchesSerialRedo) {
+  constexpr int kRows = 3000;
+  for (const int threads : {1, 4}) {
+    SCOPED_TRACE("redo threads " + std::to_string(threads));
+    TearDown();
+    SetUp();
+    {
+      Table table = Table::initialize(kTableName, schema());
+      table.createIndex({"id"});
+      std::vector<RID> rids;
+      for (int id = 0; id < kRows; ++id) {
+        rids.push_back(insertRow(table, id));
+      }
+      for (int id = 0; id < kRows; id += 3) {
+        table.heapFile().removeRecord(*pool_, *wal_, rids[id]);
+      }
+      ASSERT_GT(table.heapFile().rawFile().getMaxPageID(), 8u);
+    }
+    crash();
+
+    setenv("DBFS_RECOVERY_REDO_THREADS", std::to_string(threads).c_str(), 1);
+    restart();
+    const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+    unsetenv("DBFS_RECOVERY_REDO_THREADS");
+    EXPECT_EQ(stats.redo_threads, static_cast<size_t>(threads));
+    EXPECT_EQ(stats.records_redone, stats.records_scanned);
+
+    Table table = Table::getTable(kTableName);
+    EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+              static_cast<size_t>(kRows - (kRows + 2) / 3));
+    for (int id = 0; id < kRows; id += 7) {
+      if (id % 3 == 0) {
+        EXPECT_FALSE(lookUpValue(table, id).has_value()) << id;
+      } else {
+        EXPECT_EQ(lookUpValue(table, id), "value-" + std::to_string(id));
+      }
+    }
+  }
+}
+
+TEST_F(RecoveryTest, InsertsReuseDeletedSpaceAndRedoTheSame) {
+  constexpr int kRows = 2000;
+  // Deleted slots keep their pointers, so fewer rows fit in the freed space
+  // than were deleted.
+  constexpr int kReinserted = kRows / 4;
+  {
+    Table table = Table::initialize(kTableName, schema());
+    table.createIndex({"id"});
+    std::vector<RID> rids;
+    for (int id = 0; id < kRows; ++id) {
+      rids.push_back(insertRow(table, id));
+    }
+    for (int id = 0; id < kRows; id += 2) {
+      table.heapFile().removeRecord(*pool_, *wal_, rids[id]);
+    }
+    const PageId max_page_id = table.heapFile().rawFile().getMaxPageID();
+    // The new rows go into the space the deleted ones freed, which takes
+    // compacting the pages.
+    for (int id = kRows; id < kRows + kReinserted; ++id) {
+      insertRow(table, id);
+    }
+    EXPECT_EQ(table.heapFile().rawFile().getMaxPageID(), max_page_id);
+  }
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.records_redone, stats.records_scanned);
+
+  Table table = Table::getTable(kTableName);
+  EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+            static_cast<size_t>(kRows / 2 + kReinserted));
+  for (int id = 0; id < kRows + kReinserted; id += 5) {
+    if (id < kRows && id % 2 == 0) {
+      EXPECT_FALSE(lookUpValue(table, id).has_value()) << id;
+    } else {
+      EXPECT_EQ(lookUpValue(table, id), "value-" + std::to_string(id));
+    }
+  }
+}
+
+TEST_F(RecoveryTest, RedoSkipsRecordsAlreadyOnDisk) {
+  constexpr int kRows = 50;
+  {
+    Table table = Table::initialize(kTableName, schema());
+    table.createIndex({"id"});
+    for (int id = 0; id < kRows; ++id) {
+      insertRow(table, id);
+    }
+  }
+  crash();
+
+  restart();
+  Recovery::run(kWalPath, *pool_);
+  // Writing the redone pages back makes the second run a no-op for the heap.
+  pool_->writeBackDirtyPages(1000);
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.records_scanned, static_cast<uint64_t>(kRows));
+  EXPECT_EQ(stats.records_redone, 0u);
+  EXPECT_EQ(stats.records_already_applied, stats.records_scanned);
+
+  Table table = Table::getTable(kTableName);
+  EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+            static_cast<size_t>(kRows));
+  EXPECT_EQ(lookUpValue(table, 7), "value-7");
+}
+
+TEST_F(RecoveryTest, EmptyLogNeedsNoRedo) {
+  { Table::initialize(kTableName, schema()); }
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.records_scanned, 0u);
+  EXPECT_EQ(stats.dirty_pages, 0u);
+  EXPECT_EQ(stats.indexes_rebuilt, 0u);
+}
+
+TEST_F(RecoveryTest, RedoStartsAtTheCheckpoint) {
+  constexpr int kRowsBefore = 200;
+  constexpr int kRowsAfter = 50;
+  std::uint64_t checkpoint_lsn = 0;
+  {
+    Table table = Table::initialize(kTableName, schema());
+    table.createIndex({"id"});
+    for (int id = 0; id < kRowsBefore; ++id) {
+      insertRow(table, id);
+    }
+    wal_->flush();
+    pool_->writeBackDirtyPages(pool_->frameCount());
+    const CheckpointStats checkpoint =
+        Checkpoint::begin(*pool_, *wal_).complete(*wal_);
+    EXPECT_EQ(checkpoint.dirty_pages, 0u);
+    EXPECT_EQ(checkpoint.redo_lsn, checkpoint.checkpoint_lsn);
+    checkpoint_lsn = checkpoint.checkpoint_lsn;
+    for (int id = kRowsBefore; id < kRowsBefore + kRowsAfter; ++id) {
+      insertRow(table, id);
+    }
+  }
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.checkpoint_lsn, checkpoint_lsn);
+  // The checkpoint record itself plus the inserts after it.
+  EXPECT_EQ(stats.records_scanned, static_cast<uint64_t>(kRowsAfter + 1));
+  EXPECT_EQ(stats.records_redone, static_cast<uint64_t>(kRowsAfter));
+
+  Table table = Table::getTable(kTableName);
+  EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+            static_cast<size_t>(kRowsBefore + kRowsAfter));
+  EXPECT_EQ(lookUpValue(table, 3), "value-3");
+  EXPECT_EQ(lookUpValue(table, kRowsBefore + 7),
+            "value-" + std::to_string(kRowsBefore + 7));
+}
+
+TEST_F(RecoveryTest, CheckpointKeepsDirtyPagesRecoverable) {
+  constexpr int kRows = 300;
+  {
+    Table table = Table::initialize(kTableName, schema());
+    table.createIndex({"id"});
+    for (int id = 0; id < kRows; ++id) {
+      insertRow(table, id);
+    }
+    // Nothing was written back, so every heap page is in the checkpoint's
+    // dirty page table and redo has to start at the first record.
+    const CheckpointStats checkpoint =
+        Checkpoint::begin(*pool_, *wal_).complete(*wal_);
+    EXPECT_GT(checkpoint.dirty_pages, 1u);
+    EXPECT_EQ(checkpoint.stale_indexes, 1u);
+    EXPECT_EQ(checkpoint.redo_lsn, 0u);
+  }
+  crash();
+
+  restart();
+  const RecoveryStats stats = Recovery::run(kWalPath, *pool_);
+  EXPECT_EQ(stats.redo_start_lsn, 0u);
+  EXPECT_EQ(stats.records_redone, static_cast<uint64_t>(kRows));
+  EXPECT_EQ(stats.indexes_rebuilt, 1u);
+
+  Table table = Table::getTable(kTableName);
+  EXPECT_EQ(table.heapFile().collectRids(*pool_).size(),
+            static_cast<size_t>(kRows));
+  EXPECT_EQ(lookUpValue(table, kRows - 1),
+            "value-" + std::to_string(kRows - 1));
+}
@@ -3,19 +3,25 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <chrono>
 #include <cstdio>
 #include <filesystem>
 #include <fstream>
 #include <memory>
 #include <nlohmann/json.hpp>
+#include <thread>
 
+#include "catalog/table_metadata.h"
 #include "execution/executor.h"
 #include "execution/parsers/delete_parser.h"
 #include "execution/parsers/insert_parser.h"
 #include "execution/parsers/select_parser.h"
 #include "storage/buffer/bufferpool.h"
+#include "storage/index/btreecursor.h"
 #include "storage/page/page.h"
+#include "storage/record/record_serializer.h"
 #include "storage/wal/wal.h"
+#include "storage/wal/wal_reader.h"
 #include "storage/wal/wal_record.h"
 
 class TableTest : public ::testing::Test {
@@ -28,7 +34,7 @@ class TableTest : public ::testing::Test {
   void SetUp() override {
     std::filesystem::create_directories("data");
     Table::removeBackingFilesFor(kTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
     wal_ = WAL::initializeNew(kWalPath);
     pool_ = std::make_unique<BufferPool>(*wal_);
   }
@@ -37,7 +43,7 @@ class TableTest : public ::testing::Test {
     pool_.reset();
     wal_.reset();
     Table::removeBackingFilesFor(kTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
   }
 
   static Table createSingleColumnTable() {
@@ -59,41 +65,18 @@ class TableTest : public ::testing::Test {
   }
 
   static std::vector<WALRecord> readWalRecords(const std::string& wal_path) {
-    std::ifstream wal_file(wal_path, std::ios::binary);
-    if (!wal_file) {
+    if (!std::filesystem::exists(wal_path)) {
       return {};
     }
 
-    std::vector<char> raw_bytes((std::istreambuf_iterator<char>(wal_file)),
-                                std::istreambuf_iterator<char>());
+    WALReader reader(wal_path);
     std::vector<WALRecord> records;
-    std::size_t offset = 0;
-
-    while (offset < raw_bytes.size()) {
-      const std::size_t header_size = sizeof(uint64_t) +
-                                      sizeof(WALRecord::RecordType) +
-                                      sizeof(uint16_t) + sizeof(uint32_t);
-      if (raw_bytes.size() - offset < header_size) {
-        throw std::runtime_error("Incomplete WAL header in test fixture.");
-      }
-
-      uint32_t body_size = 0;
-      std::memcpy(&body_size,
-                  raw_bytes.data() + offset + sizeof(uint64_t) +
-                      sizeof(WALRecord::RecordType) + sizeof(uint16_t),
-                  sizeof(uint32_t));
-
-      const std::size_t record_size = header_size + body_size;
-      if (raw_bytes.size() - offset < record_size) {
-        throw std::runtime_error("Incomplete WAL record body in test fixture.");
-      }
-
-      std::vector<std::byte> record_bytes(record_size);
-      std::memcpy(record_bytes.data(), raw_bytes.data() + offset, record_size);
-      records.push_back(WALRecord::deserialize(record_bytes));
-      offset += record_size;
+    while (auto record = reader.next()) {
+      records.push_back(std::move(*record));
+    }
+    if (reader.hasTornTail()) {
+      throw std::runtime_error("Incomplete WAL record in test fixture.");
     }
-
     return records;
   }
 };
@@ -172,6 +155,31 @@ TEST_F(TableTest, GetTableDoesNotCreateMissingDataDirectory) {
   EXPECT_FALSE(std::filesystem::exists("data"));
 }
 
+TEST_F(TableTest, RelationRegistryMapsRelationIdsToTableNames) {
+  static constexpr const char* kOtherTableName = "table_test_other_table";
+  Table::removeBackingFilesFor(kOtherTableName);
+  const Schema schema(std::vector<Column>{Column("id", Column::Type::Integer)});
+  std::uint32_t relation_id = 0;
+  std::uint32_t other_relation_id = 0;
+  {
+    Table table = Table::initialize(kTableName, schema);
+    Table other = Table::initialize(kOtherTableName, schema);
+    relation_id = table.relationId();
+    other_relation_id = other.relationId();
+  }
+  ASSERT_NE(relation_id, other_relation_id);
+
+  const auto registry = TableMetadataStore::relationRegistry();
+  ASSERT_EQ(registry.count(relation_id), 1u);
+  EXPECT_EQ(registry.at(relation_id), kTableName);
+  ASSERT_EQ(registry.count(other_relation_id), 1u);
+  EXPECT_EQ(registry.at(other_relation_id), kOtherTableName);
+
+  Table::removeBackingFilesFor(kOtherTableName);
+  EXPECT_EQ(TableMetadataStore::relationRegistry().count(other_relation_id),
+            0u);
+}
+
 TEST_F(TableTest, InsertIndexFindRIDAndReadRowRoundTrip) {
   Table table = createSingleColumnTable();
 
@@ -187,6 +195,73 @@ TEST_F(TableTest, InsertIndexFindRIDAndReadRowRoundTrip) {
   EXPECT_EQ(singleVarcharValue(restored), "table-value");
 }
 
+TEST_F(TableTest, CreateIndexLoadsRowsAlreadyInTheHeap) {
+  Table table = Table::initialize(
+      kTableName,
+      Schema(std::vector<Column>{Column("id", Column::Type::Integer),
+                                 Column("value", Column::Type::Varchar)}));
+  const int num_rows = 3000;
+  std::vector<RID> rids(num_rows);
+  for (int row = 0; row < num_rows; ++row) {
+    const int id = (row * 7919) % num_rows;
+    const TypedRow typed_row{
+        {FieldValue{static_cast<Column::IntegerType>(id)},
+         FieldValue{std::string("value-") + std::to_string(id)}}};
+    rids[id] = table.heapFile().insertRecord(
+        *pool_, *wal_,
+        RecordSerializer(table.schema(), typed_row).serializedBytes());
+  }
+  table.heapFile().removeRecord(*pool_, *wal_, rids[42]);
+
+  table.createIndex(*pool_, {"id"});
+  ASSERT_TRUE(table.indexFile().has_value());
+  EXPECT_NE(table.indexFile()->get().getRootPageID(), 0u);
+
+  for (int id = 0; id < num_rows; ++id) {
+    const std::string key =
+        table.tryBuildExactMatchIndexKey(
+                 {{"id", FieldValue{static_cast<Column::IntegerType>(id)}}})
+            .value();
+    const BTreeCursor::Boundary exact{key, true};
+    const std::vector<IndexEntry> entries = BTreeCursor::findEntries(
+        *pool_, table.requireIndexFile(), {exact, exact}, false);
+    if (id == 42) {
+      EXPECT_TRUE(entries.empty());
+      continue;
+    }
+    ASSERT_EQ(entries.size(), 1u) << "id=" << id;
+    EXPECT_EQ(entries.front().rid.heap_page_id, rids[id].heap_page_id);
+    EXPECT_EQ(entries.front().rid.slot_id, rids[id].slot_id);
+  }
+}
+
+TEST_F(TableTest, DropThenCreateWithBackgroundWriterRunning) {
+  std::string heap_path;
+  std::string index_path;
+  {
+    Table table = createSingleColumnTable();
+    const TypedRow row{{FieldValue{static_cast<Column::IntegerType>(1)},
+                        FieldValue{std::string("dropped")}}};
+    table.heapFile().insertRecord(
+        *pool_, *wal_, RecordSerializer(table.schema(), row).serializedBytes());
+    heap_path = table.heapFile().rawFile().getFilePath();
+    index_path = table.requireIndexFile().getFilePath();
+  }
+  // Makes the table's dirty pages flushable by the background writer.
+  wal_->flush();
+
+  Table::removeBackingFilesFor(kTableName, *pool_);
+  // Several rounds of the writer at its default 200 ms delay.
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  EXPECT_FALSE(std::filesystem::exists(heap_path));
+  EXPECT_FALSE(std::filesystem::exists(index_path));
+  EXPECT_FALSE(File::fileIdOf(heap_path).has_value());
+  EXPECT_FALSE(File::fileIdOf(index_path).has_value());
+
+  Table table = createSingleColumnTable();
+  EXPECT_TRUE(table.heapFile().collectRids(*pool_).empty());
+}
+
 TEST_F(TableTest, HasIndexForColumnChecksCompositeIndexMembership) {
   Table table = Table::initialize(
       kTableName,
@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 #include <cstdio>
+#include <filesystem>
 #include <memory>
 #include <random>
 #include <string>
@@ -35,7 +36,7 @@ class ExecutorTest : public ::testing::Test {
   void SetUp() override {
     Table::removeBackingFilesFor(kTableName);
     Table::removeBackingFilesFor(kJoinTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
     wal_ = WAL::initializeNew(kWalPath);
     pool_ = std::make_unique<BufferPool>(*wal_);
     table_ = std::make_unique<Table>(Table::initialize(
@@ -62,7 +63,7 @@ class ExecutorTest : public ::testing::Test {
     wal_.reset();
     Table::removeBackingFilesFor(kTableName);
     Table::removeBackingFilesFor(kJoinTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
   }
 
   static std::string singleVarcharValue(const TypedRow& row) {
@@ -301,7 +302,7 @@ TEST_F(ExecutorTest, ReadSelectReturnsSumForDoubleColumn) {
   ASSERT_TRUE(std::holds_alternative<Column::DoubleType>(rows[0].values[0]));
   EXPECT_DOUBLE_EQ(std::get<Column::DoubleType>(rows[0].values[0]), 12.75);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + table_name));
   EXPECT_FALSE(Table::isPersisted(table_name));
 }
 
@@ -349,7 +350,7 @@ TEST_F(ExecutorTest, ReadSelectCountIgnoresNullValues) {
   ASSERT_EQ(rows[0].values.size(), 1u);
   EXPECT_EQ(std::get<Column::IntegerType>(rows[0].values[0]), 1);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + table_name));
   EXPECT_FALSE(Table::isPersisted(table_name));
 }
 
@@ -386,7 +387,7 @@ TEST_F(ExecutorTest, ReadSelectReturnsCountDistinctForSingleColumn) {
   ASSERT_EQ(rows[0].values.size(), 1u);
   EXPECT_EQ(std::get<Column::IntegerType>(rows[0].values[0]), 2);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + table_name));
   EXPECT_FALSE(Table::isPersisted(table_name));
 }
 
@@ -472,7 +473,7 @@ TEST_F(ExecutorTest, InsertFillsOmittedColumnsWithNull) {
   EXPECT_EQ(std::get<Column::IntegerType>(rows[0].values[0]), 7);
   EXPECT_TRUE(std::holds_alternative<std::monostate>(rows[0].values[1]));
 
-  executor::drop_table(DropTableParser("DROP TABLE " + table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + table_name));
   EXPECT_FALSE(Table::isPersisted(table_name));
 }
 
@@ -789,7 +790,7 @@ TEST_F(ExecutorTest, UpdateAppliesSelfPlusLiteralExpression) {
   ASSERT_TRUE(std::holds_alternative<Column::DoubleType>(rows[0].values[0]));
   EXPECT_DOUBLE_EQ(std::get<Column::DoubleType>(rows[0].values[0]), 13.0);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + table_name));
   EXPECT_FALSE(Table::isPersisted(table_name));
 }
 
@@ -861,6 +862,7 @@ TEST_F(ExecutorTest, CreateAndDropTable) {
   CreateTableParser parser("CREATE TABLE new_table (id INTEGER, name VARCHAR)");
   executor::create_table(parser);
   executor::create_index(
+      *pool_,
       CreateIndexParser("CREATE INDEX idx_new_table_id ON new_table (id)"));
 
   // Brackets to limit the scope of reopened table and ensure file handles are
@@ -876,7 +878,7 @@ TEST_F(ExecutorTest, CreateAndDropTable) {
     EXPECT_EQ(new_table.indexedColumnNames(), (std::vector<std::string>{"id"}));
   }
 
-  executor::drop_table(DropTableParser("DROP TABLE new_table"));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE new_table"));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -895,7 +897,7 @@ TEST_F(ExecutorTest, CreateTableBuildsIndexFromSingleColumnPrimaryKey) {
     ASSERT_TRUE(new_table.indexFile().has_value());
   }
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -930,7 +932,7 @@ TEST_F(ExecutorTest, CreateTableRejectsDuplicateCompositePrimaryKeyRows) {
                  std::runtime_error);
   }
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -970,7 +972,7 @@ TEST_F(ExecutorTest, ReadSelectUsesCompositePrimaryKeyPath) {
   ASSERT_TRUE(std::holds_alternative<Column::VarcharType>(rows[0].values[0]));
   EXPECT_EQ(std::get<Column::VarcharType>(rows[0].values[0]), "target");
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -1031,7 +1033,7 @@ TEST_F(ExecutorTest, ReadSelectFiltersNonKeyColumnAfterCompositeKeyPrefixScan) {
   EXPECT_EQ(std::get<Column::IntegerType>(rows[1].values[1]), 249);
   EXPECT_EQ(std::get<Column::IntegerType>(rows[2].values[1]), 319);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -1106,7 +1108,7 @@ TEST_F(ExecutorTest, ReadSelectFindsTpccCustomerByNameAfterLargePrefixScan) {
   ASSERT_EQ(rows.size(), 1u);
   EXPECT_EQ(std::get<Column::IntegerType>(rows[0].values[1]), 990);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
@@ -1224,7 +1226,7 @@ TEST_F(ExecutorTest, ReadSelectFindsTpccCustomerByNameWithFullCustomerRows) {
   ASSERT_EQ(rows.size(), 1u);
   EXPECT_EQ(std::get<Column::IntegerType>(rows[0].values[2]), 990);
 
-  executor::drop_table(DropTableParser("DROP TABLE " + new_table_name));
+  executor::drop_table(*pool_, DropTableParser("DROP TABLE " + new_table_name));
   EXPECT_FALSE(Table::isPersisted(new_table_name));
 }
 
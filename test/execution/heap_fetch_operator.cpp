@@ -4,6 +4,7 @@
 #include <unistd.h>
 
 #include <cstdio>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <vector>
@@ -30,7 +31,7 @@ class HeapFetchOperatorTest : public ::testing::Test {
 
   void SetUp() override {
     Table::removeBackingFilesFor(kTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
     wal_ = WAL::initializeNew(kWalPath);
     pool_ = std::make_unique<BufferPool>(*wal_);
     table_ = std::make_unique<Table>(Table::initialize(
@@ -59,7 +60,7 @@ class HeapFetchOperatorTest : public ::testing::Test {
     pool_.reset();
     wal_.reset();
     Table::removeBackingFilesFor(kTableName);
-    std::remove(kWalPath);
+    std::filesystem::remove_all(kWalPath);
   }
 };
 
@@ -7,6 +7,7 @@
 #include <sys/wait.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
@@ -18,6 +19,7 @@
 #include <string>
 #include <system_error>
 #include <thread>
+#include <vector>
 
 #include "catalog/table.h"
 #include "execution/executor.h"
@@ -221,7 +223,7 @@ void forceDataPagesToDisk(BufferPool& pool, WAL& wal) {
 void prepareTpccLikeDataset(const std::filesystem::path& temp_dir) {
   ScopedCurrentDirectory cwd(temp_dir);
   std::filesystem::create_directories("data");
-  std::remove("server_setup.wal");
+  std::filesystem::remove_all("server_setup.wal");
 
   auto wal = WAL::initializeNew("server_setup.wal");
   auto pool = std::make_unique<BufferPool>(*wal);
@@ -376,3 +378,56 @@ TEST_F(ServerTest, BatchUpdateInsertsPreparedStatementRows) {
   ASSERT_EQ(1, query_response.at("rows").at(0).size());
   EXPECT_EQ("b", query_response.at("rows").at(0).at(0).get<std::string>());
 }
+
+TEST_F(ServerTest, ConcurrentInsertsKeepPrimaryKeysUnique) {
+  constexpr int kKeys = 100;
+  constexpr int kThreadsPerTable = 2;
+  constexpr int kInsertTimeoutMs = 5000;
+  const std::vector<std::string> tables = {"insert_probe_a", "insert_probe_b"};
+  for (const std::string& table : tables) {
+    nlohmann::json create_response = sendRequest(
+        port_, "update",
+        "CREATE TABLE " + table + " (id int NOT NULL, PRIMARY KEY (id))",
+        nlohmann::json::array(), kInsertTimeoutMs);
+    ASSERT_TRUE(create_response.value("ok", false));
+  }
+
+  // Both tables take inserts at once, and on each one two clients race to
+  // insert every key.
+  std::vector<std::atomic<int>> inserted(tables.size());
+  std::atomic<int> client_errors{0};
+  std::vector<std::thread> clients;
+  for (std::size_t table = 0; table < tables.size(); ++table) {
+    for (int client = 0; client < kThreadsPerTable; ++client) {
+      clients.emplace_back([&, table] {
+        for (int key = 0; key < kKeys; ++key) {
+          try {
+            const nlohmann::json response = sendRequest(
+                port_, "update",
+                "INSERT INTO " + tables[table] + " VALUES (?)",
+                nlohmann::json::array({key}), kInsertTimeoutMs);
+            if (response.value("ok", false)) {
+              ++inserted[table];
+            }
+          } catch (const std::exception&) {
+            ++client_errors;
+          }
+        }
+      });
+    }
+  }
+  for (std::thread& client : clients) {
+    client.join();
+  }
+  ASSERT_EQ(client_errors.load(), 0);
+
+  for (std::size_t table = 0; table < tables.size(); ++table) {
+    EXPECT_EQ(inserted[table].load(), kKeys) << tables[table];
+    nlohmann::json query_response =
+        sendRequest(port_, "query", "SELECT id FROM " + tables[table],
+                    nlohmann::json::array(), kInsertTimeoutMs);
+    ASSERT_TRUE(query_response.value("ok", false));
+    EXPECT_EQ(query_response.at("rows").size(), static_cast<size_t>(kKeys))
+        << tables[table];
+  }
+}
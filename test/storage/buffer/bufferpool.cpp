@@ -3,12 +3,18 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <memory>
 #include <set>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "schema/schema.h"
 #include "storage/disk/file.h"
@@ -41,7 +47,7 @@ class BufferPoolTest : public ::testing::Test {
 
   void SetUp() override {
     std::remove(kTestFile);
-    std::remove(kWalFile);
+    std::filesystem::remove_all(kWalFile);
     std::ofstream ofs(kTestFile, std::ios::binary);
     std::array<char, Page::PAGE_SIZE_BYTE> empty{};
     ofs.write(empty.data(), empty.size());
@@ -54,12 +60,12 @@ class BufferPoolTest : public ::testing::Test {
   void TearDown() override {
     pool.reset();
     std::remove(kTestFile);
-    std::remove(kWalFile);
+    std::filesystem::remove_all(kWalFile);
   }
 };
 
 TEST_F(BufferPoolTest, GetPageSamePageReturnsCachedPage) {
-  uint16_t page_id = pool->createPage(PageKind::Heap, *testFile);
+  PageId page_id = pool->createPage(PageKind::Heap, *testFile);
   Page* page1 = pool->pinPage(page_id, *testFile);
   Page* page1_again = pool->pinPage(page_id, *testFile);
   EXPECT_EQ(page1, page1_again);
@@ -69,7 +75,7 @@ TEST_F(BufferPoolTest, GetPageSamePageReturnsCachedPage) {
 
 TEST_F(BufferPoolTest, createNewPageAllFramesFilledSuccessfully) {
   for (size_t i = 0; i < max_frames_count; ++i) {
-    uint16_t page_id = pool->createPage(PageKind::Heap, *testFile);
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
     Page* page = pool->pinPage(page_id, *testFile);
     ASSERT_NE(page, nullptr);
     pool->unpinPage(page, *testFile);
@@ -83,10 +89,10 @@ TEST_F(BufferPoolTest, createNewPageWithEviction) {
   // eviction writes them out to disk.
   std::array<std::array<char, Page::PAGE_SIZE_BYTE>, max_frames_count + 10>
       page_copies;
-  std::array<uint16_t, max_frames_count + 10> page_ids;
+  std::array<PageId, max_frames_count + 10> page_ids;
 
   for (size_t i = 0; i < max_frames_count + 10; ++i) {
-    uint16_t page_id = pool->createPage(PageKind::Heap, *testFile);
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
     Page* page = pool->pinPage(page_id, *testFile);
     ASSERT_NE(page, nullptr);
 
@@ -123,22 +129,401 @@ TEST_F(BufferPoolTest, createNewPageWithEviction) {
 
 TEST_F(BufferPoolTest, EvictionFlushesWALUpToPageLSN) {
   std::vector<std::byte> body = {std::byte{0x01}, std::byte{0x02}};
-  constexpr std::uint64_t kRecordLsn = 0;
+  // pageLSN is the end of the page's latest record.
+  const std::uint64_t record_end_lsn = WALRecord::size_bytes(body);
 
   // The record stays buffered until eviction forces WAL durability.
-  wal->write(WALRecord::RecordType::INSERT, 1, body);
-  EXPECT_EQ(wal->getFlushedLSN(), 0u);
+  wal->write(WALRecord::RecordType::INSERT, 1, 1, body);
+  EXPECT_EQ(wal->getDurableEndLSN(), 0u);
 
-  for (size_t i = 0; i < max_frames_count; ++i) {
-    uint16_t page_id = pool->createPage(PageKind::Heap, *testFile);
+  // Fill every frame so that the next page has to evict one of them.
+  for (size_t i = 0; i < pool->frameCount(); ++i) {
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
     Page* page = pool->pinPage(page_id, *testFile);
     // Mark each resident page as depending on the same WAL record.
-    page->setPageLSN(kRecordLsn);
+    page->setPageLSN(record_end_lsn);
     pool->unpinPage(page, *testFile);
   }
 
   // Allocate one more page to force eviction of a dirty page.
   (void)pool->createPage(PageKind::Heap, *testFile);
 
-  EXPECT_EQ(wal->getFlushedLSN(), kRecordLsn);
-}
\ No newline at end of file
+  EXPECT_GE(wal->getDurableEndLSN(), record_end_lsn);
+  EXPECT_EQ(wal->getFlushedLSN(), 0u);
+}
+// The write-back pass cleans unpinned dirty pages whose pageLSN is durable,
+// and leaves pinned pages and pages that would need a WAL flush alone.
+TEST_F(BufferPoolTest, WriteBackDirtyPagesSkipsPinnedAndUnflushablePages) {
+  constexpr std::uint64_t kUndurableLsn = 1000;
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < max_frames_count; ++i) {
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
+    Page* page = pool->pinPage(page_id, *testFile);
+    auto record = serializeSingleVarcharRecord("row" + std::to_string(i));
+    ASSERT_TRUE(page->insertCell(record.serializedBytes()).has_value());
+    pool->unpinPage(page, *testFile);
+    page_ids.push_back(page_id);
+  }
+
+  Page* unflushable_page = pool->pinPage(page_ids[0], *testFile);
+  unflushable_page->setPageLSN(kUndurableLsn);
+  pool->unpinPage(unflushable_page, *testFile);
+  Page* pinned_page = pool->pinPage(page_ids[1], *testFile);
+
+  pool->writeBackDirtyPages(pool->frameCount());
+  const auto wal_flushed_lsn = wal->getFlushedLSN();
+
+  EXPECT_TRUE(unflushable_page->isDirty());
+  EXPECT_TRUE(pinned_page->isDirty());
+  EXPECT_EQ(wal->getFlushedLSN(), wal_flushed_lsn)
+      << "write-back must not force the WAL";
+  for (size_t i = 2; i < page_ids.size(); ++i) {
+    Page* page = pool->pinPage(page_ids[i], *testFile);
+    EXPECT_FALSE(page->isDirty()) << "page " << page_ids[i];
+
+    std::array<char, Page::PAGE_SIZE_BYTE> on_disk{};
+    testFile->readPageIntoBuffer(page_ids[i], on_disk.data());
+    EXPECT_EQ(std::memcmp(on_disk.data(), page->data(), on_disk.size()), 0)
+        << "page " << page_ids[i] << " was not written back";
+    pool->unpinPage(page, *testFile);
+  }
+  pool->unpinPage(pinned_page, *testFile);
+
+  const auto stats = pool->stats();
+  EXPECT_GE(stats.background_writer_pages_written, page_ids.size() - 2);
+  EXPECT_GE(stats.background_writer_unflushable_skips, 1u);
+}
+
+// Many threads pinning the same small set of pages must always see the page
+// they asked for, and every pin must be matched by exactly one hit or miss.
+TEST_F(BufferPoolTest, ConcurrentPinUnpinSeesConsistentPages) {
+  constexpr size_t kPageCount = 64;
+  constexpr size_t kThreadCount = 8;
+  constexpr size_t kIterations = 5000;
+
+  std::vector<PageId> page_ids;
+  std::vector<std::array<char, Page::PAGE_SIZE_BYTE>> page_copies(kPageCount);
+  for (size_t i = 0; i < kPageCount; ++i) {
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
+    Page* page = pool->pinPage(page_id, *testFile);
+    RecordSerializer cell =
+        serializeSingleVarcharRecord("page_" + std::to_string(i));
+    page->insertCell(cell.serializedBytes());
+    std::memcpy(page_copies[i].data(), page->data(), Page::PAGE_SIZE_BYTE);
+    pool->unpinPage(page, *testFile);
+    page_ids.push_back(page_id);
+  }
+  const BufferPoolStats before = pool->stats();
+
+  std::vector<std::thread> workers;
+  std::vector<size_t> mismatches(kThreadCount, 0);
+  for (size_t t = 0; t < kThreadCount; ++t) {
+    workers.emplace_back([&, t]() {
+      File file(kTestFile);
+      for (size_t i = 0; i < kIterations; ++i) {
+        const size_t index = (i * 7 + t * 13) % kPageCount;
+        Page* page = pool->pinPage(page_ids[index], file);
+        if (page->getPageID() != page_ids[index] ||
+            std::memcmp(page->data(), page_copies[index].data(),
+                        Page::PAGE_SIZE_BYTE) != 0) {
+          mismatches[t]++;
+        }
+        pool->unpinPage(page, file);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (size_t t = 0; t < kThreadCount; ++t) {
+    EXPECT_EQ(mismatches[t], 0u) << "thread " << t;
+  }
+  const BufferPoolStats after = pool->stats();
+  EXPECT_EQ(after.pin_page_calls - before.pin_page_calls,
+            kThreadCount * kIterations);
+  EXPECT_EQ((after.resident_hits - before.resident_hits) +
+                (after.misses - before.misses),
+            kThreadCount * kIterations);
+}
+
+// Pages that only exist on disk are loaded by whichever thread misses first;
+// threads racing on the same page must wait for that load instead of reading
+// the page again.
+TEST_F(BufferPoolTest, ConcurrentMissesReadEachPageOnce) {
+  constexpr size_t kPageCount = 32;
+  constexpr size_t kThreadCount = 8;
+
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < kPageCount; ++i) {
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    PageId page_id = testFile->allocateNextPageId();
+    Page page = Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    RecordSerializer cell =
+        serializeSingleVarcharRecord("disk_page_" + std::to_string(i));
+    page.insertCell(cell.serializedBytes());
+    testFile->writePageFromBuffer(page_id, buffer.data());
+    page_ids.push_back(page_id);
+  }
+
+  std::vector<std::thread> workers;
+  std::vector<size_t> mismatches(kThreadCount, 0);
+  for (size_t t = 0; t < kThreadCount; ++t) {
+    workers.emplace_back([&, t]() {
+      File file(kTestFile);
+      for (size_t i = 0; i < kPageCount; ++i) {
+        Page* page = pool->pinPage(page_ids[i], file);
+        if (page->getPageID() != page_ids[i] || page->slotCount() != 1) {
+          mismatches[t]++;
+        }
+        pool->unpinPage(page, file);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (size_t t = 0; t < kThreadCount; ++t) {
+    EXPECT_EQ(mismatches[t], 0u) << "thread " << t;
+  }
+  EXPECT_EQ(pool->stats().read_page_into_buffer_calls, kPageCount);
+}
+
+// Prefetched pages are read in one batch, left unpinned, and then pinned as
+// hits. Resident pages and page ids past the end of the file are skipped.
+TEST_F(BufferPoolTest, PrefetchPagesLoadsPagesAheadOfPins) {
+  constexpr size_t kPageCount = 100;
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < kPageCount; ++i) {
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    PageId page_id = testFile->allocateNextPageId();
+    Page page = Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    RecordSerializer cell =
+        serializeSingleVarcharRecord("disk_page_" + std::to_string(i));
+    page.insertCell(cell.serializedBytes());
+    testFile->writePageFromBuffer(page_id, buffer.data());
+    page_ids.push_back(page_id);
+  }
+  Page* resident = pool->pinPage(page_ids[0], *testFile);
+  pool->unpinPage(resident, *testFile);
+
+  std::vector<PageId> requested = page_ids;
+  requested.push_back(testFile->getMaxPageID() + 1);
+  EXPECT_EQ(pool->prefetchPages(*testFile, requested), kPageCount - 1);
+  const BufferPoolStats after_prefetch = pool->stats();
+  EXPECT_EQ(after_prefetch.prefetched_pages, kPageCount - 1);
+
+  for (size_t i = 0; i < kPageCount; ++i) {
+    Page* page = pool->pinPage(page_ids[i], *testFile);
+    EXPECT_EQ(page->getPageID(), page_ids[i]);
+    EXPECT_EQ(page->slotCount(), 1u);
+    pool->unpinPage(page, *testFile);
+  }
+  const BufferPoolStats after_pins = pool->stats();
+  EXPECT_EQ(after_pins.misses, after_prefetch.misses);
+  EXPECT_EQ(after_pins.resident_hits - after_prefetch.resident_hits,
+            kPageCount);
+}
+
+// Misses on consecutive pages of a file start read-ahead, so a scan in file
+// order reads most of its pages in batches instead of one by one.
+TEST_F(BufferPoolTest, SequentialMissesReadAhead) {
+  constexpr size_t kPageCount = 200;
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < kPageCount; ++i) {
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    PageId page_id = testFile->allocateNextPageId();
+    Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    testFile->writePageFromBuffer(page_id, buffer.data());
+    page_ids.push_back(page_id);
+  }
+  ASSERT_GT(pool->readAheadPages(), 1u);
+
+  for (int page_id : page_ids) {
+    Page* page = pool->pinPage(page_id, *testFile);
+    EXPECT_EQ(page->getPageID(), page_id);
+    pool->unpinPage(page, *testFile);
+  }
+  const BufferPoolStats stats = pool->stats();
+  // Only the first page and the page that starts each window miss.
+  const size_t windows =
+      (kPageCount - 1 + pool->readAheadPages() - 1) / pool->readAheadPages();
+  EXPECT_EQ(stats.misses, 1 + windows);
+  EXPECT_EQ(stats.read_ahead_batches, windows);
+  EXPECT_EQ(stats.read_page_into_buffer_calls, kPageCount);
+  EXPECT_EQ(stats.prefetched_pages, kPageCount - 1);
+}
+
+// A scan of a file larger than a quarter of the pool recycles a small ring of
+// frames, so it evicts only as many resident pages as the ring holds.
+TEST_F(BufferPoolTest, BulkReadRingLeavesResidentPagesAlone) {
+  constexpr const char* kScanFile = "bufferpool_scan.db";
+  std::remove(kScanFile);
+  auto scan_file = std::make_unique<File>(kScanFile);
+  const size_t page_count = pool->frameCount() / 4 + 1000;
+  std::vector<int> page_ids;
+  for (size_t i = 0; i < page_count; ++i) {
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    PageId page_id = scan_file->allocateNextPageId();
+    Page::initializeNew(buffer.data(), PageKind::Heap, 0, page_id);
+    scan_file->writePageFromBuffer(page_id, buffer.data());
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(pool->bulkReadStrategy(*testFile), nullptr);
+  auto strategy = pool->bulkReadStrategy(*scan_file);
+  ASSERT_NE(strategy, nullptr);
+
+  for (size_t i = 0; i < pool->frameCount(); ++i) {
+    (void)pool->createPage(PageKind::Heap, *testFile);
+  }
+  const BufferPoolStats before = pool->stats();
+  for (int page_id : page_ids) {
+    Page* page = pool->pinPage(page_id, *scan_file, strategy.get());
+    EXPECT_EQ(page->getPageID(), page_id);
+    pool->unpinPage(page, *scan_file);
+  }
+  const BufferPoolStats after = pool->stats();
+
+  const size_t ring_size = strategy->ringSize();
+  // Every scanned page evicted one, but only filling the ring took frames
+  // from the pages created above; the rest recycled the ring.
+  EXPECT_EQ(after.evictions - before.evictions, page_count);
+  EXPECT_EQ(after.bulk_read.pins, page_count);
+  // Pages read ahead into the ring are hits when the scan reaches them.
+  EXPECT_EQ(after.bulk_read.resident_hits,
+            after.resident_hits - before.resident_hits);
+  EXPECT_GT(after.bulk_read.resident_hits, 0u);
+  EXPECT_EQ(after.bulk_read.shared_frames, ring_size);
+  EXPECT_EQ(after.bulk_read.ring_reuses, page_count - ring_size);
+  EXPECT_EQ(after.bulk_read.dirty_writes, 0u);
+
+  pool.reset();
+  scan_file.reset();
+  std::remove(kScanFile);
+}
+
+// Growing adds room without evicting; shrinking writes the pages in the
+// dropped frames back, so they reload unchanged.
+TEST_F(BufferPoolTest, ResizeKeepsPagesAcrossGrowAndShrink) {
+  constexpr size_t kPageCount = 96;
+  pool = std::make_unique<BufferPool>(*wal, EvictionPolicyKind::Clock, 64, 128);
+  EXPECT_EQ(pool->frameCount(), 64u);
+  EXPECT_EQ(pool->maxFrameCount(), 128u);
+  EXPECT_THROW(pool->resize(129), std::invalid_argument);
+  EXPECT_THROW(pool->resize(0), std::invalid_argument);
+
+  EXPECT_EQ(pool->resize(128), 128u);
+  std::vector<PageId> page_ids;
+  std::vector<std::array<char, Page::PAGE_SIZE_BYTE>> page_copies(kPageCount);
+  for (size_t i = 0; i < kPageCount; ++i) {
+    PageId page_id = pool->createPage(PageKind::Heap, *testFile);
+    Page* page = pool->pinPage(page_id, *testFile);
+    RecordSerializer cell =
+        serializeSingleVarcharRecord("resize_" + std::to_string(i));
+    page->insertCell(cell.serializedBytes());
+    page->markDirty();
+    std::memcpy(page_copies[i].data(), page->data(), Page::PAGE_SIZE_BYTE);
+    pool->unpinPage(page, *testFile);
+    page_ids.push_back(page_id);
+  }
+  EXPECT_EQ(pool->stats().evictions, 0u);
+
+  EXPECT_EQ(pool->resize(16), 16u);
+  EXPECT_EQ(pool->frameCount(), 16u);
+  EXPECT_EQ(pool->stats().evictions, kPageCount - 16);
+  EXPECT_EQ(pool->stats().dirty_evictions, kPageCount - 16);
+
+  for (size_t i = 0; i < kPageCount; ++i) {
+    Page* page = pool->pinPage(page_ids[i], *testFile);
+    EXPECT_EQ(std::memcmp(page->data(), page_copies[i].data(),
+                          Page::PAGE_SIZE_BYTE),
+              0)
+        << "page " << i;
+    pool->unpinPage(page, *testFile);
+  }
+}
+
+TEST_F(BufferPoolTest, PageGuardsUnpinWhenReleasedMovedOrUnwound) {
+  constexpr size_t kFrames = 4;
+  pool = std::make_unique<BufferPool>(*wal, EvictionPolicyKind::Clock, kFrames,
+                                      0);
+  std::vector<PageId> page_ids;
+  for (size_t i = 0; i < kFrames; ++i) {
+    page_ids.push_back(pool->createPage(PageKind::Heap, *testFile));
+  }
+
+  {
+    std::vector<ReadPageGuard> guards;
+    for (const PageId page_id : page_ids) {
+      guards.push_back(pool->readPage(page_id, *testFile));
+      EXPECT_EQ(guards.back()->getPageID(), page_id);
+    }
+    // Every frame is pinned by a guard.
+    EXPECT_THROW(pool->createPage(PageKind::Heap, *testFile),
+                 std::runtime_error);
+
+    ReadPageGuard moved = std::move(guards.front());
+    EXPECT_FALSE(guards.front());
+    EXPECT_TRUE(moved);
+    moved.release();
+    EXPECT_FALSE(moved);
+    // Releasing one guard frees exactly one frame.
+    page_ids.push_back(pool->createPage(PageKind::Heap, *testFile));
+    guards.push_back(pool->readPage(page_ids.back(), *testFile));
+    EXPECT_THROW(pool->createPage(PageKind::Heap, *testFile),
+                 std::runtime_error);
+  }
+
+  EXPECT_THROW(
+      {
+        WritePageGuard page = pool->writePage(page_ids.back(), *testFile);
+        throw std::runtime_error("statement failed");
+      },
+      std::runtime_error);
+  // All guards are gone, so every frame can be reused again.
+  for (size_t i = 0; i < kFrames; ++i) {
+    page_ids.push_back(pool->createPage(PageKind::Heap, *testFile));
+  }
+  for (const PageId page_id : page_ids) {
+    WritePageGuard page = pool->writePage(page_id, *testFile);
+    EXPECT_EQ(page->getPageID(), page_id);
+  }
+}
+
+TEST_F(BufferPoolTest, WriteGuardExcludesOtherGuardsOnThePage) {
+  const PageId page_id = pool->createPage(PageKind::Heap, *testFile);
+  const PageId other_page_id = pool->createPage(PageKind::Heap, *testFile);
+
+  WritePageGuard writer = pool->writePage(page_id, *testFile);
+  std::atomic<bool> reader_done{false};
+  std::atomic<bool> other_page_done{false};
+  std::thread reader([&] {
+    ReadPageGuard other = pool->readPage(other_page_id, *testFile);
+    other_page_done = true;
+    other.release();
+    ReadPageGuard page = pool->readPage(page_id, *testFile);
+    reader_done = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_TRUE(other_page_done.load());
+  EXPECT_FALSE(reader_done.load());
+
+  writer.release();
+  reader.join();
+  EXPECT_TRUE(reader_done.load());
+}
+
+TEST_F(BufferPoolTest, ReadGuardsShareThePage) {
+  const PageId page_id = pool->createPage(PageKind::Heap, *testFile);
+
+  ReadPageGuard first = pool->readPage(page_id, *testFile);
+  std::atomic<bool> second_done{false};
+  std::thread reader([&] {
+    ReadPageGuard second = pool->readPage(page_id, *testFile);
+    EXPECT_EQ(second.get(), first.get());
+    second_done = true;
+  });
+  reader.join();
+  EXPECT_TRUE(second_done.load());
+}
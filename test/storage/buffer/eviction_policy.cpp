@@ -0,0 +1,181 @@
+#include "storage/buffer/eviction_policy.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <optional>
+#include <set>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kFrameCount = 8;
+
+PageKey keyFor(int page_id) { return static_cast<PageKey>(page_id); }
+
+const EvictionPolicy::CanEvict kAnyFrame = [](int) { return true; };
+
+EvictionPolicy::CanEvict allExcept(std::set<int> pinned) {
+  return [pinned](int frame_id) { return pinned.count(frame_id) == 0; };
+}
+
+// Fills frame i with page i.
+void admitAll(EvictionPolicy& policy, size_t count = kFrameCount) {
+  for (size_t i = 0; i < count; ++i) {
+    policy.recordAdmission(static_cast<int>(i), keyFor(static_cast<int>(i)));
+  }
+}
+
+}  // namespace
+
+TEST(EvictionPolicyTest, ParsesPolicyNames) {
+  EXPECT_EQ(evictionPolicyKindFromString("clock"), EvictionPolicyKind::Clock);
+  EXPECT_EQ(evictionPolicyKindFromString("LRU-K"), EvictionPolicyKind::LRUK);
+  EXPECT_EQ(evictionPolicyKindFromString("2q"), EvictionPolicyKind::TwoQueue);
+  EXPECT_EQ(evictionPolicyKindFromString("Arc"), EvictionPolicyKind::ARC);
+  EXPECT_THROW(evictionPolicyKindFromString("fifo"), std::invalid_argument);
+}
+
+TEST(EvictionPolicyTest, EveryPolicyReturnsNulloptWhenNothingIsEvictable) {
+  for (auto kind : {EvictionPolicyKind::Clock, EvictionPolicyKind::LRUK,
+                    EvictionPolicyKind::TwoQueue, EvictionPolicyKind::ARC}) {
+    auto policy = makeEvictionPolicy(kind, kFrameCount);
+    EXPECT_FALSE(policy->pickVictim(kAnyFrame, std::nullopt).has_value())
+        << policy->name() << " proposed a victim with no resident frames";
+
+    admitAll(*policy);
+    EXPECT_FALSE(
+        policy->pickVictim([](int) { return false; }, std::nullopt).has_value())
+        << policy->name() << " proposed a frame that cannot be evicted";
+
+    // A removed frame is no longer a candidate.
+    for (size_t i = 1; i < kFrameCount; ++i) {
+      policy->recordRemoval(static_cast<int>(i));
+    }
+    auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+    ASSERT_TRUE(victim.has_value()) << policy->name();
+    EXPECT_EQ(victim.value(), 0) << policy->name();
+  }
+}
+
+TEST(EvictionPolicyTest, ClockGivesReferencedFramesASecondChance) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::Clock, kFrameCount);
+  admitAll(*policy);
+  policy->recordHit(0);
+  policy->recordHit(1);
+
+  auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 2);
+
+  // Frame 2 was not evicted (e.g. it got pinned); the hand moves on and
+  // skips frames that cannot be evicted.
+  victim = policy->pickVictim(allExcept({3}), std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 4);
+}
+
+TEST(EvictionPolicyTest, LRUKEvictsPagesWithFewerThanKAccessesFirst) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::LRUK, kFrameCount, 2);
+  admitAll(*policy, 3);
+  // Frames 0 and 1 reach K = 2 accesses; frame 2 is only seen once, so its
+  // backward 2-distance is infinite even though it was admitted last.
+  policy->recordHit(0);
+  policy->recordHit(1);
+
+  auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 2);
+
+  policy->recordRemoval(2);
+  // Among pages with K accesses, the oldest second-to-last access loses.
+  victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 0);
+}
+
+TEST(EvictionPolicyTest, LRUKRemembersHistoryOfEvictedPages) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::LRUK, kFrameCount, 2);
+  policy->recordAdmission(0, keyFor(10));
+  policy->recordEviction(0);
+  policy->recordAdmission(1, keyFor(11));
+
+  // Page 10 comes back into frame 0 and now has two accesses on record, so
+  // the once-seen page 11 is the victim.
+  policy->recordAdmission(0, keyFor(10));
+  auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 1);
+
+  const auto stats = policy->stats();
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.ghost_hits, 1u);
+  EXPECT_EQ(stats.evictions, 1u);
+}
+
+TEST(EvictionPolicyTest, TwoQueueScanDoesNotFlushHotPages) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::TwoQueue, kFrameCount);
+  // Page 100 is evicted from A1in and re-admitted while in A1out, which
+  // promotes it to Am.
+  policy->recordAdmission(0, keyFor(100));
+  policy->recordEviction(0);
+  policy->recordAdmission(0, keyFor(100));
+  EXPECT_EQ(policy->stats().ghost_hits, 1u);
+
+  // A scan fills every other frame once.
+  for (int frame_id = 1; frame_id < static_cast<int>(kFrameCount);
+       ++frame_id) {
+    policy->recordAdmission(frame_id, keyFor(200 + frame_id));
+    policy->recordHit(frame_id);
+  }
+
+  // Scan pages stay in A1in (hits there do not promote) and are evicted
+  // until A1in shrinks back to its 25% target.
+  const size_t scan_pages = kFrameCount - 1;
+  const size_t a1in_target = kFrameCount / 4;
+  for (size_t evicted = 0; evicted < scan_pages - a1in_target; ++evicted) {
+    auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+    ASSERT_TRUE(victim.has_value());
+    EXPECT_NE(victim.value(), 0) << "hot page evicted by a scan";
+    policy->recordEviction(victim.value());
+  }
+  EXPECT_EQ(policy->describeState(), "a1in=2 am=1 a1out=4");
+}
+
+TEST(EvictionPolicyTest, ARCGhostHitInB1ShiftsTargetTowardRecency) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::ARC, kFrameCount);
+  admitAll(*policy);
+  EXPECT_EQ(policy->describeState(), "p=0 t1=8 t2=0 b1=0 b2=0");
+
+  auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 0);
+  policy->recordEviction(0);
+  EXPECT_EQ(policy->describeState(), "p=0 t1=7 t2=0 b1=1 b2=0");
+
+  // Page 0 returns while remembered in B1: it lands in T2 and p grows.
+  policy->recordAdmission(0, keyFor(0));
+  EXPECT_EQ(policy->describeState(), "p=1 t1=7 t2=1 b1=0 b2=0");
+  EXPECT_EQ(policy->stats().ghost_hits, 1u);
+
+  // T1 is still above its target, so REPLACE takes its LRU page.
+  victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 1);
+}
+
+TEST(EvictionPolicyTest, ARCHitPromotesToFrequencyList) {
+  auto policy = makeEvictionPolicy(EvictionPolicyKind::ARC, kFrameCount);
+  admitAll(*policy, 2);
+  policy->recordHit(0);
+  EXPECT_EQ(policy->describeState(), "p=0 t1=1 t2=1 b1=0 b2=0");
+
+  // With p = 0, T1 is preferred, so the page seen once goes first.
+  auto victim = policy->pickVictim(kAnyFrame, std::nullopt);
+  ASSERT_TRUE(victim.has_value());
+  EXPECT_EQ(victim.value(), 1);
+
+  const auto stats = policy->stats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+}
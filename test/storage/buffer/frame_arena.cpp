@@ -0,0 +1,84 @@
+#include "storage/buffer/frame_arena.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+constexpr size_t kArenaSize = size_t{8} << 20;
+
+}  // namespace
+
+TEST(FrameArenaTest, EveryHugePageModeGivesWritableMemory) {
+  for (const HugePageMode mode : {HugePageMode::Off, HugePageMode::Transparent,
+                                  HugePageMode::HugeTLB}) {
+    SCOPED_TRACE(hugePageModeName(mode));
+    FrameArena arena(kArenaSize, mode, NumaMode::Off);
+    ASSERT_NE(arena.data(), nullptr);
+    EXPECT_EQ(arena.size(), kArenaSize);
+    // HugeTLB needs preallocated huge pages and may fall back, but never
+    // to a mode above the one asked for.
+    EXPECT_LE(static_cast<int>(arena.hugePageMode()), static_cast<int>(mode));
+
+    std::memset(arena.data(), 0x5a, arena.size());
+    EXPECT_EQ(arena.data()[0], 0x5a);
+    EXPECT_EQ(arena.data()[arena.size() - 1], 0x5a);
+  }
+}
+
+TEST(FrameArenaTest, ReleaseZeroesTheRange) {
+  FrameArena arena(kArenaSize, HugePageMode::Off, NumaMode::Off);
+  std::memset(arena.data(), 0x5a, arena.size());
+
+  const size_t half = arena.size() / 2;
+  arena.release(half, arena.size() - half);
+
+  EXPECT_EQ(arena.data()[half - 1], 0x5a);
+  EXPECT_EQ(arena.data()[half], 0);
+  EXPECT_EQ(arena.data()[arena.size() - 1], 0);
+}
+
+TEST(FrameArenaTest, ReleaseKeepsPartialPages) {
+  FrameArena arena(kArenaSize, HugePageMode::Off, NumaMode::Off);
+  std::memset(arena.data(), 0x5a, arena.size());
+
+  // Less than a page from an unaligned offset covers no whole page.
+  arena.release(100, 200);
+
+  EXPECT_EQ(arena.data()[100], 0x5a);
+  EXPECT_EQ(arena.data()[299], 0x5a);
+}
+
+TEST(FrameArenaTest, NumaModesPlaceMemoryOrFallBackToOff) {
+  for (const NumaMode mode : {NumaMode::Interleave, NumaMode::Partition}) {
+    SCOPED_TRACE(numaModeName(mode));
+    FrameArena arena(kArenaSize, HugePageMode::Off, mode);
+    std::memset(arena.data(), 0x5a, arena.size());
+
+    if (arena.numaMode() == NumaMode::Partition) {
+      EXPECT_GE(arena.nodeOf(0), 0);
+      EXPECT_GE(arena.nodeOf(arena.size() - 1), 0);
+    } else {
+      EXPECT_EQ(arena.nodeOf(0), -1);
+    }
+  }
+}
+
+TEST(FrameArenaTest, ParsesModeNames) {
+  EXPECT_EQ(hugePageModeFromString("off"), HugePageMode::Off);
+  EXPECT_EQ(hugePageModeFromString("Transparent"), HugePageMode::Transparent);
+  EXPECT_EQ(hugePageModeFromString("HUGETLB"), HugePageMode::HugeTLB);
+  EXPECT_EQ(numaModeFromString("off"), NumaMode::Off);
+  EXPECT_EQ(numaModeFromString("interleave"), NumaMode::Interleave);
+  EXPECT_EQ(numaModeFromString("Partition"), NumaMode::Partition);
+
+  EXPECT_THROW(hugePageModeFromString("always"), std::invalid_argument);
+  EXPECT_THROW(numaModeFromString("local"), std::invalid_argument);
+}
+
+TEST(FrameArenaTest, RejectsEmptyArena) {
+  EXPECT_THROW(FrameArena(0, HugePageMode::Off, NumaMode::Off),
+               std::invalid_argument);
+}
@@ -3,10 +3,26 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
 #include "storage/page/page.h"
 
+namespace {
+
+constexpr std::uint32_t kTestFileId = 1;
+constexpr std::uint32_t kFile1Id = 2;
+constexpr std::uint32_t kFile2Id = 3;
+constexpr std::uint32_t kHeapFileId = 4;
+constexpr std::uint32_t kIndexFileId = 5;
+constexpr std::uint32_t kNewFileId = 6;
+constexpr std::uint32_t kNonexistentFileId = 7;
+
+}  // namespace
+
 class FrameDirectoryTest : public ::testing::Test {
  protected:
   FrameDirectory directory;
@@ -28,11 +44,11 @@ class FrameDirectoryTest : public ::testing::Test {
 };
 
 TEST_F(FrameDirectoryTest, TestClaimFreeFrame) {
-  for (int i = 0; i < FrameDirectory::MAX_FRAME_COUNT; ++i) {
+  for (size_t i = 0; i < directory.frameCount(); ++i) {
     auto frame_opt = directory.reserveFreeFrame();
     ASSERT_TRUE(frame_opt.has_value());
     EXPECT_GE(frame_opt.value(), 0);
-    EXPECT_LT(frame_opt.value(), FrameDirectory::MAX_FRAME_COUNT);
+    EXPECT_LT(static_cast<size_t>(frame_opt.value()), directory.frameCount());
   }
 
   auto no_frame = directory.reserveFreeFrame();
@@ -44,25 +60,26 @@ TEST_F(FrameDirectoryTest, RegisterAndFindPageByID) {
   ASSERT_TRUE(frame_opt.has_value());
   int frame_id = frame_opt.value();
 
-  directory.registerResidentPage(frame_id, 100, "test.db", std::move(page1));
+  directory.registerResidentPage(frame_id, 100, kTestFileId, "test.db",
+                                 *page1);
 
-  auto found_frame = directory.findResidentFrame(100, "test.db");
+  auto found_frame = directory.findResidentFrame(100, kTestFileId);
   ASSERT_TRUE(found_frame.has_value());
   EXPECT_EQ(frame_id, found_frame.value());
 
   // Registration should populate both the lookup table and the frame metadata
   // that eviction and pin tracking depend on.
   const auto& frame = directory.getFrame(frame_id);
-  EXPECT_NE(nullptr, frame.page);
+  EXPECT_TRUE(frame.page.has_value());
   EXPECT_EQ(100, frame.page_id);
-  EXPECT_EQ("test.db", frame.file_path);
+  EXPECT_EQ("test.db", *frame.file_path);
   EXPECT_EQ(0, frame.pin_count);
 
   directory.unregisterResidentPage(frame_id);
 }
 
 TEST_F(FrameDirectoryTest, FindNonExistentPageReturnsNullopt) {
-  auto result = directory.findResidentFrame(999, "nonexistent.db");
+  auto result = directory.findResidentFrame(999, kNonexistentFileId);
   EXPECT_FALSE(result.has_value());
 }
 
@@ -75,16 +92,16 @@ TEST_F(FrameDirectoryTest, RegisterMultiplePagesInDifferentFrames) {
   ASSERT_TRUE(frame2.has_value());
   ASSERT_TRUE(frame3.has_value());
 
-  directory.registerResidentPage(frame1.value(), 10, "file1.db",
-                                 std::move(page1));
-  directory.registerResidentPage(frame2.value(), 20, "file2.db",
-                                 std::move(page2));
-  directory.registerResidentPage(frame3.value(), 30, "file1.db",
-                                 std::move(page3));
+  directory.registerResidentPage(frame1.value(), 10, kFile1Id, "file1.db",
+                                 *page1);
+  directory.registerResidentPage(frame2.value(), 20, kFile2Id, "file2.db",
+                                 *page2);
+  directory.registerResidentPage(frame3.value(), 30, kFile1Id, "file1.db",
+                                 *page3);
 
-  auto found1 = directory.findResidentFrame(10, "file1.db");
-  auto found2 = directory.findResidentFrame(20, "file2.db");
-  auto found3 = directory.findResidentFrame(30, "file1.db");
+  auto found1 = directory.findResidentFrame(10, kFile1Id);
+  auto found2 = directory.findResidentFrame(20, kFile2Id);
+  auto found3 = directory.findResidentFrame(30, kFile1Id);
 
   EXPECT_EQ(frame1.value(), found1.value());
   EXPECT_EQ(frame2.value(), found2.value());
@@ -100,18 +117,19 @@ TEST_F(FrameDirectoryTest, UnregisterPageFreesFrame) {
   ASSERT_TRUE(frame_opt.has_value());
   int frame_id = frame_opt.value();
 
-  directory.registerResidentPage(frame_id, 100, "test.db", std::move(page1));
+  directory.registerResidentPage(frame_id, 100, kTestFileId, "test.db",
+                                 *page1);
 
-  auto found = directory.findResidentFrame(100, "test.db");
+  auto found = directory.findResidentFrame(100, kTestFileId);
   ASSERT_TRUE(found.has_value());
 
   directory.unregisterResidentPage(frame_id);
 
-  found = directory.findResidentFrame(100, "test.db");
+  found = directory.findResidentFrame(100, kTestFileId);
   EXPECT_FALSE(found.has_value());
 
   const auto& frame = directory.getFrame(frame_id);
-  EXPECT_EQ(nullptr, frame.page);
+  EXPECT_FALSE(frame.page.has_value());
   EXPECT_EQ(-1, frame.page_id);
 }
 
@@ -120,15 +138,45 @@ TEST_F(FrameDirectoryTest, CheckOccupiedStatusBeforeAndAfterRegistration) {
   ASSERT_TRUE(frame_opt.has_value());
   int frame_id = frame_opt.value();
 
-  EXPECT_TRUE(directory.getFrame(frame_id).page == nullptr);
+  EXPECT_FALSE(directory.getFrame(frame_id).page.has_value());
 
-  directory.registerResidentPage(frame_id, 100, "test.db", std::move(page1));
+  directory.registerResidentPage(frame_id, 100, kTestFileId, "test.db",
+                                 *page1);
 
-  EXPECT_FALSE(directory.getFrame(frame_id).page == nullptr);
+  EXPECT_TRUE(directory.getFrame(frame_id).page.has_value());
 
   directory.unregisterResidentPage(frame_id);
 
-  EXPECT_TRUE(directory.getFrame(frame_id).page == nullptr);
+  EXPECT_FALSE(directory.getFrame(frame_id).page.has_value());
+}
+
+TEST_F(FrameDirectoryTest, PageDescriptorsLiveInlineInAlignedFrames) {
+  auto frame_opt = directory.reserveFreeFrame();
+  ASSERT_TRUE(frame_opt.has_value());
+  const int frame_id = frame_opt.value();
+  ASSERT_TRUE(directory.claimFrameForLoad(frame_id, 100, kTestFileId,
+                                          "test.db") == std::nullopt);
+  Page* loaded = directory.completeLoad(frame_id, *page1);
+
+  const auto& frame = directory.getFrame(frame_id);
+  const auto frame_start = reinterpret_cast<std::uintptr_t>(&frame);
+  const auto page_start = reinterpret_cast<std::uintptr_t>(loaded);
+  EXPECT_EQ(frame_start % FrameDirectory::CACHE_LINE_SIZE, 0u);
+  EXPECT_GE(page_start, frame_start);
+  EXPECT_LT(page_start, frame_start + sizeof(frame));
+  EXPECT_EQ(loaded->getPageID(), page1->getPageID());
+  EXPECT_EQ(loaded->data(), page_buffer1.data());
+
+  // Frames sharing a file share one interned path.
+  auto other_frame = directory.reserveFreeFrame();
+  ASSERT_TRUE(other_frame.has_value());
+  directory.registerResidentPage(other_frame.value(), 101, kTestFileId,
+                                 "test.db", *page2);
+  EXPECT_EQ(frame.file_path, directory.getFrame(other_frame.value()).file_path);
+
+  directory.unpin(frame_id);
+  directory.unregisterResidentPage(frame_id);
+  directory.unregisterResidentPage(other_frame.value());
 }
 
 TEST_F(FrameDirectoryTest, CollectStatsCountsKindsPinnedAndDirtyPages) {
@@ -153,12 +201,12 @@ TEST_F(FrameDirectoryTest, CollectStatsCountsKindsPinnedAndDirtyPages) {
   ASSERT_TRUE(leaf_frame.has_value());
   ASSERT_TRUE(internal_frame.has_value());
 
-  directory.registerResidentPage(heap_frame.value(), 1, "heap.db",
-                                 std::move(heap_page));
-  directory.registerResidentPage(leaf_frame.value(), 2, "index.db",
-                                 std::move(leaf_page));
-  directory.registerResidentPage(internal_frame.value(), 3, "index.db",
-                                 std::move(internal_page));
+  directory.registerResidentPage(heap_frame.value(), 1, kHeapFileId, "heap.db",
+                                 *heap_page);
+  directory.registerResidentPage(leaf_frame.value(), 2, kIndexFileId,
+                                 "index.db", *leaf_page);
+  directory.registerResidentPage(internal_frame.value(), 3, kIndexFileId,
+                                 "index.db", *internal_page);
   directory.pin(heap_frame.value());
   directory.pin(internal_frame.value());
 
@@ -167,7 +215,7 @@ TEST_F(FrameDirectoryTest, CollectStatsCountsKindsPinnedAndDirtyPages) {
   EXPECT_EQ(stats.frames_resident, 3u);
   EXPECT_EQ(stats.frames_pinned, 2u);
   EXPECT_EQ(stats.frames_evictable, 1u);
-  EXPECT_EQ(stats.frames_free, FrameDirectory::MAX_FRAME_COUNT - 3);
+  EXPECT_EQ(stats.frames_free, directory.frameCount() - 3);
 
   EXPECT_EQ(stats.resident_heap_pages, 1u);
   EXPECT_EQ(stats.resident_leaf_index_pages, 1u);
@@ -188,7 +236,7 @@ TEST_F(FrameDirectoryTest, MultipleRegisterUnregisterCycles) {
   // set.
   for (int cycle = 0; cycle < 3; ++cycle) {
     std::vector<int> claimed_frames;
-    for (size_t i = 0; i < FrameDirectory::MAX_FRAME_COUNT; ++i) {
+    for (size_t i = 0; i < directory.frameCount(); ++i) {
       auto frame_opt = directory.reserveFreeFrame();
       ASSERT_TRUE(frame_opt.has_value())
           << "Failed to claim frame in cycle " << cycle;
@@ -200,10 +248,10 @@ TEST_F(FrameDirectoryTest, MultipleRegisterUnregisterCycles) {
           Page::initializeNew(buffer.data(), PageKind::Heap, 0, i));
       int page_id = cycle * 100 + i;
 
-      directory.registerResidentPage(frame_id, page_id, "test.db",
-                                     std::move(page));
+      directory.registerResidentPage(frame_id, page_id, kTestFileId, "test.db",
+                                     *page);
 
-      auto found = directory.findResidentFrame(page_id, "test.db");
+      auto found = directory.findResidentFrame(page_id, kTestFileId);
       EXPECT_TRUE(found.has_value());
       EXPECT_EQ(frame_id, found.value());
     }
@@ -216,7 +264,7 @@ TEST_F(FrameDirectoryTest, MultipleRegisterUnregisterCycles) {
       directory.unregisterResidentPage(frame_id);
     }
 
-    for (size_t i = 0; i < FrameDirectory::MAX_FRAME_COUNT; ++i) {
+    for (size_t i = 0; i < directory.frameCount(); ++i) {
       auto frame_opt = directory.reserveFreeFrame();
       EXPECT_TRUE(frame_opt.has_value())
           << "Frame should be free after unregister in cycle " << cycle;
@@ -231,7 +279,7 @@ TEST_F(FrameDirectoryTest, FrameReuseAfterUnregister) {
   std::set<int> used_frame_ids;
 
   std::vector<int> initial_frames;
-  for (size_t i = 0; i < FrameDirectory::MAX_FRAME_COUNT; ++i) {
+  for (size_t i = 0; i < directory.frameCount(); ++i) {
     auto frame_opt = directory.reserveFreeFrame();
     ASSERT_TRUE(frame_opt.has_value());
     int frame_id = frame_opt.value();
@@ -241,7 +289,8 @@ TEST_F(FrameDirectoryTest, FrameReuseAfterUnregister) {
     std::array<char, 4096> buffer;
     auto page = std::make_unique<Page>(
         Page::initializeNew(buffer.data(), PageKind::Heap, 0, i));
-    directory.registerResidentPage(frame_id, i, "test.db", std::move(page));
+    directory.registerResidentPage(frame_id, i, kTestFileId, "test.db",
+                                   *page);
   }
 
   EXPECT_FALSE(directory.reserveFreeFrame().has_value());
@@ -260,24 +309,24 @@ TEST_F(FrameDirectoryTest, FrameReuseAfterUnregister) {
   std::array<char, 4096> new_buffer;
   auto new_page = std::make_unique<Page>(
       Page::initializeNew(new_buffer.data(), PageKind::Heap, 0, 99));
-  directory.registerResidentPage(reused_frame_id, 999, "new.db",
-                                 std::move(new_page));
+  directory.registerResidentPage(reused_frame_id, 999, kNewFileId, "new.db",
+                                 *new_page);
 
-  auto found = directory.findResidentFrame(999, "new.db");
+  auto found = directory.findResidentFrame(999, kNewFileId);
   ASSERT_TRUE(found.has_value());
   EXPECT_EQ(reused_frame_id, found.value());
 }
 
 TEST_F(FrameDirectoryTest, FindVictimFrameWhenAllFramesFilled) {
-  for (size_t i = 0; i < FrameDirectory::MAX_FRAME_COUNT; ++i) {
+  for (size_t i = 0; i < directory.frameCount(); ++i) {
     auto frame_opt = directory.reserveFreeFrame();
     ASSERT_TRUE(frame_opt.has_value());
 
     std::array<char, 4096> buffer;
     auto page = std::make_unique<Page>(
         Page::initializeNew(buffer.data(), PageKind::Heap, 0, i));
-    directory.registerResidentPage(frame_opt.value(), i, "test.db",
-                                   std::move(page));
+    directory.registerResidentPage(frame_opt.value(), i, kTestFileId, "test.db",
+                                   *page);
   }
 
   EXPECT_FALSE(directory.reserveFreeFrame().has_value());
@@ -292,7 +341,7 @@ TEST_F(FrameDirectoryTest, FindVictimFrameWhenAllFramesFilled) {
   EXPECT_FALSE(directory.isPinned(victim_frame_id));
 }
 
-TEST_F(FrameDirectoryTest, FindVictimFramePrefersCleanFrame) {
+TEST_F(FrameDirectoryTest, FindVictimFrameDoesNotPreferCleanFrames) {
   auto dirty_frame_opt = directory.reserveFreeFrame();
   ASSERT_TRUE(dirty_frame_opt.has_value());
   const int dirty_frame_id = dirty_frame_opt.value();
@@ -301,8 +350,8 @@ TEST_F(FrameDirectoryTest, FindVictimFramePrefersCleanFrame) {
   auto dirty_page = std::make_unique<Page>(
       Page::initializeNew(dirty_buffer.data(), PageKind::Heap, 0, 1));
   dirty_page->markDirty();
-  directory.registerResidentPage(dirty_frame_id, 1, "test.db",
-                                 std::move(dirty_page));
+  directory.registerResidentPage(dirty_frame_id, 1, kTestFileId, "test.db",
+                                 *dirty_page);
 
   auto clean_frame_opt = directory.reserveFreeFrame();
   ASSERT_TRUE(clean_frame_opt.has_value());
@@ -311,10 +360,96 @@ TEST_F(FrameDirectoryTest, FindVictimFramePrefersCleanFrame) {
   std::array<char, 4096> clean_buffer;
   auto clean_page =
       std::make_unique<Page>(Page::wrapExisting(clean_buffer.data(), 2));
-  directory.registerResidentPage(clean_frame_id, 2, "test.db",
-                                 std::move(clean_page));
+  directory.registerResidentPage(clean_frame_id, 2, kTestFileId, "test.db",
+                                 *clean_page);
+
+  // The replacement policy only looks at recency; write-back cost is not a
+  // reason to skip the older page.
+  auto victim_opt = directory.findVictimFrame();
+  ASSERT_TRUE(victim_opt.has_value());
+  EXPECT_EQ(dirty_frame_id, victim_opt.value());
+}
+
+TEST_F(FrameDirectoryTest, FindVictimFrameSkipsPinnedAndRecentlyUsedFrames) {
+  std::array<std::array<char, 4096>, 3> buffers;
+  std::array<int, 3> frame_ids;
+  for (int i = 0; i < 3; ++i) {
+    auto frame_opt = directory.reserveFreeFrame();
+    ASSERT_TRUE(frame_opt.has_value());
+    frame_ids[i] = frame_opt.value();
+    directory.registerResidentPage(
+        frame_ids[i], i + 1, kTestFileId, "test.db",
+        Page::initializeNew(buffers[i].data(), PageKind::Heap, 0, i + 1));
+  }
+
+  // Page 1 is pinned and page 2 was just used, so page 3 is the victim.
+  ASSERT_TRUE(directory.pinResidentFrame(1, kTestFileId).has_value());
+  ASSERT_TRUE(directory.pinResidentFrame(2, kTestFileId).has_value());
+  directory.unpin(frame_ids[1]);
 
   auto victim_opt = directory.findVictimFrame();
   ASSERT_TRUE(victim_opt.has_value());
-  EXPECT_EQ(clean_frame_id, victim_opt.value());
+  EXPECT_EQ(frame_ids[2], victim_opt.value());
+
+  const auto policy_stats = directory.evictionPolicy().stats();
+  EXPECT_EQ(policy_stats.hits, 2u);
+  EXPECT_EQ(policy_stats.misses, 3u);
+}
+
+// Growing adds free frames; shrinking evicts the frames that go away from the
+// top down and stops at a pinned one.
+TEST(FrameDirectoryResizeTest, GrowAndShrinkFrames) {
+  FrameDirectory directory(nullptr, 4, 8);
+  EXPECT_EQ(directory.frameCount(), 4u);
+  EXPECT_EQ(directory.maxFrameCount(), 8u);
+  EXPECT_THROW(directory.grow(9), std::invalid_argument);
+
+  directory.grow(8);
+  EXPECT_EQ(directory.frameCount(), 8u);
+  std::vector<std::array<char, 4096>> buffers(8);
+  int top_frame_page_id = -1;
+  for (int page_id = 0; page_id < 8; ++page_id) {
+    auto frame_opt = directory.reserveFreeFrame();
+    ASSERT_TRUE(frame_opt.has_value());
+    if (frame_opt.value() == 7) {
+      top_frame_page_id = page_id;
+    }
+    auto page = std::make_unique<Page>(Page::initializeNew(
+        buffers[page_id].data(), PageKind::Heap, 0, page_id));
+    directory.registerResidentPage(frame_opt.value(), page_id, kTestFileId,
+                                   "test.db", *page);
+  }
+  EXPECT_FALSE(directory.reserveFreeFrame().has_value());
+
+  const int pinned_page_id = top_frame_page_id == 2 ? 3 : 2;
+  auto pinned = directory.pinResidentFrame(pinned_page_id, kTestFileId);
+  ASSERT_TRUE(pinned.has_value());
+  std::vector<int> evicted_frames;
+  const auto record = [&](int frame_id, const std::string&, Page&) {
+    evicted_frames.push_back(frame_id);
+  };
+  const size_t frame_count = directory.shrink(1, record);
+  EXPECT_EQ(frame_count, static_cast<size_t>(pinned.value()) + 1);
+  EXPECT_EQ(directory.frameCount(), frame_count);
+  EXPECT_EQ(evicted_frames.size(), 8 - frame_count);
+  EXPECT_EQ(directory.collectStats().frames_resident, frame_count);
+  EXPECT_TRUE(
+      directory.findResidentFrame(pinned_page_id, kTestFileId).has_value());
+  EXPECT_FALSE(
+      directory.findResidentFrame(top_frame_page_id, kTestFileId).has_value());
+  // Retired frames are never offered as victims.
+  for (int i = 0; i < 8; ++i) {
+    auto victim = directory.findVictimFrame();
+    ASSERT_TRUE(victim.has_value());
+    EXPECT_LT(static_cast<size_t>(victim.value()), frame_count);
+  }
+
+  directory.unpin(pinned.value());
+  EXPECT_EQ(directory.shrink(1, record), 1u);
+  directory.grow(8);
+  EXPECT_EQ(directory.frameCount(), 8u);
+  for (int i = 0; i < 7; ++i) {
+    EXPECT_TRUE(directory.reserveFreeFrame().has_value());
+  }
+  EXPECT_FALSE(directory.reserveFreeFrame().has_value());
 }
@@ -0,0 +1,73 @@
+#include "storage/buffer/page_table.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <utility>
+
+TEST(PageTableTest, InsertFindAndOverwrite) {
+  PageTable table;
+  table.insert(1, 10, 100);
+  table.insert(2, 10, 200);
+
+  ASSERT_TRUE(table.find(1, 10).has_value());
+  EXPECT_EQ(table.find(1, 10).value(), 100);
+  ASSERT_TRUE(table.find(2, 10).has_value());
+  EXPECT_EQ(table.find(2, 10).value(), 200);
+  EXPECT_FALSE(table.find(1, 11).has_value());
+
+  // Re-inserting an existing key updates the frame instead of adding a row.
+  table.insert(1, 10, 101);
+  EXPECT_EQ(table.find(1, 10).value(), 101);
+  EXPECT_EQ(table.size(), 2u);
+}
+
+TEST(PageTableTest, GrowsPastInitialCapacity) {
+  PageTable table(4);
+  for (int page_id = 0; page_id < 1000; ++page_id) {
+    table.insert(7, page_id, page_id * 2);
+  }
+  EXPECT_EQ(table.size(), 1000u);
+  for (int page_id = 0; page_id < 1000; ++page_id) {
+    auto frame = table.find(7, page_id);
+    ASSERT_TRUE(frame.has_value()) << page_id;
+    EXPECT_EQ(frame.value(), page_id * 2);
+  }
+}
+
+// Backward-shift deletion moves entries around; random churn against a
+// reference map checks that no entry becomes unreachable.
+TEST(PageTableTest, EraseKeepsRemainingEntriesReachable) {
+  PageTable table(16);
+  std::map<std::pair<std::uint32_t, int>, int> reference;
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> file_dist(1, 4);
+  std::uniform_int_distribution<int> page_dist(0, 255);
+
+  for (int step = 0; step < 20000; ++step) {
+    const std::uint32_t file_id = static_cast<std::uint32_t>(file_dist(rng));
+    const int page_id = page_dist(rng);
+    const auto key = std::make_pair(file_id, page_id);
+    if (step % 3 == 0) {
+      EXPECT_EQ(table.erase(file_id, page_id), reference.erase(key) == 1);
+    } else {
+      table.insert(file_id, page_id, step);
+      reference[key] = step;
+    }
+  }
+
+  EXPECT_EQ(table.size(), reference.size());
+  for (const auto& [key, frame_id] : reference) {
+    auto found = table.find(key.first, key.second);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(found.value(), frame_id);
+  }
+  for (std::uint32_t file_id = 1; file_id <= 4; ++file_id) {
+    for (int page_id = 0; page_id < 256; ++page_id) {
+      EXPECT_EQ(table.find(file_id, page_id).has_value(),
+                reference.count({file_id, page_id}) == 1);
+    }
+  }
+}
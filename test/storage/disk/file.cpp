@@ -2,10 +2,15 @@
 
 #include <gtest/gtest.h>
 
+#include <cstdint>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <memory>
+#include <stdexcept>
+#include <thread>
 #include <vector>
 
 #include "storage/page/page.h"
@@ -25,13 +30,27 @@ class FileTest : public ::testing::Test {
 
   void TearDown() override {
     file_p.reset();
-    std::remove(test_file_path_.c_str());
+    File::remove(test_file_path_);
+  }
+
+  // Recreates the file with segments of segment_mb MiB.
+  void recreateWithSegmentSize(const char* segment_mb) {
+    file_p.reset();
+    File::remove(test_file_path_);
+    ::setenv("DBFS_SEGMENT_SIZE_MB", segment_mb, 1);
+    file_p = std::make_unique<File>(test_file_path_);
+    ::unsetenv("DBFS_SEGMENT_SIZE_MB");
+  }
+
+  static std::vector<char> pageFilledWith(PageId page_id) {
+    return std::vector<char>(Page::PAGE_SIZE_BYTE,
+                             static_cast<char>(page_id % 251));
   }
 };
 
 TEST_F(FileTest, AllocateAndUsage) {
   EXPECT_TRUE(file_p->isPageIDUsed(0));
-  uint16_t next = file_p->allocateNextPageId();
+  PageId next = file_p->allocateNextPageId();
   EXPECT_EQ(1u, next);
   EXPECT_TRUE(file_p->isPageIDUsed(1));
   EXPECT_FALSE(file_p->isPageIDUsed(2));
@@ -53,7 +72,7 @@ TEST_F(FileTest, WriteAndLoadPage) {
 }
 
 TEST_F(FileTest, LoadMaxPageIdFromHeader) {
-  constexpr uint16_t persisted_max = 42;
+  constexpr PageId persisted_max = 42;
 
   file_p.reset();
 
@@ -66,15 +85,15 @@ TEST_F(FileTest, LoadMaxPageIdFromHeader) {
   file_p = std::make_unique<File>(test_file_path_);
   EXPECT_TRUE(file_p->isPageIDUsed(persisted_max));
   EXPECT_FALSE(file_p->isPageIDUsed(persisted_max + 1));
-  uint16_t next = file_p->allocateNextPageId();
-  EXPECT_EQ(static_cast<uint16_t>(persisted_max + 1), next);
+  PageId next = file_p->allocateNextPageId();
+  EXPECT_EQ(persisted_max + 1, next);
   EXPECT_TRUE(file_p->isPageIDUsed(next));
 }
 
 TEST_F(FileTest, ReopenSharesUpdatedMetadataBeforeClose) {
-  constexpr uint16_t updated_root = 7;
+  constexpr PageId updated_root = 7;
 
-  uint16_t next = file_p->allocateNextPageId();
+  PageId next = file_p->allocateNextPageId();
   EXPECT_EQ(1u, next);
   file_p->setRootPageID(updated_root);
 
@@ -83,16 +102,16 @@ TEST_F(FileTest, ReopenSharesUpdatedMetadataBeforeClose) {
   EXPECT_EQ(next, reopened.getMaxPageID());
   EXPECT_EQ(updated_root, reopened.getRootPageID());
   EXPECT_TRUE(reopened.isPageIDUsed(next));
-  EXPECT_FALSE(reopened.isPageIDUsed(static_cast<uint16_t>(next + 1)));
+  EXPECT_FALSE(reopened.isPageIDUsed(next + 1));
 }
 
 TEST_F(FileTest, TestPersistanceLoadFromHeader) {
-  constexpr uint16_t persisted_max = 100;
-  constexpr uint16_t persisted_root = 5;
+  constexpr PageId persisted_max = 100;
+  constexpr PageId persisted_root = 5;
 
-  for (uint16_t i = 0; i < persisted_max; ++i) {
-    uint16_t pid = file_p->allocateNextPageId();
-    EXPECT_EQ(static_cast<uint16_t>(i + 1), pid);
+  for (PageId i = 0; i < persisted_max; ++i) {
+    PageId pid = file_p->allocateNextPageId();
+    EXPECT_EQ(i + 1, pid);
   }
   EXPECT_EQ(persisted_max, file_p->getMaxPageID());
 
@@ -108,5 +127,155 @@ TEST_F(FileTest, TestPersistanceLoadFromHeader) {
   EXPECT_EQ(persisted_root, file_p->getRootPageID());
 
   EXPECT_TRUE(file_p->isPageIDUsed(persisted_max));
-  EXPECT_FALSE(file_p->isPageIDUsed(static_cast<uint16_t>(persisted_max + 1)));
+  EXPECT_FALSE(file_p->isPageIDUsed(persisted_max + 1));
+}
+
+TEST_F(FileTest, ConcurrentPageIOOnOneFile) {
+  constexpr int kThreads = 8;
+  constexpr int kRounds = 200;
+  for (int i = 0; i < kThreads; ++i) {
+    file_p->allocateNextPageId();
+  }
+
+  // Every thread owns one page. With a shared seek position, interleaved
+  // reads and writes would land on or return another thread's page.
+  std::vector<std::thread> threads;
+  std::vector<int> mismatches(kThreads, 0);
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      File file(test_file_path_);
+      const PageId page_id = static_cast<PageId>(t + 1);
+      std::vector<char> write_buffer(Page::PAGE_SIZE_BYTE);
+      std::vector<char> read_buffer(Page::PAGE_SIZE_BYTE);
+      for (int round = 0; round < kRounds; ++round) {
+        std::memset(write_buffer.data(), t * kRounds + round,
+                    write_buffer.size());
+        file.writePageFromBuffer(page_id, write_buffer.data());
+        file.readPageIntoBuffer(page_id, read_buffer.data());
+        if (std::memcmp(write_buffer.data(), read_buffer.data(),
+                        Page::PAGE_SIZE_BYTE) != 0) {
+          ++mismatches[t];
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int t = 0; t < kThreads; ++t) {
+    EXPECT_EQ(mismatches[t], 0) << "thread " << t;
+  }
+  EXPECT_EQ(file_p->pageCountOnDisk(), static_cast<size_t>(kThreads + 1));
+}
+
+TEST_F(FileTest, ReadPastEndOfFileThrows) {
+  std::vector<char> buffer(Page::PAGE_SIZE_BYTE);
+  EXPECT_THROW(file_p->readPageIntoBuffer(3, buffer.data()),
+               std::runtime_error);
+}
+
+TEST_F(FileTest, PagesSpanSegmentFiles) {
+  recreateWithSegmentSize("1");
+  const PageId pages_per_segment = file_p->pagesPerSegment();
+  ASSERT_EQ(pages_per_segment, (1u << 20) / Page::PAGE_SIZE_BYTE);
+  const PageId page_count = pages_per_segment * 2 + 10;
+  while (file_p->getMaxPageID() + 1 < page_count) {
+    file_p->allocateNextPageId();
+  }
+  for (PageId page_id = 0; page_id < page_count; ++page_id) {
+    file_p->writePageFromBuffer(page_id, pageFilledWith(page_id).data());
+  }
+  EXPECT_TRUE(std::filesystem::exists(test_file_path_ + ".1"));
+  EXPECT_TRUE(std::filesystem::exists(test_file_path_ + ".2"));
+  EXPECT_FALSE(std::filesystem::exists(test_file_path_ + ".3"));
+  EXPECT_EQ(file_p->pageCountOnDisk(), page_count);
+
+  // The segment size is read back from the header, whatever the knob says.
+  file_p.reset();
+  file_p = std::make_unique<File>(test_file_path_);
+  EXPECT_EQ(file_p->pagesPerSegment(), pages_per_segment);
+  EXPECT_EQ(file_p->getMaxPageID(), page_count - 1);
+  std::vector<char> read_buffer(Page::PAGE_SIZE_BYTE);
+  for (PageId page_id = 0; page_id < page_count; ++page_id) {
+    file_p->readPageIntoBuffer(page_id, read_buffer.data());
+    ASSERT_EQ(read_buffer, pageFilledWith(page_id)) << "page " << page_id;
+  }
+}
+
+TEST_F(FileTest, PageIdsGoPastSixteenBits) {
+  recreateWithSegmentSize("64");
+  const PageId last_page_id = 70000;
+  while (file_p->getMaxPageID() < last_page_id) {
+    file_p->allocateNextPageId();
+  }
+  file_p->writePageFromBuffer(last_page_id,
+                              pageFilledWith(last_page_id).data());
+  file_p->setRootPageID(last_page_id);
+
+  file_p.reset();
+  file_p = std::make_unique<File>(test_file_path_);
+  EXPECT_EQ(file_p->getMaxPageID(), last_page_id);
+  EXPECT_EQ(file_p->getRootPageID(), last_page_id);
+  std::vector<char> read_buffer(Page::PAGE_SIZE_BYTE);
+  file_p->readPageIntoBuffer(last_page_id, read_buffer.data());
+  EXPECT_EQ(read_buffer, pageFilledWith(last_page_id));
+
+  // Earlier segments were filled out to full size, so pages never written
+  // there read as zeros, and past the last segment reads fail.
+  file_p->readPageIntoBuffer(100, read_buffer.data());
+  EXPECT_EQ(read_buffer, std::vector<char>(Page::PAGE_SIZE_BYTE, 0));
+  EXPECT_THROW(file_p->readPageIntoBuffer(last_page_id + 1000000,
+                                          read_buffer.data()),
+               std::runtime_error);
+}
+
+TEST_F(FileTest, NewFileDropsStaleSegments) {
+  recreateWithSegmentSize("1");
+  const PageId page_id = file_p->pagesPerSegment() + 1;
+  while (file_p->getMaxPageID() < page_id) {
+    file_p->allocateNextPageId();
+  }
+  file_p->writePageFromBuffer(page_id, pageFilledWith(page_id).data());
+  ASSERT_TRUE(std::filesystem::exists(test_file_path_ + ".1"));
+
+  // Truncating the first segment starts a new relation at the same path.
+  file_p.reset();
+  std::ofstream(test_file_path_, std::ios::binary | std::ios::trunc).close();
+  file_p = std::make_unique<File>(test_file_path_);
+  EXPECT_FALSE(std::filesystem::exists(test_file_path_ + ".1"));
+  EXPECT_EQ(file_p->pageCountOnDisk(), 0u);
+
+  file_p->writePageFromBuffer(page_id, pageFilledWith(page_id).data());
+  file_p.reset();
+  File::remove(test_file_path_);
+  EXPECT_FALSE(std::filesystem::exists(test_file_path_));
+  EXPECT_FALSE(std::filesystem::exists(test_file_path_ + ".1"));
+}
+
+TEST_F(FileTest, OpenIfExistsLeavesMissingPathsAlone) {
+  const std::string missing_path = "file_test_missing.db";
+  File::remove(missing_path);
+  EXPECT_EQ(File::openIfExists(missing_path), nullptr);
+  EXPECT_FALSE(std::filesystem::exists(missing_path));
+  EXPECT_FALSE(File::fileIdOf(missing_path).has_value());
+  EXPECT_NE(File::openIfExists(test_file_path_), nullptr);
+}
+
+TEST_F(FileTest, ReleasedFileIdIsReused) {
+  const std::uint32_t file_id = file_p->getFileId();
+  EXPECT_THROW(File::releaseFileId(test_file_path_), std::logic_error);
+
+  file_p.reset();
+  File::remove(test_file_path_);
+  File::releaseFileId(test_file_path_);
+  EXPECT_FALSE(File::fileIdOf(test_file_path_).has_value());
+
+  const std::string other_path = "file_test_other.db";
+  {
+    File other(other_path);
+    EXPECT_EQ(other.getFileId(), file_id);
+  }
+  File::remove(other_path);
+  File::releaseFileId(other_path);
 }
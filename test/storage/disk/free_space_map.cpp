@@ -0,0 +1,91 @@
+#include "storage/disk/free_space_map.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <memory>
+#include <string>
+
+class FreeSpaceMapTest : public ::testing::Test {
+ protected:
+  const std::string heap_path_ = "free_space_map_test.db";
+
+  void SetUp() override { FreeSpaceMap::remove(heap_path_); }
+  void TearDown() override { FreeSpaceMap::remove(heap_path_); }
+};
+
+TEST_F(FreeSpaceMapTest, FindsTheSmallestCategoryThatFits) {
+  auto map = FreeSpaceMap::forHeap(heap_path_);
+  EXPECT_FALSE(map->findPage(10).has_value());
+
+  map->update(3, 300);
+  map->update(7, 2000);
+  map->update(9, 100);
+  EXPECT_EQ(map->categoryOf(3), 1);
+  EXPECT_EQ(map->categoryOf(7), 7);
+  EXPECT_EQ(map->categoryOf(9), 0);
+  EXPECT_EQ(map->categoryOf(1000), 0);
+
+  EXPECT_EQ(map->findPage(10), 3u);
+  EXPECT_EQ(map->findPage(256), 3u);
+  // 257 bytes might not fit in a page with 256 to 511 free.
+  EXPECT_EQ(map->findPage(257), 7u);
+  EXPECT_EQ(map->findPage(1792), 7u);
+  EXPECT_FALSE(map->findPage(1793).has_value());
+  EXPECT_FALSE(map->findPage(FreeSpaceMap::CATEGORY_COUNT *
+                            FreeSpaceMap::CATEGORY_BYTES)
+                   .has_value());
+}
+
+TEST_F(FreeSpaceMapTest, PagesThatFilledUpAreNotOfferedAgain) {
+  auto map = FreeSpaceMap::forHeap(heap_path_);
+  for (PageId page_id = 0; page_id < 100; ++page_id) {
+    map->update(page_id, 3000);
+  }
+  // Fill pages in the order the map offers them, then free one of them.
+  for (int i = 0; i < 100; ++i) {
+    const auto page_id = map->findPage(1000);
+    ASSERT_TRUE(page_id.has_value()) << i;
+    map->update(*page_id, 50);
+  }
+  EXPECT_FALSE(map->findPage(1000).has_value());
+  map->update(42, 3000);
+  EXPECT_EQ(map->findPage(1000), 42u);
+
+  // Categories changing back and forth do not grow the map without bound.
+  for (int i = 0; i < 10000; ++i) {
+    map->update(42, i % 2 == 0 ? 50 : 3000);
+  }
+  EXPECT_EQ(map->findPage(1000), 42u);
+}
+
+TEST_F(FreeSpaceMapTest, SavedMapIsLoadedAfterRemovalFromMemory) {
+  {
+    auto map = FreeSpaceMap::forHeap(heap_path_);
+    map->update(0, 100);
+    map->update(5, 3000);
+    map->save();
+  }
+  ASSERT_TRUE(std::filesystem::exists(FreeSpaceMap::pathFor(heap_path_)));
+  const std::string copy_path = heap_path_ + ".copy";
+  std::filesystem::copy_file(
+      FreeSpaceMap::pathFor(heap_path_), FreeSpaceMap::pathFor(copy_path),
+      std::filesystem::copy_options::overwrite_existing);
+
+  auto loaded = FreeSpaceMap::forHeap(copy_path);
+  EXPECT_EQ(loaded->categoryOf(5), 11);
+  EXPECT_EQ(loaded->findPage(2000), 5u);
+  FreeSpaceMap::remove(copy_path);
+  EXPECT_FALSE(std::filesystem::exists(FreeSpaceMap::pathFor(copy_path)));
+
+  FreeSpaceMap::remove(heap_path_);
+  EXPECT_FALSE(FreeSpaceMap::forHeap(heap_path_)->findPage(10).has_value());
+}
+
+TEST_F(FreeSpaceMapTest, ClearForgetsEveryPage) {
+  auto map = FreeSpaceMap::forHeap(heap_path_);
+  map->update(2, 3000);
+  map->clear();
+  EXPECT_FALSE(map->findPage(10).has_value());
+  EXPECT_EQ(map->categoryOf(2), 0);
+}
@@ -0,0 +1,154 @@
+#include "storage/disk/io_engine.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr const char* kPath = "io_engine_test.db";
+constexpr size_t kBlockBytes = 4096;
+
+// A scratch file and an engine of the given kind.
+struct EngineFixture {
+  std::unique_ptr<IOEngine> engine;
+  int fd;
+
+  explicit EngineFixture(IOEngineKind kind)
+      : engine(makeIOEngine(kind, 4)),
+        fd(::open(kPath, O_RDWR | O_CREAT | O_TRUNC, 0644)) {}
+  ~EngineFixture() {
+    engine.reset();
+    ::close(fd);
+    std::remove(kPath);
+  }
+
+  IORequest request(IORequest::Op op, char* buffer, size_t block) const {
+    return IORequest{op, fd, buffer, kBlockBytes,
+                     static_cast<off_t>(block * kBlockBytes)};
+  }
+};
+
+// Auto resolves to io_uring where the kernel allows it.
+constexpr IOEngineKind kAllEngines[] = {IOEngineKind::Auto,
+                                        IOEngineKind::ThreadPool};
+
+}  // namespace
+
+TEST(IOEngineTest, ParsesEngineNames) {
+  EXPECT_EQ(ioEngineKindFromString("auto"), IOEngineKind::Auto);
+  EXPECT_EQ(ioEngineKindFromString("IO_URING"), IOEngineKind::IOUring);
+  EXPECT_EQ(ioEngineKindFromString("threads"), IOEngineKind::ThreadPool);
+  EXPECT_THROW(ioEngineKindFromString("aio"), std::invalid_argument);
+}
+
+TEST(IOEngineTest, BatchWritesAndReadsBlocks) {
+  constexpr size_t kBlocks = 200;
+  for (auto kind : kAllEngines) {
+    EngineFixture fixture(kind);
+    SCOPED_TRACE(fixture.engine->name());
+    ASSERT_NE(fixture.fd, -1);
+    std::vector<std::vector<char>> written(kBlocks,
+                                           std::vector<char>(kBlockBytes));
+    std::vector<IORequest> writes;
+    for (size_t block = 0; block < kBlocks; ++block) {
+      std::memset(written[block].data(), static_cast<int>(block),
+                  kBlockBytes);
+      writes.push_back(
+          fixture.request(IORequest::Op::Write, written[block].data(), block));
+    }
+    fixture.engine->submitAndWait(writes);
+    for (const auto& write : writes) {
+      EXPECT_TRUE(write.succeeded()) << write.result;
+    }
+
+    std::vector<std::vector<char>> read(kBlocks,
+                                        std::vector<char>(kBlockBytes));
+    std::vector<IORequest> reads;
+    for (size_t block = 0; block < kBlocks; ++block) {
+      reads.push_back(
+          fixture.request(IORequest::Op::Read, read[block].data(), block));
+    }
+    fixture.engine->submitAndWait(reads);
+    for (size_t block = 0; block < kBlocks; ++block) {
+      EXPECT_TRUE(reads[block].succeeded()) << reads[block].result;
+      EXPECT_EQ(read[block], written[block]) << "block " << block;
+    }
+  }
+}
+
+TEST(IOEngineTest, FailedRequestDoesNotAffectTheRestOfTheBatch) {
+  for (auto kind : kAllEngines) {
+    EngineFixture fixture(kind);
+    SCOPED_TRACE(fixture.engine->name());
+    std::vector<char> data(kBlockBytes, 'x');
+    std::vector<IORequest> writes{
+        fixture.request(IORequest::Op::Write, data.data(), 0)};
+    fixture.engine->submitAndWait(writes);
+    ASSERT_TRUE(writes[0].succeeded());
+
+    std::vector<char> good(kBlockBytes);
+    std::vector<char> past_end(kBlockBytes);
+    std::vector<char> bad_fd(kBlockBytes);
+    std::vector<IORequest> reads{
+        fixture.request(IORequest::Op::Read, good.data(), 0),
+        fixture.request(IORequest::Op::Read, past_end.data(), 5),
+        fixture.request(IORequest::Op::Read, bad_fd.data(), 0)};
+    reads[2].fd = -1;
+    fixture.engine->submitAndWait(reads);
+
+    EXPECT_TRUE(reads[0].succeeded());
+    EXPECT_EQ(good, data);
+    EXPECT_EQ(reads[1].result, 0);
+    EXPECT_EQ(reads[2].result, -EBADF);
+  }
+}
+
+TEST(IOEngineTest, ConcurrentBatchesFromManyThreads) {
+  constexpr size_t kThreads = 4;
+  constexpr size_t kBlocksPerThread = 100;
+  for (auto kind : kAllEngines) {
+    EngineFixture fixture(kind);
+    SCOPED_TRACE(fixture.engine->name());
+    std::vector<std::thread> threads;
+    std::vector<size_t> failures(kThreads, 0);
+    for (size_t t = 0; t < kThreads; ++t) {
+      threads.emplace_back([&, t] {
+        std::vector<std::vector<char>> buffers(
+            kBlocksPerThread,
+            std::vector<char>(kBlockBytes, static_cast<char>('a' + t)));
+        std::vector<IORequest> writes;
+        for (size_t i = 0; i < kBlocksPerThread; ++i) {
+          writes.push_back(fixture.request(IORequest::Op::Write,
+                                           buffers[i].data(),
+                                           t * kBlocksPerThread + i));
+        }
+        fixture.engine->submitAndWait(writes);
+        for (const auto& write : writes) {
+          failures[t] += write.succeeded() ? 0 : 1;
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    for (size_t t = 0; t < kThreads; ++t) {
+      EXPECT_EQ(failures[t], 0u) << "thread " << t;
+      std::vector<char> block(kBlockBytes);
+      const off_t offset =
+          static_cast<off_t>((t + 1) * kBlocksPerThread - 1) * kBlockBytes;
+      ASSERT_EQ(::pread(fixture.fd, block.data(), kBlockBytes, offset),
+                static_cast<ssize_t>(kBlockBytes));
+      EXPECT_EQ(block[0], static_cast<char>('a' + t));
+    }
+  }
+}
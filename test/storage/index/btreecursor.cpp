@@ -3,9 +3,12 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <atomic>
 #include <cstdio>
+#include <filesystem>
 #include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "storage/buffer/bufferpool.h"
@@ -26,7 +29,7 @@ class BTreeCursorTest : public ::testing::Test {
 
   void SetUp() override {
     std::remove(index_path_.c_str());
-    std::remove(wal_path_.c_str());
+    std::filesystem::remove_all(wal_path_);
     wal_ = WAL::initializeNew(wal_path_);
     pool_ = std::make_unique<BufferPool>(*wal_);
     index_file_ = std::make_unique<File>(index_path_);
@@ -37,7 +40,7 @@ class BTreeCursorTest : public ::testing::Test {
     index_file_.reset();
     wal_.reset();
     std::remove(index_path_.c_str());
-    std::remove(wal_path_.c_str());
+    std::filesystem::remove_all(wal_path_);
   }
 
   static void initializeLeafPage(File& file) {
@@ -137,7 +140,7 @@ std::string encodeOrderLinePrimaryKey(int warehouse_id, int district_id,
 // are in place.
 
 TEST_F(BTreeCursorTest, InsertIntoIndexAndFindRecordLocation) {
-  const uint16_t heap_page_id = 5;
+  const PageId heap_page_id = 5;
   const uint16_t slot_id = 3;
 
   std::vector<int> keys = {1, 42, 100};
@@ -156,7 +159,7 @@ TEST_F(BTreeCursorTest, InsertIntoIndexAndFindRecordLocation) {
 }
 
 TEST_F(BTreeCursorTest, InsertManyKeysTriggersSplitAndIsSearchable) {
-  const uint16_t heap_page_id = 7;
+  const PageId heap_page_id = 7;
 
   const int initial_max_page = index_file_->getMaxPageID();
 
@@ -272,7 +275,7 @@ TEST_F(BTreeCursorTest, InsertCompactsFullyInvalidLeafBeforeSplitting) {
 
 TEST_F(BTreeCursorTest,
        InsertCompositeKeysAcrossInternalSplitsRemainsSearchable) {
-  const uint16_t heap_page_id = 11;
+  const PageId heap_page_id = 11;
 
   const int num_keys = 30000;
   for (int customer_id = 1; customer_id <= num_keys; ++customer_id) {
@@ -290,3 +293,181 @@ TEST_F(BTreeCursorTest,
     EXPECT_EQ(rids.front().heap_page_id, heap_page_id);
   }
 }
+
+TEST_F(BTreeCursorTest, CompositeKeysStoreSharedPrefixesOncePerPage) {
+  const int num_keys = 20000;
+  for (int order_id = 1; order_id <= num_keys; ++order_id) {
+    BTreeCursor::insertIntoIndex(
+        *pool_, *index_file_, encodeOrderLinePrimaryKey(3, 5, order_id, 1), 1,
+        static_cast<uint16_t>(order_id));
+  }
+
+  // Every page but those on the left and right edges of the tree has a
+  // closed key range inside warehouse 3, district 5, so it stores at least
+  // that much of the key once in its header.
+  const std::string district_prefix = encodeOrderLinePrimaryKeyPrefix(3, 5, 0)
+                                          .substr(0, 10);
+  int pages = 0;
+  int prefixed_pages = 0;
+  bool truncated_separator = false;
+  for (PageId page_id = 0; page_id <= index_file_->getMaxPageID(); ++page_id) {
+    ReadPageGuard page = pool_->readPage(page_id, *index_file_);
+    ++pages;
+    const std::string_view prefix = page->keyPrefix();
+    if (prefix.size() >= district_prefix.size()) {
+      EXPECT_EQ(prefix.substr(0, district_prefix.size()), district_prefix);
+      ++prefixed_pages;
+    }
+    if (!page->isLeaf()) {
+      InternalIndexPage internal(*page);
+      for (int slot = 0; slot < page->slotCount(); ++slot) {
+        truncated_separator |= internal.cellAt(slot).key().size() <
+                               encodeOrderLinePrimaryKey(3, 5, 1, 1).size();
+      }
+    }
+  }
+  EXPECT_GT(prefixed_pages, pages * 3 / 4);
+  EXPECT_TRUE(truncated_separator);
+
+  for (int order_id = 1; order_id <= num_keys; order_id += 97) {
+    auto rids = entryRIDs(BTreeCursor::findEntries(
+        *pool_, *index_file_,
+        exactBoundary(encodeOrderLinePrimaryKeyPrefix(3, 5, order_id)),
+        false));
+    ASSERT_EQ(rids.size(), 1u) << "order_id=" << order_id;
+    EXPECT_EQ(rids.front().slot_id, order_id);
+  }
+}
+
+TEST_F(BTreeCursorTest, ConcurrentInsertsAndLookupsSeeEveryKey) {
+  constexpr int kWriters = 4;
+  constexpr int kReaders = 2;
+  constexpr int kNumKeys = 20000;
+
+  // Writers insert interleaved keys, so they keep splitting the same leaves
+  // and, through them, the internal pages and the root.
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+  for (int writer = 0; writer < kWriters; ++writer) {
+    threads.emplace_back([&, writer] {
+      for (int key = writer; key < kNumKeys; key += kWriters) {
+        BTreeCursor::insertIntoIndex(*pool_, *index_file_, encodeIntKey(key),
+                                     static_cast<uint16_t>(writer),
+                                     static_cast<uint16_t>(key));
+      }
+      writers_done.fetch_add(1);
+    });
+  }
+  // Readers look keys up while the tree changes shape under them; whatever
+  // they find must be the entry that was inserted for the key.
+  std::atomic<int> bad_lookups{0};
+  for (int reader = 0; reader < kReaders; ++reader) {
+    threads.emplace_back([&, reader] {
+      int key = reader;
+      while (writers_done.load() < kWriters) {
+        for (const RID& rid : findIntRIDs(*pool_, *index_file_, key)) {
+          if (rid.heap_page_id != static_cast<PageId>(key % kWriters) ||
+              rid.slot_id != key) {
+            bad_lookups.fetch_add(1);
+          }
+        }
+        key = (key + 7919) % kNumKeys;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(bad_lookups.load(), 0);
+
+  for (int key = 0; key < kNumKeys; ++key) {
+    auto rids = findIntRIDs(*pool_, *index_file_, key);
+    ASSERT_EQ(rids.size(), 1u) << "key=" << key;
+    EXPECT_EQ(rids.front().slot_id, key);
+  }
+  std::vector<IndexEntry> entries = BTreeCursor::findEntries(
+      *pool_, *index_file_, boundaries("", true, "", true), false);
+  ASSERT_EQ(entries.size(), static_cast<std::size_t>(kNumKeys));
+  for (int key = 0; key < kNumKeys; ++key) {
+    EXPECT_EQ(entries[static_cast<std::size_t>(key)].key, encodeIntKey(key));
+  }
+}
+
+TEST_F(BTreeCursorTest, ConcurrentSplitsBelowTheRootKeepEveryKey) {
+  constexpr int kWriters = 4;
+  constexpr int kReaders = 2;
+  constexpr int kNumKeys = 24000;
+  // Keys in a group share a long prefix, so separators are long and the
+  // tree grows a level of internal pages below the root, which is then
+  // split-safe for most leaf splits.
+  const auto key_for = [](int key) {
+    std::string padded = std::to_string(key);
+    padded.insert(0, 6 - padded.size(), '0');
+    return encodeVarcharKey(std::to_string(key % 37) + std::string(150, 'x') +
+                            padded);
+  };
+
+  std::atomic<int> writers_done{0};
+  std::vector<std::thread> threads;
+  for (int writer = 0; writer < kWriters; ++writer) {
+    threads.emplace_back([&, writer] {
+      for (int key = writer; key < kNumKeys; key += kWriters) {
+        BTreeCursor::insertIntoIndex(*pool_, *index_file_, key_for(key),
+                                     static_cast<uint16_t>(writer),
+                                     static_cast<uint16_t>(key));
+      }
+      writers_done.fetch_add(1);
+    });
+  }
+  std::atomic<int> bad_lookups{0};
+  for (int reader = 0; reader < kReaders; ++reader) {
+    threads.emplace_back([&, reader] {
+      int key = reader;
+      while (writers_done.load() < kWriters) {
+        for (const RID& rid : entryRIDs(BTreeCursor::findEntries(
+                 *pool_, *index_file_, exactBoundary(key_for(key)), false))) {
+          if (rid.heap_page_id != static_cast<PageId>(key % kWriters) ||
+              rid.slot_id != key) {
+            bad_lookups.fetch_add(1);
+          }
+        }
+        key = (key + 7919) % kNumKeys;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(bad_lookups.load(), 0);
+
+  int depth = 1;
+  PageId page_id = index_file_->getRootPageID();
+  while (true) {
+    ReadPageGuard page = pool_->readPage(page_id, *index_file_);
+    if (page->isLeaf()) {
+      break;
+    }
+    page_id = InternalIndexPage(*page).leftMostChildPageId();
+    ++depth;
+  }
+  EXPECT_GE(depth, 3);
+
+  for (int key = 0; key < kNumKeys; ++key) {
+    auto rids = entryRIDs(BTreeCursor::findEntries(
+        *pool_, *index_file_, exactBoundary(key_for(key)), false));
+    ASSERT_EQ(rids.size(), 1u) << "key=" << key;
+    EXPECT_EQ(rids.front().slot_id, key);
+  }
+}
+
+TEST_F(BTreeCursorTest, KeysOverTheSizeLimitAreRejected) {
+  const std::string longest(index_key::MAX_KEY_SIZE, 'k');
+  BTreeCursor::insertIntoIndex(*pool_, *index_file_, longest, 1, 1);
+  EXPECT_THROW(BTreeCursor::insertIntoIndex(*pool_, *index_file_,
+                                            longest + "k", 1, 2),
+               std::runtime_error);
+  EXPECT_EQ(entryRIDs(BTreeCursor::findEntries(*pool_, *index_file_,
+                                               exactBoundary(longest), false))
+                .size(),
+            1u);
+}
@@ -0,0 +1,250 @@
+#include "storage/index/index_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "storage/buffer/bufferpool.h"
+#include "storage/disk/file.h"
+#include "storage/index/btreecursor.h"
+#include "storage/index/index_key.h"
+#include "storage/index/index_page.h"
+#include "storage/page/page.h"
+#include "storage/wal/wal.h"
+
+class IndexBuilderTest : public ::testing::Test {
+ protected:
+  std::unique_ptr<BufferPool> pool_;
+  std::unique_ptr<File> index_file_;
+  std::unique_ptr<WAL> wal_;
+  const std::string index_path_ = "index_builder_test.index";
+  const std::string wal_path_ = "index_builder_test.wal";
+
+  void SetUp() override {
+    std::remove(index_path_.c_str());
+    std::filesystem::remove_all(wal_path_);
+    wal_ = WAL::initializeNew(wal_path_);
+    pool_ = std::make_unique<BufferPool>(*wal_);
+    index_file_ = std::make_unique<File>(index_path_);
+    std::array<char, Page::PAGE_SIZE_BYTE> buffer{};
+    Page::initializeNew(buffer.data(), PageKind::LeafIndex,
+                        LeafIndexPage::NO_RIGHT_SIBLING, 0);
+    index_file_->writePageFromBuffer(0, buffer.data());
+  }
+
+  void TearDown() override {
+    pool_.reset();
+    index_file_.reset();
+    wal_.reset();
+    std::remove(index_path_.c_str());
+    std::filesystem::remove_all(wal_path_);
+  }
+
+  // Every entry of the index, in leaf chain order.
+  std::vector<IndexEntry> scanLeafChain() {
+    PageId page_id = index_file_->getRootPageID();
+    while (true) {
+      ReadPageGuard page = pool_->readPage(page_id, *index_file_);
+      if (page->isLeaf()) {
+        break;
+      }
+      page_id = InternalIndexPage(*page).leftMostChildPageId();
+    }
+    std::vector<IndexEntry> entries;
+    while (page_id != LeafIndexPage::NO_RIGHT_SIBLING) {
+      ReadPageGuard page = pool_->readPage(page_id, *index_file_);
+      LeafIndexPage leaf(*page);
+      for (int slot = 0; slot < page->slotCount(); ++slot) {
+        LeafCell cell = leaf.cellAt(slot);
+        entries.push_back(
+            IndexEntry{cell.key(), RID{cell.heap_page_id(), cell.slot_id()}});
+      }
+      page_id = leaf.getRightSiblingPageId();
+    }
+    return entries;
+  }
+};
+
+namespace {
+
+std::string encodeIntKey(int value) {
+  return index_key::encodeFieldValue(
+      FieldValue{static_cast<Column::IntegerType>(value)},
+      Column::Type::Integer);
+}
+
+// TPC-C order-line primary key (w_id, d_id, o_id, ol_number).
+std::string encodeOrderLineKey(int warehouse_id, int district_id, int order_id,
+                               int line_number) {
+  std::string key;
+  for (const int field : {warehouse_id, district_id, order_id, line_number}) {
+    key.push_back('I');
+    key += index_key::encodeInteger(field);
+  }
+  return key;
+}
+
+std::vector<int> shuffledKeys(int count) {
+  std::vector<int> keys(static_cast<size_t>(count));
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  return keys;
+}
+
+std::vector<IndexEntry> findExact(BufferPool& pool, File& index_file,
+                                  const std::string& key) {
+  const BTreeCursor::Boundary exact{key, true};
+  return BTreeCursor::findEntries(pool, index_file, {exact, exact}, false);
+}
+
+}  // namespace
+
+TEST_F(IndexBuilderTest, LoadsUnsortedEntriesIntoSearchableTree) {
+  const int num_keys = 20000;
+  IndexBuilder builder(*index_file_, IndexBuilder::Options{});
+  for (const int key : shuffledKeys(num_keys)) {
+    builder.add(encodeIntKey(key),
+                RID{static_cast<uint16_t>(key / 100),
+                    static_cast<uint16_t>(key % 100)});
+  }
+  EXPECT_EQ(builder.finish(), static_cast<size_t>(num_keys));
+  EXPECT_EQ(builder.runCount(), 0u);
+
+  ReadPageGuard root = pool_->readPage(index_file_->getRootPageID(),
+                                       *index_file_);
+  EXPECT_FALSE(root->isLeaf());
+  root.release();
+
+  const std::vector<IndexEntry> entries = scanLeafChain();
+  ASSERT_EQ(entries.size(), static_cast<size_t>(num_keys));
+  for (int key = 0; key < num_keys; ++key) {
+    ASSERT_EQ(entries[key].key, encodeIntKey(key)) << "key=" << key;
+  }
+  for (int key = 0; key < num_keys; key += 37) {
+    const std::vector<IndexEntry> found =
+        findExact(*pool_, *index_file_, encodeIntKey(key));
+    ASSERT_EQ(found.size(), 1u) << "key=" << key;
+    EXPECT_EQ(found.front().rid.heap_page_id, key / 100);
+    EXPECT_EQ(found.front().rid.slot_id, key % 100);
+  }
+}
+
+TEST_F(IndexBuilderTest, SpillsSortedRunsAndMergesThem) {
+  const int num_keys = 20000;
+  IndexBuilder::Options options;
+  options.sort_memory_bytes = 64 << 10;
+  {
+    IndexBuilder builder(*index_file_, options);
+    for (const int key : shuffledKeys(num_keys)) {
+      builder.add(encodeIntKey(key), RID{1, static_cast<uint16_t>(key)});
+    }
+    EXPECT_GT(builder.runCount(), 1u);
+    EXPECT_EQ(builder.finish(), static_cast<size_t>(num_keys));
+  }
+  EXPECT_FALSE(std::filesystem::exists(index_path_ + ".run0"));
+
+  const std::vector<IndexEntry> entries = scanLeafChain();
+  ASSERT_EQ(entries.size(), static_cast<size_t>(num_keys));
+  for (int key = 0; key < num_keys; ++key) {
+    ASSERT_EQ(entries[key].key, encodeIntKey(key)) << "key=" << key;
+    ASSERT_EQ(entries[key].rid.slot_id, key);
+  }
+}
+
+TEST_F(IndexBuilderTest, FillFactorLeavesRoomForLaterInserts) {
+  // Even keys are bulk loaded, odd ones inserted afterwards, which splits
+  // the leaves of a full build but not those of a half-full one.
+  const int num_keys = 20000;
+  int full_pages = 0;
+  for (const int fill_factor : {100, 50}) {
+    SCOPED_TRACE("fill factor " + std::to_string(fill_factor));
+    TearDown();
+    SetUp();
+    IndexBuilder::Options options;
+    options.fill_factor_percent = fill_factor;
+    IndexBuilder builder(*index_file_, options);
+    for (int key = 0; key < num_keys; key += 2) {
+      builder.add(encodeIntKey(key), RID{1, static_cast<uint16_t>(key)});
+    }
+    builder.finish();
+    const int loaded_pages = index_file_->getMaxPageID() + 1;
+    if (fill_factor == 100) {
+      full_pages = loaded_pages;
+    } else {
+      EXPECT_GT(loaded_pages, full_pages * 3 / 2);
+    }
+
+    for (int key = 1; key < num_keys; key += 2) {
+      BTreeCursor::insertIntoIndex(*pool_, *index_file_, encodeIntKey(key), 1,
+                                   static_cast<uint16_t>(key));
+    }
+    const int grown_pages = index_file_->getMaxPageID() + 1;
+    if (fill_factor == 100) {
+      EXPECT_GT(grown_pages, loaded_pages * 3 / 2);
+    } else {
+      EXPECT_LT(grown_pages, loaded_pages * 5 / 4);
+    }
+    for (int key = 0; key < num_keys; key += 41) {
+      const std::vector<IndexEntry> found =
+          findExact(*pool_, *index_file_, encodeIntKey(key));
+      ASSERT_EQ(found.size(), 1u) << "key=" << key;
+      EXPECT_EQ(found.front().rid.slot_id, key);
+    }
+  }
+}
+
+TEST_F(IndexBuilderTest, PagesStoreTheCommonPrefixOfTheirKeyRange) {
+  IndexBuilder builder(*index_file_, IndexBuilder::Options{});
+  int count = 0;
+  for (int order_id = 1; order_id <= 3000; ++order_id) {
+    for (int line = 1; line <= 5; ++line) {
+      builder.add(encodeOrderLineKey(2, 7, order_id, line),
+                  RID{static_cast<uint16_t>(order_id),
+                      static_cast<uint16_t>(line)});
+      ++count;
+    }
+  }
+  builder.finish();
+
+  // All pages but the left and right edges have closed key ranges inside
+  // warehouse 2, district 7.
+  const std::string district_prefix =
+      encodeOrderLineKey(2, 7, 0, 0).substr(0, 10);
+  int pages = 0;
+  int prefixed_pages = 0;
+  for (PageId page_id = 0; page_id <= index_file_->getMaxPageID(); ++page_id) {
+    ReadPageGuard page = pool_->readPage(page_id, *index_file_);
+    ++pages;
+    if (page->keyPrefix().substr(0, district_prefix.size()) ==
+        district_prefix) {
+      ++prefixed_pages;
+    }
+  }
+  EXPECT_GT(prefixed_pages, pages * 3 / 4);
+
+  EXPECT_EQ(scanLeafChain().size(), static_cast<size_t>(count));
+  for (int order_id = 1; order_id <= 3000; order_id += 13) {
+    const std::vector<IndexEntry> found = findExact(
+        *pool_, *index_file_, encodeOrderLineKey(2, 7, order_id, 3));
+    ASSERT_EQ(found.size(), 1u) << "order_id=" << order_id;
+    EXPECT_EQ(found.front().rid.heap_page_id, order_id);
+  }
+}
+
+TEST_F(IndexBuilderTest, EmptyInputKeepsTheEmptyRootLeaf) {
+  IndexBuilder builder(*index_file_, IndexBuilder::Options{});
+  EXPECT_EQ(builder.finish(), 0u);
+  EXPECT_EQ(index_file_->getRootPageID(), 0u);
+  EXPECT_TRUE(scanLeafChain().empty());
+
+  BTreeCursor::insertIntoIndex(*pool_, *index_file_, encodeIntKey(5), 1, 5);
+  EXPECT_EQ(findExact(*pool_, *index_file_, encodeIntKey(5)).size(), 1u);
+}
@@ -2,10 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <cstring>
 #include <memory>
 #include <optional>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -50,7 +52,7 @@ TEST(PageTest, InsertLeafPageAndFind) {
   EXPECT_TRUE(page->isDirty());
   struct Entry {
     int key;
-    uint16_t heap_page_id;
+    PageId heap_page_id;
     uint16_t slot_id;
   } entries[] = {{22222, 500, 2}, {11111, 999, 15}, {33333, 123, 7}};
   int expected_slot_ids[] = {0, 0, 2};
@@ -180,13 +182,13 @@ TEST(PageTest, InsertOversizedHeapRecordDoesNotCorruptPage) {
 
 TEST(PageTest, InsertIntermediatePageAndFind) {
   std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
-  uint16_t right_most_child_page_id = 999;
+  PageId right_most_child_page_id = 999;
   auto page = std::make_unique<Page>(Page::initializeNew(
       page_data.data(), PageKind::InternalIndex, right_most_child_page_id, 1));
   EXPECT_TRUE(page->isDirty());
   struct Entry {
     int key;
-    uint16_t page_id;
+    PageId page_id;
   } entries[] = {{10000, 63}, {30000, 21}, {20000, 42}};
 
   for (const Entry& entry : entries) {
@@ -350,6 +352,142 @@ TEST(PageTest, LeafInsertInvalidateReuseSlot) {
   EXPECT_EQ(entries.front().rid.slot_id, 1);
 }
 
+TEST(PageTest, IndexSlotsStayInKeyOrderAcrossInvalidatedCells) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(
+      Page::initializeNew(page_data.data(), PageKind::LeafIndex,
+                          LeafIndexPage::NO_RIGHT_SIBLING, 1));
+  for (int key = 0; key < 40; key += 2) {
+    ASSERT_TRUE(page->insertCell(LeafCell(encodeIntKey(key), 1, key)));
+  }
+  // Invalidated cells keep their slots; new keys must still land in key
+  // order around them, or the binary search would skip over keys.
+  for (int slot_id = 0; slot_id < 20; slot_id += 3) {
+    page->invalidateSlot(static_cast<uint16_t>(slot_id));
+  }
+  for (int key = 39; key > 0; key -= 2) {
+    ASSERT_TRUE(page->insertCell(LeafCell(encodeIntKey(key), 1, key)));
+  }
+
+  LeafIndexPage leaf(*page);
+  ASSERT_EQ(page->slotCount(), 40);
+  for (int slot_id = 0; slot_id < 40; ++slot_id) {
+    EXPECT_EQ(LeafCell::getKey(page->slotCellStartUnchecked(slot_id)),
+              encodeIntKey(slot_id));
+  }
+  for (int key = 0; key < 40; ++key) {
+    const bool invalidated = key % 2 == 0 && (key / 2) % 3 == 0;
+    EXPECT_EQ(leaf.hasKey(encodeIntKey(key)), !invalidated) << "key=" << key;
+  }
+
+  auto [next_page, entries] =
+      leaf.findEntries(inclusiveBoundary(encodeIntKey(5)),
+                       BTreeCursor::Boundary{encodeIntKey(12), false}, false);
+  EXPECT_EQ(LeafIndexPage::NO_RIGHT_SIBLING, next_page);
+  std::vector<uint16_t> slot_ids;
+  for (const IndexEntry& entry : entries) {
+    slot_ids.push_back(entry.rid.slot_id);
+  }
+  EXPECT_EQ(slot_ids, (std::vector<uint16_t>{5, 7, 8, 9, 10, 11}));
+}
+
+TEST(PageTest, FindChildPageSkipsInvalidatedSeparators) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(Page::initializeNew(
+      page_data.data(), PageKind::InternalIndex, 999, 1));
+  for (int key = 1; key <= 5; ++key) {
+    ASSERT_TRUE(page->insertCell(IntermediateCell(
+        static_cast<uint16_t>(100 + key), encodeIntKey(key * 10))));
+  }
+  page->invalidateSlot(1);
+  page->invalidateSlot(4);
+
+  InternalIndexPage internal(*page);
+  EXPECT_EQ(101, internal.leftMostChildPageId());
+  EXPECT_EQ(101, internal.findChildPage(encodeIntKey(10)));
+  EXPECT_EQ(103, internal.findChildPage(encodeIntKey(11)));
+  EXPECT_EQ(103, internal.findChildPage(encodeIntKey(20)));
+  EXPECT_EQ(104, internal.findChildPage(encodeIntKey(40)));
+  EXPECT_EQ(999, internal.findChildPage(encodeIntKey(41)));
+}
+
+TEST(PageTest, LeafKeyPrefixIsStoredOnceAndSearchedAround) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(
+      Page::initializeNew(page_data.data(), PageKind::LeafIndex,
+                          LeafIndexPage::NO_RIGHT_SIBLING, 1));
+  // Keys 0x10000..0x100ff differ only in their last byte.
+  const std::string prefix = encodeIntKey(0x10000).substr(0, 4);
+  for (int key = 0x10000; key < 0x10100; key += 2) {
+    ASSERT_TRUE(page->insertCell(LeafCell(encodeIntKey(key), 1, key & 0xff)));
+  }
+  // Layout: bytes 3-4 = slot directory offset, the start of the cells.
+  auto cells_start = [&page_data] {
+    uint16_t offset;
+    std::memcpy(&offset, page_data.data() + 3, sizeof(offset));
+    return offset;
+  };
+  const uint16_t cells_start_before = cells_start();
+
+  LeafIndexPage leaf(*page);
+  leaf.setKeyPrefix(prefix);
+  EXPECT_EQ(page->keyPrefix(), prefix);
+  EXPECT_EQ(cells_start() - cells_start_before,
+            static_cast<int>(prefix.size()) * page->slotCount());
+  EXPECT_EQ(leaf.cellAt(3).key(), encodeIntKey(0x10006));
+
+  for (int key = 0x10000; key < 0x10100; ++key) {
+    EXPECT_EQ(leaf.hasKey(encodeIntKey(key)), key % 2 == 0) << key;
+  }
+  // Keys that sort before or after everything under the prefix.
+  EXPECT_FALSE(leaf.hasKey(encodeIntKey(0xff)));
+  EXPECT_FALSE(leaf.hasKey(encodeIntKey(0x20000)));
+  EXPECT_FALSE(leaf.hasKey(prefix.substr(0, 2)));
+  EXPECT_EQ(page->lowerBoundSlot(encodeIntKey(0xff)), 0);
+  EXPECT_EQ(page->lowerBoundSlot(prefix.substr(0, 2)), 0);
+  EXPECT_EQ(page->lowerBoundSlot(encodeIntKey(0x20000)), page->slotCount());
+  // Longer and shorter than the stored suffixes.
+  EXPECT_EQ(page->lowerBoundSlot(encodeIntKey(0x10004) + "x"), 3);
+  EXPECT_EQ(page->upperBoundSlot(encodeIntKey(0x10004)), 3);
+  EXPECT_EQ(page->lowerBoundSlot(prefix), 0);
+
+  ASSERT_TRUE(page->insertCell(LeafCell(encodeIntKey(0x10001), 1, 1)));
+  EXPECT_TRUE(leaf.hasKey(encodeIntKey(0x10001)));
+  EXPECT_EQ(leaf.cellAt(1).key(), encodeIntKey(0x10001));
+  EXPECT_THROW(page->insertCell(LeafCell(encodeIntKey(0x20000), 1, 1)),
+               std::logic_error);
+
+  auto [next_page, entries] =
+      leaf.findEntries(inclusiveBoundary(prefix),
+                       inclusiveBoundary(encodeIntKey(0x10003)), false);
+  EXPECT_EQ(LeafIndexPage::NO_RIGHT_SIBLING, next_page);
+  ASSERT_EQ(entries.size(), 3u);
+  EXPECT_EQ(entries[2].key, encodeIntKey(0x10002));
+}
+
+TEST(PageTest, MixedKeyLengthsDisableFixedWidthSearch) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(
+      Page::initializeNew(page_data.data(), PageKind::LeafIndex,
+                          LeafIndexPage::NO_RIGHT_SIBLING, 1));
+  const std::vector<std::string> keys = {
+      "b", "ab", "abc", "a", "abcdefghij", "abd", std::string("a\0", 2), "ac"};
+  for (const std::string& key : keys) {
+    ASSERT_TRUE(page->insertCell(LeafCell(key, 1, 1)));
+  }
+
+  std::vector<std::string> sorted = keys;
+  std::sort(sorted.begin(), sorted.end());
+  LeafIndexPage leaf(*page);
+  for (size_t slot = 0; slot < sorted.size(); ++slot) {
+    EXPECT_EQ(leaf.cellAt(static_cast<int>(slot)).key(), sorted[slot]);
+    EXPECT_TRUE(leaf.hasKey(sorted[slot]));
+  }
+  EXPECT_FALSE(leaf.hasKey("abcd"));
+  EXPECT_FALSE(leaf.hasKey(""));
+  EXPECT_EQ(page->lowerBoundSlot("abcd"), 4);
+}
+
 TEST(PageTest, HeapInsertInvalidateReuseSlot) {
   std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
   auto page = std::make_unique<Page>(
@@ -375,6 +513,108 @@ TEST(PageTest, HeapInsertInvalidateReuseSlot) {
   EXPECT_EQ(std::get<Column::VarcharType>(row.values[0]), payload);
 }
 
+TEST(PageTest, HeapInsertCompactsInvalidatedCellsAndKeepsSlotIds) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(
+      Page::initializeNew(page_data.data(), PageKind::Heap, 0, 1));
+  static const Schema schema{
+      std::vector<Column>{Column("value", Column::Type::Varchar)}};
+  auto valueAt = [&](int slot_id) {
+    return std::get<Column::VarcharType>(
+        RecordCellView(page->getSlotCellStart(slot_id))
+            .getTypedRow(schema)
+            .values[0]);
+  };
+
+  std::vector<int> slots;
+  while (const auto slot_id = page->insertCell(
+             serializeSingleVarcharRecord(
+                 "row-" + std::to_string(slots.size()) +
+                 std::string(slots.size() % 5 * 7, 'x'))
+                 .serializedBytes())) {
+    slots.push_back(*slot_id);
+  }
+  ASSERT_GT(slots.size(), 20u);
+  const size_t full_free_bytes = page->heapFreeBytes();
+  for (size_t i = 0; i < slots.size(); i += 2) {
+    page->invalidateSlot(slots[i]);
+  }
+  page->invalidateSlot(slots[0]);  // Counted once.
+  const size_t freed_bytes = page->heapFreeBytes() - full_free_bytes;
+  EXPECT_GT(freed_bytes, Page::PAGE_SIZE_BYTE / 3);
+
+  // Only fits once the invalidated cells are reclaimed.
+  const RecordSerializer large =
+      serializeSingleVarcharRecord(std::string(freed_bytes / 2, 'L'));
+  const auto large_slot = page->insertCell(large.serializedBytes());
+  ASSERT_TRUE(large_slot.has_value());
+  EXPECT_EQ(*large_slot, static_cast<int>(slots.size()));
+  EXPECT_EQ(page->heapFreeBytes(),
+            full_free_bytes + freed_bytes - large.serializedBytes().size() -
+                Page::CELL_POINTER_SIZE);
+
+  for (size_t i = 0; i < slots.size(); ++i) {
+    SCOPED_TRACE("slot " + std::to_string(slots[i]));
+    if (i % 2 == 0) {
+      EXPECT_FALSE(Cell::isValid(page->slotCellStartUnchecked(slots[i])));
+    } else {
+      ASSERT_TRUE(Cell::isValid(page->slotCellStartUnchecked(slots[i])));
+      EXPECT_EQ(valueAt(slots[i]), "row-" + std::to_string(i) +
+                                       std::string(i % 5 * 7, 'x'));
+    }
+  }
+  EXPECT_EQ(valueAt(*large_slot), std::string(freed_bytes / 2, 'L'));
+
+  // Slots reclaimed by compaction stay invalid and count nothing when they
+  // are invalidated again, as a repeated redo does.
+  const size_t free_bytes = page->heapFreeBytes();
+  page->invalidateSlot(slots[2]);
+  EXPECT_EQ(page->heapFreeBytes(), free_bytes);
+}
+
+TEST(PageTest, HeapCompactionReleasesDeadSlotsForReuse) {
+  std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
+  auto page = std::make_unique<Page>(
+      Page::initializeNew(page_data.data(), PageKind::Heap, 0, 1));
+  auto insert = [&](const std::string& value) {
+    return page->insertCell(
+        serializeSingleVarcharRecord(value).serializedBytes());
+  };
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_EQ(insert("row-" + std::to_string(i)), i);
+  }
+
+  // A compaction that keeps slots leaves them dead, and only a releasing
+  // one frees them, along with the cells it reclaims itself.
+  page->invalidateSlot(1);
+  EXPECT_EQ(page->compactHeapCells(), 0);
+  EXPECT_TRUE(page->hasDeadSlots());
+  EXPECT_EQ(insert("row-10"), 10);
+  page->invalidateSlot(5);
+  page->invalidateSlot(10);
+  EXPECT_EQ(page->compactHeapCells(/*release_dead_slots=*/true), 3);
+  EXPECT_FALSE(page->hasDeadSlots());
+  // The free slot at the end is dropped.
+  EXPECT_EQ(page->slotCount(), 10);
+
+  // Inserts take the lowest free slot first.
+  EXPECT_EQ(insert("new-1"), 1);
+  EXPECT_EQ(insert("new-5"), 5);
+  EXPECT_EQ(insert("new-10"), 10);
+  EXPECT_EQ(page->slotCount(), 11);
+  static const Schema schema{
+      std::vector<Column>{Column("value", Column::Type::Varchar)}};
+  for (const auto& [slot_id, value] :
+       std::vector<std::pair<int, std::string>>{
+           {0, "row-0"}, {1, "new-1"}, {5, "new-5"}, {9, "row-9"}}) {
+    EXPECT_EQ(std::get<Column::VarcharType>(
+                  RecordCellView(page->getSlotCellStart(slot_id))
+                      .getTypedRow(schema)
+                      .values[0]),
+              value);
+  }
+}
+
 TEST(PageTest, SetPageLSNUpdatesHeaderAndMarksDirty) {
   std::array<char, Page::PAGE_SIZE_BYTE> page_data{};
   auto page = std::make_unique<Page>(
@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+#include "storage/record/record_serializer.h"
+
 class RecordCellTest : public ::testing::Test {
  protected:
   void SetUp() override {}
@@ -15,4 +17,18 @@ class RecordCellTest : public ::testing::Test {
   void TearDown() override {}
 };
 
-TEST_F(RecordCellTest, DummyTest) {}
\ No newline at end of file
+TEST_F(RecordCellTest, DummyTest) {}
+TEST_F(RecordCellTest, CellHeaderRecordsTheCellSize) {
+  const Schema schema(std::vector<Column>{Column("id", Column::Type::Integer),
+                                          Column("name", Column::Type::Varchar),
+                                          Column("note", Column::Type::Varchar)});
+  for (const TypedRow& row :
+       {TypedRow{{1, std::string("alice"), std::string(300, 'x')}},
+        TypedRow{{2, std::monostate{}, std::string()}}}) {
+    const RecordSerializer serializer(schema, row);
+    const std::vector<std::byte>& bytes = serializer.serializedBytes();
+    const RecordCellView view(reinterpret_cast<const char*>(bytes.data()));
+    EXPECT_EQ(view.cellSize(), bytes.size());
+    EXPECT_EQ(view.getTypedRow(schema).values, row.values);
+  }
+}
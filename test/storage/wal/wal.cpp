@@ -7,56 +7,37 @@
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <thread>
 #include <vector>
 
+#include "storage/wal/wal_directory.h"
+#include "storage/wal/wal_reader.h"
 #include "storage/wal/wal_record.h"
 
 class WALTest : public ::testing::Test {
  protected:
   const char* wal_path = "testwal.log";
 
-  void SetUp() override { std::remove(wal_path); }
+  void SetUp() override { std::filesystem::remove_all(wal_path); }
 
-  void TearDown() override { std::remove(wal_path); }
+  void TearDown() override { std::filesystem::remove_all(wal_path); }
 
   std::vector<WALRecord> readWalRecords() const {
-    std::ifstream wal_file(wal_path, std::ios::binary);
-    if (!wal_file) {
+    if (!std::filesystem::exists(wal_path)) {
       return {};
     }
 
-    std::vector<char> raw_bytes((std::istreambuf_iterator<char>(wal_file)),
-                                std::istreambuf_iterator<char>());
+    WALReader reader(wal_path);
     std::vector<WALRecord> records;
-    std::size_t offset = 0;
-
-    while (offset < raw_bytes.size()) {
-      const std::size_t header_size = sizeof(uint64_t) +
-                                      sizeof(WALRecord::RecordType) +
-                                      sizeof(uint16_t) + sizeof(uint32_t);
-      if (raw_bytes.size() - offset < header_size) {
-        throw std::runtime_error("Incomplete WAL header in test fixture.");
-      }
-
-      uint32_t body_size = 0;
-      std::memcpy(&body_size,
-                  raw_bytes.data() + offset + sizeof(uint64_t) +
-                      sizeof(WALRecord::RecordType) + sizeof(uint16_t),
-                  sizeof(uint32_t));
-
-      const std::size_t record_size = header_size + body_size;
-      if (raw_bytes.size() - offset < record_size) {
-        throw std::runtime_error("Incomplete WAL record body in test fixture.");
-      }
-
-      std::vector<std::byte> record_bytes(record_size);
-      std::memcpy(record_bytes.data(), raw_bytes.data() + offset, record_size);
-      records.push_back(WALRecord::deserialize(record_bytes));
-      offset += record_size;
+    while (auto record = reader.next()) {
+      records.push_back(std::move(*record));
+    }
+    if (reader.hasTornTail()) {
+      throw std::runtime_error("Incomplete WAL record in test fixture.");
     }
-
     return records;
   }
 };
@@ -68,8 +49,8 @@ TEST_F(WALTest, FlushedLSNFollowsLastRecordLSN) {
   std::vector<std::byte> body2 = {std::byte{0x10}, std::byte{0x20},
                                   std::byte{0x30}};
 
-  wal->write(WALRecord::RecordType::INSERT, 1, body1);
-  wal->write(WALRecord::RecordType::DELETE, 2, body2);
+  wal->write(WALRecord::RecordType::INSERT, 1, 1, body1);
+  wal->write(WALRecord::RecordType::DELETE, 1, 2, body2);
 
   // Flush so getFlushedLSN() reflects the written records.
   wal->flush();
@@ -100,7 +81,7 @@ TEST_F(WALTest, WriteOverloadAllocatesSequentialLSNsFromRecordSizes) {
   };
 
   for (const auto& body : bodies) {
-    wal->write(WALRecord::RecordType::INSERT, 1, body);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body);
   }
   wal->flush();
 
@@ -122,15 +103,15 @@ TEST_F(WALTest, ReopenContinuesAppendingFromPersistedWalEnd) {
 
   {
     auto wal = WAL::initializeNew(wal_path);
-    wal->write(WALRecord::RecordType::INSERT, 1, body1);
-    wal->write(WALRecord::RecordType::INSERT, 1, body2);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body1);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body2);
     wal->flush();
   }
 
   {
     auto wal = WAL::openExisting(wal_path);
     EXPECT_EQ(wal->getFlushedLSN(), WALRecord::size_bytes(body1));
-    wal->write(WALRecord::RecordType::INSERT, 1, body3);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body3);
     wal->flush();
   }
 
@@ -140,4 +121,255 @@ TEST_F(WALTest, ReopenContinuesAppendingFromPersistedWalEnd) {
   EXPECT_EQ(records[1].get_lsn(), WALRecord::size_bytes(body1));
   EXPECT_EQ(records[2].get_lsn(),
             WALRecord::size_bytes(body1) + WALRecord::size_bytes(body2));
-}
\ No newline at end of file
+}
+TEST_F(WALTest, ReopenTruncatesTornTail) {
+  std::vector<std::byte> body1 = {std::byte{0x01}, std::byte{0x02}};
+  std::vector<std::byte> body2 = {std::byte{0x10}, std::byte{0x20},
+                                  std::byte{0x30}};
+
+  {
+    auto wal = WAL::initializeNew(wal_path);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body1);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body2);
+    wal->flush();
+  }
+  // A crash in the middle of writing the second record.
+  const auto valid_end = WALRecord::size_bytes(body1);
+  std::filesystem::resize_file(WALDirectory::segmentPath(wal_path, 0),
+                               valid_end + 5);
+
+  {
+    auto wal = WAL::openExisting(wal_path);
+    EXPECT_EQ(wal->getFlushedLSN(), 0u);
+    EXPECT_EQ(wal->getDurableEndLSN(), valid_end);
+    EXPECT_EQ(wal->write(WALRecord::RecordType::INSERT, 1, 1, body2),
+              valid_end);
+    wal->flush();
+  }
+
+  std::vector<WALRecord> records = readWalRecords();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[1].get_lsn(), valid_end);
+}
+
+TEST_F(WALTest, ReopenTruncatesRecordWithCorruptBody) {
+  std::vector<std::byte> body1 = {std::byte{0x01}, std::byte{0x02}};
+  std::vector<std::byte> body2(64, std::byte{0x5A});
+
+  {
+    auto wal = WAL::initializeNew(wal_path);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body1);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body2);
+    wal->flush();
+  }
+  // The second record's header reached the disk, but a block of its body
+  // did not: its length and LSN are intact, its bytes are not.
+  const auto valid_end = WALRecord::size_bytes(body1);
+  {
+    std::fstream segment(WALDirectory::segmentPath(wal_path, 0),
+                         std::ios::binary | std::ios::in | std::ios::out);
+    segment.seekp(static_cast<std::streamoff>(
+        valid_end + WALRecord::header_size_bytes() + 40));
+    segment.write("\0\0\0\0", 4);
+  }
+
+  {
+    WALReader reader(wal_path);
+    ASSERT_TRUE(reader.next().has_value());
+    EXPECT_FALSE(reader.next().has_value());
+    EXPECT_TRUE(reader.hasTornTail());
+    EXPECT_EQ(reader.validEndLSN(), valid_end);
+  }
+  {
+    auto wal = WAL::openExisting(wal_path);
+    EXPECT_EQ(wal->getDurableEndLSN(), valid_end);
+    EXPECT_EQ(wal->write(WALRecord::RecordType::INSERT, 1, 1, body1),
+              valid_end);
+    wal->flush();
+  }
+  EXPECT_EQ(readWalRecords().size(), 2u);
+}
+
+TEST_F(WALTest, CommitHandleWaitsUntilRecordsAreDurable) {
+  auto wal = WAL::initializeNew(wal_path);
+  std::vector<std::byte> body1 = {std::byte{0x01}, std::byte{0x02}};
+  std::vector<std::byte> body2 = {std::byte{0x10}};
+
+  EXPECT_EQ(wal->write(WALRecord::RecordType::INSERT, 1, 1, body1), 0u);
+  const std::uint64_t second_lsn =
+      wal->write(WALRecord::RecordType::DELETE, 1, 2, body2);
+  EXPECT_EQ(second_lsn, WALRecord::size_bytes(body1));
+
+  // No explicit flush(): the flusher thread serves the commit request.
+  const WAL::CommitHandle commit = wal->requestCommit();
+  EXPECT_EQ(commit.endLSN(), second_lsn + WALRecord::size_bytes(body2));
+  commit.wait();
+  EXPECT_TRUE(commit.isDurable());
+  EXPECT_EQ(wal->getFlushedLSN(), second_lsn);
+
+  std::vector<WALRecord> records = readWalRecords();
+  ASSERT_EQ(records.size(), 2u);
+  EXPECT_EQ(records[1].get_lsn(), second_lsn);
+
+  // Nothing new was appended, so a second commit is durable immediately.
+  EXPECT_TRUE(wal->requestCommit().isDurable());
+}
+
+// Concurrent committers must end up with a gap-free log in LSN order, and
+// each flush may cover several of their commits.
+TEST_F(WALTest, ConcurrentCommittersShareFlushes) {
+  constexpr int kThreads = 8;
+  constexpr int kCommitsPerThread = 100;
+  auto wal = WAL::initializeNew(wal_path);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&wal, t] {
+      std::vector<std::byte> body(16, static_cast<std::byte>(t));
+      for (int i = 0; i < kCommitsPerThread; ++i) {
+        wal->write(WALRecord::RecordType::INSERT, 1,
+                   static_cast<uint16_t>(t), body);
+        wal->requestCommit().wait();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const WALStats stats = wal->stats();
+  EXPECT_EQ(stats.records_written,
+            static_cast<std::uint64_t>(kThreads * kCommitsPerThread));
+  EXPECT_GE(stats.flushes, 1u);
+  EXPECT_LE(stats.flushes, stats.records_written);
+
+  std::vector<WALRecord> records = readWalRecords();
+  ASSERT_EQ(records.size(), static_cast<size_t>(kThreads * kCommitsPerThread));
+  std::uint64_t expected_lsn = 0;
+  for (const auto& record : records) {
+    EXPECT_EQ(record.get_lsn(), expected_lsn);
+    expected_lsn += WALRecord::size_bytes(record.get_body());
+  }
+}
+
+// Writers that append far more than the log buffer holds must wait for the
+// flusher to free ring space, and the file must still be gap-free.
+TEST_F(WALTest, WritersWrapAroundASmallLogBuffer) {
+  constexpr int kThreads = 4;
+  constexpr int kRecordsPerThread = 2000;
+  ::setenv("DBFS_WAL_BUFFER_BYTES", "65536", 1);
+  auto wal = WAL::initializeNew(wal_path);
+  ::unsetenv("DBFS_WAL_BUFFER_BYTES");
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&wal, t] {
+      // Bodies of varying size so that records straddle the ring's end.
+      for (int i = 0; i < kRecordsPerThread; ++i) {
+        std::vector<std::byte> body(1 + (i * 37 + t) % 200,
+                                    static_cast<std::byte>(t));
+        wal->write(WALRecord::RecordType::UPDATE, 1,
+                   static_cast<uint16_t>(t), body);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  wal->flush();
+
+  const WALStats stats = wal->stats();
+  EXPECT_GT(stats.bytes_written, 65536u * 4);
+  std::vector<WALRecord> records = readWalRecords();
+  ASSERT_EQ(records.size(), static_cast<size_t>(kThreads * kRecordsPerThread));
+  std::uint64_t expected_lsn = 0;
+  for (const auto& record : records) {
+    ASSERT_EQ(record.get_lsn(), expected_lsn);
+    for (std::byte b : record.get_body()) {
+      ASSERT_EQ(b, static_cast<std::byte>(record.get_page_id()));
+    }
+    expected_lsn += WALRecord::size_bytes(record.get_body());
+  }
+  EXPECT_EQ(wal->getFlushedLSN(),
+            expected_lsn - WALRecord::size_bytes(records.back().get_body()));
+}
+
+TEST_F(WALTest, RecordsContinueAcrossSegments) {
+  ::setenv("DBFS_WAL_SEGMENT_BYTES", "65536", 1);
+  const std::vector<std::byte> body(1000, std::byte{0x42});
+  constexpr int kRecords = 300;
+  {
+    auto wal = WAL::initializeNew(wal_path);
+    for (int i = 0; i < kRecords; ++i) {
+      wal->write(WALRecord::RecordType::INSERT, 1, 1, body);
+    }
+    wal->flush();
+    EXPECT_GE(wal->stats().segments_created, 4u);
+  }
+
+  {
+    // Appends continue in the last segment after a restart.
+    auto wal = WAL::openExisting(wal_path);
+    wal->write(WALRecord::RecordType::INSERT, 1, 1, body);
+    wal->flush();
+  }
+  ::unsetenv("DBFS_WAL_SEGMENT_BYTES");
+
+  const std::vector<WALSegment> segments = WALDirectory::listSegments(wal_path);
+  ASSERT_GE(segments.size(), 4u);
+  for (size_t i = 0; i + 1 < segments.size(); ++i) {
+    EXPECT_EQ(segments[i].start_lsn + segments[i].size_bytes,
+              segments[i + 1].start_lsn);
+    EXPECT_LE(segments[i].size_bytes, 65536u);
+  }
+  std::vector<WALRecord> records = readWalRecords();
+  ASSERT_EQ(records.size(), static_cast<size_t>(kRecords + 1));
+  EXPECT_EQ(records.back().get_lsn(),
+            kRecords * WALRecord::size_bytes(body));
+}
+
+TEST_F(WALTest, CheckpointLetsOldSegmentsGo) {
+  ::setenv("DBFS_WAL_SEGMENT_BYTES", "65536", 1);
+  const std::vector<std::byte> body(1000, std::byte{0x42});
+  std::uint64_t checkpoint_lsn = 0;
+  std::uint64_t last_lsn = 0;
+  {
+    auto wal = WAL::initializeNew(wal_path);
+    for (int i = 0; i < 200; ++i) {
+      wal->write(WALRecord::RecordType::INSERT, 1, 1, body);
+    }
+    const std::uint64_t redo_lsn = wal->getEndLSN();
+    CheckpointBody checkpoint;
+    checkpoint.redo_lsn = redo_lsn;
+    checkpoint_lsn = wal->writeCheckpoint(checkpoint.encode());
+    EXPECT_EQ(WALDirectory::readCheckpointLSN(wal_path), checkpoint_lsn);
+
+    const size_t before = WALDirectory::listSegments(wal_path).size();
+    const size_t removed = wal->removeSegmentsBefore(redo_lsn);
+    EXPECT_GE(removed, 2u);
+    const std::vector<WALSegment> segments =
+        WALDirectory::listSegments(wal_path);
+    EXPECT_EQ(segments.size(), before - removed);
+    EXPECT_LE(segments.front().start_lsn, redo_lsn);
+    last_lsn = wal->write(WALRecord::RecordType::INSERT, 1, 2, body);
+    wal->flush();
+  }
+
+  // Startup reads from the checkpoint, so the removed segments are not
+  // missed.
+  auto wal = WAL::openExisting(wal_path);
+  ::unsetenv("DBFS_WAL_SEGMENT_BYTES");
+  EXPECT_EQ(wal->getFlushedLSN(), last_lsn);
+  EXPECT_EQ(wal->getEndLSN(), last_lsn + WALRecord::size_bytes(body));
+
+  WALReader reader(wal_path, checkpoint_lsn);
+  const auto checkpoint = reader.next();
+  ASSERT_TRUE(checkpoint.has_value());
+  EXPECT_EQ(checkpoint->get_type(), WALRecord::RecordType::CHECKPOINT);
+  const auto last = reader.next();
+  ASSERT_TRUE(last.has_value());
+  EXPECT_EQ(last->get_lsn(), last_lsn);
+  EXPECT_FALSE(reader.next().has_value());
+  EXPECT_FALSE(reader.hasTornTail());
+  EXPECT_THROW(WALReader(wal_path, 0), std::runtime_error);
+}
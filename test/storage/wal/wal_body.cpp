@@ -4,6 +4,8 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
 TEST(WALBodyTest, InsertRedoBodyRoundTrip) {
@@ -55,3 +57,68 @@ TEST(WALBodyTest, DeleteRedoBodyRoundTrip) {
     EXPECT_EQ(original.before[i], decoded.before[i]);
   }
 }
+
+TEST(WALBodyTest, CheckpointBodyRoundTrip) {
+  CheckpointBody original;
+  original.redo_lsn = 4096;
+  original.dirty_pages = {{1, 3, 4096}, {2, 0, 8192}};
+  original.stale_indexes = {1, 5};
+
+  CheckpointBody decoded = CheckpointBody::decode(original.encode());
+
+  EXPECT_EQ(decoded.redo_lsn, original.redo_lsn);
+  ASSERT_EQ(decoded.dirty_pages.size(), 2u);
+  EXPECT_EQ(decoded.dirty_pages[1].relation_id, 2u);
+  EXPECT_EQ(decoded.dirty_pages[1].page_id, 0);
+  EXPECT_EQ(decoded.dirty_pages[1].rec_lsn, 8192u);
+  EXPECT_EQ(decoded.stale_indexes, original.stale_indexes);
+}
+
+TEST(WALBodyTest, TruncatedCheckpointBodyIsRejected) {
+  CheckpointBody original;
+  original.redo_lsn = 4096;
+  original.dirty_pages = {{1, 3, 4096}, {2, 0, 8192}};
+  original.stale_indexes = {1, 5};
+  const std::vector<std::byte> encoded = original.encode();
+
+  // Every proper prefix ends inside a field or a counted array.
+  for (std::size_t size = 0; size < encoded.size(); ++size) {
+    SCOPED_TRACE("size " + std::to_string(size));
+    const std::vector<std::byte> truncated(encoded.begin(),
+                                           encoded.begin() + size);
+    EXPECT_THROW(CheckpointBody::decode(truncated), std::runtime_error);
+  }
+
+  // A dirty page count far past the body.
+  std::vector<std::byte> corrupt = encoded;
+  corrupt[sizeof(uint64_t) + 3] = std::byte{0x7F};
+  EXPECT_THROW(CheckpointBody::decode(corrupt), std::runtime_error);
+}
+
+TEST(WALBodyTest, CompactRedoBodyRoundTrip) {
+  CompactRedoBody original;
+  original.slot_count = 41;
+  original.reclaimed_bytes = 1234;
+  original.released_slots = 7;
+
+  CompactRedoBody decoded = CompactRedoBody::decode(original.encode());
+
+  EXPECT_EQ(decoded.slot_count, original.slot_count);
+  EXPECT_EQ(decoded.reclaimed_bytes, original.reclaimed_bytes);
+  EXPECT_EQ(decoded.released_slots, original.released_slots);
+}
+
+TEST(WALBodyTest, TruncatedCompactRedoBodyIsRejected) {
+  CompactRedoBody original;
+  original.slot_count = 41;
+  original.reclaimed_bytes = 1234;
+  original.released_slots = 7;
+  const std::vector<std::byte> encoded = original.encode();
+
+  for (std::size_t size = 0; size < encoded.size(); ++size) {
+    SCOPED_TRACE("size " + std::to_string(size));
+    const std::vector<std::byte> truncated(encoded.begin(),
+                                           encoded.begin() + size);
+    EXPECT_THROW(CompactRedoBody::decode(truncated), std::runtime_error);
+  }
+}
@@ -6,25 +6,29 @@
 #include <cstdint>
 #include <vector>
 
+#include "storage/wal/crc32c.h"
 #include "storage/wal/wal_body.h"
 
 // Build a representative INSERT record and verify that serialization keeps
 // both the record metadata and raw body bytes intact across round-trip.
 TEST(WALRecordTest, SerializeDeserializeRoundTrip) {
-  uint16_t page_id = 321;
+  uint32_t relation_id = 7;
+  PageId page_id = 70321;
 
   InsertRedoBody body;
   body.offset = 55;
   body.tuple = {std::byte{0x01}, std::byte{0x02}, std::byte{0x03}};
   std::vector<std::byte> encoded_body = body.encode();
 
-  WALRecord record(123, WALRecord::RecordType::INSERT, page_id, encoded_body);
+  WALRecord record(123, WALRecord::RecordType::INSERT, relation_id, page_id,
+                   encoded_body);
 
   std::vector<std::byte> serialized = record.serialize();
   WALRecord restored = WALRecord::deserialize(serialized);
 
   EXPECT_EQ(record.get_lsn(), restored.get_lsn());
   EXPECT_EQ(WALRecord::RecordType::INSERT, restored.get_type());
+  EXPECT_EQ(relation_id, restored.get_relation_id());
   EXPECT_EQ(page_id, restored.get_page_id());
 
   const auto& restored_body = restored.get_body();
@@ -42,7 +46,8 @@ TEST(WALRecordTest, DecodeBodyDispatchesToCorrectType) {
   insert_body.offset = 10;
   insert_body.tuple = {std::byte{0x10}, std::byte{0x20}};
   auto insert_encoded = insert_body.encode();
-  WALRecord insert_record(0, WALRecord::RecordType::INSERT, 0, insert_encoded);
+  WALRecord insert_record(0, WALRecord::RecordType::INSERT, 1, 0,
+                          insert_encoded);
 
   WALBody insert_variant = decode_body(insert_record);
   ASSERT_TRUE(std::holds_alternative<InsertRedoBody>(insert_variant));
@@ -59,7 +64,8 @@ TEST(WALRecordTest, DecodeBodyDispatchesToCorrectType) {
   update_body.before = {std::byte{0x01}};
   update_body.after = {std::byte{0x02}, std::byte{0x03}};
   auto update_encoded = update_body.encode();
-  WALRecord update_record(10, WALRecord::RecordType::UPDATE, 0, update_encoded);
+  WALRecord update_record(10, WALRecord::RecordType::UPDATE, 1, 0,
+                          update_encoded);
 
   WALBody update_variant = decode_body(update_record);
   ASSERT_TRUE(std::holds_alternative<UpdateRedoBody>(update_variant));
@@ -79,7 +85,8 @@ TEST(WALRecordTest, DecodeBodyDispatchesToCorrectType) {
   delete_body.offset = 30;
   delete_body.before = {std::byte{0xAA}, std::byte{0xBB}};
   auto delete_encoded = delete_body.encode();
-  WALRecord delete_record(20, WALRecord::RecordType::DELETE, 0, delete_encoded);
+  WALRecord delete_record(20, WALRecord::RecordType::DELETE, 1, 0,
+                          delete_encoded);
 
   WALBody delete_variant = decode_body(delete_record);
   ASSERT_TRUE(std::holds_alternative<DeleteRedoBody>(delete_variant));
@@ -90,3 +97,36 @@ TEST(WALRecordTest, DecodeBodyDispatchesToCorrectType) {
     EXPECT_EQ(delete_body.before[i], delete_decoded.before[i]);
   }
 }
+
+TEST(WALRecordTest, HeaderCarriesCrcOfHeaderAndBody) {
+  // The CRC-32C check value.
+  const char check[] = "123456789";
+  EXPECT_EQ(crc32c::value(reinterpret_cast<const std::byte*>(check), 9),
+            0xE3069283u);
+
+  std::vector<std::byte> body(100);
+  for (std::size_t i = 0; i < body.size(); ++i) {
+    body[i] = static_cast<std::byte>(i * 7);
+  }
+  const std::vector<std::byte> serialized =
+      WALRecord(64, WALRecord::RecordType::DELETE, 3, 9, body).serialize();
+  const std::byte* header = serialized.data();
+  const std::byte* serialized_body =
+      serialized.data() + WALRecord::header_size_bytes();
+  EXPECT_EQ(WALRecord::storedChecksum(header),
+            WALRecord::checksum(header, serialized_body, 100));
+
+  // Any changed byte, in the header or the body, changes the CRC.
+  std::vector<std::byte> changed = serialized;
+  changed[WALRecord::header_size_bytes() + 50] ^= std::byte{0x01};
+  EXPECT_NE(WALRecord::checksum(changed.data(),
+                                changed.data() + WALRecord::header_size_bytes(),
+                                100),
+            WALRecord::storedChecksum(header));
+  changed = serialized;
+  changed[WALRecord::body_size_offset_bytes() - 1] ^= std::byte{0x80};
+  EXPECT_NE(WALRecord::checksum(changed.data(),
+                                changed.data() + WALRecord::header_size_bytes(),
+                                100),
+            WALRecord::storedChecksum(header));
+}